@@ -15,6 +15,9 @@
 #define OLED_SCL_PIN        6           // IO6 - I2C时钟线
 #define OLED_SDA_PIN        8           // IO8 - I2C数据线
 #define OLED_I2C_ADDR       0x3C        // SSD1306 I2C地址
+#ifndef OLED_I2C_CLOCK
+#define OLED_I2C_CLOCK      400000      // 硬件I2C时钟 (USE_HW_I2C时有效)
+#endif
 
 // ============================================================================
 // 按键配置 (Active Low - 按下接地)
@@ -0,0 +1,44 @@
+/**
+ * @file AppEvents.cpp
+ * @brief 唤醒主循环的事件组实现
+ */
+
+#include "AppEvents.h"
+#include <esp32-hal-log.h>
+
+static const char* TAG = "AppEvents";
+
+EventGroupHandle_t AppEvents::_group = NULL;
+
+bool AppEvents::begin() {
+    if (_group == NULL) {
+        _group = xEventGroupCreate();
+    }
+    if (_group == NULL) {
+        ESP_LOGE(TAG, "事件组创建失败");
+        return false;
+    }
+    return true;
+}
+
+void AppEvents::post(EventBits_t bits) {
+    if (_group != NULL) {
+        xEventGroupSetBits(_group, bits);
+    }
+}
+
+EventBits_t AppEvents::wait(unsigned long timeoutMs) {
+    if (_group == NULL) {
+        // 没有事件组时退回轮询
+        if (timeoutMs > 0) {
+            vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+        }
+        return 0;
+    }
+    // 等到任一位即返回，并清除返回的位
+    return xEventGroupWaitBits(_group, ALL, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs)) & ALL;
+}
+
+bool AppEvents::pending() {
+    return _group != NULL && (xEventGroupGetBits(_group) & ALL) != 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file AppEvents.h
+ * @brief 唤醒主循环的事件组
+ *
+ * 主循环没事可做时阻塞在wait()上，不再空转。产生事件的任务
+ * (按键、RF解码、发送) 把数据放进各自的队列后post()对应的位，
+ * 主循环醒来后把所有队列取空。事件位是锁存的: 主循环忙时post()的位
+ * 保留到下一次wait()立即返回，不会丢失。
+ */
+
+#ifndef APP_EVENTS_H
+#define APP_EVENTS_H
+
+#include <Arduino.h>
+#include <freertos/event_groups.h>
+
+class AppEvents {
+public:
+    static const EventBits_t BUTTON = 1 << 0;   // 按键事件入队
+    static const EventBits_t RF = 1 << 1;       // 解码出帧或原始捕获完成
+    static const EventBits_t TX = 1 << 2;       // 发送任务结束 (完成、取消或失败)
+    static const EventBits_t ALL = BUTTON | RF | TX;
+
+    /**
+     * 创建事件组 (在其他模块begin()之前调用)
+     */
+    static bool begin();
+
+    /**
+     * 设置事件位 (任务中调用)
+     */
+    static void post(EventBits_t bits);
+
+    /**
+     * 等待任一事件
+     * @param timeoutMs 最长等待时间，0=不等待
+     * @return 收到的事件位 (已清除)，超时返回0
+     */
+    static EventBits_t wait(unsigned long timeoutMs);
+
+    /**
+     * 有没有还没被wait()取走的事件位
+     */
+    static bool pending();
+
+private:
+    static EventGroupHandle_t _group;
+};
+
+#endif // APP_EVENTS_H
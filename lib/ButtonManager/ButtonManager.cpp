@@ -4,6 +4,7 @@
  */
 
 #include "ButtonManager.h"
+#include "AppEvents.h"
 #include <esp32-hal-log.h>
 
 static const char* TAG = "Button";
@@ -31,11 +32,6 @@ void ButtonManager::begin() {
     pinMode(_okBtn.pin, INPUT_PULLUP);
     pinMode(_downBtn.pin, INPUT_PULLUP);
 
-    // 附加中断 (下降沿触发 - 按键按下时)
-    attachInterrupt(digitalPinToInterrupt(_upBtn.pin), handleUpButton, FALLING);
-    attachInterrupt(digitalPinToInterrupt(_okBtn.pin), handleOkButton, FALLING);
-    attachInterrupt(digitalPinToInterrupt(_downBtn.pin), handleDownButton, FALLING);
-
     // 创建长按检测任务 (优先级10, 运行在核心1)
     xTaskCreatePinnedToCore(
         checkLongPress,           // 任务函数
@@ -47,6 +43,11 @@ void ButtonManager::begin() {
         1                         // 核心1
     );
 
+    // 附加中断 (下降沿触发 - 按键按下时)，中断里要通知上面的任务
+    attachInterrupt(digitalPinToInterrupt(_upBtn.pin), handleUpButton, FALLING);
+    attachInterrupt(digitalPinToInterrupt(_okBtn.pin), handleOkButton, FALLING);
+    attachInterrupt(digitalPinToInterrupt(_downBtn.pin), handleDownButton, FALLING);
+
     ESP_LOGI(TAG, "按键管理器初始化完成");
 }
 
@@ -61,6 +62,7 @@ void IRAM_ATTR ButtonManager::handleUpButton() {
     _upBtn.pressed = true;
     _upBtn.pressTime = now;
     _upBtn.longPressTriggered = false;
+    wakeLongPressTask();
 }
 
 void IRAM_ATTR ButtonManager::handleOkButton() {
@@ -73,6 +75,7 @@ void IRAM_ATTR ButtonManager::handleOkButton() {
     _okBtn.pressed = true;
     _okBtn.pressTime = now;
     _okBtn.longPressTriggered = false;
+    wakeLongPressTask();
 }
 
 void IRAM_ATTR ButtonManager::handleDownButton() {
@@ -85,10 +88,28 @@ void IRAM_ATTR ButtonManager::handleDownButton() {
     _downBtn.pressed = true;
     _downBtn.pressTime = now;
     _downBtn.longPressTriggered = false;
+    wakeLongPressTask();
+}
+
+void IRAM_ATTR ButtonManager::wakeLongPressTask() {
+    if (_longPressTaskHandle == NULL) {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(_longPressTaskHandle, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
 }
 
 void ButtonManager::checkLongPress(void* parameter) {
     while (true) {
+        // 没有按键按下时阻塞，由按键中断唤醒 (通知计数不会丢)
+        if (!isPressed()) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
         unsigned long now = millis();
 
         // 检查上键
@@ -156,7 +177,7 @@ void ButtonManager::checkLongPress(void* parameter) {
             }
         }
 
-        // 缩短检查间隔到5ms，提高响应速度
+        // 有按键按下时每5ms检查一次长按和释放
         vTaskDelay(pdMS_TO_TICKS(5));
     }
 }
@@ -169,6 +190,8 @@ void ButtonManager::pushEvent(ButtonEvent event) {
         _eventQueue[_queueTail] = event;
         _queueTail = nextTail;
     }
+
+    AppEvents::post(AppEvents::BUTTON);
 }
 
 ButtonEvent ButtonManager::getEvent() {
@@ -185,3 +208,30 @@ ButtonEvent ButtonManager::getEvent() {
 bool ButtonManager::hasEvent() {
     return _queueHead != _queueTail;
 }
+
+bool ButtonManager::isPressed() {
+    return _upBtn.pressed || _okBtn.pressed || _downBtn.pressed;
+}
+
+void ButtonManager::resyncAfterWake() {
+    // 睡眠期间GPIO中断不工作，唤醒时的下降沿没有进中断:
+    // 按着的键按刚刚按下处理，长按从现在开始计时
+    unsigned long now = millis();
+    bool resynced = resyncButton(_upBtn, now);
+    resynced = resyncButton(_okBtn, now) || resynced;
+    resynced = resyncButton(_downBtn, now) || resynced;
+
+    if (resynced && _longPressTaskHandle != NULL) {
+        xTaskNotifyGive(_longPressTaskHandle);
+    }
+}
+
+bool ButtonManager::resyncButton(ButtonState& button, unsigned long now) {
+    if (button.pressed || digitalRead(button.pin) != LOW) {
+        return false;
+    }
+    button.pressTime = now;
+    button.longPressTriggered = false;
+    button.pressed = true;
+    return true;
+}
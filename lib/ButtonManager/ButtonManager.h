@@ -5,6 +5,9 @@
  * 支持三个按键（上、确认、下）的中断处理
  * 支持短按和长按检测（长按500ms）
  * 按键为Active Low (按下时下拉到GND)
+ *
+ * 长按检测任务只在有按键按下时轮询，其余时间阻塞等按键中断；
+ * 事件入队时通知主循环 (AppEvents::BUTTON)。
  */
 
 #ifndef BUTTON_MANAGER_H
@@ -48,12 +51,25 @@ public:
      */
     bool hasEvent();
 
+    /**
+     * @brief 是否有按键按着 (还没产生释放事件)
+     */
+    static bool isPressed();
+
+    /**
+     * @brief 从浅睡眠唤醒后调用，补上睡眠期间没进中断的按下
+     */
+    void resyncAfterWake();
+
 private:
     // 静态中断处理函数
     static void IRAM_ATTR handleUpButton();
     static void IRAM_ATTR handleOkButton();
     static void IRAM_ATTR handleDownButton();
 
+    // 通知长按检测任务 (中断中调用)
+    static void IRAM_ATTR wakeLongPressTask();
+
     // 长按检测任务
     static void checkLongPress(void* parameter);
 
@@ -71,6 +87,9 @@ private:
     static ButtonState _okBtn;
     static ButtonState _downBtn;
 
+    // 按着但没标记按下时补上，返回是否补了
+    static bool resyncButton(ButtonState& button, unsigned long now);
+
     // 事件队列 (简单的环形缓冲区)
     static const int EVENT_QUEUE_SIZE = 10;
     static volatile ButtonEvent _eventQueue[EVENT_QUEUE_SIZE];
@@ -0,0 +1,49 @@
+/**
+ * @file Crc32.h
+ * @brief CRC-32 (IEEE 802.3, 与zlib相同) 校验
+ *
+ * 使用16项半字节查找表，表只占64字节，速度足够校验存储记录。
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class Crc32 {
+public:
+    static const uint32_t INITIAL = 0xFFFFFFFF;
+
+    /**
+     * 计算一段数据的CRC
+     */
+    static uint32_t compute(const void* data, size_t length) {
+        return finish(update(INITIAL, data, length));
+    }
+
+    /**
+     * 分段计算: crc = update(INITIAL, ...) ... finish(crc)
+     */
+    static uint32_t update(uint32_t crc, const void* data, size_t length) {
+        static const uint32_t TABLE[16] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+            0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+            0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= bytes[i];
+            crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+            crc = (crc >> 4) ^ TABLE[crc & 0x0F];
+        }
+        return crc;
+    }
+
+    static uint32_t finish(uint32_t crc) {
+        return crc ^ 0xFFFFFFFF;
+    }
+};
+
+#endif // CRC32_H
@@ -4,27 +4,42 @@
  */
 
 #include "Display.h"
+#include "OledI2c.h"
 #include <esp32-hal-log.h>
 
 static const char* TAG = "Display";
 
 Display::Display()
-    #ifdef USE_HW_I2C
-        : _u8g2(U8G2_R0, U8X8_PIN_NONE) {
-        // 硬件I2C构造函数
-    #else
-        : _u8g2(U8G2_R0, OLED_SCL_PIN, OLED_SDA_PIN, U8X8_PIN_NONE) {
-        // 软件I2C构造函数 (scl, sda, reset)
-    #endif
+    : _u8g2(U8G2_R0, OLED_SCL_PIN, OLED_SDA_PIN, U8X8_PIN_NONE)  // 软件I2C构造函数 (scl, sda, reset)
+        , _swByteCallback(NULL)
+        , _bus(BUS_SW_I2C)
+        , _benchmarkState(BENCHMARK_NONE)
+        , _sendIndex(0)
+        , _framePending(false)
+        , _invalidatePending(false)
+        , _sending(false)
+        , _diff()
+        , _mutex(NULL)
+        , _displayTaskHandle(NULL)
+        , _frameCount(0)
+        , _coalescedCount(0)
+        , _droppedCount(0)
+        , _totalBytes(0)
+        , _lastFrameBytes(0)
+        , _lastFrameTime(0)
+        , _maxFrameTime(0)
+{
+    memset(_benchmarkResults, 0, sizeof(_benchmarkResults));
+    memset(_frames, 0, sizeof(_frames));
 }
 
 bool Display::begin() {
-    #ifdef USE_HW_I2C
-        ESP_LOGI(TAG, "初始化OLED显示屏 (硬件I2C, 1MHz)...");
+    // 软件I2C的回调在构造时设好，切换总线时要还原
+    _swByteCallback = _u8g2.getU8x8()->byte_cb;
 
-        // 设置I2C时钟频率为1MHz (ESP32-C3支持)
-        Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
-        Wire.setClock(1000000);  // 1MHz - SSD1306最高支持
+    #ifdef USE_HW_I2C
+        ESP_LOGI(TAG, "初始化OLED显示屏 (硬件I2C, %lu Hz)...", (unsigned long)OLED_I2C_CLOCK);
+        selectBus(BUS_HW_I2C, OLED_I2C_CLOCK);
     #else
         ESP_LOGI(TAG, "初始化OLED显示屏 (软件I2C)...");
     #endif
@@ -37,8 +52,26 @@ bool Display::begin() {
     _u8g2.enableUTF8Print();
     _u8g2.setContrast(255);
 
-    // 设置I2C时钟 (对软件I2C也有效)
-    _u8g2.setBusClock(400000);  // 400kHz
+    // begin()清过屏，但影子缓冲区还没和屏幕对上
+    _diff.invalidate();
+
+    // 之后I2C只由显示任务使用
+    if (_mutex == NULL) {
+        _mutex = xSemaphoreCreateMutex();
+    }
+    if (_displayTaskHandle == NULL) {
+        xTaskCreate(
+            displayTask,              // 任务函数
+            "Display",                // 任务名称
+            3072,                     // 堆栈大小
+            this,                     // 参数
+            1,                        // 优先级 (与主循环相同，发送时主循环照常运行)
+            &_displayTaskHandle       // 任务句柄
+        );
+    }
+    if (_displayTaskHandle == NULL) {
+        ESP_LOGW(TAG, "显示任务创建失败，改为同步刷新");
+    }
 
     ESP_LOGI(TAG, "OLED初始化成功");
     return true;
@@ -60,8 +93,206 @@ void Display::scanI2C() {
     }
 
     ESP_LOGD(TAG, "扫描完成，找到 %d 个设备", count);
+
+    // 释放I2C控制器和引脚，之后由显示驱动使用
+    Wire.end();
+}
+
+void Display::selectBus(Bus bus, uint32_t clock) {
+    u8x8_t* u8x8 = _u8g2.getU8x8();
+    if (bus == BUS_HW_I2C) {
+        OledI2c::begin(I2C_NUM_0, OLED_SDA_PIN, OLED_SCL_PIN, clock);
+        u8x8->byte_cb = OledI2c::byteCallback;
+        u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_INIT, 0, NULL);
+    } else {
+        OledI2c::end();
+        u8x8->byte_cb = _swByteCallback;
+        u8x8_gpio_Init(u8x8);
+        u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_INIT, 0, NULL);
+    }
+    _bus = bus;
 }
 
 U8G2* Display::getU8g2() {
     return &_u8g2;
 }
+
+bool Display::present() {
+    // 没有显示任务时直接发送
+    if (_displayTaskHandle == NULL) {
+        memcpy(_frames[_sendIndex], _u8g2.getBufferPtr(), FRAME_SIZE);
+        sendFrame(_frames[_sendIndex]);
+        return true;
+    }
+
+    // 任务只在交换缓冲区时短暂持有锁，拿不到说明任务被长时间打断
+    if (xSemaphoreTake(_mutex, PRESENT_TIMEOUT) != pdTRUE) {
+        _droppedCount++;
+        return false;
+    }
+    if (_framePending) {
+        _coalescedCount++;
+    }
+    memcpy(_frames[_sendIndex ^ 1], _u8g2.getBufferPtr(), FRAME_SIZE);
+    _framePending = true;
+    xSemaphoreGive(_mutex);
+
+    xTaskNotifyGive(_displayTaskHandle);
+    return true;
+}
+
+void Display::invalidate() {
+    if (_mutex == NULL) {
+        _diff.invalidate();
+        return;
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _invalidatePending = true;
+    xSemaphoreGive(_mutex);
+}
+
+void Display::resetStats() {
+    _frameCount = 0;
+    _coalescedCount = 0;
+    _droppedCount = 0;
+    _totalBytes = 0;
+    _maxFrameTime = 0;
+}
+
+void Display::sendFrame(uint8_t* frame) {
+    const unsigned long start = micros();
+
+    TileDiff::Run runs[TileDiff::MAX_RUNS];
+    const int count = _diff.diff(frame, 0, TileDiff::HEIGHT_TILES, runs);
+
+    uint32_t bytes = 0;
+    OledI2c::beginBatch();
+    for (int i = 0; i < count; i++) {
+        const TileDiff::Run& run = runs[i];
+        u8x8_DrawTile(_u8g2.getU8x8(), run.x, run.y, run.width,
+                      &frame[run.y * TileDiff::ROW_BYTES + run.x * TileDiff::TILE_BYTES]);
+        OledI2c::flush();   // 硬件I2C: 一段一次传输 (软件I2C没有攒下的数据)
+        bytes += TileDiff::runBytes(run.width);
+    }
+    OledI2c::endBatch();
+
+    _lastFrameTime = micros() - start;
+    _lastFrameBytes = bytes;
+    _totalBytes += bytes;
+    _frameCount++;
+    if (_lastFrameTime > _maxFrameTime) {
+        _maxFrameTime = _lastFrameTime;
+    }
+    ESP_LOGV(TAG, "刷新: %d 段, %lu 字节, %lu us", count, (unsigned long)bytes, (unsigned long)_lastFrameTime);
+}
+
+void Display::displayTask(void* parameter) {
+    Display* self = static_cast<Display*>(parameter);
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (self->_benchmarkState == BENCHMARK_REQUESTED) {
+            self->runBenchmark();
+        }
+
+        // 交换缓冲区: 待发送的帧变成正在发送的帧，主循环之后写另一个
+        xSemaphoreTake(self->_mutex, portMAX_DELAY);
+        if (!self->_framePending) {
+            xSemaphoreGive(self->_mutex);
+            continue;
+        }
+        self->_sendIndex ^= 1;
+        self->_framePending = false;
+        self->_sending = true;
+        if (self->_invalidatePending) {
+            self->_invalidatePending = false;
+            self->_diff.invalidate();
+        }
+        xSemaphoreGive(self->_mutex);
+
+        self->sendFrame(self->_frames[self->_sendIndex]);
+        self->_sending = false;
+    }
+}
+
+// ==================== 总线测速 ====================
+
+void Display::requestBenchmark() {
+    if (_benchmarkState == BENCHMARK_RUNNING || _benchmarkState == BENCHMARK_REQUESTED) {
+        return;
+    }
+    _benchmarkState = BENCHMARK_REQUESTED;
+    if (_displayTaskHandle != NULL) {
+        xTaskNotifyGive(_displayTaskHandle);
+    } else {
+        runBenchmark();
+    }
+}
+
+uint32_t Display::timeFullFrames(const uint8_t* frame) {
+    u8x8_t* u8x8 = _u8g2.getU8x8();
+    const unsigned long start = micros();
+    OledI2c::beginBatch();
+    for (int n = 0; n < BENCHMARK_FULL_FRAMES; n++) {
+        for (uint8_t y = 0; y < TileDiff::HEIGHT_TILES; y++) {
+            u8x8_DrawTile(u8x8, 0, y, TileDiff::WIDTH_TILES, (uint8_t*)&frame[y * TileDiff::ROW_BYTES]);
+            OledI2c::flush();
+        }
+    }
+    OledI2c::endBatch();
+    return (micros() - start) / BENCHMARK_FULL_FRAMES;
+}
+
+uint32_t Display::timePartialUpdates(const uint8_t* frame) {
+    // 典型的局部刷新: 列表箭头所在的两个tile
+    u8x8_t* u8x8 = _u8g2.getU8x8();
+    const uint8_t y = 3;
+    const unsigned long start = micros();
+    OledI2c::beginBatch();
+    for (int n = 0; n < BENCHMARK_PARTIAL_UPDATES; n++) {
+        u8x8_DrawTile(u8x8, 0, y, 2, (uint8_t*)&frame[y * TileDiff::ROW_BYTES]);
+        OledI2c::flush();
+    }
+    OledI2c::endBatch();
+    return (micros() - start) / BENCHMARK_PARTIAL_UPDATES;
+}
+
+void Display::runBenchmark() {
+    static const struct {
+        const char* name;
+        Bus bus;
+        uint32_t clock;
+    } MODES[BENCHMARK_MODES] = {
+        {"SW",    BUS_SW_I2C, 0},
+        {"HW400", BUS_HW_I2C, 400000},
+        {"HW1M",  BUS_HW_I2C, 1000000},
+    };
+
+    _benchmarkState = BENCHMARK_RUNNING;
+    const Bus savedBus = _bus;
+    const uint32_t savedClock = OledI2c::getClock();
+
+    // 重发屏幕上已有的内容，测速时画面不变
+    const uint8_t* frame = _frames[_sendIndex];
+    ESP_LOGI(TAG, "I2C测速: 整屏 x%d, 局部(2 tile) x%d", BENCHMARK_FULL_FRAMES, BENCHMARK_PARTIAL_UPDATES);
+    for (int i = 0; i < BENCHMARK_MODES; i++) {
+        BenchmarkResult& result = _benchmarkResults[i];
+        result.name = MODES[i].name;
+        selectBus(MODES[i].bus, MODES[i].clock);
+
+        const uint32_t errors = OledI2c::getErrorCount();
+        result.fullFrameUs = timeFullFrames(frame);
+        result.partialUs = timePartialUpdates(frame);
+        result.errors = OledI2c::getErrorCount() - errors;
+
+        ESP_LOGI(TAG, "  %-6s 整屏 %6lu us (%lu FPS), 局部 %5lu us, 错误 %lu",
+                 result.name, (unsigned long)result.fullFrameUs,
+                 (unsigned long)(result.fullFrameUs ? 1000000UL / result.fullFrameUs : 0),
+                 (unsigned long)result.partialUs, (unsigned long)result.errors);
+    }
+
+    selectBus(savedBus, savedClock);
+    _diff.invalidate();
+    _benchmarkState = BENCHMARK_DONE;
+}
@@ -2,15 +2,26 @@
  * @file Display.h
  * @brief OLED显示管理模块
  *
- * 统一管理U8g2显示系统，提供I2C扫描和初始化功能
+ * 统一管理U8g2显示系统，提供I2C扫描和初始化功能。
+ *
+ * 刷新由单独的显示任务完成，主循环不等I2C:
+ *   主循环在U8g2缓冲区里绘制 -> present() 复制到待发送帧，通知任务
+ *   显示任务交换两个帧缓冲区，只发送和上次相比变化过的tile (见TileDiff)
+ * 任务发送期间主循环又提交的帧会覆盖还没发出的那一帧 (合并)，
+ * 屏幕上只显示最新的内容。begin()之后I2C总线只由显示任务使用。
+ *
+ * 默认用U8g2的软件I2C；定义USE_HW_I2C时改用ESP-IDF I2C驱动 (OledI2c)，
+ * 时钟为OLED_I2C_CLOCK。requestBenchmark()比较几种总线配置的刷新耗时。
  */
 
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include <Arduino.h>
 #include <U8g2lib.h>
 #include <Wire.h>
 #include "pin_config.h"
+#include "TileDiff.h"
 
 class StatusBar;
 class Menu;
@@ -39,15 +50,111 @@ public:
      */
     U8G2* getU8g2();
 
+    /**
+     * @brief 提交U8g2缓冲区中绘制好的一帧，由显示任务发送
+     * @return false=显示任务正占用帧缓冲区，本帧丢弃 (下次再提交)
+     */
+    bool present();
+
+    /**
+     * @brief 屏幕内容未知时调用，下次整屏发送
+     */
+    void invalidate();
+
+    /**
+     * @brief 还有帧没发完 (此时不能进浅睡眠)
+     */
+    bool isBusy() const { return _framePending || _sending || isBenchmarkRunning(); }
+
+    // 刷新统计 (resetStats()后重新累计)
+    uint32_t getFrameCount() const { return _frameCount; }          // 发送的帧数
+    uint32_t getCoalescedCount() const { return _coalescedCount; }  // 被后一帧覆盖、没单独发送的帧数
+    uint32_t getDroppedCount() const { return _droppedCount; }      // present()失败的次数
+    uint32_t getTotalBytes() const { return _totalBytes; }          // I2C字节数 (估算)
+    uint32_t getLastFrameBytes() const { return _lastFrameBytes; }
+    uint32_t getLastFrameTime() const { return _lastFrameTime; }    // 微秒
+    uint32_t getMaxFrameTime() const { return _maxFrameTime; }
+    void resetStats();
+
+    // ========== 总线测速 ==========
+
+    static const int BENCHMARK_MODES = 3;           // 软件I2C, 硬件I2C 400kHz, 硬件I2C 1MHz
+    static const int BENCHMARK_FULL_FRAMES = 10;
+    static const int BENCHMARK_PARTIAL_UPDATES = 50;
+
+    struct BenchmarkResult {
+        const char* name;
+        uint32_t fullFrameUs;   // 整屏 (8行 x 16 tile) 平均耗时
+        uint32_t partialUs;     // 局部刷新 (2个tile) 平均耗时
+        uint32_t errors;        // I2C错误次数
+    };
+
+    /**
+     * @brief 让显示任务依次用各种总线配置测速，结果输出到日志
+     */
+    void requestBenchmark();
+
+    bool isBenchmarkRunning() const {
+        return _benchmarkState == BENCHMARK_REQUESTED || _benchmarkState == BENCHMARK_RUNNING;
+    }
+
+    /**
+     * @brief 测速结果 (BENCHMARK_MODES个)，还没测过返回NULL
+     */
+    const BenchmarkResult* getBenchmarkResults() const {
+        return (_benchmarkState == BENCHMARK_DONE) ? _benchmarkResults : NULL;
+    }
+
 private:
-    // 硬件I2C: U8G2_SSD1306_128X64_NONAME_F_HW_I2C (更快)
-    // 软件I2C: U8G2_SSD1306_128X64_NONAME_F_SW_I2C (更稳定)
-    // 2ND_HW_I2C: 使用第二I2C总线 (ESP32-C3默认)
-    #ifdef USE_HW_I2C
-        U8G2_SSD1306_128X64_NONAME_F_2ND_HW_I2C _u8g2;
-    #else
-        U8G2_SSD1306_128X64_NONAME_F_SW_I2C _u8g2;
-    #endif
+    enum Bus {
+        BUS_SW_I2C = 0,     // U8g2软件I2C (逐位翻转GPIO)
+        BUS_HW_I2C          // ESP-IDF I2C驱动 (OledI2c)
+    };
+
+    enum BenchmarkState {
+        BENCHMARK_NONE = 0,
+        BENCHMARK_REQUESTED,
+        BENCHMARK_RUNNING,
+        BENCHMARK_DONE
+    };
+
+    // 按软件I2C构造；定义USE_HW_I2C时begin()换成OledI2c的字节回调
+    U8G2_SSD1306_128X64_NONAME_F_SW_I2C _u8g2;
+    u8x8_msg_cb _swByteCallback;
+    Bus _bus;
+
+    volatile BenchmarkState _benchmarkState;
+    BenchmarkResult _benchmarkResults[BENCHMARK_MODES];
+
+    static const size_t FRAME_SIZE = TileDiff::BUFFER_SIZE;
+    static const TickType_t PRESENT_TIMEOUT = 2;   // present()等待帧缓冲区的最长时间 (tick)
+
+    // 两个帧缓冲区: 一个正在发送，另一个接收主循环提交的帧
+    uint8_t _frames[2][FRAME_SIZE];
+    uint8_t _sendIndex;         // 正在发送的帧缓冲区
+    bool _framePending;         // 另一个缓冲区里有没发送的帧
+    bool _invalidatePending;    // 下一帧整屏发送
+    volatile bool _sending;     // 显示任务正在发送
+
+    TileDiff _diff;             // 只由显示任务使用
+
+    SemaphoreHandle_t _mutex;   // 保护帧缓冲区交换和上面的标志
+    TaskHandle_t _displayTaskHandle;
+
+    uint32_t _frameCount;
+    uint32_t _coalescedCount;
+    uint32_t _droppedCount;
+    uint32_t _totalBytes;
+    uint32_t _lastFrameBytes;
+    uint32_t _lastFrameTime;
+    uint32_t _maxFrameTime;
+
+    void sendFrame(uint8_t* frame);
+    void selectBus(Bus bus, uint32_t clock);
+    void runBenchmark();
+    uint32_t timeFullFrames(const uint8_t* frame);
+    uint32_t timePartialUpdates(const uint8_t* frame);
+    static void displayTask(void* parameter);
 };
 
 #endif // DISPLAY_H
@@ -0,0 +1,210 @@
+/**
+ * @file OledI2c.cpp
+ * @brief 基于ESP-IDF I2C主机驱动的U8x8字节回调实现
+ */
+
+#include "OledI2c.h"
+#include <esp32-hal-log.h>
+
+static const char* TAG = "OledI2c";
+
+i2c_port_t OledI2c::_port = I2C_NUM_0;
+int OledI2c::_sdaPin = -1;
+int OledI2c::_sclPin = -1;
+uint32_t OledI2c::_clock = 400000;
+uint8_t OledI2c::_address = 0x3C;
+bool OledI2c::_installed = false;
+bool OledI2c::_batching = false;
+
+uint8_t OledI2c::_data[OledI2c::DATA_SIZE];
+size_t OledI2c::_dataLength = 0;
+OledI2c::Transfer OledI2c::_transfers[OledI2c::MAX_TRANSFERS];
+int OledI2c::_transferCount = 0;
+bool OledI2c::_inTransfer = false;
+uint8_t OledI2c::_link[I2C_LINK_RECOMMENDED_SIZE(OledI2c::MAX_TRANSFERS)];
+
+uint32_t OledI2c::_flushCount = 0;
+uint32_t OledI2c::_errorCount = 0;
+uint32_t OledI2c::_recoveryCount = 0;
+
+bool OledI2c::begin(i2c_port_t port, int sdaPin, int sclPin, uint32_t clock) {
+    end();
+    _port = port;
+    _sdaPin = sdaPin;
+    _sclPin = sclPin;
+    _clock = clock;
+    return install();
+}
+
+void OledI2c::end() {
+    if (_installed) {
+        i2c_driver_delete(_port);
+        _installed = false;
+    }
+    _dataLength = 0;
+    _transferCount = 0;
+    _inTransfer = false;
+}
+
+bool OledI2c::install() {
+    i2c_config_t config = {};
+    config.mode = I2C_MODE_MASTER;
+    config.sda_io_num = _sdaPin;
+    config.scl_io_num = _sclPin;
+    config.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    config.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    config.master.clk_speed = _clock;
+
+    esp_err_t err = i2c_param_config(_port, &config);
+    if (err == ESP_OK) {
+        // 主机模式不需要收发缓冲区
+        err = i2c_driver_install(_port, I2C_MODE_MASTER, 0, 0, 0);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "I2C驱动安装失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    _installed = true;
+    ESP_LOGI(TAG, "硬件I2C: SDA=%d SCL=%d %lu Hz", _sdaPin, _sclPin, (unsigned long)_clock);
+    return true;
+}
+
+uint8_t OledI2c::byteCallback(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr) {
+    switch (msg) {
+        case U8X8_MSG_BYTE_INIT:
+            // U8x8给的是8位地址
+            _address = u8x8_GetI2CAddress(u8x8) >> 1;
+            return (_installed || install()) ? 1 : 0;
+
+        case U8X8_MSG_BYTE_SET_DC:
+            break;
+
+        case U8X8_MSG_BYTE_START_TRANSFER:
+            // 放不下一次完整的写时先把攒下的发出去
+            if (_transferCount >= MAX_TRANSFERS || DATA_SIZE - _dataLength < MAX_WRITE) {
+                flush();
+            }
+            _transfers[_transferCount].start = _dataLength;
+            _transfers[_transferCount].length = 0;
+            _inTransfer = true;
+            break;
+
+        case U8X8_MSG_BYTE_SEND:
+            if (!_inTransfer || _dataLength + argInt > DATA_SIZE) {
+                ESP_LOGE(TAG, "I2C写超出缓冲区");
+                return 0;
+            }
+            memcpy(&_data[_dataLength], argPtr, argInt);
+            _dataLength += argInt;
+            _transfers[_transferCount].length += argInt;
+            break;
+
+        case U8X8_MSG_BYTE_END_TRANSFER:
+            _inTransfer = false;
+            _transferCount++;
+            if (!_batching) {
+                flush();
+            }
+            break;
+
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+void OledI2c::beginBatch() {
+    _batching = true;
+}
+
+void OledI2c::endBatch() {
+    flush();
+    _batching = false;
+}
+
+bool OledI2c::flush() {
+    if (_transferCount == 0) {
+        return true;
+    }
+
+    bool ok = false;
+    for (int attempt = 0; attempt <= MAX_RETRIES && !ok; attempt++) {
+        if (attempt > 0) {
+            ESP_LOGW(TAG, "I2C重试 %d/%d", attempt, MAX_RETRIES);
+        }
+        ok = _installed && send();
+        if (!ok) {
+            _errorCount++;
+            recoverBus();
+        }
+    }
+    if (!ok) {
+        ESP_LOGE(TAG, "I2C发送失败，丢弃 %d 次写", _transferCount);
+    }
+
+    _flushCount++;
+    _dataLength = 0;
+    _transferCount = 0;
+    return ok;
+}
+
+bool OledI2c::send() {
+    // 每次写: 起始条件 + 地址 + 数据，最后一个停止条件
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(_link, sizeof(_link));
+    if (cmd == NULL) {
+        return false;
+    }
+
+    esp_err_t err = ESP_OK;
+    for (int i = 0; i < _transferCount && err == ESP_OK; i++) {
+        const Transfer& transfer = _transfers[i];
+        err = i2c_master_start(cmd);
+        if (err == ESP_OK) {
+            err = i2c_master_write_byte(cmd, (_address << 1) | I2C_MASTER_WRITE, true);
+        }
+        if (err == ESP_OK && transfer.length > 0) {
+            err = i2c_master_write(cmd, &_data[transfer.start], transfer.length, true);
+        }
+    }
+    if (err == ESP_OK) {
+        err = i2c_master_stop(cmd);
+    }
+    if (err == ESP_OK) {
+        // 中断驱动，等待期间本任务阻塞
+        err = i2c_master_cmd_begin(_port, cmd, TIMEOUT_TICKS);
+    }
+    i2c_cmd_link_delete_static(cmd);
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "I2C传输错误: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+void OledI2c::recoverBus() {
+    _recoveryCount++;
+    if (_installed) {
+        i2c_driver_delete(_port);
+        _installed = false;
+    }
+
+    // 从机拉住SDA时，SCL打9个脉冲让它把当前字节送完，再发停止条件
+    pinMode(_sdaPin, INPUT_PULLUP);
+    pinMode(_sclPin, OUTPUT_OPEN_DRAIN);
+    for (int i = 0; i < 9 && digitalRead(_sdaPin) == LOW; i++) {
+        digitalWrite(_sclPin, LOW);
+        delayMicroseconds(5);
+        digitalWrite(_sclPin, HIGH);
+        delayMicroseconds(5);
+    }
+    pinMode(_sdaPin, OUTPUT_OPEN_DRAIN);
+    digitalWrite(_sdaPin, LOW);
+    delayMicroseconds(5);
+    digitalWrite(_sclPin, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(_sdaPin, HIGH);
+    delayMicroseconds(5);
+
+    install();
+}
@@ -0,0 +1,97 @@
+/**
+ * @file OledI2c.h
+ * @brief 基于ESP-IDF I2C主机驱动的U8x8字节回调 (硬件I2C)
+ *
+ * U8x8每次START_TRANSFER..END_TRANSFER是一次I2C写 (命令或数据)。
+ * 批量模式下这些写先攒在缓冲区里，flush()时用一个命令链接
+ * (重复起始条件分隔) 一次交给驱动: 一个tile行只等一次中断完成，
+ * 等待期间调用任务阻塞、CPU可以运行其他任务。
+ *
+ * 传输失败时重试，超时或总线被从机拉住时先发9个SCL脉冲释放总线，
+ * 再重新安装驱动。
+ *
+ * 只有一个实例 (U8x8回调没有上下文参数)，由显示任务使用。
+ */
+
+#ifndef OLED_I2C_H
+#define OLED_I2C_H
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <driver/i2c.h>
+
+class OledI2c {
+public:
+    static const size_t DATA_SIZE = 512;        // 一批的数据字节数
+    static const int MAX_TRANSFERS = 16;        // 一批的I2C写次数
+    static const size_t MAX_WRITE = 160;        // U8x8一次写的最大字节数 (一行128字节数据 + 控制字节)
+    static const int MAX_RETRIES = 3;           // 失败后重试次数
+    static const TickType_t TIMEOUT_TICKS = pdMS_TO_TICKS(50);
+
+    /**
+     * 安装I2C驱动
+     * @param clock SCL频率 (Hz)
+     */
+    static bool begin(i2c_port_t port, int sdaPin, int sclPin, uint32_t clock);
+
+    /**
+     * 卸载驱动，释放引脚 (切回软件I2C前调用)
+     */
+    static void end();
+
+    /**
+     * U8x8字节回调 (u8x8->byte_cb)
+     */
+    static uint8_t byteCallback(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr);
+
+    /**
+     * 批量模式: END_TRANSFER后不立即发送，等flush()
+     */
+    static void beginBatch();
+    static void endBatch();
+
+    /**
+     * 发送攒下的I2C写
+     * @return false=重试后仍失败
+     */
+    static bool flush();
+
+    static bool isInstalled() { return _installed; }
+    static uint32_t getClock() { return _clock; }
+
+    // 统计
+    static uint32_t getFlushCount() { return _flushCount; }
+    static uint32_t getErrorCount() { return _errorCount; }
+    static uint32_t getRecoveryCount() { return _recoveryCount; }
+
+private:
+    struct Transfer {
+        uint16_t start;     // 在_data中的起始位置
+        uint16_t length;
+    };
+
+    static i2c_port_t _port;
+    static int _sdaPin;
+    static int _sclPin;
+    static uint32_t _clock;
+    static uint8_t _address;
+    static bool _installed;
+    static bool _batching;
+
+    static uint8_t _data[DATA_SIZE];
+    static size_t _dataLength;
+    static Transfer _transfers[MAX_TRANSFERS];
+    static int _transferCount;
+    static bool _inTransfer;
+    static uint8_t _link[I2C_LINK_RECOMMENDED_SIZE(MAX_TRANSFERS)];   // 命令链接 (不用堆)
+
+    static uint32_t _flushCount;
+    static uint32_t _errorCount;
+    static uint32_t _recoveryCount;
+
+    static bool install();
+    static bool send();
+    static void recoverBus();
+};
+
+#endif // OLED_I2C_H
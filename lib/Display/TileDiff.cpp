@@ -0,0 +1,68 @@
+/**
+ * @file TileDiff.cpp
+ * @brief 帧缓冲区的tile级差异比较实现
+ */
+
+#include "TileDiff.h"
+#include <string.h>
+
+TileDiff::TileDiff()
+    : _validRows(0)
+{
+    memset(_shadow, 0, sizeof(_shadow));
+}
+
+void TileDiff::invalidate() {
+    _validRows = 0;
+}
+
+bool TileDiff::tileChanged(const uint8_t* buffer, size_t offset) const {
+    return memcmp(&buffer[offset], &_shadow[offset], TILE_BYTES) != 0;
+}
+
+int TileDiff::diff(const uint8_t* buffer, uint8_t tileY, uint8_t tileHeight, Run* runs) {
+    int count = 0;
+    const uint8_t endY = (tileY + tileHeight > HEIGHT_TILES) ? HEIGHT_TILES : tileY + tileHeight;
+
+    for (uint8_t y = tileY; y < endY; y++) {
+        const size_t rowOffset = y * ROW_BYTES;
+
+        // 影子缓冲区无效的行整行发送
+        if (!(_validRows & (1 << y))) {
+            runs[count].x = 0;
+            runs[count].y = y;
+            runs[count].width = WIDTH_TILES;
+            count++;
+            memcpy(&_shadow[rowOffset], &buffer[rowOffset], ROW_BYTES);
+            _validRows |= (1 << y);
+            continue;
+        }
+
+        // 相邻的变化tile合并成一段 (中间隔一个不变tile时分开发更省:
+        // 一个tile 8字节 > 每段开销)
+        uint8_t x = 0;
+        while (x < WIDTH_TILES) {
+            if (!tileChanged(buffer, rowOffset + x * TILE_BYTES)) {
+                x++;
+                continue;
+            }
+            const uint8_t start = x;
+            while (x < WIDTH_TILES && tileChanged(buffer, rowOffset + x * TILE_BYTES)) {
+                x++;
+            }
+            runs[count].x = start;
+            runs[count].y = y;
+            runs[count].width = x - start;
+            count++;
+            memcpy(&_shadow[rowOffset + start * TILE_BYTES], &buffer[rowOffset + start * TILE_BYTES],
+                   (x - start) * TILE_BYTES);
+        }
+    }
+    return count;
+}
+
+size_t TileDiff::runBytes(uint8_t width) {
+    const size_t data = width * TILE_BYTES;
+    const size_t chunks = (data + I2C_CHUNK - 1) / I2C_CHUNK;
+    return RUN_OVERHEAD + data + (chunks - 1) * 2;
+}
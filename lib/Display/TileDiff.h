@@ -0,0 +1,68 @@
+/**
+ * @file TileDiff.h
+ * @brief 帧缓冲区的tile级差异比较
+ *
+ * SSD1306的U8g2全缓冲区按tile排列: 每个tile行128字节，每个tile是
+ * 连续的8字节 (8列 x 8像素)。保存上次发出的缓冲区副本，刷新时只找出
+ * 变化过的tile，同一行里相邻的变化tile合并成一段，一段对应一次
+ * updateDisplayArea()。这样只移动了一个箭头时只发送一两个tile，
+ * 而不是整个内容区。
+ */
+
+#ifndef TILE_DIFF_H
+#define TILE_DIFF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TileDiff {
+public:
+    static const uint8_t WIDTH_TILES = 16;      // 128像素 / 8
+    static const uint8_t HEIGHT_TILES = 8;      // 64像素 / 8
+    static const size_t TILE_BYTES = 8;
+    static const size_t ROW_BYTES = WIDTH_TILES * TILE_BYTES;
+    static const size_t BUFFER_SIZE = ROW_BYTES * HEIGHT_TILES;
+    static const int MAX_RUNS = (WIDTH_TILES + 1) / 2 * HEIGHT_TILES;  // 隔一个变一个时最多
+
+    // I2C上每段的额外开销: 地址+控制字节+3条定位命令，数据前再一次地址+控制字节
+    static const size_t RUN_OVERHEAD = 7;
+    // 每个I2C传输最多32字节数据，超出部分要重新发地址+控制字节
+    static const size_t I2C_CHUNK = 32;
+
+    // 一行里连续变化的tile
+    struct Run {
+        uint8_t x;          // 起始tile列
+        uint8_t y;          // tile行
+        uint8_t width;      // tile数
+    };
+
+    TileDiff();
+
+    /**
+     * 屏幕内容未知 (初始化、唤醒等)，下次比较时整行发送
+     */
+    void invalidate();
+
+    /**
+     * 比较指定tile行，找出变化的段并把它们记入影子缓冲区
+     * @param buffer U8g2缓冲区 (BUFFER_SIZE字节)
+     * @param tileY 起始tile行
+     * @param tileHeight tile行数
+     * @param runs 输出的段 (至少MAX_RUNS个)
+     * @return 段数
+     */
+    int diff(const uint8_t* buffer, uint8_t tileY, uint8_t tileHeight, Run* runs);
+
+    /**
+     * 估算发送一段需要的I2C字节数
+     */
+    static size_t runBytes(uint8_t width);
+
+private:
+    uint8_t _shadow[BUFFER_SIZE];   // 上次发出的内容
+    uint8_t _validRows;             // 影子缓冲区有效的tile行 (位图)
+
+    bool tileChanged(const uint8_t* buffer, size_t offset) const;
+};
+
+#endif // TILE_DIFF_H
@@ -0,0 +1,122 @@
+/**
+ * @file EdgeTrace.h
+ * @brief 接收边沿轨迹的紧凑二进制格式 (录制和主机回放共用)
+ *
+ * 文件由8字节文件头和边沿序列组成:
+ *   文件头: "RFET" + 版本(1) + 标志(1) + 保留(2)
+ *   边沿:   LEB128变长整数 (delta << 2) | (band << 1) | level
+ *     delta - 距同一频段上一个边沿的时间 (微秒)，首个边沿距录制开始
+ *     band  - 0=433MHz, 1=315MHz
+ *     level - 边沿之后的电平
+ *
+ * 按频段分别计算间隔是因为解码任务逐个频段批量取出边沿，两个频段之间
+ * 的先后顺序不保证；回放时按各自的绝对时间重新合并。
+ * 常见脉冲 (< 8192us) 占2字节，长静默最多占5字节。
+ */
+
+#ifndef EDGE_TRACE_H
+#define EDGE_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class EdgeTrace {
+public:
+    static const uint8_t VERSION = 1;
+    static const size_t HEADER_SIZE = 8;
+    static const size_t MAX_EDGE_SIZE = 5;          // 单个边沿最大字节数
+    static const uint32_t MAX_DELTA = 0x3FFFFFFF;   // 可表示的最大间隔
+
+    static const uint8_t BAND_433 = 0;
+    static const uint8_t BAND_315 = 1;
+
+    struct Edge {
+        uint8_t band;
+        uint8_t level;
+        uint32_t delta;     // 微秒
+    };
+
+    /**
+     * 写入文件头
+     * @return 写入的字节数, 0=空间不足
+     */
+    static size_t writeHeader(uint8_t* out, size_t space) {
+        if (space < HEADER_SIZE) return 0;
+        out[0] = 'R';
+        out[1] = 'F';
+        out[2] = 'E';
+        out[3] = 'T';
+        out[4] = VERSION;
+        out[5] = 0;
+        out[6] = 0;
+        out[7] = 0;
+        return HEADER_SIZE;
+    }
+
+    /**
+     * 检查文件头 (魔数和版本)
+     */
+    static bool checkHeader(const uint8_t* data, size_t length) {
+        return length >= HEADER_SIZE &&
+               data[0] == 'R' && data[1] == 'F' && data[2] == 'E' && data[3] == 'T' &&
+               data[4] == VERSION;
+    }
+
+    /**
+     * 编码一个边沿
+     * @param out 输出缓冲区
+     * @param space 输出缓冲区剩余字节数
+     * @return 写入的字节数, 0=空间不足
+     */
+    static size_t encode(const Edge& edge, uint8_t* out, size_t space) {
+        const uint32_t delta = edge.delta > MAX_DELTA ? MAX_DELTA : edge.delta;
+        uint64_t value = ((uint64_t)delta << 2) | ((edge.band & 1) << 1) | (edge.level & 1);
+        size_t count = 0;
+        do {
+            if (count >= space) return 0;
+            uint8_t byte = value & 0x7F;
+            value >>= 7;
+            if (value != 0) byte |= 0x80;
+            out[count++] = byte;
+        } while (value != 0);
+        return count;
+    }
+
+    /**
+     * 解码下一个边沿
+     * @param data 边沿数据 (不含文件头)
+     * @param length 总字节数
+     * @param pos 当前位置 (解码后前进)
+     * @return false=数据结束或不完整
+     */
+    static bool decode(const uint8_t* data, size_t length, size_t& pos, Edge& edge) {
+        uint64_t value = 0;
+        unsigned int shift = 0;
+        size_t next = pos;
+        while (true) {
+            if (next >= length || shift >= MAX_EDGE_SIZE * 7) return false;
+            const uint8_t byte = data[next++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        edge.level = value & 1;
+        edge.band = (value >> 1) & 1;
+        edge.delta = (uint32_t)(value >> 2);
+        pos = next;
+        return true;
+    }
+
+    /**
+     * 频率 (433/315) 转频段编号
+     */
+    static uint8_t bandOf(unsigned int freq) {
+        return freq == 315 ? BAND_315 : BAND_433;
+    }
+
+    static unsigned int frequencyOf(uint8_t band) {
+        return band == BAND_315 ? 315 : 433;
+    }
+};
+
+#endif // EDGE_TRACE_H
@@ -0,0 +1,86 @@
+/**
+ * @file EdgeTraceRecorder.cpp
+ * @brief 边沿轨迹录制实现
+ */
+
+#include "EdgeTraceRecorder.h"
+#include <esp32-hal-log.h>
+
+static const char* TAG = "EdgeTrace";
+
+uint8_t* EdgeTraceRecorder::_buffer = NULL;
+size_t EdgeTraceRecorder::_capacity = 0;
+volatile size_t EdgeTraceRecorder::_length = 0;
+volatile bool EdgeTraceRecorder::_recording = false;
+volatile bool EdgeTraceRecorder::_full = false;
+volatile unsigned long EdgeTraceRecorder::_edgeCount = 0;
+unsigned long EdgeTraceRecorder::_lastTime[2] = {0, 0};
+uint8_t EdgeTraceRecorder::_level[2] = {LOW, LOW};
+
+bool EdgeTraceRecorder::start(size_t capacity) {
+    if (_recording || capacity < EdgeTrace::HEADER_SIZE + EdgeTrace::MAX_EDGE_SIZE) {
+        return false;
+    }
+    release();
+    _buffer = (uint8_t*)malloc(capacity);
+    if (!_buffer) {
+        ESP_LOGE(TAG, "轨迹缓冲区分配失败: %d 字节", (int)capacity);
+        return false;
+    }
+    _capacity = capacity;
+    _length = EdgeTrace::writeHeader(_buffer, capacity);
+    _full = false;
+    _edgeCount = 0;
+
+    const unsigned long now = micros();
+    for (int band = 0; band < 2; band++) {
+        _lastTime[band] = now;
+        _level[band] = LOW;
+    }
+    _recording = true;
+    ESP_LOGI(TAG, "开始录制边沿轨迹 (%d 字节)", (int)capacity);
+    return true;
+}
+
+void EdgeTraceRecorder::stop() {
+    if (!_recording) return;
+    _recording = false;
+    ESP_LOGI(TAG, "录制结束: %lu 个边沿, %d 字节%s", (unsigned long)_edgeCount,
+             (int)_length, _full ? " (缓冲区已满)" : "");
+}
+
+void EdgeTraceRecorder::release() {
+    stop();
+    free(_buffer);
+    _buffer = NULL;
+    _capacity = 0;
+    _length = 0;
+}
+
+void EdgeTraceRecorder::record(unsigned int frequency, unsigned long time) {
+    if (!_recording) return;
+
+    const uint8_t band = EdgeTrace::bandOf(frequency);
+    EdgeTrace::Edge edge;
+    edge.band = band;
+    // 录制开始前进入缓冲区的边沿时间早于起点，记为0
+    edge.delta = (long)(time - _lastTime[band]) > 0 ? time - _lastTime[band] : 0;
+    edge.level = _level[band] ^ 1;
+
+    const size_t length = _length;
+    const size_t written = EdgeTrace::encode(edge, _buffer + length, _capacity - length);
+    if (written == 0) {
+        _full = true;
+        _recording = false;
+        return;
+    }
+    _lastTime[band] = time;
+    _level[band] = edge.level;
+    _edgeCount++;
+    _length = length + written;
+}
+
+const uint8_t* EdgeTraceRecorder::getData(size_t& length) {
+    length = _length;
+    return _buffer;
+}
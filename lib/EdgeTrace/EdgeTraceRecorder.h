@@ -0,0 +1,67 @@
+/**
+ * @file EdgeTraceRecorder.h
+ * @brief 把接收边沿录制成EdgeTrace轨迹 (RAM缓冲区)
+ *
+ * record()作为RCSwitch的边沿监听回调，在解码任务中按时间戳顺序调用，
+ * 中断处理不变。中断只记录时间戳，电平按边沿交替推出 (每个频段录制后
+ * 的第一个边沿记为高电平)，解码只看时间间隔，不受影响。
+ *
+ * 缓冲区写满后停止记录；stop()之后解码任务最多还在写最后一个边沿，
+ * 长度最后更新，读取方看到的数据总是完整的。
+ */
+
+#ifndef EDGE_TRACE_RECORDER_H
+#define EDGE_TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include "EdgeTrace.h"
+
+class EdgeTraceRecorder {
+public:
+    /**
+     * 分配缓冲区、写入文件头并开始记录
+     * @param capacity 缓冲区字节数 (含文件头)
+     * @return false=内存不足或已在记录
+     */
+    static bool start(size_t capacity);
+
+    /**
+     * 停止记录 (数据保留到release())
+     */
+    static void stop();
+
+    /**
+     * 释放缓冲区
+     */
+    static void release();
+
+    /**
+     * 边沿监听回调 (RCSwitchEdgeTap)
+     */
+    static void record(unsigned int frequency, unsigned long time);
+
+    static bool isRecording() { return _recording; }
+    static bool isFull() { return _full; }
+    static unsigned long getEdgeCount() { return _edgeCount; }
+
+    /**
+     * 获取已录制的轨迹 (含文件头)
+     * @param length 输出字节数
+     * @return 数据指针, 未分配时返回NULL
+     */
+    static const uint8_t* getData(size_t& length);
+
+private:
+    static uint8_t* _buffer;
+    static size_t _capacity;
+    static volatile size_t _length;
+    static volatile bool _recording;
+    static volatile bool _full;
+    static volatile unsigned long _edgeCount;
+
+    // 每个频段上一个边沿的时间和电平
+    static unsigned long _lastTime[2];
+    static uint8_t _level[2];
+};
+
+#endif // EDGE_TRACE_RECORDER_H
@@ -4,9 +4,11 @@
 
 static const char* TAG = "AboutPage";
 
-AboutPage::AboutPage(U8G2* u8g2, BatteryMonitor* battery)
+AboutPage::AboutPage(U8G2* u8g2, BatteryMonitor* battery, Display* display)
     : _u8g2(u8g2)
     , _battery(battery)
+    , _display(display)
+    , _showBenchmark(false)
     , _startTime(0)
     , _frameCount(0)
     , _currentFPS(0)
@@ -20,6 +22,7 @@ void AboutPage::enter() {
     _frameCount = 0;
     _currentFPS = 0;
     _lastFPSUpdate = millis();
+    _showBenchmark = false;
     ESP_LOGI(TAG, "进入: 关于页面");
 }
 
@@ -44,6 +47,11 @@ void AboutPage::draw() {
     // 使用小字体显示系统信息
     _u8g2->setFont(u8g2_font_6x10_tf);
 
+    if (_showBenchmark) {
+        drawBenchmark();
+        return;
+    }
+
     // 第1行: FPS
     char line1[24] = "FPS: ";
     floatToStr(_currentFPS, line1 + 5);
@@ -134,6 +142,14 @@ bool AboutPage::handleButton(ButtonEvent event) {
 
         case BTN_OK_SHORT:
             ESP_LOGD(TAG, "按键: 确认");
+            if (_showBenchmark) {
+                if (!_display->isBenchmarkRunning()) {
+                    _showBenchmark = false;
+                }
+            } else {
+                _showBenchmark = true;
+                _display->requestBenchmark();
+            }
             return true;
 
         default:
@@ -141,6 +157,28 @@ bool AboutPage::handleButton(ButtonEvent event) {
     }
 }
 
+void AboutPage::drawBenchmark() {
+    const Display::BenchmarkResult* results = _display->getBenchmarkResults();
+    if (_display->isBenchmarkRunning() || !results) {
+        _u8g2->drawStr(0, 28, "I2C benchmark...");
+        return;
+    }
+
+    // 每行: 总线  整屏毫秒  局部微秒
+    _u8g2->drawStr(0, 26, "Bus   Full   Part");
+    for (int i = 0; i < Display::BENCHMARK_MODES; i++) {
+        char line[24];
+        const Display::BenchmarkResult& result = results[i];
+        // 超出列宽的值封顶 (999.9ms / 9999us)，一行不超过21个字符
+        const uint32_t fullUs = result.fullFrameUs < 999999UL ? result.fullFrameUs : 999999UL;
+        const uint32_t partialUs = result.partialUs < 9999UL ? result.partialUs : 9999UL;
+        snprintf(line, sizeof(line), "%-5s %3u.%ums %4uus%s", result.name,
+                 (unsigned int)(fullUs / 1000), (unsigned int)(fullUs % 1000 / 100),
+                 (unsigned int)partialUs, result.errors ? "!" : "");
+        _u8g2->drawStr(0, 38 + i * 10, line);
+    }
+}
+
 // 快速整数转字符串
 void AboutPage::intToStr(unsigned long val, char* buf, int width) {
     char temp[12];
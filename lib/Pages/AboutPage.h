@@ -3,25 +3,31 @@
 
 #include "Page.h"
 #include "BatteryMonitor.h"
+#include "Display.h"
 
 /**
  * 关于页面
  * 显示系统信息：FPS、CPU频率、RAM、Flash、SDK版本、运行时间、电池电压
+ * 按确认键测试显示总线速度 (软件I2C / 硬件I2C 400kHz / 1MHz)，再按返回
  */
 class AboutPage : public Page {
 public:
-    AboutPage(U8G2* u8g2, BatteryMonitor* battery);
+    AboutPage(U8G2* u8g2, BatteryMonitor* battery, Display* display);
 
     void enter() override;
     void draw() override;
     bool handleButton(ButtonEvent event) override;
     const char* getTitle() override { return "关于"; }
-    bool needsConstantRefresh() override { return true; }
+    unsigned long getRefreshInterval() override { return REFRESH_INTERVAL; }
     bool update() override;
 
 private:
+    static const unsigned long REFRESH_INTERVAL = 100;  // 运行时间、FPS等每100ms刷新
+
     U8G2* _u8g2;
     BatteryMonitor* _battery;
+    Display* _display;
+    bool _showBenchmark;    // 显示测速结果
 
     // FPS相关
     unsigned long _startTime;
@@ -29,6 +35,8 @@ private:
     float _currentFPS;
     unsigned long _lastFPSUpdate;
 
+    void drawBenchmark();
+
     // 工具函数
     static void intToStr(unsigned long val, char* buf, int width = 0);
     static void floatToStr(float val, char* buf);
@@ -40,13 +40,14 @@ public:
     virtual const char* getTitle() = 0;
 
     /**
-     * 是否需要强制每帧刷新
-     * 默认false，关于页面等需要计算FPS的页面返回true
+     * 定时刷新间隔 (ms)
+     * 默认0: 只在事件或update()返回true时刷新；关于页面等显示随时间变化
+     * 内容的页面返回间隔，主循环据此定时唤醒
      */
-    virtual bool needsConstantRefresh() { return false; }
+    virtual unsigned long getRefreshInterval() { return 0; }
 
     /**
-     * 页面更新 (每帧调用，用于更新内部状态)
+     * 页面更新 (主循环每次唤醒时调用，用于更新内部状态)
      * @return true表示需要重绘
      */
     virtual bool update() { return false; }
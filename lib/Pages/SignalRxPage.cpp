@@ -4,16 +4,69 @@
 
 static const char* TAG = "SignalRx";
 
+// 编码列可显示的字符数 (x=48到状态列x=116, 6x10字体)
+static const size_t CODE_COLUMN_CHARS = 11;
+
+/**
+ * 超出列宽的文本截断并以".."结尾
+ */
+static void clipText(char* text, size_t maxChars) {
+    if (strlen(text) > maxChars) {
+        text[maxChars - 2] = '.';
+        text[maxChars - 1] = '.';
+        text[maxChars] = '\0';
+    }
+}
+
+// formatCount/formatGated输出最多6个字符
+static const size_t COUNT_TEXT_SIZE = 8;
+
+/**
+ * 计数压缩到5个字符以内 (超过99999用k/M，再大封顶在99999M)
+ */
+static void formatCount(char* text, size_t size, unsigned long value) {
+    if (value < 100000UL) {
+        snprintf(text, size, "%u", (unsigned int)value);
+    } else if (value < 100000000UL) {
+        snprintf(text, size, "%uk", (unsigned int)(value / 1000));
+    } else {
+        const unsigned long mega = value / 1000000;
+        snprintf(text, size, "%uM", (unsigned int)(mega < 99999UL ? mega : 99999UL));
+    }
+}
+
+/**
+ * 中断关闭时间压缩到4个字符 (10秒内带一位小数，超过999秒用分钟，封顶999m)
+ */
+static void formatGated(char* text, size_t size, unsigned long ms) {
+    const unsigned long seconds = ms / 1000;
+    if (ms < 10000UL) {
+        snprintf(text, size, "%u.%us", (unsigned int)seconds, (unsigned int)(ms % 1000 / 100));
+    } else if (seconds < 1000UL) {
+        snprintf(text, size, "%us", (unsigned int)seconds);
+    } else {
+        const unsigned long minutes = seconds / 60;
+        snprintf(text, size, "%um", (unsigned int)(minutes < 999UL ? minutes : 999UL));
+    }
+}
+
 SignalRxPage::SignalRxPage(U8G2* u8g2, RFReceiver* receiver, SignalStorage* storage)
     : _u8g2(u8g2)
     , _receiver(receiver)
     , _storage(storage)
     , _hasSignal(false)
+    , _currentSignal()
     , _signalExists(false)
-    , _lastCode(0)
+    , _rawMode(false)
+    , _hasRaw(false)
+    , _rawSaved(false)
+    , _rawFreq(0)
+    , _rawPulses(0)
+    , _rawDuration(0)
+    , _showDiagnostics(false)
+    , _lastCode()
     , _lastCodeTime(0)
 {
-    memset(&_currentSignal, 0, sizeof(_currentSignal));
     memset(_savedName, 0, sizeof(_savedName));
 }
 
@@ -21,8 +74,13 @@ void SignalRxPage::enter() {
     ESP_LOGI(TAG, "进入: 信号接收页面");
     _hasSignal = false;
     _signalExists = false;
-    _lastCode = 0;
+    _lastCode = RFCode();
     _lastCodeTime = 0;
+    _hasRaw = false;
+    _showDiagnostics = false;
+    // 页面和接收器的原始捕获状态一起复位 (上次离开时不一定经过stopScanning())
+    _rawMode = false;
+    _receiver->setRawCapture(false);
 
     // 启动RF接收扫描
     _receiver->startScanning();
@@ -32,20 +90,32 @@ void SignalRxPage::exit() {
     ESP_LOGI(TAG, "退出: 信号接收页面");
     // 停止RF接收
     _receiver->stopScanning();
+
+    // 把这次捕获排队的记录写完再离开
+    _storage->flush();
+    ESP_LOGI(TAG, "存储写入 %lu 批 %lu 条, 单批最长 %lu us",
+             _storage->getBatchCount(), _storage->getBatchedRecords(), _storage->getMaxBatchTime());
 }
 
 bool SignalRxPage::update() {
     // 更新RF接收
     _receiver->update();
 
+    if (_rawMode) {
+        return updateRaw();
+    }
+
     // 检查是否有新信号
     if (_receiver->hasNewSignal()) {
-        RFReceiver::Signal newSignal = _receiver->getLastSignal();
+        SignalRecord newSignal = _receiver->getLastSignal();
         unsigned long now = millis();
 
+        char codeText[RFCode::DECIMAL_SIZE];
+        newSignal.code.toDecimal(codeText, sizeof(codeText));
+
         // 防重复：同一编码在时间窗口内忽略
         if (newSignal.code == _lastCode && (now - _lastCodeTime) < DUPLICATE_WINDOW) {
-            ESP_LOGD(TAG, "重复信号，忽略: %lu", newSignal.code);
+            ESP_LOGD(TAG, "重复信号，忽略: %s", codeText);
             return false;  // 不更新界面
         }
 
@@ -55,29 +125,21 @@ bool SignalRxPage::update() {
         _lastCodeTime = now;
         _hasSignal = true;
 
-        ESP_LOGI(TAG, "收到信号: %dMHz 编码:%lu 协议:%s",
-                 _currentSignal.freq,
-                 _currentSignal.code,
+        ESP_LOGI(TAG, "收到信号: %dMHz 编码:%s 协议:%s",
+                 _currentSignal.freq(),
+                 codeText,
                  RFReceiver::getProtocolName(_currentSignal.protocol));
 
         // 检查是否已存在
-        if (_storage->signalExists(_currentSignal.code)) {
+        if (_storage->signalExists(_currentSignal.code, _currentSignal.bits,
+                                   _currentSignal.protocol, _currentSignal.freq())) {
             _signalExists = true;
             ESP_LOGI(TAG, "信号已存在于存储中");
         } else {
             _signalExists = false;
-            // 保存信号
-            SignalStorage::StoredSignal stored;
-            SignalStorage::generateName(_currentSignal.freq, _currentSignal.code,
-                                        stored.name, sizeof(stored.name));
-            stored.code = _currentSignal.code;
-            stored.freq = _currentSignal.freq;
-            stored.protocol = _currentSignal.protocol;
-            stored.bits = _currentSignal.bits;
-            stored.pulseLength = _currentSignal.pulseLength;
-
-            if (_storage->saveSignal(stored)) {
-                strncpy(_savedName, stored.name, sizeof(_savedName) - 1);
+            // 保存信号 (接收记录直接保存，使用默认名称)
+            if (_storage->saveSignal(_currentSignal)) {
+                _storage->getSignalName(_currentSignal, _savedName, sizeof(_savedName));
                 ESP_LOGI(TAG, "信号已保存: %s", _savedName);
             } else {
                 ESP_LOGE(TAG, "保存信号失败");
@@ -90,8 +152,51 @@ bool SignalRxPage::update() {
     return false;  // 无变化，不需要重绘
 }
 
+bool SignalRxPage::updateRaw() {
+    size_t wordCount = 0;
+    unsigned int freq = 0;
+    const uint16_t* words = _receiver->getRawCapture(wordCount, freq);
+    if (!words) {
+        return false;
+    }
+
+    _hasRaw = true;
+    _rawFreq = freq;
+    _rawPulses = RawPulse::countPulses(words, wordCount);
+    _rawDuration = RawPulse::totalDuration(words, wordCount);
+
+    ESP_LOGI(TAG, "捕获原始信号: %dMHz %d 个脉冲 时长:%luus",
+             _rawFreq, _rawPulses, _rawDuration);
+
+    SignalRecord stored;
+    _rawSaved = _storage->saveRawSignal(freq, words, wordCount, &stored);
+    if (_rawSaved) {
+        _storage->getSignalName(stored, _savedName, sizeof(_savedName));
+        ESP_LOGI(TAG, "原始信号已保存: %s", _savedName);
+    } else {
+        ESP_LOGE(TAG, "保存原始信号失败");
+    }
+
+    // 保存后释放缓冲区，开始下一次捕获
+    _receiver->releaseRawCapture();
+
+    return true;
+}
+
+void SignalRxPage::setRawMode(bool enable) {
+    _rawMode = enable;
+    _hasRaw = false;
+    _hasSignal = false;
+    _receiver->setRawCapture(enable);
+    ESP_LOGI(TAG, "原始捕获模式: %s", enable ? "开启" : "关闭");
+}
+
 void SignalRxPage::draw() {
-    if (_hasSignal) {
+    if (_showDiagnostics) {
+        drawDiagnostics();
+    } else if (_rawMode) {
+        drawRawInfo();
+    } else if (_hasSignal) {
         drawSignalInfo();
     } else {
         drawWaiting();
@@ -107,7 +212,8 @@ void SignalRxPage::drawWaiting() {
 
     // 显示已保存数量
     char countText[24];
-    snprintf(countText, sizeof(countText), "已保存: %d/50", _storage->getSignalCount());
+    snprintf(countText, sizeof(countText), "已保存: %d/%d",
+             _storage->getSignalCount(), SignalStorage::MAX_SIGNALS);
     _u8g2->drawUTF8(24, 52, countText);
 }
 
@@ -128,12 +234,13 @@ void SignalRxPage::drawSignalInfo() {
     // 第1行 Y=28
     // 左: 频率
     char freqText[10];
-    snprintf(freqText, sizeof(freqText), "%dMHz", _currentSignal.freq);
+    snprintf(freqText, sizeof(freqText), "%dMHz", _currentSignal.freq());
     _u8g2->drawStr(0, 28, freqText);
 
     // 中: 十进制编码
-    char codeText[12];
-    snprintf(codeText, sizeof(codeText), "%lu", _currentSignal.code);
+    char codeText[RFCode::DECIMAL_SIZE];
+    _currentSignal.code.toDecimal(codeText, sizeof(codeText));
+    clipText(codeText, CODE_COLUMN_CHARS);
     _u8g2->drawStr(48, 28, codeText);
 
     // 第2行 Y=40
@@ -141,19 +248,20 @@ void SignalRxPage::drawSignalInfo() {
     _u8g2->drawStr(0, 40, RFReceiver::getProtocolName(_currentSignal.protocol));
 
     // 中: 十六进制编码
-    char hexText[12];
-    snprintf(hexText, sizeof(hexText), "0x%lX", _currentSignal.code);
+    char hexText[RFCode::HEX_SIZE];
+    _currentSignal.code.toHex(hexText, sizeof(hexText));
+    clipText(hexText, CODE_COLUMN_CHARS);
     _u8g2->drawStr(48, 40, hexText);
 
     // 第3行 Y=52
     // 左: 位数
     char bitsText[8];
-    snprintf(bitsText, sizeof(bitsText), "%db", _currentSignal.bits);
+    snprintf(bitsText, sizeof(bitsText), "%db", (int)_currentSignal.bits);
     _u8g2->drawStr(0, 52, bitsText);
 
     // 中: 脉宽
     char pulseText[12];
-    snprintf(pulseText, sizeof(pulseText), "%dus", _currentSignal.pulseLength);
+    snprintf(pulseText, sizeof(pulseText), "%dus", (int)_currentSignal.pulseLength);
     _u8g2->drawStr(48, 52, pulseText);
 
     // 右侧竖排显示状态 (使用中文字体)
@@ -169,15 +277,98 @@ void SignalRxPage::drawSignalInfo() {
     }
 }
 
+void SignalRxPage::drawRawInfo() {
+    if (!_hasRaw) {
+        _u8g2->setFont(u8g2_font_wqy12_t_gb2312);
+        _u8g2->drawUTF8(24, 36, "等待原始信号");
+        _u8g2->drawUTF8(16, 52, "长按确认键退出");
+        return;
+    }
+
+    _u8g2->setFont(u8g2_font_6x10_tf);
+
+    // 第1行: 频率 + 名称
+    char freqText[10];
+    snprintf(freqText, sizeof(freqText), "%dMHz", _rawFreq);
+    _u8g2->drawStr(0, 28, freqText);
+    if (_rawSaved) {
+        _u8g2->drawStr(48, 28, _savedName);
+    }
+
+    // 第2行: 脉冲数
+    char pulseText[20];
+    snprintf(pulseText, sizeof(pulseText), "%u pulses", _rawPulses);
+    _u8g2->drawStr(0, 40, pulseText);
+
+    // 第3行: 总时长 (按64位unsigned long的最大值留够: 17位整数.1位小数ms)
+    char durText[24];
+    snprintf(durText, sizeof(durText), "%lu.%lums",
+             _rawDuration / 1000, (_rawDuration % 1000) / 100);
+    _u8g2->drawStr(0, 52, durText);
+
+    // 右侧竖排显示状态
+    _u8g2->setFont(u8g2_font_wqy12_t_gb2312);
+    if (_rawSaved) {
+        _u8g2->drawUTF8(116, 28, "已");
+        _u8g2->drawUTF8(116, 42, "保");
+        _u8g2->drawUTF8(116, 56, "存");
+    } else {
+        _u8g2->drawUTF8(116, 28, "失");
+        _u8g2->drawUTF8(116, 42, "败");
+    }
+}
+
+void SignalRxPage::drawDiagnostics() {
+    /*
+     * 布局 (6x10字体, 每行21个字符):
+     * MHz   e/s   glt gate     Y=28
+     * 433 23512  4810 1.2s*    Y=40   (*=中断正在关闭)
+     * 315  1840    12 0.0s     Y=52
+     */
+    _u8g2->setFont(u8g2_font_6x10_tf);
+    char line[40];
+    snprintf(line, sizeof(line), "%3s %5s %5s %4s", "MHz", "e/s", "glt", "gate");
+    _u8g2->drawStr(0, 28, line);
+
+    const unsigned int freqs[2] = { RCSwitch433::FREQUENCY, RCSwitch315::FREQUENCY };
+    for (int i = 0; i < 2; i++) {
+        RFReceiver::NoiseStats stats;
+        if (!_receiver->getNoiseStats(freqs[i], stats)) {
+            continue;
+        }
+        char rate[COUNT_TEXT_SIZE];
+        char glitches[COUNT_TEXT_SIZE];
+        char gated[COUNT_TEXT_SIZE];
+        formatCount(rate, sizeof(rate), stats.edgeRate);
+        formatCount(glitches, sizeof(glitches), stats.glitches);
+        formatGated(gated, sizeof(gated), stats.gatedMs);
+        snprintf(line, sizeof(line), "%3u %5s %5s %4s%s", freqs[i], rate, glitches, gated,
+                 stats.gated ? "*" : "");
+        _u8g2->drawStr(0, 40 + i * 12, line);
+    }
+}
+
 bool SignalRxPage::handleButton(ButtonEvent event) {
     switch (event) {
+        case BTN_OK_LONG:
+            ESP_LOGD(TAG, "按键: 确认键长按 - 切换原始捕获");
+            setRawMode(!_rawMode);
+            return true;
+
         case BTN_UP_LONG:
             ESP_LOGD(TAG, "按键: 上键长按 - 返回主菜单");
             exit();  // 退出前停止扫描
             return false;
 
-        case BTN_UP_SHORT:
         case BTN_DOWN_SHORT:
+            _showDiagnostics = !_showDiagnostics;
+            if (_showDiagnostics) {
+                _receiver->resetDebugCounters();  // 统计从打开诊断开始
+            }
+            ESP_LOGD(TAG, "按键: 下 - 接收诊断: %s", _showDiagnostics ? "开启" : "关闭");
+            return true;
+
+        case BTN_UP_SHORT:
         case BTN_OK_SHORT:
         default:
             return true;
@@ -8,6 +8,8 @@
 /**
  * 信号接收页面
  * 用于接收和显示RF信号，自动保存到Flash
+ * 长按确认键切换原始捕获模式 (记录完整脉冲序列，不做协议解码)
+ * 短按下键切换接收诊断 (每个频段的边沿速率、丢弃的毛刺、中断关闭时间)
  *
  * 布局设计:
  * +------------------+--------+
@@ -24,7 +26,8 @@ public:
     void exit();  // 退出页面时调用
     void draw() override;
     bool handleButton(ButtonEvent event) override;
-    const char* getTitle() override { return "信号接收"; }
+    const char* getTitle() override { return _rawMode ? "原始捕获" : "信号接收"; }
+    unsigned long getRefreshInterval() override { return _showDiagnostics ? DIAGNOSTICS_INTERVAL : 0; }
     bool update() override;
 
 private:
@@ -36,18 +39,34 @@ private:
     bool _hasSignal;
 
     // 当前显示的信号
-    RFReceiver::Signal _currentSignal;
+    SignalRecord _currentSignal;
     char _savedName[32];
     bool _signalExists;  // 信号是否已存在（未保存）
 
+    // 原始捕获模式
+    bool _rawMode;
+    bool _hasRaw;                 // 是否已捕获到原始信号
+    bool _rawSaved;               // 原始信号是否保存成功
+    unsigned int _rawFreq;        // 原始信号频率
+    unsigned int _rawPulses;      // 脉冲数
+    unsigned long _rawDuration;   // 总时长 (微秒)
+
+    // 接收诊断
+    bool _showDiagnostics;
+    static const unsigned long DIAGNOSTICS_INTERVAL = 500;  // 诊断每500ms刷新
+
     // 防重复机制
-    unsigned long _lastCode;      // 上次接收的编码
+    RFCode _lastCode;             // 上次接收的编码
     unsigned long _lastCodeTime;  // 上次接收时间
     static const unsigned long DUPLICATE_WINDOW = 2000;  // 2秒防重复窗口
 
     // 辅助函数
     void drawWaiting();
     void drawSignalInfo();
+    void drawRawInfo();
+    void drawDiagnostics();
+    bool updateRaw();
+    void setRawMode(bool enable);
 };
 
 #endif // SIGNAL_RX_PAGE_H
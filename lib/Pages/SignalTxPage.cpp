@@ -8,16 +8,19 @@ SignalTxPage::SignalTxPage(U8G2* u8g2, SignalStorage* storage, RFTransmitter* tr
     : _u8g2(u8g2)
     , _storage(storage)
     , _transmitter(transmitter)
+    , _cursor(storage)
     , _signalCount(0)
     , _selectedIndex(0)
     , _scrollOffset(0)
     , _arrowRight(true)
+    , _wasSending(false)
     , _editMode(false)
     , _editingDigit(false)
     , _cursorPos(0)
-    , _editCode(0)
     , _digitCount(1)
+    , _digitOffset(0)
 {
+    memset(_editDigits, 0, sizeof(_editDigits));
 }
 
 void SignalTxPage::enter() {
@@ -30,8 +33,10 @@ void SignalTxPage::enter() {
 }
 
 void SignalTxPage::exit() {
-    ESP_LOGI(TAG, "退出: 发送模式页面");
+    ESP_LOGI(TAG, "退出: 发送模式页面 (列表读取 %lu 次, 最长 %lu us)",
+             _cursor.getLoadCount(), _cursor.getMaxLoadTime());
     _editMode = false;
+    _storage->flush();
 }
 
 const char* SignalTxPage::getTitle() {
@@ -45,11 +50,30 @@ const char* SignalTxPage::getTitle() {
 }
 
 void SignalTxPage::loadSignals() {
-    _signalCount = _storage->loadSignals(_signals, MAX_DISPLAY_SIGNALS);
+    _cursor.invalidate();
+    _signalCount = _cursor.count();
     ESP_LOGI(TAG, "加载信号: %d 个", _signalCount);
 }
 
+bool SignalTxPage::getSelectedSignal(SignalRecord& sig) {
+    if (_signalCount == 0 || _selectedIndex >= _signalCount) {
+        return false;
+    }
+    const SignalRecord* selected = _cursor.at(_selectedIndex);
+    if (!selected) {
+        return false;
+    }
+    sig = *selected;
+    return true;
+}
+
 bool SignalTxPage::update() {
+    // 发送状态变化时刷新底部提示
+    bool sending = _transmitter->isSending();
+    if (sending != _wasSending) {
+        _wasSending = sending;
+        return true;
+    }
     return false;
 }
 
@@ -82,17 +106,30 @@ void SignalTxPage::drawSignalList() {
     // 显示信号列表
     int y = 28;
     for (int i = startIdx; i < endIdx; i++) {
+        const SignalRecord* sig = _cursor.at(i);
+        if (!sig) {
+            break;
+        }
+
         // 格式: "1    433M xxx" 或 "2 >  433M xxx" (选中项)
-        char line[32];
-        if (i == _selectedIndex) {
+        char codeText[RFCode::DECIMAL_SIZE];
+        sig->code.toDecimal(codeText, sizeof(codeText));
+        // 最长: 序号和频率各10位 + 标记 + 39位十进制编码
+        char line[RFCode::DECIMAL_SIZE + 32];
+        if (sig->type == SignalRecord::TYPE_RAW) {
+            // 原始信号: 显示脉冲数
+            snprintf(line, sizeof(line), "%d %c %dM RAW %up",
+                     i + 1, (i == _selectedIndex) ? (_arrowRight ? '>' : '<') : ' ',
+                     sig->freq(), (unsigned int)sig->bits);
+        } else if (i == _selectedIndex) {
             // 选中项: 显示 > 或 <
-            snprintf(line, sizeof(line), "%d %c %dM %lu",
+            snprintf(line, sizeof(line), "%d %c %dM %s",
                      i + 1, _arrowRight ? '>' : '<',
-                     _signals[i].freq, _signals[i].code);
+                     sig->freq(), codeText);
         } else {
             // 未选中项: 空格占位
-            snprintf(line, sizeof(line), "%d   %dM %lu",
-                     i + 1, _signals[i].freq, _signals[i].code);
+            snprintf(line, sizeof(line), "%d   %dM %s",
+                     i + 1, sig->freq(), codeText);
         }
         _u8g2->drawStr(0, y, line);
 
@@ -101,33 +138,48 @@ void SignalTxPage::drawSignalList() {
 
     // 显示滚动指示器
     if (_signalCount > ITEMS_PER_PAGE) {
-        char countText[16];
+        char countText[24];
         snprintf(countText, sizeof(countText), "%d/%d", _selectedIndex + 1, _signalCount);
-        _u8g2->drawStr(90, 62, countText);
+        _u8g2->drawStr(128 - _u8g2->getStrWidth(countText), 62, countText);  // 右对齐，四位数也放得下
     }
 
-    // 底部提示
-    _u8g2->drawStr(0, 62, "[OK]Send [+]Edit");
+    // 底部提示 (发送中显示状态)
+    if (_wasSending) {
+        _u8g2->drawStr(0, 62, "Sending...");
+    } else {
+        _u8g2->drawStr(0, 62, "[OK]Send [+]Edit");
+    }
 }
 
 void SignalTxPage::drawEditMode() {
+    const SignalRecord* sig = _cursor.at(_selectedIndex);
+    if (sig && sig->type == SignalRecord::TYPE_RAW) {
+        // 原始信号: 无编码可编辑，只显示名称和脉冲数
+        _u8g2->setFont(u8g2_font_6x10_tf);
+        char name[32];
+        _storage->getSignalName(*sig, name, sizeof(name));
+        _u8g2->drawStr(0, 28, name);
+        char info[24];
+        snprintf(info, sizeof(info), "%dM %u pulses", sig->freq(), (unsigned int)sig->bits);
+        _u8g2->drawStr(0, 40, info);
+    }
+
     // 使用更大的字体显示数字
     _u8g2->setFont(u8g2_font_logisoso16_tn);  // 16像素高数字字体
 
-    // 编码值，固定位数显示（带前导零）
-    char codeStr[16];
-    snprintf(codeStr, sizeof(codeStr), "%0*lu", _digitCount, _editCode);
+    // 编码值，固定位数显示（带前导零），超过一屏时只显示光标附近的窗口
+    int visibleCount = min(_digitCount, VISIBLE_DIGITS);
 
     // 计算居中位置 (该字体数字宽度约10像素)
     int digitWidth = 12;
-    int totalWidth = _digitCount * digitWidth;
+    int totalWidth = visibleCount * digitWidth;
     int startX = (128 - totalWidth) / 2;
 
     int x = startX;
     int y = 38;
 
-    for (int i = 0; i < _digitCount; i++) {
-        char digit[2] = { codeStr[i], '\0' };
+    for (int i = _digitOffset; i < _digitOffset + visibleCount; i++) {
+        char digit[2] = { _editDigits[i], '\0' };
 
         bool isSelected = (_cursorPos == i);
         bool isEditing = isSelected && _editingDigit;
@@ -149,6 +201,17 @@ void SignalTxPage::drawEditMode() {
         x += digitWidth;
     }
 
+    // 左右还有未显示的位时给出提示
+    if (visibleCount < _digitCount) {
+        _u8g2->setFont(u8g2_font_6x10_tf);
+        if (_digitOffset > 0) {
+            _u8g2->drawStr(0, y - 4, "<");
+        }
+        if (_digitOffset + visibleCount < _digitCount) {
+            _u8g2->drawStr(122, y - 4, ">");
+        }
+    }
+
     // 底部: 只显示删除按钮，居中
     int btnY = 60;
     int delX = (128 - 32) / 2;
@@ -161,17 +224,24 @@ void SignalTxPage::drawEditMode() {
 }
 
 void SignalTxPage::enterEditMode() {
-    if (_signalCount == 0 || _selectedIndex >= _signalCount) {
+    SignalRecord sig;
+    if (!getSelectedSignal(sig)) {
         return;
     }
 
     _editMode = true;
     _editingDigit = false;
-    _editCode = _signals[_selectedIndex].code;
-    _digitCount = calcDigitCount(_editCode);
+    // 原始信号没有编码位，光标直接落在删除按钮上
+    if (sig.type == SignalRecord::TYPE_RAW) {
+        _editDigits[0] = '\0';
+        _digitCount = 0;
+    } else {
+        _digitCount = sig.code.toDecimal(_editDigits, sizeof(_editDigits));
+    }
     _cursorPos = 0;
+    _digitOffset = 0;
 
-    ESP_LOGI(TAG, "进入编辑模式: 编码=%lu, 位数=%d", _editCode, _digitCount);
+    ESP_LOGI(TAG, "进入编辑模式: 编码=%s, 位数=%d", _editDigits, _digitCount);
 }
 
 void SignalTxPage::exitEditMode() {
@@ -181,46 +251,68 @@ void SignalTxPage::exitEditMode() {
 }
 
 void SignalTxPage::sendSelectedSignal() {
-    if (_signalCount == 0 || _selectedIndex >= _signalCount) {
+    SignalRecord sig;
+    if (!getSelectedSignal(sig)) {
         return;
     }
 
-    SignalStorage::StoredSignal& sig = _signals[_selectedIndex];
+    if (sig.type == SignalRecord::TYPE_RAW) {
+        _arrowRight = !_arrowRight;
+        sendRawSignal(sig);
+        return;
+    }
 
-    ESP_LOGI(TAG, "发送信号: %s 编码:%lu 频率:%dMHz 协议:%d 位数:%d 脉宽:%dus",
-             sig.name, sig.code, sig.freq, sig.protocol, sig.bits, sig.pulseLength);
+    char codeText[RFCode::DECIMAL_SIZE];
+    sig.code.toDecimal(codeText, sizeof(codeText));
+    ESP_LOGI(TAG, "发送信号: 编码:%s 频率:%dMHz 协议:%d 位数:%d 脉宽:%dus",
+             codeText, sig.freq(), (int)sig.protocol, (int)sig.bits, (int)sig.pulseLength);
 
     // 切换箭头方向 (> <-> <)
     _arrowRight = !_arrowRight;
 
     // 发送信号
-    _transmitter->send(sig.code, sig.bits, sig.freq, sig.protocol, sig.pulseLength);
+    _transmitter->send(sig);
 }
 
 void SignalTxPage::sendEditedSignal() {
-    if (_signalCount == 0 || _selectedIndex >= _signalCount) {
+    SignalRecord sig;
+    if (!getSelectedSignal(sig)) {
         return;
     }
 
-    SignalStorage::StoredSignal& sig = _signals[_selectedIndex];
+    ESP_LOGI(TAG, "发送编辑后信号: 编码:%s 频率:%dMHz 协议:%d 位数:%d 脉宽:%dus",
+             _editDigits, sig.freq(), (int)sig.protocol, (int)sig.bits, (int)sig.pulseLength);
+
+    // 发送编辑后的信号 (只替换编码，其余字段沿用原记录)
+    sig.code = RFCode::fromDecimal(_editDigits);
+    _transmitter->send(sig);
+}
 
-    ESP_LOGI(TAG, "发送编辑后信号: 编码:%lu 频率:%dMHz 协议:%d 位数:%d 脉宽:%dus",
-             _editCode, sig.freq, sig.protocol, sig.bits, sig.pulseLength);
+void SignalTxPage::sendRawSignal(const SignalRecord& sig) {
+    size_t wordCount = _storage->loadRawData(sig, _rawBuffer, SignalStorage::MAX_RAW_WORDS);
+    if (wordCount == 0) {
+        ESP_LOGE(TAG, "读取原始数据失败: %lu", (unsigned long)sig.code.low64());
+        return;
+    }
 
-    // 发送编辑后的信号
-    _transmitter->send(_editCode, sig.bits, sig.freq, sig.protocol, sig.pulseLength);
+    ESP_LOGI(TAG, "发送原始信号: %lu 频率:%dMHz 脉冲数:%d",
+             (unsigned long)sig.code.low64(), sig.freq(), (int)sig.bits);
+    _transmitter->sendRaw(_rawBuffer, wordCount, sig.freq());
 }
 
 void SignalTxPage::deleteSelectedSignal() {
-    if (_signalCount == 0 || _selectedIndex >= _signalCount) {
+    SignalRecord sig;
+    if (!getSelectedSignal(sig)) {
         return;
     }
 
-    ESP_LOGI(TAG, "删除信号: %s", _signals[_selectedIndex].name);
+    char name[32];
+    _storage->getSignalName(sig, name, sizeof(name));
+    ESP_LOGI(TAG, "删除信号: %s", name);
 
     if (_storage->deleteSignal(_selectedIndex)) {
-        // 重新加载信号列表
-        loadSignals();
+        // 只更新数量，窗口按存储版本号自动重新读取
+        _signalCount = _cursor.count();
 
         // 调整选中索引
         if (_selectedIndex >= _signalCount && _signalCount > 0) {
@@ -237,36 +329,30 @@ void SignalTxPage::deleteSelectedSignal() {
     }
 }
 
-int SignalTxPage::calcDigitCount(unsigned long code) {
-    if (code == 0) return 1;
-    int count = 0;
-    unsigned long temp = code;
-    while (temp > 0) {
-        temp /= 10;
-        count++;
+void SignalTxPage::scrollToCursor() {
+    // 光标在删除按钮上时保持当前窗口
+    if (_cursorPos >= _digitCount) {
+        return;
+    }
+    if (_cursorPos < _digitOffset) {
+        _digitOffset = _cursorPos;
+    } else if (_cursorPos >= _digitOffset + VISIBLE_DIGITS) {
+        _digitOffset = _cursorPos - VISIBLE_DIGITS + 1;
     }
-    return count;
 }
 
 int SignalTxPage::getDigitAt(int pos) {
     // pos: 0=最高位，使用固定位数格式
-    char codeStr[16];
-    snprintf(codeStr, sizeof(codeStr), "%0*lu", _digitCount, _editCode);
     if (pos >= 0 && pos < _digitCount) {
-        return codeStr[pos] - '0';
+        return _editDigits[pos] - '0';
     }
     return 0;
 }
 
 void SignalTxPage::setDigitAt(int pos, int digit) {
-    // pos: 0=最高位, digit: 0-9，使用固定位数格式
-    char codeStr[16];
-    snprintf(codeStr, sizeof(codeStr), "%0*lu", _digitCount, _editCode);
-
+    // pos: 0=最高位, digit: 0-9，直接修改十进制字符串，保持固定位数
     if (pos >= 0 && pos < _digitCount && digit >= 0 && digit <= 9) {
-        codeStr[pos] = '0' + digit;
-        _editCode = strtoul(codeStr, NULL, 10);
-        // 不再重新计算位数，保持固定位数
+        _editDigits[pos] = '0' + digit;
     }
 }
 
@@ -290,7 +376,7 @@ bool SignalTxPage::handleButton(ButtonEvent event) {
                         int digit = getDigitAt(_cursorPos);
                         digit = (digit + 1) % 10;
                         setDigitAt(_cursorPos, digit);
-                        ESP_LOGD(TAG, "按键: 上 - 编码变为 %lu", _editCode);
+                        ESP_LOGD(TAG, "按键: 上 - 编码变为 %s", _editDigits);
                     }
                     return true;
 
@@ -300,7 +386,7 @@ bool SignalTxPage::handleButton(ButtonEvent event) {
                         int digit = getDigitAt(_cursorPos);
                         digit = (digit + 9) % 10;  // +9 等于 -1 mod 10
                         setDigitAt(_cursorPos, digit);
-                        ESP_LOGD(TAG, "按键: 下 - 编码变为 %lu", _editCode);
+                        ESP_LOGD(TAG, "按键: 下 - 编码变为 %s", _editDigits);
                     }
                     return true;
 
@@ -332,6 +418,7 @@ bool SignalTxPage::handleButton(ButtonEvent event) {
                     // 上键: 光标左移
                     if (_cursorPos > 0) {
                         _cursorPos--;
+                        scrollToCursor();
                         ESP_LOGD(TAG, "按键: 上 - 光标移到位置 %d", _cursorPos);
                     }
                     return true;
@@ -340,6 +427,7 @@ bool SignalTxPage::handleButton(ButtonEvent event) {
                     // 下键: 光标右移
                     if (_cursorPos < maxPos) {
                         _cursorPos++;
+                        scrollToCursor();
                         ESP_LOGD(TAG, "按键: 下 - 光标移到位置 %d", _cursorPos);
                     }
                     return true;
@@ -409,6 +497,12 @@ bool SignalTxPage::handleButton(ButtonEvent event) {
                 enterEditMode();
                 return true;
 
+            case BTN_DOWN_LONG:
+                // 长按下键: 取消所有发送
+                ESP_LOGD(TAG, "按键: 下键长按 - 取消发送");
+                _transmitter->cancelAll();
+                return true;
+
             default:
                 return true;
         }
@@ -3,12 +3,16 @@
 
 #include "Page.h"
 #include "SignalStorage.h"
+#include "SignalCursor.h"
 #include "RFTransmitter.h"
 
 /**
  * 发送模式页面
  * 显示已保存的RF信号列表，按OK键直接发送
+ * 列表通过游标按需读取可见的几项，不复制整个信号库
  * 长按OK进入编辑模式，可删除信号或修改编码
+ * 原始信号按原时序重放，编辑模式下只能删除
+ * 发送在后台任务中进行，列表模式下长按下键取消所有发送
  */
 class SignalTxPage : public Page {
 public:
@@ -27,37 +31,46 @@ private:
     RFTransmitter* _transmitter;
 
     // 信号列表
-    static const int MAX_DISPLAY_SIGNALS = 50;
-    SignalStorage::StoredSignal _signals[MAX_DISPLAY_SIGNALS];
+    SignalCursor _cursor;
     int _signalCount;
     int _selectedIndex;
     int _scrollOffset;
 
     // 发送指示器 (> 和 < 交替)
     bool _arrowRight;   // true=显示>, false=显示<
+    bool _wasSending;   // 上次刷新时是否正在发送
 
     // 编辑模式
     bool _editMode;             // 是否在编辑模式
     bool _editingDigit;         // 是否正在编辑某一位 (false=选择模式, true=编辑模式)
     int _cursorPos;             // 光标位置: 0~digitCount-1=数字位, digitCount=发射, digitCount+1=删除
-    unsigned long _editCode;    // 编辑中的编码值
-    int _digitCount;            // 编码的位数
+    char _editDigits[RFCode::DECIMAL_SIZE]; // 编辑中的编码值 (十进制，固定位数)
+    int _digitCount;            // 编码的位数 (原始信号为0)
+    int _digitOffset;           // 可见窗口的第一位 (长编码左右滚动)
+
+    // 编辑模式一屏显示的数字位数
+    static const int VISIBLE_DIGITS = 9;
+
+    // 原始信号发送缓冲区
+    uint16_t _rawBuffer[SignalStorage::MAX_RAW_WORDS];
 
     // 每页显示的信号数量
     static const int ITEMS_PER_PAGE = 3;
 
     void loadSignals();
+    bool getSelectedSignal(SignalRecord& sig);
     void drawSignalList();
     void drawEmptyMessage();
     void drawEditMode();
     void sendSelectedSignal();
     void sendEditedSignal();
+    void sendRawSignal(const SignalRecord& sig);
     void deleteSelectedSignal();
 
     // 编辑模式辅助函数
     void enterEditMode();
     void exitEditMode();
-    int calcDigitCount(unsigned long code);
+    void scrollToCursor();
     int getDigitAt(int pos);
     void setDigitAt(int pos, int digit);
 };
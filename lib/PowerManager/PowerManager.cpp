@@ -0,0 +1,61 @@
+/**
+ * @file PowerManager.cpp
+ * @brief 空闲时进入浅睡眠实现
+ */
+
+#include "PowerManager.h"
+#include <esp32-hal-log.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+static const char* TAG = "Power";
+
+const uint8_t PowerManager::WAKE_PINS[] = { BTN_UP_PIN, BTN_OK_PIN, BTN_DOWN_PIN };
+const int PowerManager::WAKE_PIN_COUNT = sizeof(WAKE_PINS) / sizeof(WAKE_PINS[0]);
+
+PowerManager::PowerManager()
+    : _wokeByButton(false)
+    , _sleepCount(0)
+    , _sleepTime(0)
+{
+}
+
+unsigned long PowerManager::lightSleep(unsigned long timeoutMs) {
+    // 按键: 关掉下降沿中断，改为低电平唤醒 (中断若开着会在唤醒后不停触发)
+    for (int i = 0; i < WAKE_PIN_COUNT; i++) {
+        const gpio_num_t pin = (gpio_num_t)WAKE_PINS[i];
+        gpio_intr_disable(pin);
+        gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)timeoutMs * 1000);
+
+    const unsigned long start = millis();
+    const esp_err_t err = esp_light_sleep_start();
+    const unsigned long slept = millis() - start;
+
+    // 恢复按键中断
+    for (int i = 0; i < WAKE_PIN_COUNT; i++) {
+        const gpio_num_t pin = (gpio_num_t)WAKE_PINS[i];
+        gpio_wakeup_disable(pin);
+        gpio_set_intr_type(pin, GPIO_INTR_NEGEDGE);
+        gpio_intr_enable(pin);
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "浅睡眠失败: %s", esp_err_to_name(err));
+        _wokeByButton = false;
+        return 0;
+    }
+
+    _wokeByButton = (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO);
+    _sleepCount++;
+    _sleepTime += slept;
+    ESP_LOGV(TAG, "浅睡眠 %lu ms%s", slept, _wokeByButton ? " (按键唤醒)" : "");
+    return slept;
+}
+
+void PowerManager::resetStats() {
+    _sleepCount = 0;
+    _sleepTime = 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file PowerManager.h
+ * @brief 空闲时进入浅睡眠
+ *
+ * 主循环确认没有进行中的工作 (RF扫描、发送、存储写入、显示刷新、
+ * USB连接) 后调用lightSleep()。睡眠期间CPU和FreeRTOS时钟停止，
+ * 内存和外设状态保留；定时器到期或任一按键拉低时唤醒。
+ *
+ * 按键平时用下降沿中断，睡眠时GPIO中断不工作，改为低电平唤醒；
+ * 唤醒后恢复下降沿中断，由ButtonManager::resyncAfterWake()补上
+ * 睡眠期间的按下。
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "pin_config.h"
+
+class PowerManager {
+public:
+    // 短于此时间不值得睡 (进出浅睡眠本身要约1ms)
+    static const unsigned long MIN_SLEEP_MS = 20;
+
+    PowerManager();
+
+    /**
+     * 浅睡眠，定时器到期或按键按下时返回
+     * @param timeoutMs 最长睡眠时间
+     * @return 实际睡眠时间 (ms)
+     */
+    unsigned long lightSleep(unsigned long timeoutMs);
+
+    /**
+     * 上次是否被按键唤醒
+     */
+    bool wokeByButton() const { return _wokeByButton; }
+
+    // 统计 (resetStats()后重新累计)
+    uint32_t getSleepCount() const { return _sleepCount; }
+    uint32_t getSleepTime() const { return _sleepTime; }     // 毫秒
+    void resetStats();
+
+private:
+    static const uint8_t WAKE_PINS[];
+    static const int WAKE_PIN_COUNT;
+
+    bool _wokeByButton;
+    uint32_t _sleepCount;
+    uint32_t _sleepTime;
+};
+
+#endif // POWER_MANAGER_H
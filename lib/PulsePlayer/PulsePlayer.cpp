@@ -0,0 +1,103 @@
+/**
+ * @file PulsePlayer.cpp
+ * @brief RMT脉冲程序播放实现
+ */
+
+#include "PulsePlayer.h"
+#include <esp32-hal-log.h>
+
+static const char* TAG = "PulsePlayer";
+
+// APB 80MHz / 80 = 1MHz, 每个tick 1us
+static const uint8_t RMT_CLOCK_DIV = 80;
+
+PulsePlayer* PulsePlayer::_players[RMT_CHANNEL_MAX] = {};
+bool PulsePlayer::_callbackRegistered = false;
+
+PulsePlayer::PulsePlayer(rmt_channel_t channel, size_t maxSteps)
+    : _channel(channel)
+    , _maxSteps(maxSteps)
+    , _ready(false)
+    , _busy(false)
+    , _doneCallback(NULL)
+    , _doneArg(NULL)
+{
+}
+
+bool PulsePlayer::begin(int pin) {
+    if (_ready) {
+        return true;
+    }
+
+    if (!_program.reserve(_maxSteps)) {
+        ESP_LOGE(TAG, "程序缓冲区分配失败: %d 步", (int)_maxSteps);
+        return false;
+    }
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)pin, _channel);
+    config.clk_div = RMT_CLOCK_DIV;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+    config.tx_config.idle_output_en = true;
+
+    esp_err_t err = rmt_config(&config);
+    if (err == ESP_OK) {
+        err = rmt_driver_install(_channel, 0, 0);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "RMT通道%d初始化失败: %s", _channel, esp_err_to_name(err));
+        return false;
+    }
+
+    _players[_channel] = this;
+    if (!_callbackRegistered) {
+        rmt_register_tx_end_callback(onTransmitEnd, NULL);
+        _callbackRegistered = true;
+    }
+
+    _ready = true;
+    ESP_LOGI(TAG, "RMT通道%d就绪, 引脚:%d", _channel, pin);
+    return true;
+}
+
+bool PulsePlayer::start() {
+    if (!_ready || _busy || _program.empty()) {
+        return false;
+    }
+
+    _busy = true;
+    esp_err_t err = rmt_write_items(_channel,
+                                    (const rmt_item32_t*)_program.steps(),
+                                    _program.size(),
+                                    false);     // 不等待发送完成
+    if (err != ESP_OK) {
+        _busy = false;
+        ESP_LOGE(TAG, "RMT发送失败: %s", esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
+void PulsePlayer::stop() {
+    if (!_ready || !_busy) {
+        return;
+    }
+    rmt_tx_stop(_channel);
+    _busy = false;
+}
+
+void PulsePlayer::setDoneCallback(DoneCallback callback, void* arg) {
+    _doneCallback = callback;
+    _doneArg = arg;
+}
+
+void IRAM_ATTR PulsePlayer::onTransmitEnd(rmt_channel_t channel, void* arg) {
+    (void)arg;
+    PulsePlayer* player = _players[channel];
+    if (!player) {
+        return;
+    }
+    player->_busy = false;
+    if (player->_doneCallback) {
+        player->_doneCallback(player, player->_doneArg);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @file PulsePlayer.h
+ * @brief 用RMT外设播放脉冲程序 (非阻塞发送)
+ *
+ * 每个发送引脚占用一个RMT发送通道，时钟分频到1us/tick。
+ * start()把程序交给RMT驱动后立即返回，驱动在中断中分批填充通道内存；
+ * 播放结束时在中断上下文中调用完成回调。播放期间程序缓冲区不能修改。
+ */
+
+#ifndef PULSE_PLAYER_H
+#define PULSE_PLAYER_H
+
+#include <Arduino.h>
+#include <driver/rmt.h>
+#include "PulseProgram.h"
+
+class PulsePlayer {
+public:
+    /**
+     * 播放完成回调 (在中断上下文中调用，不能阻塞或打印日志)
+     */
+    typedef void (*DoneCallback)(PulsePlayer* player, void* arg);
+
+    /**
+     * @param channel RMT发送通道
+     * @param maxSteps 程序最大步骤数 (每步4字节)
+     */
+    PulsePlayer(rmt_channel_t channel, size_t maxSteps);
+
+    /**
+     * 初始化RMT通道
+     * @param pin 发送引脚
+     * @return false=RMT不可用，调用方应退回阻塞发送
+     */
+    bool begin(int pin);
+
+    /**
+     * 待播放的程序 (仅在空闲时编译)
+     */
+    PulseProgram& program() { return _program; }
+
+    /**
+     * 开始播放当前程序，立即返回
+     * @return false=未初始化、正在播放或程序为空
+     */
+    bool start();
+
+    /**
+     * 中止播放
+     */
+    void stop();
+
+    bool isReady() const { return _ready; }
+    bool isBusy() const { return _busy; }
+
+    void setDoneCallback(DoneCallback callback, void* arg);
+
+private:
+    rmt_channel_t _channel;
+    size_t _maxSteps;
+    PulseProgram _program;
+    bool _ready;
+    volatile bool _busy;
+    DoneCallback _doneCallback;
+    void* _doneArg;
+
+    // RMT发送完成回调是全局的，按通道分发到播放器
+    static PulsePlayer* _players[RMT_CHANNEL_MAX];
+    static bool _callbackRegistered;
+    static void IRAM_ATTR onTransmitEnd(rmt_channel_t channel, void* arg);
+};
+
+#endif // PULSE_PLAYER_H
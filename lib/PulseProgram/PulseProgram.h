@@ -0,0 +1,151 @@
+/**
+ * @file PulseProgram.h
+ * @brief 游程编码的发送脉冲程序
+ *
+ * 发送前把 (协议, 编码, 位数, 重复次数) 或原始脉冲序列编译成一串
+ * (电平, 时长) 步骤，由PulsePlayer交给硬件 (RMT) 播放，CPU不再逐位翻转GPIO。
+ *
+ * 每个步骤包含两段电平，位布局与RMT条目 (rmt_item32_t) 相同，
+ * 可直接交给驱动；时长为0的段表示程序结束，因此追加时会跳过0时长。
+ * 程序本身不依赖硬件，可在主机上按步骤回放以检查时序。
+ */
+
+#ifndef PULSE_PROGRAM_H
+#define PULSE_PROGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "RawPulse.h"
+
+// 一个程序步骤: 先以level0保持duration0，再以level1保持duration1 (单位: 微秒)
+struct PulseStep {
+    uint32_t duration0 : 15;
+    uint32_t level0 : 1;
+    uint32_t duration1 : 15;
+    uint32_t level1 : 1;
+};
+
+static_assert(sizeof(PulseStep) == 4, "PulseStep必须与RMT条目同为32位");
+
+class PulseProgram {
+public:
+    static const uint32_t MAX_SEGMENT = 0x7FFF;    // 单段最大时长，更长的脉冲拆成多段
+
+    PulseProgram() : _steps(NULL), _capacity(0), _count(0), _halfOpen(false), _overflow(false), _total(0) {}
+
+    ~PulseProgram() {
+        free(_steps);
+    }
+
+    /**
+     * 分配步骤缓冲区 (只在初始化时调用一次)
+     * @param steps 最大步骤数
+     * @return 是否分配成功
+     */
+    bool reserve(size_t steps) {
+        PulseStep* buffer = (PulseStep*)realloc(_steps, steps * sizeof(PulseStep));
+        if (!buffer) {
+            return false;
+        }
+        _steps = buffer;
+        _capacity = steps;
+        clear();
+        return true;
+    }
+
+    /**
+     * 清空程序，准备重新编译
+     */
+    void clear() {
+        _count = 0;
+        _halfOpen = false;
+        _overflow = false;
+        _total = 0;
+    }
+
+    /**
+     * 追加一段电平
+     * @param level 电平 (0/1)
+     * @param duration 时长 (微秒)，0被忽略
+     */
+    void append(uint8_t level, uint32_t duration) {
+        _total += duration;
+        while (duration > 0) {
+            const uint32_t segment = (duration > MAX_SEGMENT) ? MAX_SEGMENT : duration;
+            appendSegment(level, segment);
+            duration -= segment;
+        }
+    }
+
+    /**
+     * 追加原始脉冲序列 (RawPulse编码，第一个脉冲为firstLevel，之后交替)
+     */
+    void appendRaw(const uint16_t* words, size_t wordCount, uint8_t firstLevel) {
+        size_t pos = 0;
+        uint32_t duration;
+        uint8_t level = firstLevel;
+        while (RawPulse::decode(words, wordCount, pos, duration)) {
+            append(level, duration);
+            level = !level;
+        }
+    }
+
+    /**
+     * 结束程序: 补齐最后一个步骤的后半段 (0时长=结束标记)
+     * @param idleLevel 结束后保持的电平
+     * @return false=缓冲区不足，程序被截断
+     */
+    bool finish(uint8_t idleLevel) {
+        if (_halfOpen) {
+            PulseStep& step = _steps[_count - 1];
+            step.level1 = idleLevel;
+            step.duration1 = 0;
+            _halfOpen = false;
+        }
+        return !_overflow;
+    }
+
+    const PulseStep* steps() const { return _steps; }
+    size_t size() const { return _count; }
+    size_t capacity() const { return _capacity; }
+    bool empty() const { return _count == 0; }
+
+    /**
+     * 程序总时长 (微秒)
+     */
+    uint32_t totalDuration() const { return _total; }
+
+private:
+    PulseStep* _steps;
+    size_t _capacity;
+    size_t _count;
+    bool _halfOpen;     // 最后一个步骤只填了前半段
+    bool _overflow;
+    uint32_t _total;
+
+    PulseProgram(const PulseProgram&);
+    PulseProgram& operator=(const PulseProgram&);
+
+    void appendSegment(uint8_t level, uint32_t duration) {
+        if (_halfOpen) {
+            PulseStep& step = _steps[_count - 1];
+            step.level1 = level;
+            step.duration1 = duration;
+            _halfOpen = false;
+            return;
+        }
+        if (_count >= _capacity) {
+            _overflow = true;
+            return;
+        }
+        PulseStep& step = _steps[_count++];
+        step.level0 = level;
+        step.duration0 = duration;
+        step.level1 = level;
+        step.duration1 = 0;
+        _halfOpen = true;
+    }
+};
+
+#endif // PULSE_PROGRAM_H
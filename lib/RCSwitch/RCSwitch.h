@@ -0,0 +1,1436 @@
+/**
+ * @file RCSwitch.h
+ * @brief RF信号收发引擎 (基于rc-switch修改，按频段模板化)
+ *
+ * 每个频段是RCSwitch<BandTraits>的一个实例化，拥有独立的静态接收状态
+ * 和中断入口，因此多个频段可以同时收发。增加新频段只需一行:
+ *
+ *     RCSWITCH_BAND(868)   // 生成 Band868 和 RCSwitch868
+ *
+ * 中断中只记录边沿时间戳，协议解码由解码任务调用processEdges()完成，
+ * 解码出的完整帧进入无锁帧队列，由接收方通过readFrame()批量取出
+ *
+ * 解码为逐边沿的流式状态机: 同步间隔之后的每个边沿都用一次遍历同时推进
+ * 仍在候选位掩码中的协议，每个协议累计时序误差，时序超出窗口的协议被剔除，
+ * 之后每个边沿不再为它计算。帧结束时取误差最小的候选协议，出过窗的协议
+ * 误差都要明显更大 (AMBIGUITY_SHIFT)，否则整帧丢弃: 时序比例相近的协议窗口
+ * 互相重叠，真正的协议因为抖动出窗后，窗口更宽的协议仍会接受这段信号，
+ * 按编号或按剩下的候选输出都会报错协议号。出过窗的协议此时才从保存的
+ * 时序补算出窗后的误差，超过歧义门限即停止。
+ * 协议9和协议8是同一串电平错开半位，以1结尾的协议9编码两种读法误差相同，
+ * 解成编号小的协议8 (编码错开一位)，按解出的帧重放的波形和原信号相同。
+ * 线路静默超过分隔时间即可确认帧结束并立即输出，无需等待下一个同步
+ * 间隔结束后再整体重试所有协议。
+ * 同步间隔短于分隔时间的协议 (4: 6个脉宽) 单独走一个短同步通道。
+ * 遥控器总是重复发送，帧前后的同步间隔相同；一段静默和帧开头的同电平
+ * 时序合在一起也像同步间隔，但长度是任意的，按它缩放的窗口会把数据错配
+ * 给别的协议。所以帧前的同步间隔必须和帧后的同步间隔一致，或者和上一帧
+ * (解出同一协议) 前的同步间隔一致，或者由帧本身印证: 正相协议至少
+ * TRUSTED_MIN_BITS位，帧前后都有和同步间隔成比例的同步头，数据按同步
+ * 间隔缩放的脉宽误差小。这样按键的第一帧在静默超时时就输出。
+ * 反相协议 (6, 9-12) 没有帧前后的同步头、短帧凑巧对上的概率大，第一帧
+ * 只有帧后的间隔能印证，先暂存到下一个同步到达，比重复帧晚输出一个
+ * 同步间隔减去分隔时间 (协议1约6ms)；重复帧由上一帧印证，不受影响。
+ * 各协议第一帧和重复帧的延迟见 rf-remote bench decoder。
+ *
+ * 原始捕获模式记录同步间隔之后的整段脉冲 (多帧、超长帧、未知协议)，
+ * 不受MAX_CHANGES限制，可通过sendRaw()按原时序重放。
+ *
+ * 编码值使用RFCode (内联位向量)，超过32位的帧不再丢失高位。
+ *
+ * 无载波时接收模块输出连续噪声，每秒上万个边沿。两层保护:
+ * - 毛刺过滤: 中断中暂存最近一个边沿，下一个边沿间隔太短则两个一起丢弃，
+ *   不进入边沿缓冲区 (ESP32-C3的GPIO没有可配置宽度的硬件毛刺滤波)
+ * - 边沿风暴保护: 解码任务统计边沿速率，超过上限时暂时关闭该频段中断，
+ *   风暴持续则关闭时间加倍
+ */
+
+#ifndef RCSwitch_h
+#define RCSwitch_h
+
+#include <Arduino.h>
+#include "SPSCQueue.h"
+#include "RawPulse.h"
+#include "RFCode.h"
+#include "PulseProgram.h"
+
+// 最大信号变化次数 (同步间隔 + 每位两个时序)
+#define RCSWITCH_MAX_CHANGES (RFCODE_MAX_BITS * 2 + 1)
+
+// 边沿时间戳环形缓冲区大小 (必须为2的幂)
+#define RCSWITCH_EDGE_BUFFER_SIZE 256
+
+// 已解码帧队列大小 (必须为2的幂)
+#define RCSWITCH_FRAME_QUEUE_SIZE 8
+
+// 原始捕获缓冲区大小 (16位字, 见RawPulse编码)
+#define RCSWITCH_RAW_CAPTURE_SIZE 1024
+
+// 解码出的完整帧 (整帧一次入队，读取方不会看到半帧)
+struct RCSwitchFrame {
+    RFCode code;                // 编码值
+    unsigned int bitlength;     // 位长度
+    unsigned int delay;         // 脉宽 (微秒)
+    unsigned int protocol;      // 协议编号
+    unsigned long timestamp;    // 帧结束时间 (微秒)
+};
+
+// 边沿监听回调 (解码任务中调用，参数为频段频率和边沿时间戳)
+typedef void (*RCSwitchEdgeTap)(unsigned int frequency, unsigned long time);
+
+template <typename BandTraits>
+class RCSwitch {
+public:
+    // 协议结构
+    struct HighLow {
+        uint8_t high;
+        uint8_t low;
+    };
+
+    struct Protocol {
+        uint16_t pulseLength;
+        HighLow syncFactor;
+        HighLow zero;
+        HighLow one;
+        bool invertedSignal;
+    };
+
+    typedef RCSwitchFrame ReceivedFrame;
+
+    // 频段频率 (MHz)
+    static const unsigned int FREQUENCY = BandTraits::FREQUENCY;
+
+    RCSwitch();
+
+    // ========== 接收功能 ==========
+    void enableReceive(int interrupt);
+    void enableReceive();
+    void disableReceive();
+
+    /**
+     * 取出一帧已解码的数据 (先进先出)
+     * @return false=没有待读取的帧
+     */
+    bool readFrame(ReceivedFrame& frame);
+
+    void setReceiveTolerance(int nPercent);
+
+    // ========== 原始捕获 ==========
+    /**
+     * 启用/关闭原始捕获 (单次: 捕获完成后保持数据，直到releaseRawCapture())
+     */
+    static void setRawCapture(bool enable);
+
+    /**
+     * 是否已捕获到完整的一段脉冲
+     */
+    static bool isRawCaptureReady();
+
+    /**
+     * 获取已捕获的脉冲数据 (RawPulse编码)
+     * @param wordCount 输出字数
+     * @return 数据指针, 未就绪时返回NULL
+     */
+    static const uint16_t* getRawCapture(size_t& wordCount);
+
+    /**
+     * 释放已捕获数据并等待下一段脉冲
+     */
+    static void releaseRawCapture();
+
+    // ========== 发送功能 ==========
+    void enableTransmit(int nTransmitterPin);
+    void disableTransmit();
+    void send(const RFCode& code, unsigned int length);
+    void sendRaw(const uint16_t* words, size_t wordCount);
+
+    /**
+     * 按当前协议、脉宽和重复次数把编码编译成脉冲程序 (不占用发送引脚)
+     * @return false=程序缓冲区不足
+     */
+    bool compile(const RFCode& code, unsigned int length, PulseProgram& program) const;
+
+    void setRepeatTransmit(int nRepeatTransmit);
+    void setPulseLength(int nPulseLength);
+
+    void setProtocol(Protocol protocol);
+    void setProtocol(int nProtocol);
+    void setProtocol(int nProtocol, int nPulseLength);
+
+    // 调试功能
+    static unsigned long getInterruptCount();
+    static void resetInterruptCount();
+    static unsigned int getLastTimingsCount();
+    static unsigned int getEdgeBufferHighWatermark();
+    static unsigned long getEdgeOverflowCount();
+    static unsigned long getFrameDropCount();
+
+    /**
+     * 获取协议的解码延迟 (帧首个边沿到输出的时间, 微秒)
+     * @param protocol 协议编号 (1-12)
+     */
+    static unsigned long getLastDecodeLatency(unsigned int protocol);
+    static unsigned long getMaxDecodeLatency(unsigned int protocol);
+
+    // ========== 噪声保护 ==========
+    /**
+     * 毛刺过滤: 短于过滤宽度的脉冲连同它的两个边沿在中断中丢弃
+     * 宽度按协议取其最短时序接收窗口的下沿 (比它短的脉冲该协议本来就不接受):
+     * 有进行中的帧时取仍匹配的候选协议的最小值，否则取所有协议的最小值，
+     * 且不超过maxPulseUs (0=关闭)
+     */
+    static void setGlitchFilter(unsigned int maxPulseUs);
+
+    /**
+     * 边沿风暴保护: 边沿速率超过edgesPerSecond时关闭该频段中断
+     * GATE_MIN_MS，连续超限时每次加倍到GATE_MAX_MS (0=关闭)；
+     * 正在解码帧时不关闭
+     */
+    static void setEdgeRateLimit(unsigned long edgesPerSecond);
+
+    /**
+     * 最近一个统计窗口的边沿速率 (每秒, 含毛刺; 关闭期间保持关闭前的值)
+     */
+    static unsigned long getEdgeRate();
+    static unsigned long getGlitchCount();     // 丢弃的毛刺数
+    static unsigned long getGatedTime();       // 中断累计关闭时间 (毫秒)
+    static unsigned long getGateCount();       // 中断关闭次数
+    static bool isGated();
+
+    /**
+     * 本频段发送期间暂停接收: 中断直接丢弃边沿 (不计入边沿速率)，
+     * 恢复时丢弃缓冲区和进行中的帧，自己发出的信号不会被当作收到的信号
+     * 由发送任务在播放前后调用
+     */
+    static void suspendReceive();
+    static void resumeReceive();
+    static bool isReceiveSuspended();
+
+    /**
+     * 取出边沿缓冲区中的时间戳并进行协议解码
+     * 由解码任务周期调用，不在中断中执行
+     */
+    static void processEdges();
+
+    /**
+     * 帧队列里有帧或原始捕获已完成 (解码任务据此通知主循环)
+     */
+    static bool hasOutput();
+
+    /**
+     * 设置边沿监听回调 (NULL=关闭)，processEdges()解码前按顺序把每个
+     * 时间戳 (已经过毛刺过滤) 交给它，用于录制边沿轨迹；中断处理不受影响
+     */
+    static void setEdgeTap(RCSwitchEdgeTap tap);
+
+private:
+    // 协议定义 (与rc-switch完全一致)
+    static constexpr Protocol PROTOCOLS[] = {
+        { 350, {  1, 31 }, {  1,  3 }, {  3,  1 }, false },  // 1: PT2262
+        { 650, {  1, 10 }, {  1,  2 }, {  2,  1 }, false },  // 2: PT2260
+        { 100, { 30, 71 }, {  4, 11 }, {  9,  6 }, false },  // 3: EV1527
+        { 380, {  1,  6 }, {  1,  3 }, {  3,  1 }, false },  // 4: HT6P20B
+        { 500, {  6, 14 }, {  1,  2 }, {  2,  1 }, false },  // 5: SC5262
+        { 450, { 23,  1 }, {  1,  2 }, {  2,  1 }, true  },  // 6: HT6P20B
+        { 150, {  2, 62 }, {  1,  6 }, {  6,  1 }, false },  // 7: HS2303-PT
+        { 200, {  3, 130}, {  7, 16 }, {  3, 16 }, false },  // 8: Conrad RS-200 RX
+        { 200, { 130, 7 }, { 16,  7 }, { 16,  3 }, true  },  // 9: Conrad RS-200 TX
+        { 365, { 18,  1 }, {  3,  1 }, {  1,  3 }, true  },  // 10: 1ByOne Doorbell
+        { 270, { 36,  1 }, {  1,  2 }, {  2,  1 }, true  },  // 11: HT12E
+        { 320, { 36,  1 }, {  1,  2 }, {  2,  1 }, true  },  // 12: SM5212
+    };
+
+    static const unsigned int NUM_PROTOCOLS = sizeof(PROTOCOLS) / sizeof(PROTOCOLS[0]);
+    static const uint16_t ALL_PROTOCOLS = (1U << NUM_PROTOCOLS) - 1;
+    static const unsigned int SEPARATION_LIMIT = 4300;
+    // 两个同步间隔视为相同的误差: 1/8 (SYNC_MATCH_SHIFT) 加上rc-switch的200微秒
+    static const unsigned int SYNC_MATCH_SHIFT = 3;
+    static const unsigned int SYNC_MATCH_US = 200;
+    // 同步头和按同步间隔缩放的标称时长相差不超过1/4 (SYNC_HEAD_SHIFT) 时，印证同步间隔
+    static const unsigned int SYNC_HEAD_SHIFT = 2;
+    // 帧本身印证同步间隔的最少位数，和RFReceiver::MIN_VALID_BITS相同；
+    // 更短的帧和被截断的残帧仍等下一个同步间隔
+    static const unsigned int TRUSTED_MIN_BITS = 20;
+    // 出过窗的协议误差不超过最佳协议的 1 + 1/2 (AMBIGUITY_SHIFT) 时，帧有歧义
+    static const unsigned int AMBIGUITY_SHIFT = 1;
+    static const unsigned int EDGE_MASK = RCSWITCH_EDGE_BUFFER_SIZE - 1;
+
+    // 边沿风暴保护: 统计窗口和关闭时间 (毫秒)
+    static const unsigned long RATE_WINDOW_MS = 20;
+    static const unsigned long GATE_MIN_MS = 20;
+    static const unsigned long GATE_MAX_MS = 320;
+
+    // 原始捕获: 静默超过此时间视为一段脉冲结束 (微秒)
+    static const unsigned long RAW_END_GAP = 100000;
+    // 原始捕获: 少于此脉冲数的片段视为噪声丢弃
+    static const unsigned int RAW_MIN_PULSES = 24;
+
+    enum RawState {
+        RAW_OFF = 0,
+        RAW_ARMED,          // 等待同步间隔
+        RAW_CAPTURING,      // 记录中
+        RAW_READY           // 已完成，等待读取
+    };
+
+    enum RawRequest {
+        RAW_REQUEST_NONE = 0,
+        RAW_REQUEST_ARM,
+        RAW_REQUEST_OFF
+    };
+
+    // 定点缩放位数: 时序窗口以同步间隔的Q16倍数表示
+    static const unsigned int WINDOW_SHIFT = 16;
+
+    // 单个脉冲的接收窗口 (同步间隔的Q16倍数, 开区间) 和标称时长
+    struct PulseWindow {
+        uint32_t lower;
+        uint32_t center;
+        uint32_t upper;
+    };
+
+    // 协议的预计算窗口表，仅在接收容差改变时重建
+    struct ProtocolWindows {
+        uint32_t delayScale;    // 1/syncLengthInPulses (Q16)
+        uint32_t syncPulse;     // 同步信号中间隔以外的另一段 (Q16)
+        PulseWindow zeroHigh;
+        PulseWindow zeroLow;
+        PulseWindow oneHigh;
+        PulseWindow oneLow;
+    };
+
+    // 当前帧各协议的绝对时序窗口 (微秒, 开区间) 和标称时长，在同步间隔处计算一次
+    struct FrameBounds {
+        unsigned int zeroHighMin, zeroHighMax;
+        unsigned int zeroLowMin, zeroLowMax;
+        unsigned int oneHighMin, oneHighMax;
+        unsigned int oneLowMin, oneLowMax;
+        unsigned int zeroHigh, zeroLow, oneHigh, oneLow;
+        unsigned int syncPulse;
+        unsigned int glitchUs;      // 最短时序窗口的下沿
+    };
+
+    // 解码通道: 长通道以超过SEPARATION_LIMIT的时序为同步；同步间隔比它短的
+    // 协议在长通道里看不到同步，由短通道以超过shortSyncMin的时序为同步
+    enum {
+        LANE_LONG = 0,
+        LANE_SHORT,
+        LANE_COUNT
+    };
+
+    struct FrameLane {
+        uint16_t protocols;         // 本通道解码的协议
+        uint16_t viable;            // 仍然匹配的候选协议
+        unsigned int syncGap;       // 帧前的同步间隔 (微秒)
+        unsigned int leadPulse;     // 同步间隔前的一个时序 (正相协议的同步头)
+        unsigned int prevSyncGap;   // 上一帧前的同步间隔 (0=没有)
+        uint8_t protocol;           // 当前帧解出的协议 (0=没有)
+        uint8_t prevProtocol;       // 上一帧解出的协议
+        unsigned int changeCount;   // 当前帧已收到的时序数 (含同步间隔)
+        unsigned long frameStart;   // 帧首个边沿的时间
+        bool frameDone;             // 当前帧已结束 (静默超时或下一个同步)
+        bool holding;               // held等待下一个同步间隔印证
+        ReceivedFrame held;
+        uint16_t timings[RCSWITCH_MAX_CHANGES];    // 当前帧的时序，出过窗的协议在帧结束时才用它计分
+    };
+
+    // 每个频段独立的接收状态 (由中断和解码任务共享)
+    struct ReceiveState {
+        SPSCQueue<ReceivedFrame, RCSWITCH_FRAME_QUEUE_SIZE> frames;
+        int receiveTolerance;
+        bool windowsReady;
+        ProtocolWindows windows[NUM_PROTOCOLS];
+        uint16_t invertedMask;      // 反相协议 (数据从第2个时序开始)
+
+        // 流式解码状态
+        FrameLane lanes[LANE_COUNT];
+        unsigned int shortSyncMin;  // 短通道的同步阈值 (微秒)
+        unsigned long lastEdgeTime;
+        unsigned int lastDuration;  // 上一个时序 (高电平段的误差在低电平段到达后计入)
+        uint16_t zeroHighHit;       // 本位高电平段匹配"0"的协议
+        uint16_t oneHighHit;        // 本位高电平段匹配"1"的协议
+        RFCode codes[NUM_PROTOCOLS];
+        uint32_t errors[NUM_PROTOCOLS];     // 累计时序误差 (微秒)，出过窗的协议停在出窗前
+        uint16_t rejectedAt[NUM_PROTOCOLS]; // 出窗位的低电平段序号
+        FrameBounds bounds[NUM_PROTOCOLS];
+
+        // 各协议解码延迟 (微秒)
+        volatile unsigned long lastLatency[NUM_PROTOCOLS];
+        volatile unsigned long maxLatency[NUM_PROTOCOLS];
+
+        // 边沿时间戳环形缓冲区 (ISR写head, 解码任务写tail, 单生产者单消费者无锁)
+        volatile unsigned long edgeBuffer[RCSWITCH_EDGE_BUFFER_SIZE];
+        volatile unsigned int edgeHead;
+        volatile unsigned int edgeTail;
+        volatile bool resetPending;
+        volatile bool clearFrames;
+        volatile bool suspended;    // 发送期间暂停接收
+
+        // 毛刺过滤 (pendingEdge由中断写入，超过毛刺宽度仍无下一个边沿时由解码任务写入缓冲区)
+        unsigned int glitchLimitUs;         // 过滤宽度上限 (0=关闭)
+        unsigned int idleGlitchUs;          // 所有协议最短时序窗口下沿的最小值
+        volatile unsigned int glitchUs;     // 中断使用的过滤宽度 (由解码任务按候选协议更新)
+        volatile unsigned long pendingEdge;
+        volatile bool hasPendingEdge;
+        volatile unsigned long glitchCount;
+
+        // 边沿风暴保护 (只由解码任务修改)
+        volatile int pin;           // 接收中断引脚 (-1=未启用)
+        bool frameActive;           // 有通道正在解码帧 (不关闭中断)
+        unsigned long edgeRateLimit;
+        unsigned long windowStart;  // 统计窗口开始 (毫秒)
+        unsigned long windowEdges;  // 窗口开始时的中断计数
+        volatile unsigned long edgeRate;
+        volatile bool gated;
+        unsigned long gateStart;
+        unsigned long gateMs;       // 本次关闭时长 (0=上个窗口未超限)
+        volatile unsigned long gatedTime;
+        volatile unsigned long gateCount;
+
+        // 原始捕获 (状态只由解码任务修改，其他线程通过rawRequest请求)
+        uint16_t rawWords[RCSWITCH_RAW_CAPTURE_SIZE];
+        volatile unsigned int rawCount;
+        unsigned int rawPulses;
+        volatile uint8_t rawState;
+        volatile uint8_t rawRequest;
+
+        // 调试用计数器
+        volatile unsigned long interruptCount;
+        volatile unsigned int lastTimingsCount;
+        volatile unsigned int edgeHighWatermark;
+        volatile unsigned long edgeOverflowCount;
+    };
+
+    static ReceiveState _rx;
+    static RCSwitchEdgeTap volatile _edgeTap;
+    static portMUX_TYPE _edgeMux;   // 保护pendingEdge和解码任务写入缓冲区
+
+    // 接收相关
+    static void IRAM_ATTR handleInterrupt();
+    static inline void IRAM_ATTR pushEdge(unsigned long time);
+    static void flushPendingEdge();
+    static void updateGate();
+    static void updateGlitchWidth();
+    static void abandonFrame();
+    static void handleEdge(unsigned long time);
+    static void startFrame(FrameLane& lane, unsigned int syncGap, unsigned long time);
+    static void advanceFrame(FrameLane& lane, unsigned int duration);
+    static void finishFrame(FrameLane& lane, unsigned long now, unsigned int nextSyncGap);
+    static uint32_t rejectedError(const FrameLane& lane, unsigned int p, uint32_t limit);
+    static bool trustedSyncGap(const FrameLane& lane, unsigned int p, uint32_t error);
+    static void confirmHeld(FrameLane& lane, unsigned int nextSyncGap, unsigned long now);
+    static void emitFrame(const ReceivedFrame& frame, unsigned long start, unsigned long now);
+    static inline bool sameSyncGap(unsigned int a, unsigned int b) {
+        return distance(a, b) < (a >> SYNC_MATCH_SHIFT) + SYNC_MATCH_US;
+    }
+    static void resetFrames();
+    static void captureRaw(unsigned int duration);
+    static void finishRaw();
+    static void buildWindows();
+    static PulseWindow makeWindow(unsigned int factor, unsigned int syncLength);
+    static inline unsigned int distance(unsigned int a, unsigned int b) { return a > b ? a - b : b - a; }
+    int nReceiverInterrupt;
+
+    // 发送相关
+    void transmit(HighLow pulses);
+    int nTransmitterPin;
+    int nRepeatTransmit;
+    Protocol protocol;
+};
+
+// 定义一个频段: 生成 Band<freq> 特征类和 RCSwitch<freq> 类型别名
+#define RCSWITCH_BAND(freq) \
+    struct Band##freq { static const unsigned int FREQUENCY = freq; }; \
+    typedef RCSwitch<Band##freq> RCSwitch##freq;
+
+RCSWITCH_BAND(433)
+RCSWITCH_BAND(315)
+
+// ============================================================================
+// 实现 (模板，仅头文件)
+// ============================================================================
+
+template <typename BandTraits>
+constexpr typename RCSwitch<BandTraits>::Protocol RCSwitch<BandTraits>::PROTOCOLS[];
+
+template <typename BandTraits>
+typename RCSwitch<BandTraits>::ReceiveState RCSwitch<BandTraits>::_rx = {
+    {}, 60,             // 帧队列, 默认容差60%
+    false, {}, 0,       // 时序窗口表 (首次启用接收时生成)
+    { { 0, 0, 0, 0, 0, 0, 0, 0, 0, true, false, {}, {} }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, true, false, {}, {} } }, 0, // 流式解码状态
+    0, 0, 0, 0, {}, {}, {}, {},
+    {}, {},             // 解码延迟
+    {}, 0, 0, false, false, false, // 边沿缓冲区
+    0, 0, 0, 0, false, 0, // 毛刺过滤 (默认关闭)
+    -1, false, 0, 0, 0, 0, false, 0, 0, 0, 0, // 边沿风暴保护 (默认关闭)
+    {}, 0, 0, RAW_OFF, RAW_REQUEST_NONE, // 原始捕获
+    0, 0, 0, 0          // 调试计数器
+};
+
+template <typename BandTraits>
+RCSwitchEdgeTap volatile RCSwitch<BandTraits>::_edgeTap = NULL;
+
+template <typename BandTraits>
+portMUX_TYPE RCSwitch<BandTraits>::_edgeMux = portMUX_INITIALIZER_UNLOCKED;
+
+template <typename BandTraits>
+RCSwitch<BandTraits>::RCSwitch() {
+    nReceiverInterrupt = -1;
+    nTransmitterPin = -1;
+    nRepeatTransmit = 10;
+    setProtocol(1);  // 默认协议1 (PT2262)
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setReceiveTolerance(int nPercent) {
+    _rx.receiveTolerance = nPercent;
+    buildWindows();
+}
+
+template <typename BandTraits>
+typename RCSwitch<BandTraits>::PulseWindow RCSwitch<BandTraits>::makeWindow(unsigned int factor, unsigned int syncLength) {
+    // |t - delay*factor| < delay*tolerance/100, delay = sync/syncLength
+    // => sync*(factor*100 - tolerance)/(100*syncLength) < t < sync*(factor*100 + tolerance)/(100*syncLength)
+    const int32_t center = (int32_t)factor * 100;
+    const int32_t tolerance = _rx.receiveTolerance;
+    const uint32_t divisor = 100 * syncLength;
+
+    PulseWindow window;
+    window.lower = (center > tolerance)
+                   ? (uint32_t)((((uint64_t)(center - tolerance)) << WINDOW_SHIFT) / divisor) : 0;
+    window.center = (uint32_t)((((uint64_t)center) << WINDOW_SHIFT) / divisor);
+    window.upper = (uint32_t)((((uint64_t)(center + tolerance)) << WINDOW_SHIFT) / divisor);
+    return window;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::buildWindows() {
+    uint16_t shortProtocols = 0;
+    unsigned int shortSyncMin = SEPARATION_LIMIT;
+    unsigned int idleGlitchUs = UINT32_MAX;
+    for (unsigned int p = 0; p < NUM_PROTOCOLS; p++) {
+        const Protocol &pro = PROTOCOLS[p];
+        const unsigned int syncLengthInPulses = ((pro.syncFactor.low) > (pro.syncFactor.high))
+                                               ? (pro.syncFactor.low) : (pro.syncFactor.high);
+        const unsigned int syncPulse = ((pro.syncFactor.low) > (pro.syncFactor.high))
+                                      ? (pro.syncFactor.high) : (pro.syncFactor.low);
+        ProtocolWindows &w = _rx.windows[p];
+        // 向上取整，保证 (sync * delayScale) >> 16 == sync / syncLengthInPulses
+        w.delayScale = ((1UL << WINDOW_SHIFT) + syncLengthInPulses - 1) / syncLengthInPulses;
+        w.syncPulse = makeWindow(syncPulse, syncLengthInPulses).center;
+        w.zeroHigh = makeWindow(pro.zero.high, syncLengthInPulses);
+        w.zeroLow = makeWindow(pro.zero.low, syncLengthInPulses);
+        w.oneHigh = makeWindow(pro.one.high, syncLengthInPulses);
+        w.oneLow = makeWindow(pro.one.low, syncLengthInPulses);
+
+        // 毛刺宽度: 协议最短时序 (同步或数据) 接收窗口的下沿
+        unsigned int shortest = syncPulse;
+        shortest = pro.zero.high < shortest ? pro.zero.high : shortest;
+        shortest = pro.zero.low < shortest ? pro.zero.low : shortest;
+        shortest = pro.one.high < shortest ? pro.one.high : shortest;
+        shortest = pro.one.low < shortest ? pro.one.low : shortest;
+        const int glitchPercent = (int)shortest * 100 - _rx.receiveTolerance;
+        const unsigned int glitchUs = glitchPercent > 0 ? glitchPercent * pro.pulseLength / 100 : 0;
+        idleGlitchUs = glitchUs < idleGlitchUs ? glitchUs : idleGlitchUs;
+
+        // 标称同步间隔不超过分隔时间: 走短通道，同步阈值取最长数据时序和同步间隔的中点
+        if (syncLengthInPulses * pro.pulseLength <= SEPARATION_LIMIT) {
+            unsigned int longest = pro.zero.high;
+            longest = pro.zero.low > longest ? pro.zero.low : longest;
+            longest = pro.one.high > longest ? pro.one.high : longest;
+            longest = pro.one.low > longest ? pro.one.low : longest;
+            const unsigned int threshold = (longest + syncLengthInPulses) * pro.pulseLength / 2;
+            shortSyncMin = threshold < shortSyncMin ? threshold : shortSyncMin;
+            shortProtocols |= (1U << p);
+        }
+    }
+
+    _rx.invertedMask = 0;
+    for (unsigned int p = 0; p < NUM_PROTOCOLS; p++) {
+        if (PROTOCOLS[p].invertedSignal) {
+            _rx.invertedMask |= (1U << p);
+        }
+    }
+    _rx.lanes[LANE_LONG].protocols = ALL_PROTOCOLS & ~shortProtocols;
+    _rx.lanes[LANE_SHORT].protocols = shortProtocols;
+    _rx.shortSyncMin = shortSyncMin;
+    _rx.idleGlitchUs = idleGlitchUs;
+    _rx.windowsReady = true;
+    updateGlitchWidth();
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setProtocol(Protocol proto) {
+    this->protocol = proto;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setProtocol(int nProtocol) {
+    if (nProtocol < 1 || nProtocol > (int)NUM_PROTOCOLS) {
+        nProtocol = 1;
+    }
+    this->protocol = PROTOCOLS[nProtocol - 1];
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setProtocol(int nProtocol, int nPulseLength) {
+    setProtocol(nProtocol);
+    this->protocol.pulseLength = nPulseLength;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setPulseLength(int nPulseLength) {
+    this->protocol.pulseLength = nPulseLength;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setRepeatTransmit(int repeat) {
+    this->nRepeatTransmit = repeat;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::enableReceive(int interrupt) {
+    nReceiverInterrupt = interrupt;
+    enableReceive();
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::enableReceive() {
+    if (nReceiverInterrupt != -1) {
+        if (!_rx.windowsReady) {
+            buildWindows();
+        }
+        _rx.clearFrames = true;   // 由读取方丢弃上次扫描遗留的帧
+        _rx.resetPending = true;  // 由解码任务丢弃旧边沿并复位解码状态
+        _rx.gated = false;
+        _rx.gateMs = 0;
+        _rx.windowStart = millis();
+        _rx.windowEdges = _rx.interruptCount;
+        attachInterrupt(nReceiverInterrupt, handleInterrupt, CHANGE);
+        _rx.pin = nReceiverInterrupt;  // 中断打开后解码任务才开始统计速率
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::disableReceive() {
+    if (nReceiverInterrupt != -1) {
+        _rx.pin = -1;  // 先停止风暴保护，解码任务不会再重新打开中断
+        if (_rx.gated) {
+            _rx.gatedTime += millis() - _rx.gateStart;
+            _rx.gated = false;
+        }
+        detachInterrupt(nReceiverInterrupt);
+        nReceiverInterrupt = -1;
+    }
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::readFrame(ReceivedFrame& frame) {
+    if (_rx.clearFrames) {
+        _rx.clearFrames = false;
+        _rx.frames.clear();
+    }
+    return _rx.frames.pop(frame);
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setRawCapture(bool enable) {
+    _rx.rawRequest = enable ? RAW_REQUEST_ARM : RAW_REQUEST_OFF;
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::isRawCaptureReady() {
+    return _rx.rawState == RAW_READY && _rx.rawRequest == RAW_REQUEST_NONE;
+}
+
+template <typename BandTraits>
+const uint16_t* RCSwitch<BandTraits>::getRawCapture(size_t& wordCount) {
+    if (!isRawCaptureReady()) {
+        wordCount = 0;
+        return NULL;
+    }
+    wordCount = _rx.rawCount;
+    return _rx.rawWords;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::releaseRawCapture() {
+    if (_rx.rawState != RAW_OFF) {
+        _rx.rawRequest = RAW_REQUEST_ARM;
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::captureRaw(unsigned int duration) {
+    if (_rx.rawState == RAW_ARMED) {
+        // 同步间隔之后开始记录，间隔本身不记录
+        if (duration > SEPARATION_LIMIT) {
+            _rx.rawState = RAW_CAPTURING;
+            _rx.rawCount = 0;
+            _rx.rawPulses = 0;
+        }
+        return;
+    }
+
+    if (_rx.rawState != RAW_CAPTURING) {
+        return;
+    }
+
+    if (duration > RAW_END_GAP) {
+        finishRaw();
+        return;
+    }
+
+    const size_t written = RawPulse::encode(duration, &_rx.rawWords[_rx.rawCount],
+                                            RCSWITCH_RAW_CAPTURE_SIZE - _rx.rawCount);
+    if (written == 0) {
+        finishRaw();  // 缓冲区已满
+        return;
+    }
+    _rx.rawCount += written;
+    _rx.rawPulses++;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::finishRaw() {
+    if (_rx.rawPulses >= RAW_MIN_PULSES) {
+        _rx.rawState = RAW_READY;
+    } else {
+        _rx.rawState = RAW_ARMED;  // 太短，视为噪声，继续等待
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::startFrame(FrameLane& lane, unsigned int syncGap, unsigned long time) {
+    // 每帧按同步间隔缩放一次窗口，逐位比较时只做上下界比较
+    const uint64_t sync = syncGap;
+    uint16_t pending = lane.protocols;
+    while (pending) {
+        const unsigned int p = __builtin_ctz(pending);
+        pending &= pending - 1;
+        const ProtocolWindows &w = _rx.windows[p];
+        FrameBounds &b = _rx.bounds[p];
+        b.zeroHighMin = (sync * w.zeroHigh.lower) >> WINDOW_SHIFT;
+        b.zeroHighMax = (sync * w.zeroHigh.upper) >> WINDOW_SHIFT;
+        b.zeroLowMin = (sync * w.zeroLow.lower) >> WINDOW_SHIFT;
+        b.zeroLowMax = (sync * w.zeroLow.upper) >> WINDOW_SHIFT;
+        b.oneHighMin = (sync * w.oneHigh.lower) >> WINDOW_SHIFT;
+        b.oneHighMax = (sync * w.oneHigh.upper) >> WINDOW_SHIFT;
+        b.oneLowMin = (sync * w.oneLow.lower) >> WINDOW_SHIFT;
+        b.oneLowMax = (sync * w.oneLow.upper) >> WINDOW_SHIFT;
+        b.zeroHigh = (sync * w.zeroHigh.center) >> WINDOW_SHIFT;
+        b.zeroLow = (sync * w.zeroLow.center) >> WINDOW_SHIFT;
+        b.oneHigh = (sync * w.oneHigh.center) >> WINDOW_SHIFT;
+        b.oneLow = (sync * w.oneLow.center) >> WINDOW_SHIFT;
+        b.syncPulse = (sync * w.syncPulse) >> WINDOW_SHIFT;
+        unsigned int glitchUs = b.zeroHighMin < b.zeroLowMin ? b.zeroHighMin : b.zeroLowMin;
+        glitchUs = b.oneHighMin < glitchUs ? b.oneHighMin : glitchUs;
+        b.glitchUs = b.oneLowMin < glitchUs ? b.oneLowMin : glitchUs;
+        _rx.codes[p] = RFCode();
+        _rx.errors[p] = 0;
+    }
+
+    lane.prevSyncGap = lane.syncGap;
+    lane.prevProtocol = lane.protocol;
+    lane.protocol = 0;
+    lane.syncGap = syncGap;
+    lane.leadPulse = _rx.lastDuration;
+    lane.changeCount = 1;
+    lane.frameStart = time;
+    lane.frameDone = false;
+    lane.viable = lane.protocols;
+    _rx.zeroHighHit &= ~lane.protocols;
+    _rx.oneHighHit &= ~lane.protocols;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::advanceFrame(FrameLane& lane, unsigned int duration) {
+    const unsigned int index = lane.changeCount;
+    if (index >= RCSWITCH_MAX_CHANGES) {
+        return;  // 超长帧: 只解码前MAX_CHANGES个时序 (RFCode容量)
+    }
+    lane.changeCount = index + 1;
+    if (lane.viable == 0) {
+        return;  // 所有协议都已出窗，这一帧不会输出
+    }
+    lane.timings[index] = duration;
+
+    // 非反相协议: 奇数时序为位的高电平段，偶数时序为低电平段
+    // 反相协议: 第1个时序是同步尾，偶数时序为高电平段，奇数时序为低电平段
+    const uint16_t inverted = lane.protocols & _rx.invertedMask;
+    const uint16_t normal = lane.protocols & ~_rx.invertedMask;
+    uint16_t highSet;
+    uint16_t lowSet;
+    if (index & 1) {
+        highSet = normal;
+        lowSet = (index >= 3) ? inverted : 0;
+    } else {
+        highSet = inverted;
+        lowSet = normal;
+    }
+
+    uint16_t pending;
+    if (index == 1) {
+        // 反相协议的同步尾不参与判定，只计入时序误差
+        pending = inverted;
+        while (pending) {
+            const unsigned int p = __builtin_ctz(pending);
+            pending &= pending - 1;
+            _rx.errors[p] += distance(duration, _rx.bounds[p].syncPulse);
+        }
+    }
+
+    // 高电平段: 记录每个候选协议可能的位值，等低电平段到达后再判定
+    pending = highSet & lane.viable;
+    while (pending) {
+        const unsigned int p = __builtin_ctz(pending);
+        pending &= pending - 1;
+        const FrameBounds &b = _rx.bounds[p];
+        const uint16_t bit = 1U << p;
+        if (duration > b.zeroHighMin && duration < b.zeroHighMax) {
+            _rx.zeroHighHit |= bit;
+        } else {
+            _rx.zeroHighHit &= ~bit;
+        }
+        if (duration > b.oneHighMin && duration < b.oneHighMax) {
+            _rx.oneHighHit |= bit;
+        } else {
+            _rx.oneHighHit &= ~bit;
+        }
+    }
+
+    // 低电平段: 完成一位，累计高低两段的误差；不匹配的协议被剔除，
+    // 记下出窗位，之后的误差到帧结束需要比较时才从timings补算
+    const unsigned int high = _rx.lastDuration;
+    pending = lowSet & lane.viable;
+    while (pending) {
+        const unsigned int p = __builtin_ctz(pending);
+        pending &= pending - 1;
+        const FrameBounds &b = _rx.bounds[p];
+        const uint16_t bit = 1U << p;
+        if ((_rx.zeroHighHit & bit) && duration > b.zeroLowMin && duration < b.zeroLowMax) {
+            _rx.codes[p].shiftIn(false);
+            _rx.errors[p] += distance(high, b.zeroHigh) + distance(duration, b.zeroLow);
+        } else if ((_rx.oneHighHit & bit) && duration > b.oneLowMin && duration < b.oneLowMax) {
+            _rx.codes[p].shiftIn(true);
+            _rx.errors[p] += distance(high, b.oneHigh) + distance(duration, b.oneLow);
+        } else {
+            lane.viable &= ~bit;
+            _rx.rejectedAt[p] = index;
+        }
+    }
+}
+
+template <typename BandTraits>
+uint32_t RCSwitch<BandTraits>::rejectedError(const FrameLane& lane, unsigned int p, uint32_t limit) {
+    // 从出窗位起每位按较近的位值累计误差，超过limit后不必再算
+    const FrameBounds &b = _rx.bounds[p];
+    uint32_t error = _rx.errors[p];
+    for (unsigned int i = _rx.rejectedAt[p]; i < lane.changeCount && error <= limit; i += 2) {
+        const unsigned int high = lane.timings[i - 1];
+        const unsigned int low = lane.timings[i];
+        const uint32_t zeroError = distance(high, b.zeroHigh) + distance(low, b.zeroLow);
+        const uint32_t oneError = distance(high, b.oneHigh) + distance(low, b.oneLow);
+        error += zeroError < oneError ? zeroError : oneError;
+    }
+    return error;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::finishFrame(FrameLane& lane, unsigned long now, unsigned int nextSyncGap) {
+    lane.frameDone = true;
+    if (&lane == &_rx.lanes[LANE_LONG]) {
+        _rx.lastTimingsCount = lane.changeCount;  // 调试：记录时序数量
+    }
+
+    if (lane.changeCount <= 7 || lane.viable == 0) {
+        return;
+    }
+
+    // 时序数为偶数的完整帧: 正相协议的最后一个时序是同步头，计入误差
+    const bool syncHead = (lane.changeCount & 1) == 0 && lane.changeCount < RCSWITCH_MAX_CHANGES;
+
+    // 取没出过窗的协议中时序误差最小的；误差相同 (时序比例相同的协议) 时
+    // 取标称脉宽最接近的，仍相同取编号最小的，与rc-switch的检测顺序一致
+    unsigned int p = NUM_PROTOCOLS;
+    unsigned int delay = 0;
+    uint32_t bestError = 0;
+    unsigned int bestOffset = 0;
+    uint16_t pending = lane.viable;
+    while (pending) {
+        const unsigned int candidate = __builtin_ctz(pending);
+        pending &= pending - 1;
+        uint32_t error = _rx.errors[candidate];
+        if (syncHead && !(_rx.invertedMask & (1U << candidate))) {
+            error += distance(_rx.lastDuration, _rx.bounds[candidate].syncPulse);
+        }
+        const unsigned int candidateDelay =
+            ((uint64_t)lane.syncGap * _rx.windows[candidate].delayScale) >> WINDOW_SHIFT;
+        const unsigned int offset = distance(candidateDelay, PROTOCOLS[candidate].pulseLength);
+        if (p == NUM_PROTOCOLS || error < bestError || (error == bestError && offset < bestOffset)) {
+            p = candidate;
+            delay = candidateDelay;
+            bestError = error;
+            bestOffset = offset;
+        }
+    }
+
+    // 出过窗的协议误差不超过它的 1 + 1/2 时，它只是窗口更宽，无法确定是哪个协议
+    const uint32_t ambiguousError = bestError + (bestError >> AMBIGUITY_SHIFT);
+    pending = lane.protocols & ~lane.viable;
+    while (pending) {
+        const unsigned int candidate = __builtin_ctz(pending);
+        pending &= pending - 1;
+        uint32_t limit = ambiguousError;
+        if (syncHead && !(_rx.invertedMask & (1U << candidate))) {
+            const unsigned int headError = distance(_rx.lastDuration, _rx.bounds[candidate].syncPulse);
+            if (headError > limit) {
+                continue;
+            }
+            limit -= headError;
+        }
+        if (rejectedError(lane, candidate, limit) <= limit) {
+            return;
+        }
+    }
+
+    ReceivedFrame frame;
+    frame.code = _rx.codes[p];
+    frame.bitlength = (lane.changeCount - 1) / 2;
+    frame.delay = delay;
+    frame.protocol = p + 1;
+    frame.timestamp = _rx.lastEdgeTime;
+
+    // 同步间隔要有帧后 (下一帧前) 或上一帧 (同一协议) 前的同步间隔印证，
+    // 或者帧本身足以印证；否则静默超时结束时帧后的间隔还没结束，暂存到
+    // 下一个边沿，输出晚一个同步间隔
+    lane.protocol = frame.protocol;
+    if (sameSyncGap(lane.syncGap, nextSyncGap) ||
+        (lane.prevProtocol == frame.protocol && sameSyncGap(lane.syncGap, lane.prevSyncGap)) ||
+        trustedSyncGap(lane, p, bestError)) {
+        emitFrame(frame, lane.frameStart, now);
+    } else if (nextSyncGap == 0) {
+        lane.held = frame;
+        lane.holding = true;
+    }
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::trustedSyncGap(const FrameLane& lane, unsigned int p, uint32_t error) {
+    // 数据时序的总误差在帧长的1/8 (SYNC_MATCH_SHIFT) 以内: 按同步间隔缩放的
+    // 脉宽和数据一致，不是一段任意长的静默
+    if ((lane.changeCount - 1) / 2 < TRUSTED_MIN_BITS ||
+        error >= ((_rx.lastEdgeTime - lane.frameStart) >> SYNC_MATCH_SHIFT)) {
+        return false;
+    }
+    // 正相协议的帧前后都是同步头: 帧前的印证同步间隔是真的，帧尾的印证帧是完整的
+    const unsigned int head = _rx.bounds[p].syncPulse;
+    const unsigned int headTolerance = head >> SYNC_HEAD_SHIFT;
+    return !(_rx.invertedMask & (1U << p)) && (lane.changeCount & 1) == 0 &&
+           distance(lane.leadPulse, head) < headTolerance && distance(_rx.lastDuration, head) < headTolerance;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::confirmHeld(FrameLane& lane, unsigned int nextSyncGap, unsigned long now) {
+    lane.holding = false;
+    if (sameSyncGap(lane.syncGap, nextSyncGap)) {
+        emitFrame(lane.held, lane.frameStart, now);
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::emitFrame(const ReceivedFrame& frame, unsigned long start, unsigned long now) {
+    _rx.frames.push(frame);  // 队列满时丢弃并计数
+
+    const unsigned int p = frame.protocol - 1;
+    const unsigned long latency = now - start;
+    _rx.lastLatency[p] = latency;
+    if (latency > _rx.maxLatency[p]) {
+        _rx.maxLatency[p] = latency;
+    }
+}
+
+template <typename BandTraits>
+void IRAM_ATTR RCSwitch<BandTraits>::handleInterrupt() {
+    if (_rx.suspended) {
+        return;  // 本频段正在发送
+    }
+    _rx.interruptCount++;  // 调试：计数中断次数
+
+    // 中断中只记录时间戳，协议解码交给解码任务
+    const unsigned long now = micros();
+    const unsigned int glitchUs = _rx.glitchUs;
+    if (glitchUs == 0) {
+        pushEdge(now);
+        return;
+    }
+
+    // 毛刺过滤: 暂存本边沿，和上一个暂存边沿间隔太短则两个都丢弃
+    portENTER_CRITICAL_ISR(&_edgeMux);
+    if (_rx.hasPendingEdge) {
+        if (now - _rx.pendingEdge < glitchUs) {
+            _rx.hasPendingEdge = false;
+            _rx.glitchCount++;
+            portEXIT_CRITICAL_ISR(&_edgeMux);
+            return;
+        }
+        pushEdge(_rx.pendingEdge);
+    }
+    _rx.pendingEdge = now;
+    _rx.hasPendingEdge = true;
+    portEXIT_CRITICAL_ISR(&_edgeMux);
+}
+
+template <typename BandTraits>
+inline void IRAM_ATTR RCSwitch<BandTraits>::pushEdge(unsigned long time) {
+    const unsigned int head = _rx.edgeHead;
+    const unsigned int next = (head + 1) & EDGE_MASK;
+    if (next == _rx.edgeTail) {
+        _rx.edgeOverflowCount++;  // 缓冲区满，丢弃该边沿
+        return;
+    }
+
+    _rx.edgeBuffer[head] = time;
+    _rx.edgeHead = next;
+
+    const unsigned int fill = (next - _rx.edgeTail) & EDGE_MASK;
+    if (fill > _rx.edgeHighWatermark) {
+        _rx.edgeHighWatermark = fill;
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::flushPendingEdge() {
+    // 暂存的边沿已超过毛刺宽度，之后的边沿不会再和它组成毛刺
+    if (!_rx.hasPendingEdge) {
+        return;
+    }
+    portENTER_CRITICAL(&_edgeMux);
+    if (_rx.hasPendingEdge && micros() - _rx.pendingEdge >= _rx.glitchUs) {
+        pushEdge(_rx.pendingEdge);
+        _rx.hasPendingEdge = false;
+    }
+    portEXIT_CRITICAL(&_edgeMux);
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::resetFrames() {
+    for (unsigned int i = 0; i < LANE_COUNT; i++) {
+        _rx.lanes[i].syncGap = 0;
+        _rx.lanes[i].protocol = 0;
+        _rx.lanes[i].changeCount = 0;
+        _rx.lanes[i].frameDone = true;
+        _rx.lanes[i].holding = false;
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::abandonFrame() {
+    // 中断关闭期间的边沿丢失，进行中的帧和原始捕获片段都不完整
+    resetFrames();
+    if (_rx.rawState == RAW_CAPTURING) {
+        _rx.rawState = RAW_ARMED;
+    }
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::updateGate() {
+    const int pin = _rx.pin;
+    if (_rx.edgeRateLimit == 0 || pin < 0) {
+        return;
+    }
+    const unsigned long now = millis();
+
+    if (_rx.gated) {
+        if (now - _rx.gateStart < _rx.gateMs) {
+            return;
+        }
+        // 关闭时间到，重新打开中断，由下一个窗口判断风暴是否过去
+        _rx.gatedTime += now - _rx.gateStart;
+        _rx.gated = false;
+        _rx.windowStart = now;
+        _rx.windowEdges = _rx.interruptCount;
+        attachInterrupt(pin, handleInterrupt, CHANGE);
+        return;
+    }
+
+    const unsigned long elapsed = now - _rx.windowStart;
+    if (elapsed < RATE_WINDOW_MS) {
+        return;
+    }
+    const unsigned long count = _rx.interruptCount;
+    // 调试计数器被重置时从0算起
+    const unsigned long edges = count >= _rx.windowEdges ? count - _rx.windowEdges : count;
+    _rx.edgeRate = (uint64_t)edges * 1000 / elapsed;
+    _rx.windowStart = now;
+    _rx.windowEdges = count;
+
+    if (_rx.edgeRate <= _rx.edgeRateLimit) {
+        _rx.gateMs = 0;  // 风暴已过，下次从最短关闭时间开始
+        return;
+    }
+    if (_rx.frameActive) {
+        return;  // 不打断正在解码的帧，风暴持续时下一个窗口再关闭
+    }
+
+    // 超过上限: 关闭中断，连续超限时关闭时间加倍
+    if (_rx.gateMs == 0) {
+        _rx.gateMs = GATE_MIN_MS;
+    } else {
+        _rx.gateMs = (_rx.gateMs * 2 > GATE_MAX_MS) ? GATE_MAX_MS : _rx.gateMs * 2;
+    }
+    detachInterrupt(pin);
+    _rx.gated = true;
+    _rx.gateStart = now;
+    _rx.gateCount++;
+
+    portENTER_CRITICAL(&_edgeMux);
+    _rx.hasPendingEdge = false;
+    portEXIT_CRITICAL(&_edgeMux);
+    abandonFrame();
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::updateGlitchWidth() {
+    // 有进行中的帧时只看仍匹配的候选协议: 帧的窗口按同步间隔缩放过，
+    // 脉宽较长的协议可以过滤更宽的毛刺
+    unsigned int width = UINT32_MAX;
+    bool active = false;
+    for (unsigned int i = 0; i < LANE_COUNT; i++) {
+        const FrameLane &lane = _rx.lanes[i];
+        if (lane.frameDone || lane.viable == 0) {
+            continue;
+        }
+        active = true;
+        uint16_t pending = lane.viable;
+        while (pending) {
+            const unsigned int p = __builtin_ctz(pending);
+            pending &= pending - 1;
+            width = _rx.bounds[p].glitchUs < width ? _rx.bounds[p].glitchUs : width;
+        }
+    }
+    if (!active) {
+        width = _rx.idleGlitchUs;
+    }
+    _rx.frameActive = active;
+    _rx.glitchUs = _rx.glitchLimitUs < width ? _rx.glitchLimitUs : width;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::processEdges() {
+    if (_rx.resetPending) {
+        _rx.resetPending = false;
+        portENTER_CRITICAL(&_edgeMux);
+        _rx.hasPendingEdge = false;
+        portEXIT_CRITICAL(&_edgeMux);
+        _rx.edgeTail = _rx.edgeHead;
+        resetFrames();
+        _rx.lastEdgeTime = 0;
+    }
+
+    updateGate();
+    flushPendingEdge();
+
+    const uint8_t rawRequest = _rx.rawRequest;
+    if (rawRequest != RAW_REQUEST_NONE) {
+        _rx.rawState = (rawRequest == RAW_REQUEST_ARM) ? RAW_ARMED : RAW_OFF;
+        _rx.rawRequest = RAW_REQUEST_NONE;
+    }
+
+    const RCSwitchEdgeTap tap = _edgeTap;
+    unsigned int tail = _rx.edgeTail;
+    while (tail != _rx.edgeHead) {
+        const unsigned long time = _rx.edgeBuffer[tail];
+        if (tap != NULL) {
+            tap(FREQUENCY, time);
+        }
+        handleEdge(time);
+        tail = (tail + 1) & EDGE_MASK;
+        _rx.edgeTail = tail;
+    }
+
+    // 原始捕获: 线路静默足够久，结束当前片段
+    if (_rx.rawState == RAW_CAPTURING && micros() - _rx.lastEdgeTime > RAW_END_GAP) {
+        finishRaw();
+    }
+
+    // 线路静默超过分隔时间: 帧已结束，不必等同步间隔结束的边沿
+    const unsigned long now = micros();
+    if (now - _rx.lastEdgeTime > SEPARATION_LIMIT) {
+        for (unsigned int i = 0; i < LANE_COUNT; i++) {
+            if (!_rx.lanes[i].frameDone) {
+                finishFrame(_rx.lanes[i], now, 0);
+            }
+        }
+    }
+
+    updateGlitchWidth();
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::hasOutput() {
+    return !_rx.frames.empty() || isRawCaptureReady();
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setEdgeTap(RCSwitchEdgeTap tap) {
+    _edgeTap = tap;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::handleEdge(unsigned long time) {
+    const unsigned int duration = time - _rx.lastEdgeTime;
+
+    if (_rx.rawState != RAW_OFF) {
+        captureRaw(duration);
+    }
+
+    FrameLane &lane = _rx.lanes[LANE_LONG];
+    FrameLane &shortLane = _rx.lanes[LANE_SHORT];
+    if (duration > SEPARATION_LIMIT) {
+        // 长脉冲，可能是同步信号: 结束上一帧并以此为同步开始新帧
+        if (lane.holding) {
+            confirmHeld(lane, duration, time);
+        } else if (!lane.frameDone) {
+            finishFrame(lane, time, duration);
+        }
+        startFrame(lane, duration, time);
+    } else if (lane.changeCount > 0) {
+        advanceFrame(lane, duration);
+    }
+
+    if (shortLane.protocols != 0) {
+        if (duration > _rx.shortSyncMin) {
+            if (shortLane.holding) {
+                confirmHeld(shortLane, duration, time);
+            } else if (!shortLane.frameDone) {
+                finishFrame(shortLane, time, duration);
+            }
+            startFrame(shortLane, duration, time);
+        } else if (shortLane.changeCount > 0) {
+            advanceFrame(shortLane, duration);
+        }
+    }
+
+    _rx.lastEdgeTime = time;
+    _rx.lastDuration = duration;
+}
+
+// ========== 调试功能实现 ==========
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getInterruptCount() {
+    return _rx.interruptCount;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::resetInterruptCount() {
+    _rx.interruptCount = 0;
+    _rx.lastTimingsCount = 0;
+    _rx.edgeHighWatermark = 0;
+    _rx.edgeOverflowCount = 0;
+    _rx.frames.resetDropCount();
+    for (unsigned int p = 0; p < NUM_PROTOCOLS; p++) {
+        _rx.lastLatency[p] = 0;
+        _rx.maxLatency[p] = 0;
+    }
+    _rx.glitchCount = 0;
+    _rx.gatedTime = 0;
+    _rx.gateCount = 0;
+}
+
+template <typename BandTraits>
+unsigned int RCSwitch<BandTraits>::getLastTimingsCount() {
+    return _rx.lastTimingsCount;
+}
+
+template <typename BandTraits>
+unsigned int RCSwitch<BandTraits>::getEdgeBufferHighWatermark() {
+    return _rx.edgeHighWatermark;
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getEdgeOverflowCount() {
+    return _rx.edgeOverflowCount;
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getFrameDropCount() {
+    return _rx.frames.getDropCount();
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getLastDecodeLatency(unsigned int protocol) {
+    if (protocol < 1 || protocol > NUM_PROTOCOLS) return 0;
+    return _rx.lastLatency[protocol - 1];
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getMaxDecodeLatency(unsigned int protocol) {
+    if (protocol < 1 || protocol > NUM_PROTOCOLS) return 0;
+    return _rx.maxLatency[protocol - 1];
+}
+
+// ========== 噪声保护实现 ==========
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setGlitchFilter(unsigned int maxPulseUs) {
+    _rx.glitchLimitUs = maxPulseUs;
+    updateGlitchWidth();
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::setEdgeRateLimit(unsigned long edgesPerSecond) {
+    _rx.edgeRateLimit = edgesPerSecond;
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getEdgeRate() {
+    return _rx.edgeRate;
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getGlitchCount() {
+    return _rx.glitchCount;
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getGatedTime() {
+    // 正在关闭时计入到现在为止的时间
+    const bool gated = _rx.gated;
+    const unsigned long total = _rx.gatedTime;
+    return gated ? total + (millis() - _rx.gateStart) : total;
+}
+
+template <typename BandTraits>
+unsigned long RCSwitch<BandTraits>::getGateCount() {
+    return _rx.gateCount;
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::isGated() {
+    return _rx.gated;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::suspendReceive() {
+    _rx.suspended = true;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::resumeReceive() {
+    _rx.resetPending = true;  // 由解码任务丢弃发送前后残留的边沿
+    _rx.suspended = false;
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::isReceiveSuspended() {
+    return _rx.suspended;
+}
+
+// ========== 发送功能实现 ==========
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::enableTransmit(int pin) {
+    this->nTransmitterPin = pin;
+    pinMode(this->nTransmitterPin, OUTPUT);
+    digitalWrite(this->nTransmitterPin, LOW);
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::disableTransmit() {
+    this->nTransmitterPin = -1;
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::transmit(HighLow pulses) {
+    uint8_t firstLogicLevel = (this->protocol.invertedSignal) ? LOW : HIGH;
+    uint8_t secondLogicLevel = (this->protocol.invertedSignal) ? HIGH : LOW;
+
+    digitalWrite(this->nTransmitterPin, firstLogicLevel);
+    delayMicroseconds(this->protocol.pulseLength * pulses.high);
+    digitalWrite(this->nTransmitterPin, secondLogicLevel);
+    delayMicroseconds(this->protocol.pulseLength * pulses.low);
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::send(const RFCode& code, unsigned int length) {
+    if (this->nTransmitterPin == -1) return;
+
+    // 禁用接收中断，避免干扰
+    int savedInterrupt = this->nReceiverInterrupt;
+    if (savedInterrupt != -1) {
+        this->disableReceive();
+    }
+
+    for (int nRepeat = 0; nRepeat < nRepeatTransmit; nRepeat++) {
+        // 发送数据位
+        for (int i = length - 1; i >= 0; i--) {
+            if (code.bit(i)) {
+                this->transmit(protocol.one);
+            } else {
+                this->transmit(protocol.zero);
+            }
+        }
+        // 发送同步位
+        this->transmit(protocol.syncFactor);
+    }
+
+    // 确保发送结束后为低电平
+    digitalWrite(this->nTransmitterPin, LOW);
+
+    // 恢复接收中断
+    if (savedInterrupt != -1) {
+        this->enableReceive(savedInterrupt);
+    }
+}
+
+template <typename BandTraits>
+bool RCSwitch<BandTraits>::compile(const RFCode& code, unsigned int length, PulseProgram& program) const {
+    // 与transmit()相同的电平和时长，只是记录下来而不是立即输出
+    const uint8_t firstLogicLevel = (this->protocol.invertedSignal) ? LOW : HIGH;
+    const uint8_t secondLogicLevel = (this->protocol.invertedSignal) ? HIGH : LOW;
+    const uint32_t pulseLength = this->protocol.pulseLength;
+
+    program.clear();
+    for (int nRepeat = 0; nRepeat < nRepeatTransmit; nRepeat++) {
+        for (int i = length - 1; i >= 0; i--) {
+            const HighLow &pulses = code.bit(i) ? protocol.one : protocol.zero;
+            program.append(firstLogicLevel, pulseLength * pulses.high);
+            program.append(secondLogicLevel, pulseLength * pulses.low);
+        }
+        program.append(firstLogicLevel, pulseLength * protocol.syncFactor.high);
+        program.append(secondLogicLevel, pulseLength * protocol.syncFactor.low);
+    }
+    return program.finish(LOW);
+}
+
+template <typename BandTraits>
+void RCSwitch<BandTraits>::sendRaw(const uint16_t* words, size_t wordCount) {
+    if (this->nTransmitterPin == -1) return;
+
+    // 禁用接收中断，避免干扰
+    int savedInterrupt = this->nReceiverInterrupt;
+    if (savedInterrupt != -1) {
+        this->disableReceive();
+    }
+
+    // 按原时序重放: 第一个脉冲为高电平，之后交替
+    size_t pos = 0;
+    uint32_t duration;
+    uint8_t level = HIGH;
+    while (RawPulse::decode(words, wordCount, pos, duration)) {
+        digitalWrite(this->nTransmitterPin, level);
+        delayMicroseconds(duration);
+        level = (level == HIGH) ? LOW : HIGH;
+    }
+
+    // 确保发送结束后为低电平
+    digitalWrite(this->nTransmitterPin, LOW);
+
+    // 恢复接收中断
+    if (savedInterrupt != -1) {
+        this->enableReceive(savedInterrupt);
+    }
+}
+
+#endif
@@ -0,0 +1,220 @@
+/**
+ * @file RFCode.h
+ * @brief 任意长度RF编码值 (内联位向量)
+ *
+ * 64位以内的编码只用低位字，等同于uint64_t；更长的帧 (最多MAX_BITS位)
+ * 继续使用后续的字，不分配堆内存。位长度由调用方单独保存，
+ * 与原先 code + bits 的用法一致。
+ */
+
+#ifndef RF_CODE_H
+#define RF_CODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 编码最大位数 (64的整数倍)
+#define RFCODE_MAX_BITS 128
+
+class RFCode {
+public:
+    static const unsigned int WORDS = RFCODE_MAX_BITS / 64;
+    static const unsigned int MAX_BITS = RFCODE_MAX_BITS;
+    static const size_t DECIMAL_SIZE = 40;     // 十进制字符串缓冲区大小 (2^128-1为39位)
+    static const size_t HEX_SIZE = MAX_BITS / 4 + 3;  // 十六进制字符串缓冲区大小 (含0x)
+
+    static_assert(WORDS >= 2, "RFCODE_MAX_BITS至少为128");
+
+    // constexpr构造: 作为静态接收状态的成员时保持静态初始化
+    constexpr RFCode() : _words() {}
+
+    constexpr RFCode(uint64_t value) : _words{value} {}
+
+    /**
+     * 由低64位和高64位构造 (用于存储格式)
+     */
+    constexpr RFCode(uint64_t low, uint64_t high) : _words{low, high} {}
+
+    /**
+     * 左移一位并在最低位移入新位 (解码时逐位调用)
+     */
+    void shiftIn(bool bit) {
+        for (unsigned int i = WORDS - 1; i > 0; i--) {
+            _words[i] = (_words[i] << 1) | (_words[i - 1] >> 63);
+        }
+        _words[0] = (_words[0] << 1) | (bit ? 1 : 0);
+    }
+
+    /**
+     * 读取第index位 (0=最低位)
+     */
+    bool bit(unsigned int index) const {
+        if (index >= MAX_BITS) return false;
+        return (_words[index / 64] >> (index % 64)) & 1;
+    }
+
+    uint64_t low64() const { return _words[0]; }
+    uint64_t high64() const { return _words[1]; }
+
+    /**
+     * 是否超出64位 (需要额外的存储字段)
+     */
+    bool isWide() const {
+        for (unsigned int i = 1; i < WORDS; i++) {
+            if (_words[i]) return true;
+        }
+        return false;
+    }
+
+    bool isZero() const {
+        return _words[0] == 0 && !isWide();
+    }
+
+    /**
+     * 低bits位是否全为1且没有更高位 (噪声特征)
+     */
+    bool isAllOnes(unsigned int bits) const {
+        if (bits == 0 || bits > MAX_BITS) return false;
+        for (unsigned int i = 0; i < WORDS; i++) {
+            const unsigned int start = i * 64;
+            uint64_t expect;
+            if (bits >= start + 64) {
+                expect = ~0ULL;
+            } else if (bits > start) {
+                expect = (1ULL << (bits - start)) - 1;
+            } else {
+                expect = 0;
+            }
+            if (_words[i] != expect) return false;
+        }
+        return true;
+    }
+
+    bool operator==(const RFCode& other) const {
+        for (unsigned int i = 0; i < WORDS; i++) {
+            if (_words[i] != other._words[i]) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const RFCode& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * 转为十进制字符串
+     * @param out 输出缓冲区 (建议DECIMAL_SIZE)
+     * @param size 缓冲区大小
+     * @param minDigits 最少位数，不足时补前导零
+     * @return 数字位数
+     */
+    size_t toDecimal(char* out, size_t size, size_t minDigits = 1) const {
+        char digits[DECIMAL_SIZE];
+        size_t count = 0;
+        RFCode value = *this;
+        do {
+            digits[count++] = '0' + value.divideBy10();
+        } while (!value.isZero() && count < DECIMAL_SIZE);
+        while (count < minDigits && count < DECIMAL_SIZE - 1) {
+            digits[count++] = '0';
+        }
+
+        if (size == 0) return count;
+        size_t n = 0;
+        while (count > 0 && n < size - 1) {
+            out[n++] = digits[--count];
+        }
+        out[n] = '\0';
+        return n;
+    }
+
+    /**
+     * 转为十六进制字符串 (带0x前缀，大写)
+     */
+    void toHex(char* out, size_t size) const {
+        static const char HEX_DIGITS[] = "0123456789ABCDEF";
+        char digits[MAX_BITS / 4];
+        size_t count = 0;
+        unsigned int index = 0;
+        do {
+            digits[count++] = HEX_DIGITS[nibble(index++)];
+        } while (index < MAX_BITS / 4 && !shiftedIsZero(index * 4));
+
+        if (size == 0) return;
+        size_t n = 0;
+        const char* prefix = "0x";
+        while (*prefix && n < size - 1) {
+            out[n++] = *prefix++;
+        }
+        while (count > 0 && n < size - 1) {
+            out[n++] = digits[--count];
+        }
+        out[n] = '\0';
+    }
+
+    /**
+     * 解析十进制字符串 (遇到非数字字符停止，超出MAX_BITS的部分截断)
+     */
+    static RFCode fromDecimal(const char* text) {
+        RFCode value;
+        while (*text >= '0' && *text <= '9') {
+            value.multiplyAdd(10, *text - '0');
+            text++;
+        }
+        return value;
+    }
+
+private:
+    uint64_t _words[WORDS];
+
+    /**
+     * 除以10，返回余数
+     */
+    unsigned int divideBy10() {
+        uint64_t remainder = 0;
+        for (int i = WORDS - 1; i >= 0; i--) {
+            // 按32位分段做长除法，避免依赖128位整数
+            uint64_t hi = (remainder << 32) | (_words[i] >> 32);
+            const uint64_t qHi = hi / 10;
+            remainder = hi % 10;
+            uint64_t lo = (remainder << 32) | (_words[i] & 0xFFFFFFFFULL);
+            const uint64_t qLo = lo / 10;
+            remainder = lo % 10;
+            _words[i] = (qHi << 32) | qLo;
+        }
+        return (unsigned int)remainder;
+    }
+
+    /**
+     * value = value * factor + addend
+     */
+    void multiplyAdd(uint32_t factor, uint32_t addend) {
+        uint64_t carry = addend;
+        for (unsigned int i = 0; i < WORDS; i++) {
+            const uint64_t lo = (_words[i] & 0xFFFFFFFFULL) * factor + carry;
+            const uint64_t hi = (_words[i] >> 32) * factor + (lo >> 32);
+            _words[i] = (hi << 32) | (lo & 0xFFFFFFFFULL);
+            carry = hi >> 32;
+        }
+    }
+
+    unsigned int nibble(unsigned int index) const {
+        return (_words[index / 16] >> ((index % 16) * 4)) & 0xF;
+    }
+
+    /**
+     * 第shift位及以上是否全为0
+     */
+    bool shiftedIsZero(unsigned int shift) const {
+        for (unsigned int i = shift / 64; i < WORDS; i++) {
+            uint64_t word = _words[i];
+            if (i == shift / 64 && shift % 64) {
+                word >>= shift % 64;
+            }
+            if (word) return false;
+        }
+        return true;
+    }
+};
+
+#endif // RF_CODE_H
@@ -2,12 +2,15 @@
  * @file RFReceiver.cpp
  * @brief RF信号接收模块实现 - 同时监听433/315MHz
  *
- * 使用两个独立的库：
+ * 使用RCSwitch引擎的两个频段实例：
  * - RCSwitch433: 433MHz (中断方式，本地库)
  * - RCSwitch315: 315MHz (中断方式，本地库)
+ *
+ * 中断只记录边沿时间戳，协议解码在独立的解码任务中完成
  */
 
 #include "RFReceiver.h"
+#include "AppEvents.h"
 #include <esp32-hal-log.h>
 
 static const char* TAG = "RFReceiver";
@@ -25,14 +28,18 @@ static const char* PROTOCOL_NAMES[] = {
 };
 static const int PROTOCOL_COUNT = sizeof(PROTOCOL_NAMES) / sizeof(PROTOCOL_NAMES[0]);
 
+const RFReceiver::SignalFilter RFReceiver::DEFAULT_FILTER = { MIN_VALID_BITS, true, true };
+
 RFReceiver::RFReceiver()
-    : _hasNewSignal(false)
+    : _lastSignal()
+    , _hasNewSignal(false)
     , _scanning(false)
-    , _lastReceivedCode(0)
+    , _rawCapture(false)
+    , _lastReceivedCode()
     , _lastReceivedTime(0)
     , _lastValidSignalTime(0)
+    , _decodeTaskHandle(NULL)
 {
-    memset(&_lastSignal, 0, sizeof(_lastSignal));
 }
 
 void RFReceiver::begin() {
@@ -45,9 +52,28 @@ void RFReceiver::begin() {
     pinMode(RF_315_RX_PIN, INPUT);
 
     // 设置接收容差 (默认60%, 提高到80%增加兼容性)
-    _rcSwitch433.setReceiveTolerance(80);
-    _rcSwitch315.setReceiveTolerance(80);
-    ESP_LOGI(TAG, "接收容差设置为 80%%");
+    _rcSwitch433.setReceiveTolerance(RECEIVE_TOLERANCE);
+    _rcSwitch315.setReceiveTolerance(RECEIVE_TOLERANCE);
+    ESP_LOGI(TAG, "接收容差设置为 %d%%", RECEIVE_TOLERANCE);
+
+    // 噪声保护: 毛刺过滤和边沿风暴保护
+    RCSwitch433::setGlitchFilter(GLITCH_FILTER_US);
+    RCSwitch315::setGlitchFilter(GLITCH_FILTER_US);
+    RCSwitch433::setEdgeRateLimit(EDGE_RATE_LIMIT);
+    RCSwitch315::setEdgeRateLimit(EDGE_RATE_LIMIT);
+    ESP_LOGI(TAG, "毛刺过滤最多 %uus, 边沿速率上限 %lu/s", GLITCH_FILTER_US, (unsigned long)EDGE_RATE_LIMIT);
+
+    // 创建解码任务 (优先级5, 低于按键任务)
+    if (_decodeTaskHandle == NULL) {
+        xTaskCreate(
+            decodeTask,               // 任务函数
+            "RFDecode",               // 任务名称
+            2048,                     // 堆栈大小
+            this,                     // 参数
+            5,                        // 优先级
+            &_decodeTaskHandle        // 任务句柄
+        );
+    }
 
     ESP_LOGI(TAG, "RF接收模块初始化完成 (双频同时监听)");
 }
@@ -62,6 +88,10 @@ void RFReceiver::startScanning() {
     _rcSwitch433.enableReceive(digitalPinToInterrupt(RF_433_RX_PIN));
     _rcSwitch315.enableReceive(digitalPinToInterrupt(RF_315_RX_PIN));
 
+    if (_decodeTaskHandle != NULL) {
+        xTaskNotifyGive(_decodeTaskHandle);
+    }
+
     ESP_LOGI(TAG, "双频接收已启用");
 }
 
@@ -71,44 +101,122 @@ void RFReceiver::stopScanning() {
     ESP_LOGI(TAG, "停止扫描");
     _scanning = false;
 
+    if (_rawCapture) {
+        setRawCapture(false);
+    }
+
     // 禁用两个接收器
     _rcSwitch433.disableReceive();
     _rcSwitch315.disableReceive();
+
+    ESP_LOGD(TAG, "边沿缓冲区 433MHz: 最高水位:%u 溢出:%lu | 315MHz: 最高水位:%u 溢出:%lu",
+             get433EdgeHighWatermark(), get433EdgeOverflowCount(),
+             get315EdgeHighWatermark(), get315EdgeOverflowCount());
+    ESP_LOGD(TAG, "帧队列丢弃 433MHz:%lu 315MHz:%lu",
+             get433FrameDropCount(), get315FrameDropCount());
+    ESP_LOGD(TAG, "噪声保护 433MHz: 毛刺:%lu 关闭:%lums/%lu次 | 315MHz: 毛刺:%lu 关闭:%lums/%lu次",
+             RCSwitch433::getGlitchCount(), RCSwitch433::getGatedTime(), RCSwitch433::getGateCount(),
+             RCSwitch315::getGlitchCount(), RCSwitch315::getGatedTime(), RCSwitch315::getGateCount());
+    for (unsigned int p = 1; p <= 12; p++) {
+        if (getMaxDecodeLatency(433, p) || getMaxDecodeLatency(315, p)) {
+            ESP_LOGD(TAG, "协议%u解码延迟 433MHz: %lu/%luus | 315MHz: %lu/%luus (最近/最大)", p,
+                     getLastDecodeLatency(433, p), getMaxDecodeLatency(433, p),
+                     getLastDecodeLatency(315, p), getMaxDecodeLatency(315, p));
+        }
+    }
+}
+
+void RFReceiver::decodeTask(void* parameter) {
+    RFReceiver* self = static_cast<RFReceiver*>(parameter);
+
+    while (true) {
+        // 不扫描时没有边沿要处理，等startScanning()通知
+        if (!self->_scanning) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        RCSwitch433::processEdges();
+        RCSwitch315::processEdges();
+
+        // 主循环醒来后会把帧队列取空、把原始捕获取走
+        if (RCSwitch433::hasOutput() || RCSwitch315::hasOutput()) {
+            AppEvents::post(AppEvents::RF);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(DECODE_INTERVAL_MS));
+    }
 }
 
 void RFReceiver::update() {
     if (!_scanning) return;
 
-    // 检查433MHz
-    check433();
+    // 批量取出两个频段队列中的所有帧 (原始捕获模式下直接丢弃)
+    RCSwitchFrame frame;
+    while (_rcSwitch433.readFrame(frame)) {
+        if (!_rawCapture) handleFrame(frame, RCSwitch433::FREQUENCY);
+    }
+    while (_rcSwitch315.readFrame(frame)) {
+        if (!_rawCapture) handleFrame(frame, RCSwitch315::FREQUENCY);
+    }
+}
+
+void RFReceiver::setRawCapture(bool enable) {
+    _rawCapture = enable;
+    RCSwitch433::setRawCapture(enable);
+    RCSwitch315::setRawCapture(enable);
+    ESP_LOGI(TAG, "原始捕获模式: %s", enable ? "开启" : "关闭");
+}
+
+const uint16_t* RFReceiver::getRawCapture(size_t& wordCount, unsigned int& freq) {
+    wordCount = 0;
+    if (!_rawCapture) return NULL;
 
-    // 检查315MHz
-    check315();
+    const uint16_t* words = RCSwitch433::getRawCapture(wordCount);
+    if (words) {
+        freq = RCSwitch433::FREQUENCY;
+        return words;
+    }
+    words = RCSwitch315::getRawCapture(wordCount);
+    if (words) {
+        freq = RCSwitch315::FREQUENCY;
+        return words;
+    }
+    return NULL;
+}
+
+void RFReceiver::releaseRawCapture() {
+    RCSwitch433::releaseRawCapture();
+    RCSwitch315::releaseRawCapture();
 }
 
-bool RFReceiver::isValidSignal(unsigned long code, unsigned int bits) {
+void RFReceiver::setEdgeTap(RCSwitchEdgeTap tap) {
+    RCSwitch433::setEdgeTap(tap);
+    RCSwitch315::setEdgeTap(tap);
+}
+
+bool RFReceiver::isValidSignal(const RFCode& code, unsigned int bits, const SignalFilter& filter) {
     // 1. 过滤短位数信号
-    if (bits < MIN_VALID_BITS) {
+    if (bits < filter.minBits) {
         return false;
     }
 
     // 2. 过滤 2^n-1 位的信号 (通常是噪声: 3,7,15,31位)
     // 检查 bits+1 是否为2的幂
     unsigned int bitsPlus1 = bits + 1;
-    if ((bitsPlus1 & (bitsPlus1 - 1)) == 0) {
+    if (filter.rejectMaskBits && (bitsPlus1 & (bitsPlus1 - 1)) == 0) {
         return false;
     }
 
     // 3. 过滤全1的编码 (噪声特征)
-    unsigned long maxCode = (1UL << bits) - 1;
-    if (code == maxCode) {
+    if (filter.rejectAllOnes && code.isAllOnes(bits)) {
         return false;
     }
 
     return true;
 }
 
-bool RFReceiver::isDuplicateSignal(unsigned long code) {
+bool RFReceiver::isDuplicateSignal(const RFCode& code) {
     unsigned long now = millis();
     // 在去重窗口内收到相同编码，视为重复
     if (code == _lastReceivedCode && (now - _lastReceivedTime) < DUPLICATE_WINDOW_MS) {
@@ -128,103 +236,51 @@ bool RFReceiver::isInCooldown() {
     return false;
 }
 
-void RFReceiver::check433() {
-    if (_rcSwitch433.available()) {
-        unsigned long code = _rcSwitch433.getReceivedValue();
-        unsigned int bits = _rcSwitch433.getReceivedBitlength();
-
-        // 冷却期内忽略所有信号
-        if (isInCooldown()) {
-            _rcSwitch433.resetAvailable();
-            return;
-        }
-
-        if (code != 0) {
-            // 过滤无效信号
-            if (!isValidSignal(code, bits)) {
-                ESP_LOGD(TAG, "433MHz忽略无效信号: 编码:%lu 位数:%d", code, bits);
-                _rcSwitch433.resetAvailable();
-                return;
-            }
-
-            // 过滤重复信号 (防止433/315混淆)
-            if (isDuplicateSignal(code)) {
-                ESP_LOGD(TAG, "433MHz忽略重复信号: 编码:%lu", code);
-                _rcSwitch433.resetAvailable();
-                return;
-            }
-
-            _lastSignal.code = code;
-            _lastSignal.protocol = _rcSwitch433.getReceivedProtocol();
-            _lastSignal.bits = bits;
-            _lastSignal.freq = 433;
-            _lastSignal.pulseLength = _rcSwitch433.getReceivedDelay();
-            _lastSignal.timestamp = millis();
-            _hasNewSignal = true;
-            _lastValidSignalTime = millis();  // 更新冷却时间
-
-            ESP_LOGI(TAG, "收到433MHz信号! 编码:%lu 协议:%d 位数:%d 脉宽:%dus",
-                     _lastSignal.code,
-                     _lastSignal.protocol,
-                     _lastSignal.bits,
-                     _lastSignal.pulseLength);
-        }
-
-        _rcSwitch433.resetAvailable();
+void RFReceiver::handleFrame(const RCSwitchFrame& frame, unsigned int freq) {
+    // 冷却期内忽略所有信号
+    if (isInCooldown()) {
+        return;
     }
-}
 
-void RFReceiver::check315() {
-    if (_rcSwitch315.available()) {
-        unsigned long code = _rcSwitch315.getReceivedValue();
-        unsigned int bits = _rcSwitch315.getReceivedBitlength();
+    if (frame.code.isZero()) {
+        return;
+    }
 
-        // 冷却期内忽略所有信号
-        if (isInCooldown()) {
-            _rcSwitch315.resetAvailable();
-            return;
-        }
+    char codeText[RFCode::DECIMAL_SIZE];
+    frame.code.toDecimal(codeText, sizeof(codeText));
 
-        if (code != 0) {
-            // 过滤无效信号
-            if (!isValidSignal(code, bits)) {
-                ESP_LOGD(TAG, "315MHz忽略无效信号: 编码:%lu 位数:%d", code, bits);
-                _rcSwitch315.resetAvailable();
-                return;
-            }
-
-            // 过滤重复信号 (防止433/315混淆)
-            if (isDuplicateSignal(code)) {
-                ESP_LOGD(TAG, "315MHz忽略重复信号: 编码:%lu", code);
-                _rcSwitch315.resetAvailable();
-                return;
-            }
-
-            _lastSignal.code = code;
-            _lastSignal.protocol = _rcSwitch315.getReceivedProtocol();
-            _lastSignal.bits = bits;
-            _lastSignal.freq = 315;
-            _lastSignal.pulseLength = _rcSwitch315.getReceivedDelay();
-            _lastSignal.timestamp = millis();
-            _hasNewSignal = true;
-            _lastValidSignalTime = millis();  // 更新冷却时间
-
-            ESP_LOGI(TAG, "收到315MHz信号! 编码:%lu 协议:%d 位数:%d 脉宽:%dus",
-                     _lastSignal.code,
-                     _lastSignal.protocol,
-                     _lastSignal.bits,
-                     _lastSignal.pulseLength);
-        }
+    // 过滤无效信号
+    if (!isValidSignal(frame.code, frame.bitlength)) {
+        ESP_LOGD(TAG, "%dMHz忽略无效信号: 编码:%s 位数:%d", freq, codeText, frame.bitlength);
+        return;
+    }
 
-        _rcSwitch315.resetAvailable();
+    // 过滤重复信号 (防止433/315混淆)
+    if (isDuplicateSignal(frame.code)) {
+        ESP_LOGD(TAG, "%dMHz忽略重复信号: 编码:%s", freq, codeText);
+        return;
     }
+
+    _lastSignal = SignalRecord();
+    _lastSignal.code = frame.code;
+    _lastSignal.setFreq(freq);
+    _lastSignal.set(frame.protocol, frame.bitlength, frame.delay);
+    _hasNewSignal = true;
+    _lastValidSignalTime = millis();  // 更新冷却时间
+
+    ESP_LOGI(TAG, "收到%dMHz信号! 编码:%s 协议:%d 位数:%d 脉宽:%dus",
+             freq,
+             codeText,
+             (int)_lastSignal.protocol,
+             (int)_lastSignal.bits,
+             (int)_lastSignal.pulseLength);
 }
 
 bool RFReceiver::hasNewSignal() {
     return _hasNewSignal;
 }
 
-RFReceiver::Signal RFReceiver::getLastSignal() {
+SignalRecord RFReceiver::getLastSignal() {
     _hasNewSignal = false;
     return _lastSignal;
 }
@@ -259,3 +315,59 @@ unsigned int RFReceiver::get433TimingsCount() {
 unsigned int RFReceiver::get315TimingsCount() {
     return RCSwitch315::getLastTimingsCount();
 }
+
+unsigned int RFReceiver::get433EdgeHighWatermark() {
+    return RCSwitch433::getEdgeBufferHighWatermark();
+}
+
+unsigned int RFReceiver::get315EdgeHighWatermark() {
+    return RCSwitch315::getEdgeBufferHighWatermark();
+}
+
+unsigned long RFReceiver::get433EdgeOverflowCount() {
+    return RCSwitch433::getEdgeOverflowCount();
+}
+
+unsigned long RFReceiver::get315EdgeOverflowCount() {
+    return RCSwitch315::getEdgeOverflowCount();
+}
+
+unsigned long RFReceiver::get433FrameDropCount() {
+    return RCSwitch433::getFrameDropCount();
+}
+
+unsigned long RFReceiver::get315FrameDropCount() {
+    return RCSwitch315::getFrameDropCount();
+}
+
+unsigned long RFReceiver::getLastDecodeLatency(unsigned int freq, unsigned int protocol) {
+    if (freq == RCSwitch433::FREQUENCY) return RCSwitch433::getLastDecodeLatency(protocol);
+    if (freq == RCSwitch315::FREQUENCY) return RCSwitch315::getLastDecodeLatency(protocol);
+    return 0;
+}
+
+unsigned long RFReceiver::getMaxDecodeLatency(unsigned int freq, unsigned int protocol) {
+    if (freq == RCSwitch433::FREQUENCY) return RCSwitch433::getMaxDecodeLatency(protocol);
+    if (freq == RCSwitch315::FREQUENCY) return RCSwitch315::getMaxDecodeLatency(protocol);
+    return 0;
+}
+
+bool RFReceiver::getNoiseStats(unsigned int freq, NoiseStats& stats) {
+    if (freq == RCSwitch433::FREQUENCY) {
+        stats.edgeRate = RCSwitch433::getEdgeRate();
+        stats.glitches = RCSwitch433::getGlitchCount();
+        stats.gatedMs = RCSwitch433::getGatedTime();
+        stats.gateCount = RCSwitch433::getGateCount();
+        stats.gated = RCSwitch433::isGated();
+        return true;
+    }
+    if (freq == RCSwitch315::FREQUENCY) {
+        stats.edgeRate = RCSwitch315::getEdgeRate();
+        stats.glitches = RCSwitch315::getGlitchCount();
+        stats.gatedMs = RCSwitch315::getGatedTime();
+        stats.gateCount = RCSwitch315::getGateCount();
+        stats.gated = RCSwitch315::isGated();
+        return true;
+    }
+    return false;
+}
@@ -2,17 +2,19 @@
  * @file RFReceiver.h
  * @brief RF信号接收模块，支持433/315MHz同时监听
  *
- * 使用两个独立的库同时监听：
+ * 使用RCSwitch引擎的两个频段实例同时监听：
  * - RCSwitch433: 监听433MHz (RF_433_RX_PIN) - 本地库，支持调试
  * - RCSwitch315: 监听315MHz (RF_315_RX_PIN) - 本地库，支持调试
+ *
+ * 解码任务只在扫描期间运行，解码出帧时通知主循环 (AppEvents::RF)。
  */
 
 #ifndef RF_RECEIVER_H
 #define RF_RECEIVER_H
 
 #include <Arduino.h>
-#include "RCSwitch433.h"
-#include "RCSwitch315.h"
+#include "RCSwitch.h"
+#include "SignalRecord.h"
 #include "pin_config.h"
 
 class RFReceiver {
@@ -20,21 +22,44 @@ public:
     // 最小有效位数 (低于此值视为干扰信号，常见遥控器为24位)
     static const unsigned int MIN_VALID_BITS = 20;
 
+    // 接收容差 (%, RCSwitch默认60%)
+    static const int RECEIVE_TOLERANCE = 80;
+
+    // 毛刺过滤宽度上限 (us) - 实际宽度按协议取最短时序接收窗口的下沿，
+    // 容差80%时协议7 (150us) 为30us，见 rf-remote roc
+    static const unsigned int GLITCH_FILTER_US = 50;
+
+    // 边沿速率上限 (每秒) - 超过时暂时关闭该频段中断 (遥控器信号约2000-7000)。
+    // 平均脉宽25us，比任何协议最短时序的接收窗口都短；storm.rft的底噪约每秒2.5万个边沿
+    static const unsigned long EDGE_RATE_LIMIT = 40000;
+
+    // 单个频段的接收噪声统计
+    struct NoiseStats {
+        unsigned long edgeRate;     // 边沿速率 (每秒)
+        unsigned long glitches;     // 丢弃的毛刺数
+        unsigned long gatedMs;      // 中断累计关闭时间
+        unsigned long gateCount;    // 中断关闭次数
+        bool gated;                 // 当前是否关闭
+    };
+
+    // 干扰过滤设置 (见isValidSignal())
+    struct SignalFilter {
+        unsigned int minBits;       // 最小有效位数
+        bool rejectMaskBits;        // 过滤 2^n-1 位的信号
+        bool rejectAllOnes;         // 过滤全1的编码
+    };
+
+    // 固件使用的过滤设置
+    static const SignalFilter DEFAULT_FILTER;
+
     // 去重窗口时间 (ms) - 防止同一信号在两个频率上重复识别
     static const unsigned long DUPLICATE_WINDOW_MS = 100;
 
     // 接收冷却时间 (ms) - 收到有效信号后，忽略所有信号的时间
     static const unsigned long RECEIVE_COOLDOWN_MS = 500;
 
-    // 接收到的信号结构
-    struct Signal {
-        unsigned long code;     // 编码值
-        unsigned int protocol;  // 协议类型 (1=PT2262等)
-        unsigned int bits;      // 位长度
-        unsigned int freq;      // 频率 (433/315)
-        unsigned int pulseLength; // 脉宽 (微秒)
-        unsigned long timestamp;// 接收时间戳
-    };
+    // 解码任务轮询间隔 (ms) - 边沿缓冲区256项，足以覆盖该间隔内的边沿
+    static const unsigned long DECODE_INTERVAL_MS = 1;
 
     RFReceiver();
 
@@ -56,7 +81,7 @@ public:
     /**
      * 获取最后接收的信号，并清除新信号标志
      */
-    Signal getLastSignal();
+    SignalRecord getLastSignal();
 
     /**
      * 获取协议名称
@@ -65,6 +90,16 @@ public:
      */
     static const char* getProtocolName(unsigned int protocol);
 
+    /**
+     * 验证信号是否有效 (过滤干扰)
+     * @param code 编码值
+     * @param bits 位数
+     * @param filter 过滤设置 (主机模拟用其他设置评估误报和漏报)
+     * @return true=有效信号, false=干扰信号
+     */
+    static bool isValidSignal(const RFCode& code, unsigned int bits,
+                              const SignalFilter& filter = DEFAULT_FILTER);
+
     /**
      * 是否正在扫描
      */
@@ -80,6 +115,36 @@ public:
      */
     void stopScanning();
 
+    // ========== 原始捕获 ==========
+    /**
+     * 启用/关闭原始捕获模式 (两个频段同时等待，启用期间不输出解码信号)
+     */
+    void setRawCapture(bool enable);
+
+    /**
+     * 是否处于原始捕获模式
+     */
+    bool isRawCapture() { return _rawCapture; }
+
+    /**
+     * 获取已捕获的原始脉冲 (先完成的频段)
+     * @param wordCount 输出字数 (RawPulse编码)
+     * @param freq 输出频率 (433/315)
+     * @return 数据指针 (releaseRawCapture()前有效), NULL=尚未捕获到
+     */
+    const uint16_t* getRawCapture(size_t& wordCount, unsigned int& freq);
+
+    /**
+     * 释放已捕获数据，继续等待下一段
+     */
+    void releaseRawCapture();
+
+    // ========== 边沿轨迹 ==========
+    /**
+     * 设置两个频段的边沿监听回调 (NULL=关闭)，扫描期间由解码任务调用
+     */
+    void setEdgeTap(RCSwitchEdgeTap tap);
+
     // ========== 调试功能 ==========
     /**
      * 获取433MHz中断计数 (用于诊断接收问题)
@@ -106,51 +171,82 @@ public:
      */
     unsigned int get315TimingsCount();
 
+    /**
+     * 获取边沿缓冲区最高水位 (433/315MHz)
+     */
+    unsigned int get433EdgeHighWatermark();
+    unsigned int get315EdgeHighWatermark();
+
+    /**
+     * 获取边沿缓冲区溢出次数 (433/315MHz)
+     */
+    unsigned long get433EdgeOverflowCount();
+    unsigned long get315EdgeOverflowCount();
+
+    /**
+     * 获取帧队列满而丢弃的帧数 (433/315MHz)
+     */
+    unsigned long get433FrameDropCount();
+    unsigned long get315FrameDropCount();
+
+    /**
+     * 获取协议解码延迟 (帧首个边沿到输出的时间, 微秒)
+     * @param freq 频率 (433/315)
+     * @param protocol 协议编号 (1-12)
+     */
+    unsigned long getLastDecodeLatency(unsigned int freq, unsigned int protocol);
+    unsigned long getMaxDecodeLatency(unsigned int freq, unsigned int protocol);
+
+    /**
+     * 获取频段的接收噪声统计 (resetDebugCounters()清零)
+     * @param freq 频率 (433/315)
+     * @return false=没有该频段
+     */
+    bool getNoiseStats(unsigned int freq, NoiseStats& stats);
+
 private:
     RCSwitch433 _rcSwitch433;   // 433MHz接收 (本地库)
     RCSwitch315 _rcSwitch315;   // 315MHz接收 (本地库)
 
-    Signal _lastSignal;
+    SignalRecord _lastSignal;
     bool _hasNewSignal;
-    bool _scanning;
+    volatile bool _scanning;    // 解码任务也读
+    bool _rawCapture;
 
     // 去重用变量
-    unsigned long _lastReceivedCode;    // 上次接收的编码
+    RFCode _lastReceivedCode;           // 上次接收的编码
     unsigned long _lastReceivedTime;    // 上次接收的时间
 
     // 冷却时间变量
     unsigned long _lastValidSignalTime; // 上次收到有效信号的时间
 
-    /**
-     * 检查是否在冷却期内
-     * @return true=冷却中, false=可以接收
-     */
-    bool isInCooldown();
+    // 解码任务句柄
+    TaskHandle_t _decodeTaskHandle;
 
     /**
-     * 检查433MHz是否有信号
+     * 解码任务: 取出两个频段的边沿缓冲区并进行协议解码
      */
-    void check433();
+    static void decodeTask(void* parameter);
 
     /**
-     * 检查315MHz是否有信号
+     * 检查是否在冷却期内
+     * @return true=冷却中, false=可以接收
      */
-    void check315();
+    bool isInCooldown();
 
     /**
-     * 验证信号是否有效 (过滤干扰)
-     * @param code 编码值
-     * @param bits 位数
-     * @return true=有效信号, false=干扰信号
+     * 处理从帧队列取出的一帧 (冷却、过滤、去重)
+     * @param frame 已解码的帧
+     * @param freq 频率 (433/315)
      */
-    bool isValidSignal(unsigned long code, unsigned int bits);
+    void handleFrame(const RCSwitchFrame& frame, unsigned int freq);
 
     /**
      * 检查是否为重复信号 (防止433/315混淆)
      * @param code 编码值
      * @return true=重复信号, false=新信号
      */
-    bool isDuplicateSignal(unsigned long code);
+    bool isDuplicateSignal(const RFCode& code);
 };
 
 #endif // RF_RECEIVER_H
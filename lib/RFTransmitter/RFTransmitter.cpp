@@ -4,13 +4,34 @@
  */
 
 #include "RFTransmitter.h"
+#include "AppEvents.h"
 #include <esp32-hal-log.h>
 
 static const char* TAG = "RFTransmitter";
 
+// 播放超时余量: 超过程序时长这么久仍未收到完成通知则视为失败
+static const unsigned long PLAYBACK_MARGIN_MS = 200;
+
+// TxResult对应的日志文字
+static const char* const TX_RESULT_NAMES[] = { "完成", "已取消", "失败" };
+
 RFTransmitter::RFTransmitter()
-    : _sending(false)
+    : _player433(RMT_CHANNEL_0, PROGRAM_STEPS)
+    , _player315(RMT_CHANNEL_1, PROGRAM_STEPS)
     , _repeatCount(10)
+    , _sendCallback(NULL)
+    , _sendCallbackArg(NULL)
+    , _queue(micros)
+    , _queueMutex(NULL)
+    , _txTaskHandle(NULL)
+    , _currentJobId(0)
+    , _cancelCurrent(false)
+    , _currentPlayer(NULL)
+    , _lastStats()
+    , _maxQueueWait(0)
+    , _completedCount(0)
+    , _cancelledCount(0)
+    , _rejectedCount(0)
 {
 }
 
@@ -19,43 +40,466 @@ void RFTransmitter::begin() {
     ESP_LOGI(TAG, "433MHz TX引脚: %d", RF_433_TX_PIN);
     ESP_LOGI(TAG, "315MHz TX引脚: %d", RF_315_TX_PIN);
 
-    // 启用发送
-    _rcSwitch433.enableTransmit(RF_433_TX_PIN);
-    _rcSwitch315.enableTransmit(RF_315_TX_PIN);
+    // RMT播放脉冲程序，失败时退回RCSwitch阻塞发送
+    if (_player433.begin(RF_433_TX_PIN)) {
+        _player433.setDoneCallback(onPlayerDone, this);
+    } else {
+        ESP_LOGW(TAG, "433MHz RMT不可用，使用阻塞发送");
+        _rcSwitch433.enableTransmit(RF_433_TX_PIN);
+    }
+    if (_player315.begin(RF_315_TX_PIN)) {
+        _player315.setDoneCallback(onPlayerDone, this);
+    } else {
+        ESP_LOGW(TAG, "315MHz RMT不可用，使用阻塞发送");
+        _rcSwitch315.enableTransmit(RF_315_TX_PIN);
+    }
 
     // 设置重复次数
     _rcSwitch433.setRepeatTransmit(_repeatCount);
     _rcSwitch315.setRepeatTransmit(_repeatCount);
 
+    // 创建发送任务 (优先级4, 低于解码任务; 大部分时间阻塞等待)
+    if (_txTaskHandle == NULL) {
+        _queueMutex = xSemaphoreCreateMutex();
+        xTaskCreate(
+            txTask,                   // 任务函数
+            "RFTransmit",             // 任务名称
+            4096,                     // 堆栈大小
+            this,                     // 参数
+            4,                        // 优先级
+            &_txTaskHandle            // 任务句柄
+        );
+    }
+
     ESP_LOGI(TAG, "RF发送模块初始化完成");
 }
 
-void RFTransmitter::send(unsigned long code, unsigned int bits, unsigned int freq, unsigned int protocol, unsigned int pulseLength) {
-    _sending = true;
+uint32_t RFTransmitter::send(const SignalRecord& signal, TxPriority priority,
+                             uint16_t repeats, unsigned long intervalMs) {
+    if (signal.isRaw()) {
+        ESP_LOGW(TAG, "原始信号请使用sendRaw()发送");
+        return 0;
+    }
+
+    TxJob job = TxJob();
+    job.priority = priority;
+    job.signal = signal;
+    job.repeats = repeats;
+    job.intervalUs = intervalMs * 1000;
+
+    uint32_t id = enqueue(job);
+    if (id != 0) {
+        char codeText[RFCode::DECIMAL_SIZE];
+        signal.code.toDecimal(codeText, sizeof(codeText));
+        ESP_LOGI(TAG, "发送任务#%lu入队: %dMHz 编码:%s 协议:%d 位数:%d 脉宽:%dus%s",
+                 (unsigned long)id, signal.freq(), codeText, (int)signal.protocol, (int)signal.bits,
+                 (int)signal.pulseLength, (priority == TX_PRIORITY_URGENT) ? " (紧急)" : "");
+        if (repeats > 0) {
+            ESP_LOGI(TAG, "发送任务#%lu再重复 %d 次, 间隔 %lums", (unsigned long)id, (int)repeats, intervalMs);
+        }
+    }
+    return id;
+}
+
+uint32_t RFTransmitter::sendRaw(const uint16_t* words, size_t wordCount, unsigned int freq, TxPriority priority) {
+    if (wordCount == 0) {
+        return 0;
+    }
+    if (!getPlayer(freq)) {
+        ESP_LOGW(TAG, "未知频率: %d", freq);
+        return 0;
+    }
+
+    // 复制一份数据，调用方可以立即复用自己的缓冲区
+    uint16_t* copy = (uint16_t*)malloc(wordCount * sizeof(uint16_t));
+    if (!copy) {
+        ESP_LOGE(TAG, "原始数据内存不足: %d 字", (int)wordCount);
+        return 0;
+    }
+    memcpy(copy, words, wordCount * sizeof(uint16_t));
+
+    TxJob job = TxJob();
+    job.priority = priority;
+    job.signal.type = SignalRecord::TYPE_RAW;
+    job.signal.setFreq(freq);
+    job.rawWords = copy;
+    job.rawCount = wordCount;
+
+    uint32_t id = enqueue(job);
+    if (id == 0) {
+        free(copy);
+        return 0;
+    }
+
+    ESP_LOGI(TAG, "发送任务#%lu入队: %dMHz 原始信号 %d 个脉冲 时长:%luus%s",
+             (unsigned long)id, freq, (int)RawPulse::countPulses(words, wordCount),
+             (unsigned long)RawPulse::totalDuration(words, wordCount),
+             (priority == TX_PRIORITY_URGENT) ? " (紧急)" : "");
+    return id;
+}
+
+uint32_t RFTransmitter::enqueue(TxJob& job) {
+    if (_queueMutex == NULL) {
+        ESP_LOGW(TAG, "发送模块未初始化");
+        return 0;
+    }
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    uint32_t id = _queue.push(job);
+    if (id == 0) {
+        _rejectedCount++;
+    }
+    xSemaphoreGive(_queueMutex);
+
+    if (id == 0) {
+        ESP_LOGW(TAG, "发送队列已满 (%d)，忽略本次请求", QUEUE_SIZE);
+        return 0;
+    }
+
+    xTaskNotifyGive(_txTaskHandle);
+    return id;
+}
+
+bool RFTransmitter::cancel(uint32_t jobId) {
+    if (_queueMutex == NULL || jobId == 0) {
+        return false;
+    }
+
+    TxJob job;
+    bool removed = false;
+    bool current = false;
+
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    if (_queue.remove(jobId, job)) {
+        removed = true;
+    } else if (_currentJobId == jobId) {
+        // 正在发送: 停止播放，由发送任务记录结果
+        current = true;
+        _cancelCurrent = true;
+        if (_currentPlayer) {
+            _currentPlayer->stop();
+        }
+    }
+    xSemaphoreGive(_queueMutex);
+
+    if (removed) {
+        ESP_LOGI(TAG, "取消排队中的发送任务#%lu", (unsigned long)jobId);
+        finishJob(job, TX_RESULT_CANCELLED, micros());
+        releaseJob(job);
+        return true;
+    }
+    if (current) {
+        ESP_LOGI(TAG, "停止正在发送的任务#%lu", (unsigned long)jobId);
+        xTaskNotifyGive(_txTaskHandle);
+        return true;
+    }
+    return false;
+}
+
+void RFTransmitter::cancelAll() {
+    if (_queueMutex == NULL) {
+        return;
+    }
+
+    // 先取消排队的任务，再停止正在发送的任务
+    while (true) {
+        TxJob job;
+        xSemaphoreTake(_queueMutex, portMAX_DELAY);
+        bool hasJob = _queue.popAny(job);
+        xSemaphoreGive(_queueMutex);
+        if (!hasJob) {
+            break;
+        }
+        finishJob(job, TX_RESULT_CANCELLED, micros());
+        releaseJob(job);
+    }
+
+    cancel(_currentJobId);
+}
+
+void RFTransmitter::txTask(void* parameter) {
+    RFTransmitter* self = static_cast<RFTransmitter*>(parameter);
+
+    while (true) {
+        // 等待入队通知或下一次重复发送的时间 (多余的通知只会多做一次空循环)
+        xSemaphoreTake(self->_queueMutex, portMAX_DELAY);
+        const unsigned long delayUs = self->_queue.nextDelay();
+        xSemaphoreGive(self->_queueMutex);
+        if (delayUs == TxQueue<QUEUE_SIZE>::NEVER) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        } else if (delayUs > 0) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(delayUs / 1000) + 1);
+        }
+
+        while (true) {
+            TxJob job;
+            xSemaphoreTake(self->_queueMutex, portMAX_DELAY);
+            bool hasJob = self->_queue.pop(job);
+            if (hasJob) {
+                self->_currentJobId = job.id;
+                self->_cancelCurrent = false;
+            }
+            xSemaphoreGive(self->_queueMutex);
+
+            if (!hasJob) {
+                break;
+            }
+
+            const unsigned long startedAt = micros();
+            uint8_t result = self->runJob(job);
+
+            // 还有重复次数: 放回队列等下一次 (原始数据继续由任务持有)。
+            // cancel()可能在playJob()最后一次检查之后才到，和放回队列在同一次加锁里判断
+            xSemaphoreTake(self->_queueMutex, portMAX_DELAY);
+            if (result == TX_RESULT_DONE && self->_cancelCurrent) {
+                result = TX_RESULT_CANCELLED;
+            }
+            self->_cancelCurrent = false;
+            self->_currentJobId = 0;
+            self->_currentPlayer = NULL;
+            const bool again = result == TX_RESULT_DONE && self->_queue.reschedule(job);
+            xSemaphoreGive(self->_queueMutex);
+            if (again) {
+                continue;
+            }
+
+            self->finishJob(job, result, startedAt);
+            releaseJob(job);
+        }
+    }
+}
+
+uint8_t RFTransmitter::runJob(const TxJob& job) {
+    // 发送期间暂停本频段接收，接收模块听到的是自己发出的信号
+    const unsigned int freq = job.signal.freq();
+    setReceiveSuspended(freq, true);
+    const uint8_t result = playJob(job);
+    setReceiveSuspended(freq, false);
+    return result;
+}
+
+uint8_t RFTransmitter::playJob(const TxJob& job) {
+    PulsePlayer* player = getPlayer(job.signal.freq());
+
+    if (!player->isReady()) {
+        // RMT不可用: 在发送任务中阻塞发送，每帧之间检查取消
+        sendBlocking(job);
+        return isCancelled() ? TX_RESULT_CANCELLED : TX_RESULT_DONE;
+    }
+
+    if (!compileJob(job, player)) {
+        ESP_LOGE(TAG, "脉冲程序过长 (最多 %d 步)，取消发送任务#%lu",
+                 (int)PROGRAM_STEPS, (unsigned long)job.id);
+        return TX_RESULT_FAILED;
+    }
+
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    bool cancelled = _cancelCurrent;
+    if (!cancelled) {
+        _currentPlayer = player;
+    }
+    xSemaphoreGive(_queueMutex);
+
+    if (cancelled) {
+        return TX_RESULT_CANCELLED;
+    }
+    if (!player->start()) {
+        return TX_RESULT_FAILED;
+    }
+
+    ESP_LOGD(TAG, "发送任务#%lu开始: %dMHz %d 步, 时长:%luus", (unsigned long)job.id, job.signal.freq(),
+             (int)player->program().size(), (unsigned long)player->program().totalDuration());
+
+    // 等待播放完成或取消 (完成回调和cancel()都会通知本任务)
+    const TickType_t timeout = pdMS_TO_TICKS(player->program().totalDuration() / 1000 + PLAYBACK_MARGIN_MS);
+    const TickType_t startTick = xTaskGetTickCount();
+    while (player->isBusy() && !isCancelled()) {
+        const TickType_t elapsed = xTaskGetTickCount() - startTick;
+        if (elapsed >= timeout) {
+            ESP_LOGE(TAG, "发送任务#%lu超时", (unsigned long)job.id);
+            player->stop();
+            return TX_RESULT_FAILED;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout - elapsed);
+    }
+
+    return isCancelled() ? TX_RESULT_CANCELLED : TX_RESULT_DONE;
+}
+
+bool RFTransmitter::isCancelled() {
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    const bool cancelled = _cancelCurrent;
+    xSemaphoreGive(_queueMutex);
+    return cancelled;
+}
 
-    ESP_LOGI(TAG, "发送信号: %dMHz 编码:%lu 协议:%d 位数:%d 脉宽:%dus",
-             freq, code, protocol, bits, pulseLength);
+void RFTransmitter::setReceiveSuspended(unsigned int freq, bool suspended) {
+    if (freq == RCSwitch433::FREQUENCY) {
+        if (suspended) {
+            RCSwitch433::suspendReceive();
+        } else {
+            RCSwitch433::resumeReceive();
+        }
+    } else if (freq == RCSwitch315::FREQUENCY) {
+        if (suspended) {
+            RCSwitch315::suspendReceive();
+        } else {
+            RCSwitch315::resumeReceive();
+        }
+    }
+}
 
-    if (freq == 433) {
-        if (pulseLength > 0) {
-            _rcSwitch433.setProtocol(protocol, pulseLength);
+bool RFTransmitter::compileJob(const TxJob& job, PulsePlayer* player) {
+    PulseProgram& program = player->program();
+
+    if (job.signal.isRaw()) {
+        // 按原时序重放: 第一个脉冲为高电平，之后交替
+        program.clear();
+        program.appendRaw(job.rawWords, job.rawCount, HIGH);
+        return program.finish(LOW);
+    }
+
+    if (job.signal.freq() == RCSwitch433::FREQUENCY) {
+        if (job.signal.pulseLength > 0) {
+            _rcSwitch433.setProtocol(job.signal.protocol, job.signal.pulseLength);
         } else {
-            _rcSwitch433.setProtocol(protocol);
+            _rcSwitch433.setProtocol(job.signal.protocol);
+        }
+        return _rcSwitch433.compile(job.signal.code, job.signal.bits, program);
+    }
+
+    if (job.signal.pulseLength > 0) {
+        _rcSwitch315.setProtocol(job.signal.protocol, job.signal.pulseLength);
+    } else {
+        _rcSwitch315.setProtocol(job.signal.protocol);
+    }
+    return _rcSwitch315.compile(job.signal.code, job.signal.bits, program);
+}
+
+void RFTransmitter::sendBlocking(const TxJob& job) {
+    // 编码信号一帧一帧发送 (波形和连续重复相同)，每帧之间检查取消；
+    // 原始信号只有一段，发完后才能停止
+    if (job.signal.freq() == RCSwitch433::FREQUENCY) {
+        if (job.signal.isRaw()) {
+            _rcSwitch433.sendRaw(job.rawWords, job.rawCount);
+            return;
         }
-        _rcSwitch433.send(code, bits);
-    } else if (freq == 315) {
-        if (pulseLength > 0) {
-            _rcSwitch315.setProtocol(protocol, pulseLength);
+        if (job.signal.pulseLength > 0) {
+            _rcSwitch433.setProtocol(job.signal.protocol, job.signal.pulseLength);
         } else {
-            _rcSwitch315.setProtocol(protocol);
+            _rcSwitch433.setProtocol(job.signal.protocol);
         }
-        _rcSwitch315.send(code, bits);
+        _rcSwitch433.setRepeatTransmit(1);
+        for (int i = 0; i < _repeatCount && !isCancelled(); i++) {
+            _rcSwitch433.send(job.signal.code, job.signal.bits);
+        }
+        _rcSwitch433.setRepeatTransmit(_repeatCount);
+        return;
+    }
+
+    if (job.signal.isRaw()) {
+        _rcSwitch315.sendRaw(job.rawWords, job.rawCount);
+        return;
+    }
+    if (job.signal.pulseLength > 0) {
+        _rcSwitch315.setProtocol(job.signal.protocol, job.signal.pulseLength);
     } else {
-        ESP_LOGW(TAG, "未知频率: %d", freq);
+        _rcSwitch315.setProtocol(job.signal.protocol);
+    }
+    _rcSwitch315.setRepeatTransmit(1);
+    for (int i = 0; i < _repeatCount && !isCancelled(); i++) {
+        _rcSwitch315.send(job.signal.code, job.signal.bits);
+    }
+    _rcSwitch315.setRepeatTransmit(_repeatCount);
+}
+
+void RFTransmitter::finishJob(const TxJob& job, uint8_t result, unsigned long startedAt) {
+    TxJobStats stats;
+    stats.id = job.id;
+    stats.freq = job.signal.freq();
+    stats.result = result;
+    stats.queueWait = startedAt - job.queuedAt;
+    stats.duration = micros() - startedAt;
+
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    _lastStats = stats;
+    if (result == TX_RESULT_DONE) {
+        _completedCount++;
+        if (stats.queueWait > _maxQueueWait) {
+            _maxQueueWait = stats.queueWait;
+        }
+    } else if (result == TX_RESULT_CANCELLED) {
+        _cancelledCount++;
+    }
+    xSemaphoreGive(_queueMutex);
+
+    ESP_LOGI(TAG, "发送任务#%lu%s: 排队:%luus 发送:%luus", (unsigned long)stats.id,
+             TX_RESULT_NAMES[result], stats.queueWait, stats.duration);
+
+    if (_sendCallback) {
+        _sendCallback(stats, _sendCallbackArg);
+    }
+
+    // 发送状态可能变了，页面要刷新提示
+    AppEvents::post(AppEvents::TX);
+}
+
+void RFTransmitter::releaseJob(TxJob& job) {
+    if (job.rawWords) {
+        free(job.rawWords);
+        job.rawWords = NULL;
+    }
+}
+
+bool RFTransmitter::isSending() {
+    if (_queueMutex == NULL) {
+        return false;
+    }
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    bool sending = (_currentJobId != 0) || !_queue.empty();
+    xSemaphoreGive(_queueMutex);
+    return sending;
+}
+
+unsigned int RFTransmitter::getPendingCount() {
+    if (_queueMutex == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    unsigned int count = _queue.size();
+    xSemaphoreGive(_queueMutex);
+    return count;
+}
+
+TxJobStats RFTransmitter::getLastJobStats() {
+    if (_queueMutex == NULL) {
+        return TxJobStats();
     }
+    xSemaphoreTake(_queueMutex, portMAX_DELAY);
+    TxJobStats stats = _lastStats;
+    xSemaphoreGive(_queueMutex);
+    return stats;
+}
+
+void RFTransmitter::setSendCallback(SendCallback callback, void* arg) {
+    _sendCallback = callback;
+    _sendCallbackArg = arg;
+}
+
+PulsePlayer* RFTransmitter::getPlayer(unsigned int freq) {
+    if (freq == RCSwitch433::FREQUENCY) return &_player433;
+    if (freq == RCSwitch315::FREQUENCY) return &_player315;
+    return NULL;
+}
 
-    _sending = false;
-    ESP_LOGI(TAG, "发送完成");
+void IRAM_ATTR RFTransmitter::onPlayerDone(PulsePlayer* player, void* arg) {
+    (void)player;
+    // 中断上下文: 只唤醒发送任务
+    RFTransmitter* self = static_cast<RFTransmitter*>(arg);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->_txTaskHandle, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
 }
 
 void RFTransmitter::setRepeatTransmit(int repeat) {
@@ -1,34 +1,80 @@
 /**
  * @file RFTransmitter.h
  * @brief RF信号发送模块，支持433/315MHz双频发送
+ *
+ * send()/sendRaw()只把发送任务放进有界队列并立即返回任务编号，
+ * 由独立的发送任务依次取出: 编译成脉冲程序交给RMT外设播放，
+ * 等待播放完成后再处理下一个。紧急任务插到队首，排队或正在发送的
+ * 任务都可以按编号取消；重复发送的任务播完后按间隔放回队列。
+ * RMT初始化失败时发送任务退回阻塞发送，
+ * 界面线程同样不受影响。发送期间暂停同频段的接收。
  */
 
 #ifndef RF_TRANSMITTER_H
 #define RF_TRANSMITTER_H
 
 #include <Arduino.h>
-#include "RCSwitch433.h"
-#include "RCSwitch315.h"
+#include "RCSwitch.h"
+#include "PulsePlayer.h"
+#include "TxQueue.h"
 #include "pin_config.h"
 
 class RFTransmitter {
 public:
+    /**
+     * 发送任务结束回调 (在发送任务中调用，不要长时间阻塞)
+     * @param stats 任务统计 (编号、频率、结果、耗时)
+     * @param arg 注册时传入的参数
+     */
+    typedef void (*SendCallback)(const TxJobStats& stats, void* arg);
+
+    // 每个频段脉冲程序的最大步骤数 (每步一个高低电平对, 4字节)
+    static const size_t PROGRAM_STEPS = 1536;
+
+    // 发送队列容量
+    static const unsigned int QUEUE_SIZE = 8;
+
     RFTransmitter();
 
     /**
-     * 初始化RF发送模块
+     * 初始化RF发送模块并启动发送任务
      */
     void begin();
 
     /**
-     * 发送RF信号
-     * @param code 编码值
-     * @param bits 位长度
+     * 发送RF信号 (入队后立即返回)
+     * @param signal 信号记录 (脉宽为0时使用协议默认值)
+     * @param priority 优先级 (TX_PRIORITY_URGENT插队)
+     * @param repeats 播完后再发几次 (0=只发一次)，整个任务用同一个编号
+     * @param intervalMs 重复发送的间隔 (从上一次播完算起)
+     * @return 任务编号, 0=队列已满或为原始信号
+     */
+    uint32_t send(const SignalRecord& signal, TxPriority priority = TX_PRIORITY_NORMAL,
+                  uint16_t repeats = 0, unsigned long intervalMs = 0);
+
+    /**
+     * 按原始时序重放脉冲序列 (数据被复制，调用后即可复用缓冲区)
+     * @param words 脉冲数据 (RawPulse编码)
+     * @param wordCount 字数
      * @param freq 频率 (433/315)
-     * @param protocol 协议类型 (1-12)
-     * @param pulseLength 脉宽 (微秒，0=使用协议默认值)
+     * @param priority 优先级
+     * @return 任务编号, 0=队列已满、频率未知或内存不足
+     */
+    uint32_t sendRaw(const uint16_t* words, size_t wordCount, unsigned int freq,
+                     TxPriority priority = TX_PRIORITY_NORMAL);
+
+    /**
+     * 取消发送任务 (排队或等待重复中直接移除，正在发送则立即停止；
+     * RMT不可用时的阻塞发送在当前帧发完后停止，原始信号发完整段后停止)
+     * @param jobId 任务编号
+     * @return false=任务不存在或已结束
      */
-    void send(unsigned long code, unsigned int bits, unsigned int freq, unsigned int protocol, unsigned int pulseLength = 0);
+    bool cancel(uint32_t jobId);
+
+    /**
+     * 取消所有排队和正在发送的任务
+     */
+    void cancelAll();
 
     /**
      * 设置重复发送次数
@@ -37,16 +83,97 @@ public:
     void setRepeatTransmit(int repeat);
 
     /**
-     * 是否正在发送
+     * 是否正在发送或有任务排队
+     */
+    bool isSending();
+
+    /**
+     * 排队中的任务数 (不含正在发送的任务)
+     */
+    unsigned int getPendingCount();
+
+    /**
+     * 设置发送任务结束回调
      */
-    bool isSending() { return _sending; }
+    void setSendCallback(SendCallback callback, void* arg);
+
+    // ========== 统计 ==========
+    TxJobStats getLastJobStats();                           // 最近结束的任务
+    unsigned long getMaxQueueWait() { return _maxQueueWait; }   // 最长排队时间 (微秒)
+    unsigned long getCompletedCount() { return _completedCount; }
+    unsigned long getCancelledCount() { return _cancelledCount; }
+    unsigned long getRejectedCount() { return _rejectedCount; } // 队列满被拒绝
 
 private:
     RCSwitch433 _rcSwitch433;   // 433MHz发送
     RCSwitch315 _rcSwitch315;   // 315MHz发送
 
-    bool _sending;
+    PulsePlayer _player433;     // 433MHz RMT播放
+    PulsePlayer _player315;     // 315MHz RMT播放
+
     int _repeatCount;
+    SendCallback _sendCallback;
+    void* _sendCallbackArg;
+
+    // 发送队列 (由_queueMutex保护)
+    TxQueue<QUEUE_SIZE> _queue;
+    SemaphoreHandle_t _queueMutex;
+    TaskHandle_t _txTaskHandle;
+
+    // 正在发送的任务 (由_queueMutex保护，发送任务通过isCancelled()读取)
+    volatile uint32_t _currentJobId;
+    volatile bool _cancelCurrent;
+    PulsePlayer* volatile _currentPlayer;
+
+    // 统计
+    TxJobStats _lastStats;
+    unsigned long _maxQueueWait;
+    unsigned long _completedCount;
+    unsigned long _cancelledCount;
+    unsigned long _rejectedCount;
+
+    PulsePlayer* getPlayer(unsigned int freq);
+
+    /**
+     * 入队并唤醒发送任务
+     */
+    uint32_t enqueue(TxJob& job);
+
+    /**
+     * 在发送任务中执行一个任务 (期间暂停同频段接收)，返回TxResult
+     */
+    uint8_t runJob(const TxJob& job);
+
+    /**
+     * 播放任务并等待完成或取消，返回TxResult
+     */
+    uint8_t playJob(const TxJob& job);
+
+    /**
+     * 正在发送的任务是否已被取消 (加锁读取)
+     */
+    bool isCancelled();
+
+    /**
+     * 暂停/恢复频段的接收中断
+     */
+    static void setReceiveSuspended(unsigned int freq, bool suspended);
+
+    /**
+     * 编译任务到播放器的脉冲程序
+     */
+    bool compileJob(const TxJob& job, PulsePlayer* player);
+
+    /**
+     * 阻塞发送 (RMT不可用时)
+     */
+    void sendBlocking(const TxJob& job);
+
+    void finishJob(const TxJob& job, uint8_t result, unsigned long startedAt);
+    static void releaseJob(TxJob& job);
+
+    static void txTask(void* parameter);
+    static void onPlayerDone(PulsePlayer* player, void* arg);
 };
 
 #endif // RF_TRANSMITTER_H
@@ -0,0 +1,93 @@
+/**
+ * @file RawPulse.h
+ * @brief 原始脉冲序列的紧凑16位编码
+ *
+ * 每个脉冲 (两次电平变化之间的时长, 微秒) 编码为:
+ * - 小于32768us: 一个16位字
+ * - 更长的间隔: 转义字 (最高位为1, 低15位为时长高位) + 一个16位字 (时长低16位)
+ *
+ * 序列以同步间隔之后的第一个高电平脉冲开始，之后高低电平交替。
+ */
+
+#ifndef RAW_PULSE_H
+#define RAW_PULSE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class RawPulse {
+public:
+    static const uint16_t ESCAPE = 0x8000;          // 转义标志位
+    static const uint32_t MAX_DIRECT = 0x7FFF;      // 单字可表示的最大时长
+    static const uint32_t MAX_DURATION = 0x7FFFFFFF; // 转义后可表示的最大时长
+
+    /**
+     * 编码一个脉冲
+     * @param duration 时长 (微秒)
+     * @param out 输出缓冲区
+     * @param space 输出缓冲区剩余字数
+     * @return 写入的字数, 0=空间不足
+     */
+    static size_t encode(uint32_t duration, uint16_t* out, size_t space) {
+        if (duration <= MAX_DIRECT) {
+            if (space < 1) return 0;
+            out[0] = (uint16_t)duration;
+            return 1;
+        }
+        if (space < 2) return 0;
+        if (duration > MAX_DURATION) duration = MAX_DURATION;
+        out[0] = ESCAPE | (uint16_t)(duration >> 16);
+        out[1] = (uint16_t)(duration & 0xFFFF);
+        return 2;
+    }
+
+    /**
+     * 解码下一个脉冲
+     * @param words 编码数据
+     * @param count 总字数
+     * @param pos 当前位置 (解码后前进)
+     * @param duration 输出时长 (微秒)
+     * @return false=数据结束或不完整
+     */
+    static bool decode(const uint16_t* words, size_t count, size_t& pos, uint32_t& duration) {
+        if (pos >= count) return false;
+        const uint16_t word = words[pos];
+        if (!(word & ESCAPE)) {
+            duration = word;
+            pos += 1;
+            return true;
+        }
+        if (pos + 1 >= count) return false;
+        duration = ((uint32_t)(word & ~ESCAPE) << 16) | words[pos + 1];
+        pos += 2;
+        return true;
+    }
+
+    /**
+     * 统计编码数据中的脉冲数量
+     */
+    static size_t countPulses(const uint16_t* words, size_t count) {
+        size_t pos = 0;
+        size_t pulses = 0;
+        uint32_t duration;
+        while (decode(words, count, pos, duration)) {
+            pulses++;
+        }
+        return pulses;
+    }
+
+    /**
+     * 统计编码数据的总时长 (微秒)
+     */
+    static uint32_t totalDuration(const uint16_t* words, size_t count) {
+        size_t pos = 0;
+        uint32_t total = 0;
+        uint32_t duration;
+        while (decode(words, count, pos, duration)) {
+            total += duration;
+        }
+        return total;
+    }
+};
+
+#endif // RAW_PULSE_H
@@ -0,0 +1,93 @@
+/**
+ * @file SPSCQueue.h
+ * @brief 固定容量的单生产者单消费者无锁队列
+ *
+ * 生产者只写head，消费者只写tail，双方无需加锁。
+ * 队列满时新元素被丢弃并计数，由消费者通过getDropCount()查看。
+ * 容量必须为2的幂，实际可用容量为 SIZE - 1。
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+
+template <typename T, unsigned int SIZE>
+class SPSCQueue {
+public:
+    static_assert((SIZE & (SIZE - 1)) == 0, "SPSCQueue SIZE必须为2的幂");
+
+    constexpr SPSCQueue() : _items(), _head(0), _tail(0), _dropCount(0) {}
+
+    /**
+     * 入队 (仅生产者调用)
+     * @return false=队列已满，元素被丢弃
+     */
+    bool push(const T& item) {
+        const unsigned int head = _head;
+        const unsigned int next = (head + 1) & MASK;
+        if (next == _tail) {
+            _dropCount++;
+            return false;
+        }
+        _items[head] = item;
+        __sync_synchronize();  // 先写数据再发布head
+        _head = next;
+        return true;
+    }
+
+    /**
+     * 出队 (仅消费者调用)
+     * @return false=队列为空
+     */
+    bool pop(T& item) {
+        const unsigned int tail = _tail;
+        if (tail == _head) {
+            return false;
+        }
+        __sync_synchronize();  // 读到head后再读数据
+        item = _items[tail];
+        __sync_synchronize();  // 读完数据再释放槽位
+        _tail = (tail + 1) & MASK;
+        return true;
+    }
+
+    /**
+     * 丢弃所有未读元素 (仅消费者调用)
+     */
+    void clear() {
+        _tail = _head;
+    }
+
+    /**
+     * 当前元素数量
+     */
+    unsigned int size() const {
+        return (_head - _tail) & MASK;
+    }
+
+    bool empty() const {
+        return _head == _tail;
+    }
+
+    /**
+     * 因队列满而丢弃的元素数量
+     */
+    unsigned long getDropCount() const {
+        return _dropCount;
+    }
+
+    void resetDropCount() {
+        _dropCount = 0;
+    }
+
+private:
+    static const unsigned int MASK = SIZE - 1;
+
+    T _items[SIZE];
+    volatile unsigned int _head;
+    volatile unsigned int _tail;
+    volatile unsigned long _dropCount;
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,434 @@
+/**
+ * @file SignalJson.cpp
+ * @brief 单条信号记录的JSON读写实现
+ */
+
+#include "SignalJson.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+// 向定长缓冲区写JSON，空间不够时ok置false
+struct JsonWriter {
+    char* out;
+    size_t size;
+    size_t length;
+    bool first;
+    bool ok;
+
+    JsonWriter(char* buffer, size_t bufferSize)
+        : out(buffer), size(bufferSize), length(0), first(true), ok(bufferSize > 0) {}
+
+    void put(char c) {
+        if (length + 1 < size) {
+            out[length++] = c;
+        } else {
+            ok = false;
+        }
+    }
+
+    void text(const char* s) {
+        while (*s) {
+            put(*s++);
+        }
+    }
+
+    void key(const char* name) {
+        if (!first) {
+            put(',');
+        }
+        first = false;
+        put('"');
+        text(name);
+        text("\":");
+    }
+
+    void number(const char* name, uint64_t value) {
+        key(name);
+        char digits[21];
+        int count = 0;
+        do {
+            digits[count++] = '0' + (value % 10);
+            value /= 10;
+        } while (value);
+        while (count > 0) {
+            put(digits[--count]);
+        }
+    }
+
+    void string(const char* name, const char* value) {
+        key(name);
+        put('"');
+        for (; *value; value++) {
+            const unsigned char c = *value;
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put(c);
+            } else if (c < 0x20) {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                text(escaped);
+            } else {
+                put(c);     // UTF-8原样输出
+            }
+        }
+        put('"');
+    }
+};
+
+// 从字符串读JSON
+struct JsonReader {
+    const char* p;
+
+    explicit JsonReader(const char* text) : p(text) {}
+
+    void skipSpace() {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
+        }
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if (*p != c) {
+            return false;
+        }
+        p++;
+        return true;
+    }
+
+    /**
+     * 读取字符串，超长部分丢弃 (不截断UTF-8字符)
+     */
+    bool readString(char* out, size_t size) {
+        if (!expect('"')) {
+            return false;
+        }
+        size_t length = 0;
+        bool truncated = false;
+        while (*p != '"') {
+            uint32_t c = (unsigned char)*p++;
+            if (c == '\0') {
+                return false;
+            }
+            const bool escaped = (c == '\\');
+            if (escaped) {
+                switch (*p++) {
+                    case '"':  c = '"'; break;
+                    case '\\': c = '\\'; break;
+                    case '/':  c = '/'; break;
+                    case 'b':  c = '\b'; break;
+                    case 'f':  c = '\f'; break;
+                    case 'n':  c = '\n'; break;
+                    case 'r':  c = '\r'; break;
+                    case 't':  c = '\t'; break;
+                    case 'u':
+                        if (!readHex4(c)) {
+                            return false;
+                        }
+                        break;
+                    default:
+                        return false;
+                }
+            }
+
+            // 普通字节原样保存，\u转义按UTF-8写出 (代理对不支持，写'?')
+            char bytes[3];
+            size_t count = 0;
+            if (!escaped || c < 0x80) {
+                bytes[count++] = (char)c;
+            } else if (c < 0x800) {
+                bytes[count++] = (char)(0xC0 | (c >> 6));
+                bytes[count++] = (char)(0x80 | (c & 0x3F));
+            } else if (c >= 0xD800 && c <= 0xDFFF) {
+                bytes[count++] = '?';
+            } else {
+                bytes[count++] = (char)(0xE0 | (c >> 12));
+                bytes[count++] = (char)(0x80 | ((c >> 6) & 0x3F));
+                bytes[count++] = (char)(0x80 | (c & 0x3F));
+            }
+
+            if (truncated || length + count >= size) {
+                truncated = true;
+                continue;
+            }
+            memcpy(&out[length], bytes, count);
+            length += count;
+        }
+        p++;
+
+        // 截断时去掉不完整的UTF-8字符
+        if (truncated) {
+            size_t start = length;
+            while (start > 0 && ((unsigned char)out[start - 1] & 0xC0) == 0x80) {
+                start--;
+            }
+            if (start > 0 && ((unsigned char)out[start - 1] & 0x80)) {
+                const unsigned char lead = out[start - 1];
+                const size_t need = (lead >= 0xF0) ? 4 : (lead >= 0xE0) ? 3 : 2;
+                if (length - (start - 1) < need) {
+                    length = start - 1;
+                }
+            }
+        }
+        out[length] = '\0';
+        return true;
+    }
+
+    bool readHex4(uint32_t& value) {
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            const char c = *p++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                value |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                value |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readNumber(uint64_t& value) {
+        skipSpace();
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        value = 0;
+        while (*p >= '0' && *p <= '9') {
+            const uint64_t next = value * 10 + (*p - '0');
+            if (next / 10 != value) {
+                return false;   // 溢出
+            }
+            value = next;
+            p++;
+        }
+        return true;
+    }
+
+    /**
+     * 跳过不认识的值 (嵌套的数组和对象整体跳过)
+     */
+    bool skipValue() {
+        skipSpace();
+        if (*p == '"') {
+            char ignored[1];
+            return readString(ignored, sizeof(ignored));
+        }
+        if (*p == '[' || *p == '{') {
+            int depth = 0;
+            do {
+                if (*p == '"') {
+                    char ignored[1];
+                    if (!readString(ignored, sizeof(ignored))) {
+                        return false;
+                    }
+                    continue;
+                }
+                if (*p == '\0') {
+                    return false;
+                }
+                if (*p == '[' || *p == '{') {
+                    depth++;
+                } else if (*p == ']' || *p == '}') {
+                    depth--;
+                }
+                p++;
+            } while (depth > 0);
+            return true;
+        }
+        if (*p == '-' || (*p >= '0' && *p <= '9')) {
+            p++;
+            while ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-') {
+                p++;
+            }
+            return true;
+        }
+        static const char* const LITERALS[] = {"true", "false", "null"};
+        for (size_t i = 0; i < sizeof(LITERALS) / sizeof(LITERALS[0]); i++) {
+            const size_t length = strlen(LITERALS[i]);
+            if (strncmp(p, LITERALS[i], length) == 0) {
+                p += length;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
+size_t SignalJson::write(const SignalRecord& signal, const char* name, uint16_t words, char* out, size_t size) {
+    JsonWriter writer(out, size);
+    writer.put('{');
+    writer.number("freq", signal.freq());
+    if (signal.isRaw()) {
+        writer.text(",\"type\":\"raw\"");
+        writer.number("words", words);
+        writer.number("bits", signal.bits);
+    } else {
+        writer.number("code", signal.code.low64());
+        if (signal.code.high64()) {
+            writer.number("codeHi", signal.code.high64());
+        }
+        writer.number("protocol", signal.protocol);
+        writer.number("bits", signal.bits);
+        writer.number("pulse", signal.pulseLength);
+    }
+    if (name && name[0]) {
+        writer.string("name", name);
+    }
+    writer.put('}');
+
+    if (!writer.ok) {
+        out[0] = '\0';
+        return 0;
+    }
+    out[writer.length] = '\0';
+    return writer.length;
+}
+
+bool SignalJson::parse(const char* text, Entry& entry) {
+    // 旧版的默认值
+    uint64_t freq = SignalRecord::FREQ_433;
+    uint64_t codeLow = 0;
+    uint64_t codeHigh = 0;
+    uint64_t protocol = 1;
+    uint64_t bits = 24;
+    uint64_t pulse = 350;
+    uint64_t words = 0;
+    bool hasCode = false;
+    bool raw = false;
+    entry.name[0] = '\0';
+
+    JsonReader reader(text);
+    if (!reader.expect('{')) {
+        return false;
+    }
+    reader.skipSpace();
+    bool more = (*reader.p != '}');
+    while (more) {
+        char key[12];
+        if (!reader.readString(key, sizeof(key)) || !reader.expect(':')) {
+            return false;
+        }
+
+        bool ok = true;
+        if (strcmp(key, "name") == 0) {
+            ok = reader.readString(entry.name, sizeof(entry.name));
+        } else if (strcmp(key, "type") == 0) {
+            char type[8];
+            ok = reader.readString(type, sizeof(type));
+            if (strcmp(type, "raw") == 0) {
+                raw = true;
+            } else if (strcmp(type, "code") != 0) {
+                return false;
+            }
+        } else if (strcmp(key, "code") == 0) {
+            ok = reader.readNumber(codeLow);
+            hasCode = true;
+        } else if (strcmp(key, "codeHi") == 0) {
+            ok = reader.readNumber(codeHigh);
+        } else if (strcmp(key, "freq") == 0) {
+            ok = reader.readNumber(freq);
+        } else if (strcmp(key, "protocol") == 0) {
+            ok = reader.readNumber(protocol);
+        } else if (strcmp(key, "bits") == 0) {
+            ok = reader.readNumber(bits);
+        } else if (strcmp(key, "pulse") == 0) {
+            ok = reader.readNumber(pulse);
+        } else if (strcmp(key, "words") == 0) {
+            ok = reader.readNumber(words);
+        } else {
+            ok = reader.skipValue();
+        }
+        if (!ok) {
+            return false;
+        }
+
+        reader.skipSpace();
+        if (*reader.p == ',') {
+            reader.p++;
+        } else if (*reader.p == '}') {
+            more = false;
+        } else {
+            return false;
+        }
+    }
+
+    if ((!raw && !hasCode) || words > 0xFFFF ||
+        (freq != SignalRecord::FREQ_433 && freq != SignalRecord::FREQ_315)) {
+        return false;
+    }
+
+    SignalRecord& signal = entry.signal;
+    signal = SignalRecord();
+    signal.code = RFCode(codeLow, codeHigh);
+    signal.setFreq(freq);
+    signal.type = raw ? SignalRecord::TYPE_RAW : SignalRecord::TYPE_CODE;
+    signal.set(raw ? 0 : protocol, bits, raw ? 0 : pulse);
+    entry.words = words;
+    return true;
+}
+
+// ==================== SignalJsonScanner ====================
+
+SignalJsonScanner::SignalJsonScanner()
+    : _length(0)
+    , _depth(0)
+    , _inString(false)
+    , _escape(false)
+    , _overflow(false)
+    , _overflowCount(0)
+{
+    _buffer[0] = '\0';
+}
+
+bool SignalJsonScanner::feed(char c) {
+    if (_depth == 0) {
+        if (c != '{') {
+            return false;   // 对象之间的分隔符
+        }
+        _length = 0;
+        _overflow = false;
+    }
+
+    if (_inString) {
+        if (_escape) {
+            _escape = false;
+        } else if (c == '\\') {
+            _escape = true;
+        } else if (c == '"') {
+            _inString = false;
+        }
+    } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        return false;       // 字符串外的空白不保存 (旧版文件是缩进格式)
+    } else if (c == '"') {
+        _inString = true;
+    } else if (c == '{') {
+        _depth++;
+    } else if (c == '}') {
+        _depth--;
+    }
+
+    if (_length + 1 < sizeof(_buffer)) {
+        _buffer[_length++] = c;
+    } else {
+        _overflow = true;
+    }
+
+    if (_depth > 0) {
+        return false;
+    }
+    _buffer[_length] = '\0';
+    if (_overflow) {
+        _overflowCount++;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file SignalJson.h
+ * @brief 单条信号记录的JSON读写 (固定缓冲区，不分配内存)
+ *
+ * 一条记录是一个扁平的JSON对象，字段与旧版 /signals.json 相同:
+ *   {"freq":433,"code":4269192,"protocol":1,"bits":24,"pulse":350,"type":"code","name":"车库"}
+ * 超过64位的编码另有 "codeHi"，原始信号另有 "words" (脉冲数据字数，
+ * 数据本身不放在JSON里)。认识的字段只能是字符串或非负整数，
+ * 不认识的字段 (包括嵌套的数组和对象) 跳过。
+ *
+ * 整个信号库因此可以一条一条地读写，占用的内存与信号数量无关。
+ */
+
+#ifndef SIGNAL_JSON_H
+#define SIGNAL_JSON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SignalRecord.h"
+
+class SignalJson {
+public:
+    static const size_t MAX_TEXT = 192;     // 一条记录JSON的最大长度 (含'\0')
+    static const size_t NAME_SIZE = 32;     // 名称缓冲区大小
+
+    // 解析出的一条记录
+    struct Entry {
+        SignalRecord signal;
+        char name[NAME_SIZE];   // 自定义名称, 空字符串=默认名称
+        uint16_t words;         // 原始信号的数据字数
+    };
+
+    /**
+     * 把一条记录写成JSON
+     * @param name 自定义名称 (NULL=不写)
+     * @param words 原始信号的数据字数 (协议信号忽略)
+     * @return 写入的长度 (不含'\0'), 0=缓冲区不够
+     */
+    static size_t write(const SignalRecord& signal, const char* name, uint16_t words, char* out, size_t size);
+
+    /**
+     * 解析一条记录 (缺少的字段使用旧版的默认值)
+     * @return false=格式错误或缺少编码
+     */
+    static bool parse(const char* text, Entry& entry);
+};
+
+/**
+ * 从字符流中逐个取出顶层JSON对象 (用于读取旧版 [{...}, {...}] 数组文件)
+ *
+ * 对象之外的字符 (方括号、逗号、空白) 和字符串外的空白被忽略，
+ * 字符串里的括号不计入层数。
+ */
+class SignalJsonScanner {
+public:
+    SignalJsonScanner();
+
+    /**
+     * 输入一个字符
+     * @return true=刚好凑成一个完整对象，用text()读取
+     */
+    bool feed(char c);
+
+    const char* text() const { return _buffer; }
+
+    /**
+     * 被丢弃的超长对象数量
+     */
+    unsigned int getOverflowCount() const { return _overflowCount; }
+
+private:
+    char _buffer[SignalJson::MAX_TEXT];
+    size_t _length;
+    int _depth;
+    bool _inString;
+    bool _escape;
+    bool _overflow;
+    unsigned int _overflowCount;
+};
+
+#endif // SIGNAL_JSON_H
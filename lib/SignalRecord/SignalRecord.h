@@ -0,0 +1,76 @@
+/**
+ * @file SignalRecord.h
+ * @brief 接收、存储、发送共用的紧凑信号记录
+ *
+ * 编码保持内联的RFCode (长帧不截断)，其余字段压进一个32位字:
+ * 协议、位数、脉宽用位域，频率只有433/315两个频段，用1位表示。
+ * 名称不放在记录里: 默认名称由 generateName() 随时生成，
+ * 用户自定义的名称存放在存储模块的字符串池中，记录只保存池编号。
+ * 整个记录24字节，可以直接按字节保存和复制。
+ */
+
+#ifndef SIGNAL_RECORD_H
+#define SIGNAL_RECORD_H
+
+#include <stdint.h>
+#include "RFCode.h"
+
+struct SignalRecord {
+    // 信号类型
+    static const uint8_t TYPE_CODE = 0;     // 协议编码信号
+    static const uint8_t TYPE_RAW = 1;      // 原始脉冲信号
+
+    // 频段
+    static const unsigned int FREQ_433 = 433;
+    static const unsigned int FREQ_315 = 315;
+
+    // 位域上限
+    static const unsigned int MAX_PROTOCOL = 31;
+    static const unsigned int MAX_BITS = 2047;          // 原始信号的脉冲数也放在这里
+    static const unsigned int MAX_PULSE_LENGTH = 16383;
+
+    RFCode code;                    // 编码值 (原始信号: 数据编号)
+    uint32_t protocol : 5;          // 协议类型 (原始信号: 0)
+    uint32_t band : 1;              // 频段 (0=433MHz, 1=315MHz)
+    uint32_t type : 1;              // 信号类型 (TYPE_CODE/TYPE_RAW)
+    uint32_t bits : 11;             // 位长度 (原始信号: 脉冲数)
+    uint32_t pulseLength : 14;      // 脉宽 (微秒)
+    uint16_t nameId;                // 自定义名称在字符串池中的编号, 0=默认名称
+    uint16_t reserved;
+
+    SignalRecord()
+        : code(), protocol(0), band(0), type(TYPE_CODE), bits(0), pulseLength(0), nameId(0), reserved(0) {}
+
+    unsigned int freq() const {
+        return band ? FREQ_315 : FREQ_433;
+    }
+
+    void setFreq(unsigned int freq) {
+        band = (freq == FREQ_315) ? 1 : 0;
+    }
+
+    /**
+     * 写入数值字段，超出位域的值截到上限
+     */
+    void set(unsigned int newProtocol, unsigned int newBits, unsigned int newPulseLength) {
+        protocol = (newProtocol > MAX_PROTOCOL) ? MAX_PROTOCOL : newProtocol;
+        bits = (newBits > MAX_BITS) ? MAX_BITS : newBits;
+        pulseLength = (newPulseLength > MAX_PULSE_LENGTH) ? MAX_PULSE_LENGTH : newPulseLength;
+    }
+
+    bool isRaw() const {
+        return type == TYPE_RAW;
+    }
+
+    /**
+     * 查重比较: 编码、位数、协议、频段都相同 (不比较脉宽和名称)
+     */
+    bool sameKey(const SignalRecord& other) const {
+        return type == other.type && code == other.code && bits == other.bits &&
+               protocol == other.protocol && band == other.band;
+    }
+};
+
+static_assert(sizeof(SignalRecord) == sizeof(RFCode) + 8, "SignalRecord应为编码加8字节");
+
+#endif // SIGNAL_RECORD_H
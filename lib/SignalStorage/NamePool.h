@@ -0,0 +1,141 @@
+/**
+ * @file NamePool.h
+ * @brief 信号自定义名称的字符串池 (相同名称只保存一份)
+ *
+ * 名称依次以'\0'结尾存放在一块定长缓冲区里，编号为偏移加1 (0表示没有名称)，
+ * 缓冲区整体读写即可持久化。日志压缩时按新日志和上一代日志标记仍在使用的名称，
+ * 其余名称清零 (编号不变，已保存的记录不用改写)，清出的空位留给新名称。
+ * 写满后新名称保存失败，由调用方报告。
+ */
+
+#ifndef NAME_POOL_H
+#define NAME_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class NamePool {
+public:
+    static const size_t CAPACITY = 1024;    // 池大小 (字节)
+    static const size_t MAX_LENGTH = 31;    // 单个名称最大长度 (不含'\0')
+    static const size_t MARK_BYTES = CAPACITY / 8;  // 使用标记 (每个偏移一位)
+
+    NamePool() : _data(), _used(0) {}
+
+    /**
+     * 加入名称，已存在时返回原编号，否则放进第一个放得下的空位或末尾
+     * @param added 输出是否新写入了名称 (可为NULL)
+     * @return 名称编号, 0=空名称或池已满
+     */
+    uint16_t intern(const char* name, bool* added = NULL) {
+        if (added) {
+            *added = false;
+        }
+        if (!name || name[0] == '\0') {
+            return 0;
+        }
+        size_t length = strlen(name);
+        if (length > MAX_LENGTH) {
+            length = MAX_LENGTH;
+        }
+
+        // 清零的名称是一串空字符串，连续length+1个才放得下新名称
+        size_t slot = _used;
+        size_t gapStart = 0;
+        size_t gap = 0;
+        for (size_t offset = 0; offset < _used; offset += strlen(&_data[offset]) + 1) {
+            if (_data[offset] == '\0') {
+                if (gap++ == 0) {
+                    gapStart = offset;
+                }
+                if (gap == length + 1 && slot == _used) {
+                    slot = gapStart;
+                }
+                continue;
+            }
+            gap = 0;
+            if (strncmp(&_data[offset], name, length) == 0 && _data[offset + length] == '\0') {
+                return offset + 1;
+            }
+        }
+
+        if (slot == _used) {
+            if (_used + length + 1 > CAPACITY) {
+                return 0;
+            }
+            _used += length + 1;
+        }
+        memcpy(&_data[slot], name, length);
+        _data[slot + length] = '\0';
+        if (added) {
+            *added = true;
+        }
+        return slot + 1;
+    }
+
+    /**
+     * 按编号取名称
+     * @return 名称, NULL=编号无效或名称已清除
+     */
+    const char* get(uint16_t id) const {
+        if (id == 0 || id > _used || _data[id - 1] == '\0') {
+            return NULL;
+        }
+        return &_data[id - 1];
+    }
+
+    /**
+     * 在标记中登记一个仍在使用的名称编号
+     */
+    static void mark(uint8_t* marks, uint16_t id) {
+        if (id > 0 && id <= CAPACITY) {
+            marks[(id - 1) / 8] |= 1 << ((id - 1) % 8);
+        }
+    }
+
+    /**
+     * 清除没有标记的名称，末尾的空位直接截掉
+     * @param marks MARK_BYTES字节的使用标记
+     * @return 是否清除了名称
+     */
+    bool sweep(const uint8_t* marks) {
+        bool freed = false;
+        size_t end = 0;     // 最后一个保留名称之后的位置
+        for (size_t offset = 0; offset < _used; ) {
+            const size_t length = strlen(&_data[offset]);
+            if (length > 0 && !(marks[offset / 8] & (1 << (offset % 8)))) {
+                memset(&_data[offset], 0, length);
+                freed = true;
+            } else if (length > 0) {
+                end = offset + length + 1;
+            }
+            offset += length + 1;
+        }
+        _used = end;
+        return freed;
+    }
+
+    /**
+     * 从持久化数据恢复 (必须以'\0'结尾)
+     */
+    bool load(const char* data, size_t size) {
+        if (size > CAPACITY || (size > 0 && data[size - 1] != '\0')) {
+            return false;
+        }
+        memcpy(_data, data, size);
+        _used = size;
+        return true;
+    }
+
+    void clear() { _used = 0; }
+
+    const char* data() const { return _data; }
+    size_t size() const { return _used; }
+
+private:
+    char _data[CAPACITY];
+    size_t _used;
+};
+
+#endif // NAME_POOL_H
@@ -0,0 +1,75 @@
+/**
+ * @file SignalCursor.cpp
+ * @brief 信号列表游标实现
+ */
+
+#include "SignalCursor.h"
+#include <esp32-hal-log.h>
+
+static const char* TAG = "SignalCursor";
+
+SignalCursor::SignalCursor(SignalStorage* storage)
+    : _storage(storage)
+    , _window()
+    , _first(0)
+    , _loaded(0)
+    , _generation(0)
+    , _valid(false)
+    , _loadCount(0)
+    , _lastLoadTime(0)
+    , _maxLoadTime(0)
+{
+}
+
+const SignalRecord* SignalCursor::at(int index) {
+    if (index < 0 || index >= count()) {
+        return NULL;
+    }
+
+    if (!_valid || _generation != _storage->getGeneration() ||
+        index < _first || index >= _first + _loaded) {
+        load(index);
+    }
+
+    if (index < _first || index >= _first + _loaded) {
+        return NULL;
+    }
+    return &_window[index - _first];
+}
+
+int SignalCursor::count() {
+    return _storage->getSignalCount();
+}
+
+void SignalCursor::invalidate() {
+    _valid = false;
+}
+
+void SignalCursor::load(int index) {
+    // 按滚动方向预取: 向下翻时窗口大部分放在后面，向上翻时放在前面，
+    // 并保留一屏 (3项) 的余量，首次读取以目标为中心
+    int first;
+    if (!_valid) {
+        first = index - WINDOW_SIZE / 2;
+    } else if (index >= _first + _loaded) {
+        first = index - 2;
+    } else if (index < _first) {
+        first = index - WINDOW_SIZE + 3;
+    } else {
+        first = _first;     // 存储版本变化，原位重读
+    }
+    first = min(first, count() - WINDOW_SIZE);
+    first = max(first, 0);
+
+    unsigned long start = micros();
+    _generation = _storage->getGeneration();
+    _loaded = _storage->loadSignals(first, _window, WINDOW_SIZE);
+    _first = first;
+    _valid = true;
+
+    _lastLoadTime = micros() - start;
+    _maxLoadTime = max(_maxLoadTime, _lastLoadTime);
+    _loadCount++;
+
+    ESP_LOGD(TAG, "读取窗口: %d-%d (%lu us)", _first, _first + _loaded - 1, _lastLoadTime);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file SignalCursor.h
+ * @brief 信号列表游标，只缓存当前可见的一小段信号
+ *
+ * 列表页面按索引取信号，游标在索引超出窗口时重新读取 WINDOW_SIZE 个信号:
+ * 首次读取以目标为中心，之后按滚动方向偏置 (向下翻时目标前留2项、其余
+ * 预取在后面；向上翻时反过来)。存储版本号变化 (保存或删除) 时窗口原位
+ * 重读，页面不需要自己重新加载整个列表。
+ */
+
+#ifndef SIGNAL_CURSOR_H
+#define SIGNAL_CURSOR_H
+
+#include "SignalStorage.h"
+
+class SignalCursor {
+public:
+    static const int WINDOW_SIZE = 8;   // 窗口信号数 (一屏3项，按滚动方向多预取5项)
+
+    SignalCursor(SignalStorage* storage);
+
+    /**
+     * 获取指定索引的信号
+     * @param index 信号索引
+     * @return 信号指针 (下次调用at()前有效), NULL=索引无效或读取失败
+     */
+    const SignalRecord* at(int index);
+
+    /**
+     * 信号总数
+     */
+    int count();
+
+    /**
+     * 丢弃窗口，下次访问时重新读取
+     */
+    void invalidate();
+
+    // ========== 统计 ==========
+    unsigned long getLoadCount() { return _loadCount; }         // 窗口读取次数
+    unsigned long getLastLoadTime() { return _lastLoadTime; }   // 最近一次读取耗时 (微秒)
+    unsigned long getMaxLoadTime() { return _maxLoadTime; }     // 最长读取耗时 (微秒)
+
+private:
+    SignalStorage* _storage;
+    SignalRecord _window[WINDOW_SIZE];
+    int _first;             // 窗口第一个信号的索引
+    int _loaded;            // 窗口中有效信号数
+    uint32_t _generation;   // 读取窗口时的存储版本号
+    bool _valid;
+
+    unsigned long _loadCount;
+    unsigned long _lastLoadTime;
+    unsigned long _maxLoadTime;
+
+    void load(int index);
+};
+
+#endif // SIGNAL_CURSOR_H
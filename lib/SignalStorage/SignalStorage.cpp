@@ -5,18 +5,55 @@
 
 #include "SignalStorage.h"
 #include <LittleFS.h>
-#include <ArduinoJson.h>
 #include <esp32-hal-log.h>
+#include "RawPulse.h"
+#include "Crc32.h"
+#include "SignalJson.h"
 
 static const char* TAG = "Storage";
 
-const char* SignalStorage::STORAGE_FILE = "/signals.json";
+const char* SignalStorage::LOG_FILE = "/signals.dat";
+const char* SignalStorage::LOG_TMP_FILE = "/signals.dat.tmp";
+const char* SignalStorage::LOG_PREV_FILE = "/signals.dat.1";
+const char* SignalStorage::NAMES_FILE = "/names.dat";
+const char* SignalStorage::NAMES_TMP_FILE = "/names.dat.tmp";
+const char* SignalStorage::NAMES_PREV_FILE = "/names.dat.1";
+const char* SignalStorage::LEGACY_LOG_FILE = "/signals.log";
+const char* SignalStorage::LEGACY_JSON_FILE = "/signals.json";
+const char* SignalStorage::RAW_DIR = "/raw";
 
 SignalStorage::SignalStorage()
-    : _signalCount(0)
+    : _entries(NULL)
+    , _capacity(0)
+    , _slots(NULL)
+    , _slotMask(0)
+    , _names()
+    , _cache()
+    , _cacheClock(0)
+    , _cacheHits(0)
+    , _cacheMisses(0)
+    , _pending()
+    , _pendingHead(0)
+    , _pendingCount(0)
+    , _namesDirty(false)
+    , _logTorn(false)
+    , _batchCount(0)
+    , _batchedRecords(0)
+    , _maxBatchTime(0)
+    , _signalCount(0)
+    , _generation(0)
     , _initialized(false)
+    , _nextRawId(1)
+    , _nextId(1)
+    , _deadRecords(0)
+    , _compactionCount(0)
+    , _logGeneration(0)
+    , _namesGeneration(0)
+    , _logNameMarks()
+    , _mutex(NULL)
+    , _writeMutex(NULL)
+    , _storageTaskHandle(NULL)
 {
-    memset(_signals, 0, sizeof(_signals));
 }
 
 bool SignalStorage::begin() {
@@ -29,53 +66,294 @@ bool SignalStorage::begin() {
 
     ESP_LOGI(TAG, "LittleFS挂载成功");
 
-    // 尝试加载已保存的信号
-    if (!loadFromFile()) {
+    if (!LittleFS.exists(RAW_DIR)) {
+        LittleFS.mkdir(RAW_DIR);
+    }
+
+    _mutex = xSemaphoreCreateMutex();
+    _writeMutex = xSemaphoreCreateMutex();
+
+    if (!ensureCapacity()) {
+        ESP_LOGE(TAG, "索引内存分配失败");
+        return false;
+    }
+
+    loadNames();
+
+    // 压缩在两次改名之间掉电: 临时文件已完整同步则用它，否则退回上一代
+    if (!LittleFS.exists(LOG_FILE)) {
+        if (LittleFS.exists(LOG_TMP_FILE) && checkLogFile(LOG_TMP_FILE)) {
+            ESP_LOGW(TAG, "恢复未完成的压缩");
+            LittleFS.rename(LOG_TMP_FILE, LOG_FILE);
+        } else if (LittleFS.exists(LOG_PREV_FILE)) {
+            ESP_LOGW(TAG, "日志丢失，使用上一代日志");
+            LittleFS.rename(LOG_PREV_FILE, LOG_FILE);
+        }
+    }
+    if (LittleFS.exists(LOG_TMP_FILE)) {
+        LittleFS.remove(LOG_TMP_FILE);
+    }
+
+    // 旧格式日志先逐条转换，再按新日志重放
+    if (!LittleFS.exists(LOG_FILE) && LittleFS.exists(LEGACY_LOG_FILE) && migrateLegacyLog()) {
+        ESP_LOGI(TAG, "旧格式日志 %s 已转换", LEGACY_LOG_FILE);
+        saveNames();
+        LittleFS.remove(LEGACY_LOG_FILE);
+    }
+
+    LogState state = LOG_STATE_DIRTY;
+    if (LittleFS.exists(LOG_FILE)) {
+        state = replayLog();
+        if (state == LOG_STATE_INVALID && LittleFS.exists(LOG_PREV_FILE)) {
+            // 文件头或压缩写入的记录区损坏: 这一代不可信，整体退回上一代
+            ESP_LOGE(TAG, "日志损坏，退回上一代日志");
+            LittleFS.remove(LOG_FILE);
+            LittleFS.rename(LOG_PREV_FILE, LOG_FILE);
+            state = replayLog();
+        }
+        if (state == LOG_STATE_INVALID) {
+            ESP_LOGE(TAG, "日志和上一代日志都不可用，从空白开始");
+            _signalCount = 0;
+        }
+    } else if (loadFromJson()) {
+        // 旧版JSON已写成日志，删除JSON
+        ESP_LOGI(TAG, "从 %s 导入 %d 个信号", LEGACY_JSON_FILE, _signalCount);
+        saveNames();
+        LittleFS.remove(LEGACY_JSON_FILE);
+    } else {
         ESP_LOGW(TAG, "无已保存的信号或加载失败，从空白开始");
         _signalCount = 0;
     }
 
-    ESP_LOGI(TAG, "已加载 %d 个信号", _signalCount);
+    // 尾部损坏、没有文件头或刚导入的日志立即重写，之后的追加从干净的边界开始
+    if (state != LOG_STATE_OK) {
+        compact();
+    }
+
+    rebuildIndex();
+
+    // 后台存储任务 (最低优先级，有记录排队或失效记录超过阈值时被唤醒)
+    if (_storageTaskHandle == NULL) {
+        xTaskCreate(
+            storageTask,              // 任务函数
+            "Storage",                // 任务名称
+            4096,                     // 堆栈大小
+            this,                     // 参数
+            1,                        // 优先级
+            &_storageTaskHandle       // 任务句柄
+        );
+    }
+
+    ESP_LOGI(TAG, "已加载 %d 个信号 (失效记录: %d, 索引内存: %d 字节)",
+             _signalCount, _deadRecords, (int)getIndexMemory());
     _initialized = true;
     return true;
 }
 
-bool SignalStorage::saveSignal(const StoredSignal& signal) {
+bool SignalStorage::saveSignal(const SignalRecord& signal, const char* name, SaveError* error) {
+    SaveError dummy;
+    SaveError& result = error ? *error : dummy;
+    result = SAVE_ERROR_FAILED;
     if (!_initialized) {
         ESP_LOGE(TAG, "存储未初始化");
         return false;
     }
 
-    // 检查是否已存在
-    if (signalExists(signal.code)) {
-        ESP_LOGW(TAG, "信号已存在: %lu", signal.code);
+    // 检查是否已存在 (原始信号不按编码去重)
+    char codeText[RFCode::DECIMAL_SIZE];
+    signal.code.toDecimal(codeText, sizeof(codeText));
+
+    if (signal.type == SignalRecord::TYPE_CODE &&
+        signalExists(signal.code, signal.bits, signal.protocol, signal.freq())) {
+        ESP_LOGW(TAG, "信号已存在: %s", codeText);
+        result = SAVE_ERROR_EXISTS;
         return false;
     }
 
+    // 队列满时才在调用方同步写入
+    if (_pendingCount >= WRITE_QUEUE_SIZE) {
+        ESP_LOGW(TAG, "写入队列已满，同步写入");
+        flush();
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
     // 检查是否已满
+    if (!ensureCapacity()) {
+        xSemaphoreGive(_mutex);
+        ESP_LOGW(TAG, "存储已满，最多 %d 个信号", MAX_SIGNALS);
+        result = SAVE_ERROR_FULL;
+        return false;
+    }
+
+    // 只有自定义名称才进名称池，放不下时不保存，由调用方决定怎么处理
+    SignalRecord saved = signal;
+    if (!internName(signal, name, saved.nameId)) {
+        xSemaphoreGive(_mutex);
+        result = SAVE_ERROR_NAMES_FULL;
+        return false;
+    }
+
+    // 记录放进写入队列，索引立即更新
+    const uint32_t id = _nextId;
+    LogRecord record;
+    encodeRecord(SIGNAL_LOG_OP_ADD, id, &saved, record);
+    bool ok = enqueueWrite(record, NULL, 0, false, 0);
+    if (ok) {
+        addToList(saved, id, PENDING_OFFSET);
+        insertSlot(_signalCount - 1);
+        cachePut(id, saved);
+        _generation++;
+    }
+    xSemaphoreGive(_mutex);
+
+    if (ok) {
+        result = SAVE_ERROR_NONE;
+        if (_storageTaskHandle != NULL) {
+            xTaskNotifyGive(_storageTaskHandle);
+        }
+
+        char savedName[32];
+        getSignalName(saved, savedName, sizeof(savedName));
+        ESP_LOGI(TAG, "保存信号: %s (编码:%s)", savedName, codeText);
+    }
+    return ok;
+}
+
+bool SignalStorage::saveRawSignal(unsigned int freq, const uint16_t* words, size_t wordCount, SignalRecord* outSignal) {
+    if (!_initialized) {
+        ESP_LOGE(TAG, "存储未初始化");
+        return false;
+    }
+
+    if (wordCount == 0 || wordCount > MAX_RAW_WORDS) {
+        ESP_LOGW(TAG, "原始数据长度无效: %d", (int)wordCount);
+        return false;
+    }
+
+    if (_pendingCount >= WRITE_QUEUE_SIZE) {
+        ESP_LOGW(TAG, "写入队列已满，同步写入");
+        flush();
+    }
+
+    // 数据文件由存储任务在ADD记录之前写入
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
     if (_signalCount >= MAX_SIGNALS) {
+        xSemaphoreGive(_mutex);
         ESP_LOGW(TAG, "存储已满，最多 %d 个信号", MAX_SIGNALS);
         return false;
     }
+    const unsigned long id = _nextRawId;
+    SignalRecord signal;
+    signal.code = id;
+    signal.setFreq(freq);
+    signal.set(0, RawPulse::countPulses(words, wordCount), 0);
+    signal.type = SignalRecord::TYPE_RAW;
 
-    // 添加信号
-    _signals[_signalCount] = signal;
-    _signalCount++;
+    bool ok = ensureCapacity();
+    if (ok) {
+        const uint32_t recordId = _nextId;
+        LogRecord record;
+        encodeRecord(SIGNAL_LOG_OP_ADD, recordId, &signal, record);
+        ok = enqueueWrite(record, words, wordCount, false, id);
+        if (ok) {
+            addToList(signal, recordId, PENDING_OFFSET);
+            insertSlot(_signalCount - 1);
+            cachePut(recordId, signal);
+            _nextRawId++;
+            _generation++;
+        }
+    }
+    xSemaphoreGive(_mutex);
+
+    if (!ok) {
+        return false;
+    }
+    if (_storageTaskHandle != NULL) {
+        xTaskNotifyGive(_storageTaskHandle);
+    }
+
+    if (outSignal) {
+        *outSignal = signal;
+    }
+
+    ESP_LOGI(TAG, "保存原始信号: %lu (%d 个脉冲, %d 字节)", id, (int)signal.bits, (int)(wordCount * sizeof(uint16_t)));
+    return true;
+}
+
+size_t SignalStorage::loadRawData(const SignalRecord& signal, uint16_t* words, size_t maxWords) {
+    if (!_initialized || signal.type != SignalRecord::TYPE_RAW) {
+        return 0;
+    }
+
+    const unsigned long id = signal.code.low64();
+
+    // 还没写入的数据直接从队列复制
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    size_t count = 0;
+    for (int i = 0; i < _pendingCount; i++) {
+        const PendingWrite& pending = _pending[(_pendingHead + i) % WRITE_QUEUE_SIZE];
+        if (pending.rawWords && pending.rawId == id) {
+            count = (pending.rawCount < maxWords) ? pending.rawCount : maxWords;
+            memcpy(words, pending.rawWords, count * sizeof(uint16_t));
+            break;
+        }
+    }
+    xSemaphoreGive(_mutex);
+    if (count > 0) {
+        return count;
+    }
+
+    char path[24];
+    rawPath(id, path, sizeof(path));
+
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        ESP_LOGE(TAG, "原始数据文件不存在: %s", path);
+        return 0;
+    }
 
-    ESP_LOGI(TAG, "保存信号: %s (编码:%lu)", signal.name, signal.code);
+    size_t bytes = min((size_t)file.size(), maxWords * sizeof(uint16_t));
+    size_t bytesRead = file.read((uint8_t*)words, bytes);
+    file.close();
 
-    // 保存到文件
-    return saveToFile();
+    return bytesRead / sizeof(uint16_t);
 }
 
-int SignalStorage::loadSignals(StoredSignal* signals, int maxCount) {
-    if (!_initialized) return 0;
+int SignalStorage::loadSignals(int first, SignalRecord* signals, int maxCount) {
+    if (!_initialized || first < 0) return 0;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    int count = max(0, min(maxCount, _signalCount - first));
+    File file = LittleFS.open(LOG_FILE, "r");
+    LogRecord record;
+    for (int i = 0; i < count; i++) {
+        // 顺序读取时不经过缓存，避免把热点信号挤出去
+        if (!readEntry(file, first + i, record)) {
+            count = i;
+            break;
+        }
+        decodeRecord(record, signals[i]);
+    }
+    if (file) {
+        file.close();
+    }
 
-    int count = min(maxCount, _signalCount);
-    memcpy(signals, _signals, count * sizeof(StoredSignal));
+    xSemaphoreGive(_mutex);
     return count;
 }
 
+bool SignalStorage::getSignal(int index, SignalRecord& signal) {
+    if (!_initialized) return false;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool ok = (index >= 0 && index < _signalCount) && readSignal(index, signal);
+    xSemaphoreGive(_mutex);
+    return ok;
+}
+
 int SignalStorage::getSignalCount() {
     return _signalCount;
 }
@@ -85,92 +363,983 @@ bool SignalStorage::deleteSignal(int index) {
         return false;
     }
 
-    // 移动后续信号
-    for (int i = index; i < _signalCount - 1; i++) {
-        _signals[i] = _signals[i + 1];
+    if (_pendingCount >= WRITE_QUEUE_SIZE) {
+        ESP_LOGW(TAG, "写入队列已满，同步写入");
+        flush();
+    }
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    SignalRecord signal;
+    if (!readSignal(index, signal)) {
+        xSemaphoreGive(_mutex);
+        return false;
+    }
+
+    // 墓碑放进写入队列: 新增记录和墓碑都成为失效记录，原始数据文件在墓碑写入后删除
+    const uint32_t id = _entries[index].id;
+    LogRecord record;
+    encodeRecord(SIGNAL_LOG_OP_DELETE, id, NULL, record);
+    bool ok = enqueueWrite(record, NULL, 0, signal.type == SignalRecord::TYPE_RAW, signal.code.low64());
+    if (ok) {
+        cacheRemove(id);
+        removeFromList(index);
+        rebuildIndex();
+        _generation++;
+        _deadRecords += 2;
+    }
+
+    xSemaphoreGive(_mutex);
+
+    if (!ok) {
+        ESP_LOGW(TAG, "写入队列已满，删除失败");
+        return false;
     }
-    _signalCount--;
 
     ESP_LOGI(TAG, "删除信号索引: %d", index);
+    if (_storageTaskHandle != NULL) {
+        xTaskNotifyGive(_storageTaskHandle);
+    }
+    return true;
+}
+
+int SignalStorage::findSignal(const RFCode& code, unsigned int bits, unsigned int protocol, unsigned int freq) {
+    if (!_initialized) return -1;
 
-    return saveToFile();
+    const uint32_t hash = keyHash(code, bits, protocol, freq);
+    int found = -1;
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+
+    // 线性探测: 哈希相同时再读出信号确认，不存在的编码通常不需要读日志
+    for (uint32_t slot = hash & _slotMask; _slots[slot] != EMPTY_SLOT; slot = (slot + 1) & _slotMask) {
+        const int index = _slots[slot];
+        if (_entries[index].keyHash != hash) {
+            continue;
+        }
+        SignalRecord signal;
+        if (readSignal(index, signal) && signal.type == SignalRecord::TYPE_CODE && signal.code == code &&
+            signal.bits == bits && signal.protocol == protocol && signal.freq() == freq) {
+            found = index;
+            break;
+        }
+    }
+
+    xSemaphoreGive(_mutex);
+    return found;
 }
 
-bool SignalStorage::signalExists(unsigned long code) {
-    for (int i = 0; i < _signalCount; i++) {
-        if (_signals[i].code == code) {
-            return true;
+bool SignalStorage::signalExists(const RFCode& code, unsigned int bits, unsigned int protocol, unsigned int freq) {
+    return findSignal(code, bits, protocol, freq) >= 0;
+}
+
+size_t SignalStorage::getIndexMemory() {
+    return _capacity * sizeof(IndexEntry) + (_slotMask + 1) * sizeof(uint16_t) + sizeof(_cache);
+}
+
+void SignalStorage::generateName(unsigned int freq, const RFCode& code, char* outName, int maxLen) {
+    char codeText[RFCode::DECIMAL_SIZE];
+    code.toDecimal(codeText, sizeof(codeText));
+    snprintf(outName, maxLen, "%d_%s", freq, codeText);
+}
+
+void SignalStorage::generateRawName(unsigned int freq, unsigned long id, char* outName, int maxLen) {
+    snprintf(outName, maxLen, "RAW_%d_%lu", freq, id);
+}
+
+void SignalStorage::rawPath(unsigned long id, char* outPath, int maxLen) {
+    snprintf(outPath, maxLen, "%s/%lu.bin", RAW_DIR, id);
+}
+
+bool SignalStorage::readRecord(File& file, uint32_t offset, LogRecord& record) {
+    if (!file.seek(offset) ||
+        file.read((uint8_t*)&record, sizeof(record)) != sizeof(record) ||
+        Crc32::compute(&record, offsetof(LogRecord, crc)) != record.crc) {
+        ESP_LOGE(TAG, "日志记录读取失败 (偏移 %u)", (unsigned int)offset);
+        return false;
+    }
+    return true;
+}
+
+bool SignalStorage::readEntry(File& file, int index, LogRecord& record) {
+    if (_entries[index].offset == PENDING_OFFSET) {
+        PendingWrite* pending = findPending(_entries[index].id);
+        if (!pending) {
+            return false;
+        }
+        record = pending->record;
+        return true;
+    }
+    return file && readRecord(file, _entries[index].offset, record);
+}
+
+bool SignalStorage::enqueueWrite(const LogRecord& record, const uint16_t* raw, size_t rawCount,
+                                 bool removeRaw, unsigned long rawId) {
+    if (_pendingCount >= WRITE_QUEUE_SIZE) {
+        return false;
+    }
+
+    PendingWrite& pending = _pending[(_pendingHead + _pendingCount) % WRITE_QUEUE_SIZE];
+    pending.rawWords = NULL;
+    if (raw) {
+        pending.rawWords = (uint16_t*)malloc(rawCount * sizeof(uint16_t));
+        if (!pending.rawWords) {
+            ESP_LOGE(TAG, "原始数据副本分配失败: %d 字", (int)rawCount);
+            return false;
         }
+        memcpy(pending.rawWords, raw, rawCount * sizeof(uint16_t));
+    }
+    pending.record = record;
+    pending.rawCount = rawCount;
+    pending.removeRaw = removeRaw;
+    pending.rawId = rawId;
+    _pendingCount++;
+    return true;
+}
+
+SignalStorage::PendingWrite* SignalStorage::findPending(uint32_t id) {
+    for (int i = 0; i < _pendingCount; i++) {
+        PendingWrite& pending = _pending[(_pendingHead + i) % WRITE_QUEUE_SIZE];
+        if (pending.record.id == id && pending.record.op == SIGNAL_LOG_OP_ADD) {
+            return &pending;
+        }
+    }
+    return NULL;
+}
+
+void SignalStorage::popPending() {
+    PendingWrite& pending = _pending[_pendingHead];
+    free(pending.rawWords);
+    pending.rawWords = NULL;
+    _pendingHead = (_pendingHead + 1) % WRITE_QUEUE_SIZE;
+    _pendingCount--;
+}
+
+bool SignalStorage::flush() {
+    if (!_initialized) {
+        return false;
     }
-    return false;
+
+    xSemaphoreTake(_writeMutex, portMAX_DELAY);
+    bool ok = true;
+    while (_pendingCount > 0 && ok) {
+        ok = writePending();
+    }
+    xSemaphoreGive(_writeMutex);
+    return ok;
 }
 
-void SignalStorage::generateName(unsigned int freq, unsigned long code, char* outName, int maxLen) {
-    snprintf(outName, maxLen, "%d_%lu", freq, code);
+bool SignalStorage::writePending() {
+    // 取一批: 队列中这一段只有本函数会修改，写Flash时不持有_mutex
+    if (_logTorn) {
+        // 上一批没写完: 先把已写入的有效记录重写为新日志，队列之后照常追加
+        _logTorn = !compact();
+        return !_logTorn;
+    }
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    const int count = _pendingCount;
+    if (_namesDirty) {
+        // 名称先于引用它的记录写入
+        saveNames();
+    }
+    xSemaphoreGive(_mutex);
+    if (count == 0) {
+        return true;
+    }
+
+    const unsigned long startTime = micros();
+
+    // 原始数据文件先于ADD记录写入
+    for (int i = 0; i < count; i++) {
+        PendingWrite& pending = _pending[(_pendingHead + i) % WRITE_QUEUE_SIZE];
+        if (pending.rawWords && !writeRawFile(pending.rawId, pending.rawWords, pending.rawCount)) {
+            ESP_LOGE(TAG, "原始数据写入失败: %lu", pending.rawId);
+        }
+    }
+
+    // 整批记录一次打开日志追加
+    File file = LittleFS.open(LOG_FILE, "a");
+    if (!file) {
+        ESP_LOGE(TAG, "无法打开文件写入: %s", LOG_FILE);
+        return false;
+    }
+    const uint32_t firstOffset = file.size();
+    int written = 0;
+    while (written < count) {
+        const PendingWrite& pending = _pending[(_pendingHead + written) % WRITE_QUEUE_SIZE];
+        if (file.write((const uint8_t*)&pending.record, sizeof(pending.record)) != sizeof(pending.record)) {
+            break;
+        }
+        written++;
+    }
+    file.flush();
+    file.close();
+
+    // 写入的记录换成日志偏移 (期间被删除的信号已不在索引中)
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    for (int i = 0; i < written; i++) {
+        const PendingWrite& pending = _pending[_pendingHead];
+        if (pending.record.op == SIGNAL_LOG_OP_ADD) {
+            SignalRecord signal;
+            decodeRecord(pending.record, signal);
+            NamePool::mark(_logNameMarks, signal.nameId);
+            const int index = indexOfId(pending.record.id);
+            if (index >= 0) {
+                _entries[index].offset = firstOffset + i * sizeof(LogRecord);
+            }
+        } else if (pending.removeRaw) {
+            char path[24];
+            rawPath(pending.rawId, path, sizeof(path));
+            LittleFS.remove(path);
+        }
+        popPending();
+    }
+
+    xSemaphoreGive(_mutex);
+
+    bool ok = (written == count);
+    if (!ok) {
+        // 写了一半的记录之后不能再追加: 先重写日志，剩下的队列留给下一批
+        ESP_LOGE(TAG, "日志写入不完整: %d/%d 条，重写日志", written, count);
+        ok = compact();
+        _logTorn = !ok;
+    }
+
+    const unsigned long elapsed = micros() - startTime;
+    if (elapsed > _maxBatchTime) {
+        _maxBatchTime = elapsed;
+    }
+    _batchCount++;
+    _batchedRecords += written;
+    ESP_LOGD(TAG, "写入一批: %d 条记录, %luus", written, elapsed);
+    return ok;
 }
 
-bool SignalStorage::saveToFile() {
-    File file = LittleFS.open(STORAGE_FILE, "w");
+bool SignalStorage::writeRawFile(unsigned long id, const uint16_t* words, size_t wordCount) {
+    char path[24];
+    rawPath(id, path, sizeof(path));
+
+    File file = LittleFS.open(path, "w");
     if (!file) {
-        ESP_LOGE(TAG, "无法打开文件写入: %s", STORAGE_FILE);
+        ESP_LOGE(TAG, "无法打开文件写入: %s", path);
+        return false;
+    }
+    const size_t bytes = wordCount * sizeof(uint16_t);
+    const size_t bytesWritten = file.write((const uint8_t*)words, bytes);
+    file.flush();
+    file.close();
+
+    if (bytesWritten != bytes) {
+        ESP_LOGE(TAG, "原始数据写入不完整: %d/%d", (int)bytesWritten, (int)bytes);
+        LittleFS.remove(path);
         return false;
     }
+    return true;
+}
+
+SignalStorage::LogState SignalStorage::replayLog() {
+    File file = LittleFS.open(LOG_FILE, "r");
+    if (!file) {
+        ESP_LOGD(TAG, "文件不存在: %s", LOG_FILE);
+        return LOG_STATE_INVALID;
+    }
+
+    _signalCount = 0;
+    _deadRecords = 0;
+    memset(_logNameMarks, 0, sizeof(_logNameMarks));
+    LogState state = LOG_STATE_OK;
+    uint32_t offset = 0;
+
+    // 文件头: 没有魔数的是转换或导入时写出的裸记录，重放后立即压缩
+    FileHeader header;
+    uint32_t baseCount = 0;
+    if (file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) && header.magic == LOG_MAGIC) {
+        if (!checkHeader(header, LOG_MAGIC, sizeof(LogRecord))) {
+            ESP_LOGE(TAG, "日志文件头无效 (版本 %d)", header.version);
+            file.close();
+            return LOG_STATE_INVALID;
+        }
+        offset = sizeof(header);
+        baseCount = header.recordCount;
+        _logGeneration = header.generation;
+    } else {
+        file.seek(0);
+        state = LOG_STATE_DIRTY;
+    }
+
+    uint32_t recordIndex = 0;
+    uint32_t baseCrc = Crc32::INITIAL;
+    LogRecord record;
+
+    while (true) {
+        size_t bytesRead = file.read((uint8_t*)&record, sizeof(record));
+        if (bytesRead == 0) {
+            break;
+        }
+        if (bytesRead != sizeof(record) ||
+            Crc32::compute(&record, offsetof(LogRecord, crc)) != record.crc ||
+            (record.op != SIGNAL_LOG_OP_ADD && record.op != SIGNAL_LOG_OP_DELETE)) {
+            ESP_LOGW(TAG, "日志记录损坏 (偏移 %u)，丢弃之后的内容", (unsigned int)offset);
+            state = LOG_STATE_DIRTY;
+            break;
+        }
+
+        // 压缩时写入的记录区整体校验
+        if (recordIndex < baseCount) {
+            baseCrc = Crc32::update(baseCrc, &record, sizeof(record));
+            if (recordIndex + 1 == baseCount && Crc32::finish(baseCrc) != header.dataCrc) {
+                break;
+            }
+        }
+        recordIndex++;
+
+        if (record.id >= _nextId) {
+            _nextId = record.id + 1;
+        }
+
+        if (record.op == SIGNAL_LOG_OP_ADD) {
+            SignalRecord signal;
+            decodeRecord(record, signal);
+            NamePool::mark(_logNameMarks, signal.nameId);
+            if (!ensureCapacity() || !addToList(signal, record.id, offset)) {
+                _deadRecords++;
+            }
+        } else {
+            _deadRecords++;
+            int index = indexOfId(record.id);
+            if (index >= 0) {
+                removeFromList(index);
+                _deadRecords++;
+            }
+        }
+        offset += sizeof(record);
+    }
+    file.close();
 
-    // 创建JSON文档
-    JsonDocument doc;
-    JsonArray arr = doc.to<JsonArray>();
+    if (recordIndex < baseCount || (baseCount > 0 && Crc32::finish(baseCrc) != header.dataCrc)) {
+        ESP_LOGE(TAG, "日志记录区校验失败: %u/%u 条", (unsigned int)recordIndex, (unsigned int)baseCount);
+        _signalCount = 0;
+        _deadRecords = 0;
+        return LOG_STATE_INVALID;
+    }
+    return state;
+}
 
+bool SignalStorage::compact() {
+    // 在锁内取快照: 已写入日志的有效信号的偏移，以及此刻的失效记录数。
+    // 重写期间只有本函数持有_writeMutex，日志不会被追加；新的保存和删除
+    // 照常进入索引和写入队列，压缩完成后再追加到新日志
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    const unsigned int deadAtStart = _deadRecords;
+    uint32_t* offsets = (uint32_t*)malloc((_signalCount > 0 ? _signalCount : 1) * sizeof(uint32_t));
+    int count = 0;
+    for (int i = 0; offsets != NULL && i < _signalCount; i++) {
+        if (_entries[i].offset != PENDING_OFFSET) {
+            offsets[count++] = _entries[i].offset;
+        }
+    }
+    xSemaphoreGive(_mutex);
+    if (!offsets) {
+        ESP_LOGE(TAG, "压缩快照内存分配失败");
+        return false;
+    }
+
+    File source = LittleFS.open(LOG_FILE, "r");
+    if (count > 0 && !source) {
+        ESP_LOGE(TAG, "无法读取日志: %s", LOG_FILE);
+        free(offsets);
+        return false;
+    }
+    File file = LittleFS.open(LOG_TMP_FILE, "w");
+    if (!file) {
+        ESP_LOGE(TAG, "无法打开文件写入: %s", LOG_TMP_FILE);
+        if (source) source.close();
+        free(offsets);
+        return false;
+    }
+
+    // 先占住文件头的位置，记录写完后再回填记录数和CRC
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+
+    // 只复制快照中的ADD记录 (原样复制，CRC不变)，offsets改存记录编号，
+    // 同时标记新日志引用的名称
+    uint8_t nameMarks[NamePool::MARK_BYTES];
+    memset(nameMarks, 0, sizeof(nameMarks));
+    uint32_t dataCrc = Crc32::INITIAL;
+    LogRecord record;
+    SignalRecord signal;
+    for (int i = 0; i < count && ok; i++) {
+        ok = readRecord(source, offsets[i], record) &&
+             file.write((const uint8_t*)&record, sizeof(record)) == sizeof(record);
+        dataCrc = Crc32::update(dataCrc, &record, sizeof(record));
+        offsets[i] = record.id;
+        decodeRecord(record, signal);
+        NamePool::mark(nameMarks, signal.nameId);
+    }
+
+    const uint32_t generation = _logGeneration + 1;
+    if (ok) {
+        makeHeader(LOG_MAGIC, sizeof(LogRecord), generation, count, Crc32::finish(dataCrc), header);
+        ok = file.seek(0) && file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+    }
+    file.flush();
+    if (source) source.close();
+    file.close();
+
+    if (!ok) {
+        ESP_LOGE(TAG, "压缩写入失败");
+        LittleFS.remove(LOG_TMP_FILE);
+        free(offsets);
+        return false;
+    }
+
+    // 替换文件和换偏移在同一次加锁内完成，读取方不会拿新偏移读旧文件。
+    // 重写期间被删除的信号已不在索引中，它的ADD记录连同之后追加的墓碑都是失效记录
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    ok = replaceFile(LOG_TMP_FILE, LOG_FILE, LOG_PREV_FILE);
+    if (ok) {
+        for (int i = 0; i < count; i++) {
+            const int index = indexOfId(offsets[i]);
+            if (index >= 0) {
+                _entries[index].offset = sizeof(FileHeader) + i * sizeof(LogRecord);
+            }
+        }
+        _logGeneration = generation;
+        _deadRecords -= deadAtStart;
+        _compactionCount++;
+
+        // 写入队列中的记录 (包括重写期间保存的) 之后追加到新日志，它们的名称也保留。
+        // 名称池在新日志就位后才清除并写回，任何时刻掉电，正式日志引用的名称都还在
+        for (int i = 0; i < _pendingCount; i++) {
+            const PendingWrite& pending = _pending[(_pendingHead + i) % WRITE_QUEUE_SIZE];
+            if (pending.record.op == SIGNAL_LOG_OP_ADD) {
+                decodeRecord(pending.record, signal);
+                NamePool::mark(nameMarks, signal.nameId);
+            }
+        }
+
+        // 旧日志刚成为上一代，begin()可能退回到它: 它引用的名称这次不清除，
+        // 编号也不会被新名称占用，下一次压缩 (上一代被替换) 后才释放
+        uint8_t keepMarks[NamePool::MARK_BYTES];
+        for (size_t i = 0; i < NamePool::MARK_BYTES; i++) {
+            keepMarks[i] = nameMarks[i] | _logNameMarks[i];
+        }
+        memcpy(_logNameMarks, nameMarks, sizeof(_logNameMarks));
+        if (_names.sweep(keepMarks)) {
+            saveNames();
+        }
+    }
+    const int live = _signalCount;
+    xSemaphoreGive(_mutex);
+    free(offsets);
+
+    if (!ok) {
+        ESP_LOGE(TAG, "压缩替换日志失败");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "日志压缩完成: 第 %u 代, 写入 %d 条记录 (当前 %d 个信号), 清除 %u 条失效记录",
+             (unsigned int)generation, count, live, deadAtStart);
+    return true;
+}
+
+bool SignalStorage::replaceFile(const char* tmpPath, const char* path, const char* prevPath) {
+    // 任一步之后掉电，begin()都能找到完整的文件:
+    // 改名前有原文件，两次改名之间有临时文件和上一代，之后有新文件
+    if (LittleFS.exists(path)) {
+        if (LittleFS.exists(prevPath)) {
+            LittleFS.remove(prevPath);
+        }
+        if (!LittleFS.rename(path, prevPath)) {
+            return false;
+        }
+    }
+    if (!LittleFS.rename(tmpPath, path)) {
+        LittleFS.rename(prevPath, path);
+        return false;
+    }
+    return true;
+}
+
+bool SignalStorage::checkLogFile(const char* path) {
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    FileHeader header;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              checkHeader(header, LOG_MAGIC, sizeof(LogRecord));
+    uint32_t dataCrc = Crc32::INITIAL;
+    LogRecord record;
+    for (uint32_t i = 0; ok && i < header.recordCount; i++) {
+        ok = file.read((uint8_t*)&record, sizeof(record)) == sizeof(record);
+        dataCrc = Crc32::update(dataCrc, &record, sizeof(record));
+    }
+    file.close();
+
+    return ok && Crc32::finish(dataCrc) == header.dataCrc;
+}
+
+void SignalStorage::makeHeader(uint32_t magic, uint16_t recordSize, uint32_t generation,
+                               uint32_t recordCount, uint32_t dataCrc, FileHeader& header) {
+    header.magic = magic;
+    header.version = FORMAT_VERSION;
+    header.recordSize = recordSize;
+    header.generation = generation;
+    header.recordCount = recordCount;
+    header.dataCrc = dataCrc;
+    header.crc = Crc32::compute(&header, offsetof(FileHeader, crc));
+}
+
+bool SignalStorage::checkHeader(const FileHeader& header, uint32_t magic, uint16_t recordSize) {
+    return header.magic == magic &&
+           header.crc == Crc32::compute(&header, offsetof(FileHeader, crc)) &&
+           header.version == FORMAT_VERSION &&
+           header.recordSize == recordSize;
+}
+
+void SignalStorage::storageTask(void* parameter) {
+    SignalStorage* self = static_cast<SignalStorage*>(parameter);
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 等一小段时间，让连续捕获的记录攒成一批
+        vTaskDelay(pdMS_TO_TICKS(COALESCE_MS));
+
+        xSemaphoreTake(self->_writeMutex, portMAX_DELAY);
+        while (self->_pendingCount > 0 && self->writePending()) {
+        }
+
+        // 压缩只在取快照和替换文件时短暂持有_mutex，重写期间界面照常读写
+        xSemaphoreTake(self->_mutex, portMAX_DELAY);
+        const bool compactNow = self->_pendingCount == 0 && self->needsCompaction();
+        xSemaphoreGive(self->_mutex);
+        if (compactNow) {
+            self->compact();
+        }
+        xSemaphoreGive(self->_writeMutex);
+    }
+}
+
+bool SignalStorage::needsCompaction() {
+    return _deadRecords >= COMPACT_MIN_DEAD && _deadRecords >= (unsigned int)_signalCount;
+}
+
+bool SignalStorage::addToList(const SignalRecord& signal, uint32_t id, uint32_t offset) {
+    if (_signalCount >= _capacity) {
+        return false;
+    }
+
+    IndexEntry& entry = _entries[_signalCount];
+    entry.id = id;
+    entry.offset = offset;
+    entry.keyHash = keyHash(signal.code, signal.bits, signal.protocol, signal.freq());
+    _signalCount++;
+
+    if (id >= _nextId) {
+        _nextId = id + 1;
+    }
+
+    const unsigned long rawId = signal.code.low64();
+    if (signal.type == SignalRecord::TYPE_RAW && rawId >= _nextRawId) {
+        _nextRawId = rawId + 1;
+    }
+    return true;
+}
+
+void SignalStorage::removeFromList(int index) {
+    // 移动后续索引项
+    memmove(&_entries[index], &_entries[index + 1], (_signalCount - index - 1) * sizeof(IndexEntry));
+    _signalCount--;
+}
+
+int SignalStorage::indexOfId(uint32_t id) {
+    int low = 0;
+    int high = _signalCount - 1;
+    while (low <= high) {
+        const int mid = (low + high) / 2;
+        if (_entries[mid].id == id) {
+            return mid;
+        }
+        if (_entries[mid].id < id) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+bool SignalStorage::ensureCapacity() {
+    if (_signalCount < _capacity) {
+        return true;
+    }
+    if (_capacity >= MAX_SIGNALS) {
+        return false;
+    }
+
+    int capacity = (_capacity == 0) ? (int)INITIAL_CAPACITY : _capacity * 2;
+    if (capacity > MAX_SIGNALS) {
+        capacity = MAX_SIGNALS;
+    }
+    // 哈希表大小取2的幂，装载率不超过3/4 (倍增到的容量正好是2倍)
+    uint32_t slotCount = 1;
+    while (slotCount * 3 < (uint32_t)capacity * 4) {
+        slotCount <<= 1;
+    }
+
+    IndexEntry* entries = (IndexEntry*)realloc(_entries, capacity * sizeof(IndexEntry));
+    if (!entries) {
+        return false;
+    }
+    _entries = entries;
+
+    uint16_t* slots = (uint16_t*)realloc(_slots, slotCount * sizeof(uint16_t));
+    if (!slots) {
+        return false;
+    }
+    _slots = slots;
+    _slotMask = slotCount - 1;
+    _capacity = capacity;
+
+    rebuildIndex();
+    return true;
+}
+
+void SignalStorage::insertSlot(int index) {
+    uint32_t slot = _entries[index].keyHash & _slotMask;
+    while (_slots[slot] != EMPTY_SLOT) {
+        slot = (slot + 1) & _slotMask;
+    }
+    _slots[slot] = index;
+}
+
+void SignalStorage::rebuildIndex() {
+    memset(_slots, 0xFF, (_slotMask + 1) * sizeof(uint16_t));
     for (int i = 0; i < _signalCount; i++) {
-        JsonObject obj = arr.add<JsonObject>();
-        obj["name"] = _signals[i].name;
-        obj["code"] = _signals[i].code;
-        obj["freq"] = _signals[i].freq;
-        obj["protocol"] = _signals[i].protocol;
-        obj["bits"] = _signals[i].bits;
-        obj["pulse"] = _signals[i].pulseLength;
+        insertSlot(i);
+    }
+}
+
+bool SignalStorage::readSignal(int index, SignalRecord& signal) {
+    const uint32_t id = _entries[index].id;
+
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (_cache[i].id == id) {
+            _cache[i].lastUse = ++_cacheClock;
+            signal = _cache[i].signal;
+            _cacheHits++;
+            return true;
+        }
+    }
+
+    _cacheMisses++;
+    File file = LittleFS.open(LOG_FILE, "r");
+    LogRecord record;
+    bool ok = readEntry(file, index, record);
+    if (file) {
+        file.close();
+    }
+    if (!ok) {
+        return false;
+    }
+
+    decodeRecord(record, signal);
+    cachePut(id, signal);
+    return true;
+}
+
+void SignalStorage::cachePut(uint32_t id, const SignalRecord& signal) {
+    // 替换空位或最久未用的项
+    int victim = 0;
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (_cache[i].id == 0 || _cache[i].id == id) {
+            victim = i;
+            break;
+        }
+        if (_cache[i].lastUse < _cache[victim].lastUse) {
+            victim = i;
+        }
+    }
+    _cache[victim].id = id;
+    _cache[victim].lastUse = ++_cacheClock;
+    _cache[victim].signal = signal;
+}
+
+void SignalStorage::cacheRemove(uint32_t id) {
+    for (int i = 0; i < CACHE_SIZE; i++) {
+        if (_cache[i].id == id) {
+            _cache[i].id = 0;
+            return;
+        }
+    }
+}
+
+uint32_t SignalStorage::keyHash(const RFCode& code, unsigned int bits, unsigned int protocol, unsigned int freq) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    const uint64_t words[3] = {
+        code.low64(),
+        code.high64(),
+        ((uint64_t)freq << 32) | ((uint64_t)protocol << 16) | bits
+    };
+    const uint8_t* bytes = (const uint8_t*)words;
+    for (size_t i = 0; i < sizeof(words); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void SignalStorage::encodeRecord(uint8_t op, uint32_t id, const SignalRecord* signal, LogRecord& record) {
+    memset(&record, 0, sizeof(record));
+    record.op = op;
+    record.id = id;
+    if (signal) {
+        memcpy(record.signal, signal, sizeof(record.signal));
+    }
+    record.crc = Crc32::compute(&record, offsetof(LogRecord, crc));
+}
+
+void SignalStorage::decodeRecord(const LogRecord& record, SignalRecord& signal) {
+    memcpy(&signal, record.signal, sizeof(signal));
+}
+
+void SignalStorage::defaultName(const SignalRecord& signal, char* outName, int maxLen) {
+    if (signal.isRaw()) {
+        generateRawName(signal.freq(), signal.code.low64(), outName, maxLen);
+    } else {
+        generateName(signal.freq(), signal.code, outName, maxLen);
+    }
+}
+
+void SignalStorage::getSignalName(const SignalRecord& signal, char* outName, int maxLen) {
+    const char* name = _names.get(signal.nameId);
+    if (name) {
+        snprintf(outName, maxLen, "%s", name);
+    } else {
+        defaultName(signal, outName, maxLen);
+    }
+}
+
+bool SignalStorage::internName(const SignalRecord& signal, const char* name, uint16_t& nameId) {
+    nameId = 0;
+    if (!name || name[0] == '\0') {
+        return true;
+    }
+
+    char generated[32];
+    defaultName(signal, generated, sizeof(generated));
+    if (strcmp(name, generated) == 0) {
+        return true;
     }
 
-    // 序列化到文件
-    size_t bytesWritten = serializeJson(doc, file);
+    bool added = false;
+    nameId = _names.intern(name, &added);
+    if (nameId == 0) {
+        ESP_LOGW(TAG, "名称池已满: %s", name);
+        return false;
+    }
+    if (added) {
+        _namesDirty = true;
+    }
+    return true;
+}
+
+void SignalStorage::loadNames() {
+    if (loadNamesFrom(NAMES_FILE)) {
+        return;
+    }
+    if (LittleFS.exists(NAMES_PREV_FILE) && loadNamesFrom(NAMES_PREV_FILE)) {
+        ESP_LOGW(TAG, "名称池损坏，使用上一代名称池");
+        return;
+    }
+    if (LittleFS.exists(NAMES_FILE)) {
+        ESP_LOGW(TAG, "名称池损坏，自定义名称恢复为默认名称");
+    }
+    _names.clear();
+}
+
+bool SignalStorage::loadNamesFrom(const char* path) {
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    // 文件头 + 池内容 (记录数为字节数)
+    FileHeader header;
+    char* buffer = NULL;
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              checkHeader(header, NAMES_MAGIC, 1) &&
+              header.recordCount <= NamePool::CAPACITY;
+    if (ok) {
+        const size_t size = header.recordCount;
+        buffer = (char*)malloc(size + 1);
+        ok = buffer != NULL &&
+             file.read((uint8_t*)buffer, size) == size &&
+             Crc32::compute(buffer, size) == header.dataCrc &&
+             _names.load(buffer, size);
+    }
     file.close();
+    free(buffer);
 
-    ESP_LOGD(TAG, "保存 %d 个信号到文件, 写入 %d 字节", _signalCount, bytesWritten);
-    return bytesWritten > 0;
+    if (ok) {
+        _namesGeneration = header.generation;
+    }
+    return ok;
 }
 
-bool SignalStorage::loadFromFile() {
-    File file = LittleFS.open(STORAGE_FILE, "r");
+bool SignalStorage::saveNames() {
+    File file = LittleFS.open(NAMES_TMP_FILE, "w");
     if (!file) {
-        ESP_LOGD(TAG, "文件不存在: %s", STORAGE_FILE);
+        ESP_LOGE(TAG, "无法打开文件写入: %s", NAMES_TMP_FILE);
+        return false;
+    }
+    FileHeader header;
+    makeHeader(NAMES_MAGIC, 1, _namesGeneration + 1, _names.size(),
+               Crc32::compute(_names.data(), _names.size()), header);
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t*)_names.data(), _names.size()) == _names.size();
+    file.flush();
+    file.close();
+
+    if (!ok || !replaceFile(NAMES_TMP_FILE, NAMES_FILE, NAMES_PREV_FILE)) {
+        ESP_LOGE(TAG, "名称池写入失败");
+        LittleFS.remove(NAMES_TMP_FILE);
         return false;
     }
+    _namesGeneration = header.generation;
+    _namesDirty = false;
+    return true;
+}
+
+bool SignalStorage::migrateLegacyLog() {
+    // 旧格式记录 (定长68字节, 名称内嵌)
+    struct __attribute__((packed)) LegacyRecord {
+        uint8_t op;
+        uint8_t type;
+        uint16_t freq;
+        uint32_t id;
+        uint64_t codeLow;
+        uint64_t codeHigh;
+        uint16_t protocol;
+        uint16_t bits;
+        uint16_t pulseLength;
+        uint16_t reserved;
+        char name[32];
+        uint32_t crc;
+    };
 
-    // 解析JSON
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, file);
+    File source = LittleFS.open(LEGACY_LOG_FILE, "r");
+    File file = LittleFS.open(LOG_TMP_FILE, "w");
+    if (!source || !file) {
+        ESP_LOGE(TAG, "无法打开文件写入: %s", LOG_TMP_FILE);
+        if (source) source.close();
+        if (file) file.close();
+        return false;
+    }
+
+    // 逐条转换，记录编号不变，损坏的尾部直接丢弃
+    bool ok = true;
+    LegacyRecord legacy;
+    LogRecord record;
+    while (ok && source.read((uint8_t*)&legacy, sizeof(legacy)) == sizeof(legacy) &&
+           Crc32::compute(&legacy, offsetof(LegacyRecord, crc)) == legacy.crc) {
+        SignalRecord signal;
+        signal.code = RFCode(legacy.codeLow, legacy.codeHigh);
+        signal.setFreq(legacy.freq);
+        signal.set(legacy.protocol, legacy.bits, legacy.pulseLength);
+        signal.type = legacy.type;
+        legacy.name[sizeof(legacy.name) - 1] = '\0';
+        if (!internName(signal, legacy.name, signal.nameId)) {
+            ESP_LOGW(TAG, "名称池已满，信号 %u 使用默认名称", (unsigned int)legacy.id);
+        }
+
+        encodeRecord(legacy.op, legacy.id, (legacy.op == SIGNAL_LOG_OP_ADD) ? &signal : NULL, record);
+        ok = file.write((const uint8_t*)&record, sizeof(record)) == sizeof(record);
+    }
+    source.close();
     file.close();
 
-    if (error) {
-        ESP_LOGE(TAG, "JSON解析失败: %s", error.c_str());
+    if (!ok || !LittleFS.rename(LOG_TMP_FILE, LOG_FILE)) {
+        ESP_LOGE(TAG, "旧格式日志转换失败");
+        LittleFS.remove(LOG_TMP_FILE);
+        return false;
+    }
+    return true;
+}
+
+bool SignalStorage::loadFromJson() {
+    File file = LittleFS.open(LEGACY_JSON_FILE, "r");
+    if (!file) {
+        ESP_LOGD(TAG, "文件不存在: %s", LEGACY_JSON_FILE);
         return false;
     }
 
-    // 读取信号数组
-    JsonArray arr = doc.as<JsonArray>();
+    // 写入临时文件，全部写完后改名为日志
+    File log = LittleFS.open(LOG_TMP_FILE, "w");
+    if (!log) {
+        ESP_LOGE(TAG, "无法打开文件写入: %s", LOG_TMP_FILE);
+        file.close();
+        return false;
+    }
+
+    // 逐个对象解析，不把整个文件读进内存
+    SignalJsonScanner scanner;
+    SignalJson::Entry entry;
     _signalCount = 0;
+    uint32_t offset = 0;
+    unsigned int invalid = 0;
+    bool ok = true;
 
-    for (JsonObject obj : arr) {
-        if (_signalCount >= MAX_SIGNALS) break;
+    uint8_t chunk[64];
+    size_t bytesRead;
+    while (ok && (bytesRead = file.read(chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; ok && i < bytesRead; i++) {
+            if (!scanner.feed((char)chunk[i])) {
+                continue;
+            }
+            if (!SignalJson::parse(scanner.text(), entry)) {
+                invalid++;
+                continue;
+            }
+            if (!ensureCapacity()) {
+                break;
+            }
 
-        const char* name = obj["name"] | "";
-        strncpy(_signals[_signalCount].name, name, sizeof(_signals[0].name) - 1);
-        _signals[_signalCount].code = obj["code"] | 0UL;
-        _signals[_signalCount].freq = obj["freq"] | 433;
-        _signals[_signalCount].protocol = obj["protocol"] | 1;
-        _signals[_signalCount].bits = obj["bits"] | 24;
-        _signals[_signalCount].pulseLength = obj["pulse"] | 350;  // 默认350us
+            SignalRecord& signal = entry.signal;
+            if (!internName(signal, entry.name, signal.nameId)) {
+                ESP_LOGW(TAG, "名称池已满，%s 使用默认名称", entry.name);
+            }
 
-        _signalCount++;
+            const uint32_t id = _nextId;
+            LogRecord record;
+            encodeRecord(SIGNAL_LOG_OP_ADD, id, &signal, record);
+            if (log.write((const uint8_t*)&record, sizeof(record)) != sizeof(record)) {
+                ok = false;
+                break;
+            }
+            addToList(signal, id, offset);
+            offset += sizeof(record);
+        }
+    }
+    file.close();
+    log.close();
+
+    invalid += scanner.getOverflowCount();
+    if (invalid > 0) {
+        ESP_LOGW(TAG, "跳过 %u 个无法解析的信号", invalid);
+    }
+
+    if (!ok || !LittleFS.rename(LOG_TMP_FILE, LOG_FILE)) {
+        ESP_LOGE(TAG, "导入写入失败");
+        LittleFS.remove(LOG_TMP_FILE);
+        _signalCount = 0;
+        return false;
     }
 
     return true;
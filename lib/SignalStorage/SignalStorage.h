@@ -1,26 +1,67 @@
 /**
  * @file SignalStorage.h
- * @brief RF信号存储模块，使用LittleFS + ArduinoJson
+ * @brief RF信号存储模块，使用LittleFS追加日志
+ *
+ * 信号列表保存在 /signals.dat，由定长二进制记录组成，每条记录带CRC32:
+ * 保存追加一条ADD记录，删除追加一条DELETE墓碑，不再整文件重写。
+ * 启动时按顺序重放日志恢复列表，遇到CRC错误或写了一半的记录即停止，
+ * 并立即压缩掉损坏的尾部。失效记录 (墓碑和被删除的信号) 超过阈值后
+ * 由后台存储任务压缩。
+ *
+ * 压缩和名称池都是整文件重写: 先写临时文件并同步到Flash，再把原文件
+ * 改名为 .1 (保留上一代)，最后把临时文件改名为正式文件，任何时刻掉电
+ * 都至少有一份完整的文件。文件开头是带CRC的文件头 (魔数、版本、代数、
+ * 记录数、记录区CRC32)；文件头或压缩时写入的记录区校验失败时，
+ * 退回上一代文件。压缩在锁外写临时文件，期间保存、删除和读取信号都不等待。
+ *
+ * 日志记录直接保存紧凑的SignalRecord。自定义名称单独保存在
+ * /names.dat 的字符串池中，默认名称不保存，显示时重新生成。
+ *
+ * 内存中不再保存完整的信号列表，只保留每个信号的索引项 (记录编号、
+ * 日志偏移、查重键哈希，12字节)，并用开放寻址哈希表 (每项2个2字节槽) 按
+ * (编码, 位数, 协议, 频率) 查重。信号内容按需从日志读取，
+ * 最近用到的少量信号留在LRU缓存中。索引数组按实际数量倍增扩容，
+ * 信号少时占用的内存也少；常驻内存有固定上限: 信号数最多MAX_SIGNALS，
+ * 满容量时索引和哈希表共约75KB (ESP32-C3约400KB内存)。
+ *
+ * 原始脉冲信号的数据较长，单独保存在 /raw/<编号>.bin，
+ * 信号列表中只记录编号和脉冲数
+ *
+ * 写入是延后的: 保存和删除只更新内存中的索引，并把日志记录 (和原始
+ * 数据副本) 放进写入队列后立即返回，界面和接收循环不等待Flash。
+ * 低优先级的存储任务被唤醒后先等一小段时间，把连续捕获的一批记录
+ * 一次追加到日志。尚未写入的信号从队列中读取。休眠、断电或离开
+ * 接收页面前调用flush()把队列写完。
+ *
+ * 旧版本的 /signals.json 和旧格式日志 /signals.log 在首次启动时
+ * 转换为新日志后删除。
  */
 
 #ifndef SIGNAL_STORAGE_H
 #define SIGNAL_STORAGE_H
 
 #include <Arduino.h>
+#include <FS.h>
+#include "SignalRecord.h"
+#include "NamePool.h"
+
+// 日志记录操作
+#define SIGNAL_LOG_OP_ADD       0x41    // 'A' 新增信号
+#define SIGNAL_LOG_OP_DELETE    0x44    // 'D' 删除墓碑
+
+// 保存信号失败的原因
+enum SaveError {
+    SAVE_ERROR_NONE = 0,
+    SAVE_ERROR_EXISTS,          // 相同的信号已存在
+    SAVE_ERROR_FULL,            // 信号数量已满
+    SAVE_ERROR_NAMES_FULL,      // 名称池已满，自定义名称放不下 (信号未保存)
+    SAVE_ERROR_FAILED           // 未初始化、写入队列已满或内存不足
+};
 
 class SignalStorage {
 public:
-    // 存储的信号结构
-    struct StoredSignal {
-        char name[32];          // 显示名称
-        unsigned long code;     // 编码值
-        unsigned int freq;      // 频率 (433/315)
-        unsigned int protocol;  // 协议类型
-        unsigned int bits;      // 位长度
-        unsigned int pulseLength; // 脉宽 (微秒)
-    };
-
-    static const int MAX_SIGNALS = 50;  // 最大保存信号数量
+    static const int MAX_SIGNALS = 5000;    // 最大保存信号数量 (决定索引常驻内存的上限)
+    static const size_t MAX_RAW_WORDS = 1024;  // 原始信号最大字数 (RawPulse编码)
 
     SignalStorage();
 
@@ -33,23 +74,69 @@ public:
     /**
      * 保存信号
      * @param signal 要保存的信号
+     * @param name 自定义名称 (NULL或与默认名称相同时不保存名称)
+     * @param error 输出失败原因 (可为NULL)
+     * @return 是否保存成功
+     */
+    bool saveSignal(const SignalRecord& signal, const char* name = NULL, SaveError* error = NULL);
+
+    /**
+     * 保存原始脉冲信号
+     * @param freq 频率
+     * @param words 脉冲数据 (RawPulse编码)
+     * @param wordCount 字数
+     * @param outSignal 输出保存后的信号记录 (可为NULL)
      * @return 是否保存成功
      */
-    bool saveSignal(const StoredSignal& signal);
+    bool saveRawSignal(unsigned int freq, const uint16_t* words, size_t wordCount, SignalRecord* outSignal = NULL);
+
+    /**
+     * 读取原始信号的脉冲数据
+     * @param signal 信号记录 (TYPE_RAW)
+     * @param words 输出缓冲区
+     * @param maxWords 缓冲区最大字数
+     * @return 读取的字数, 0=失败
+     */
+    size_t loadRawData(const SignalRecord& signal, uint16_t* words, size_t maxWords);
 
     /**
-     * 加载所有信号
+     * 从日志连续读取一段信号 (不经过缓存，列表翻页用)
+     * @param first 第一个信号的索引
      * @param signals 信号数组
      * @param maxCount 最大加载数量
      * @return 实际加载的信号数量
      */
-    int loadSignals(StoredSignal* signals, int maxCount);
+    int loadSignals(int first, SignalRecord* signals, int maxCount);
+
+    /**
+     * 读取指定索引的信号 (缓存未命中时从日志读取)
+     * @param index 信号索引
+     * @param signal 输出信号
+     * @return 是否读取成功
+     */
+    bool getSignal(int index, SignalRecord& signal);
+
+    /**
+     * 把写入队列中的记录全部写入Flash (阻塞，休眠或断电前调用)
+     * @return 是否全部写入成功
+     */
+    bool flush();
+
+    /**
+     * 写入队列中等待写入的记录数
+     */
+    int getPendingWrites() { return _pendingCount; }
 
     /**
      * 获取信号数量
      */
     int getSignalCount();
 
+    /**
+     * 信号列表版本号，保存或删除信号后改变 (列表缓存据此判断是否失效)
+     */
+    uint32_t getGeneration() { return _generation; }
+
     /**
      * 删除指定索引的信号
      * @param index 信号索引
@@ -58,11 +145,16 @@ public:
     bool deleteSignal(int index);
 
     /**
-     * 检查信号是否已存在（根据编码）
-     * @param code 编码值
+     * 查找协议编码信号
+     * @return 信号索引, -1=不存在
+     */
+    int findSignal(const RFCode& code, unsigned int bits, unsigned int protocol, unsigned int freq);
+
+    /**
+     * 检查信号是否已存在（根据编码、位数、协议和频率）
      * @return 是否存在
      */
-    bool signalExists(unsigned long code);
+    bool signalExists(const RFCode& code, unsigned int bits, unsigned int protocol, unsigned int freq);
 
     /**
      * 生成信号名称
@@ -71,24 +163,289 @@ public:
      * @param outName 输出名称缓冲区
      * @param maxLen 缓冲区最大长度
      */
-    static void generateName(unsigned int freq, unsigned long code, char* outName, int maxLen);
+    static void generateName(unsigned int freq, const RFCode& code, char* outName, int maxLen);
+
+    /**
+     * 生成原始信号名称
+     * @param freq 频率
+     * @param id 数据编号
+     * @param outName 输出名称缓冲区
+     * @param maxLen 缓冲区最大长度
+     */
+    static void generateRawName(unsigned int freq, unsigned long id, char* outName, int maxLen);
+
+    /**
+     * 获取信号的显示名称 (自定义名称，没有时生成默认名称)
+     * @param signal 信号记录
+     * @param outName 输出名称缓冲区
+     * @param maxLen 缓冲区最大长度
+     */
+    void getSignalName(const SignalRecord& signal, char* outName, int maxLen);
+
+    // ========== 调试统计 ==========
+    unsigned int getDeadRecordCount() { return _deadRecords; }
+    unsigned long getCompactionCount() { return _compactionCount; }
+    uint32_t getLogGeneration() { return _logGeneration; }     // 日志已压缩的代数
+    unsigned long getCacheHits() { return _cacheHits; }
+    unsigned long getCacheMisses() { return _cacheMisses; }
+    unsigned long getBatchCount() { return _batchCount; }       // 写入批次数
+    unsigned long getBatchedRecords() { return _batchedRecords; }   // 批量写入的记录数
+    unsigned long getMaxBatchTime() { return _maxBatchTime; }   // 单批最长写入时间 (微秒)
+    size_t getIndexMemory();            // 索引、哈希表和缓存占用的内存 (字节)
 
 private:
-    static const char* STORAGE_FILE;
+    // 文件头 (日志和名称池共用)
+    struct __attribute__((packed)) FileHeader {
+        uint32_t magic;         // 文件类型
+        uint16_t version;       // 格式版本
+        uint16_t recordSize;    // 每条记录的字节数
+        uint32_t generation;    // 代数 (每次整文件重写加1)
+        uint32_t recordCount;   // 重写时写入的记录数
+        uint32_t dataCrc;       // 这些记录的CRC32
+        uint32_t crc;           // 文件头前面所有字段的CRC32
+    };
+
+    // 重放日志的结果
+    enum LogState {
+        LOG_STATE_OK = 0,       // 完整
+        LOG_STATE_DIRTY,        // 尾部损坏或没有文件头，需要立即压缩
+        LOG_STATE_INVALID       // 文件头或记录区损坏，需要退回上一代
+    };
+
+    static const uint32_t LOG_MAGIC = 0x4C534652;      // "RFSL"
+    static const uint32_t NAMES_MAGIC = 0x4E534652;    // "RFSN"
+    static const uint16_t FORMAT_VERSION = 1;
+
+    // 日志记录 (定长, 小端, 末尾为前面所有字节的CRC32)
+    struct __attribute__((packed)) LogRecord {
+        uint8_t op;             // SIGNAL_LOG_OP_ADD / SIGNAL_LOG_OP_DELETE
+        uint8_t reserved[3];
+        uint32_t id;            // 信号记录编号 (删除时用来定位)
+        uint8_t signal[sizeof(SignalRecord)];   // SignalRecord原样保存 (删除时为0)
+        uint32_t crc;
+    };
+
+    // 内存中的信号索引项 (按记录编号递增排列)
+    struct IndexEntry {
+        uint32_t id;            // 记录编号
+        uint32_t offset;        // ADD记录在日志中的偏移
+        uint32_t keyHash;       // 查重键哈希
+    };
+
+    // 等待写入Flash的日志记录
+    struct PendingWrite {
+        LogRecord record;
+        uint16_t* rawWords;     // 原始数据副本 (新增原始信号时), 写入后释放
+        uint16_t rawCount;      // 原始数据字数
+        bool removeRaw;         // 写入后删除原始数据文件 (删除原始信号时)
+        unsigned long rawId;    // 原始数据编号
+    };
+
+    // 最近使用的信号缓存
+    struct CacheEntry {
+        uint32_t id;            // 记录编号, 0=空
+        uint32_t lastUse;       // 最近使用序号
+        SignalRecord signal;
+    };
+
+    // 失效记录达到该数量且不少于有效记录时触发压缩
+    static const unsigned int COMPACT_MIN_DEAD = 16;
+
+    static const int INITIAL_CAPACITY = 64;     // 初始索引容量
+    static const int CACHE_SIZE = 16;           // 缓存的信号数量
+    static const uint16_t EMPTY_SLOT = 0xFFFF;      // 哈希表空槽 (槽里存的索引号小于MAX_SIGNALS)
+    static_assert(MAX_SIGNALS < EMPTY_SLOT, "哈希槽的索引号必须放得进16位");
+    static const uint32_t PENDING_OFFSET = 0xFFFFFFFF;  // 记录还在写入队列中
+
+    static const int WRITE_QUEUE_SIZE = 32;     // 写入队列容量
+    static const unsigned long COALESCE_MS = 50;    // 唤醒后等待同一批记录的时间
+
+    static const char* LOG_FILE;
+    static const char* LOG_TMP_FILE;
+    static const char* LOG_PREV_FILE;
+    static const char* NAMES_FILE;
+    static const char* NAMES_TMP_FILE;
+    static const char* NAMES_PREV_FILE;
+    static const char* LEGACY_LOG_FILE;
+    static const char* LEGACY_JSON_FILE;
+    static const char* RAW_DIR;
+
+    /**
+     * 生成原始数据文件路径
+     */
+    static void rawPath(unsigned long id, char* outPath, int maxLen);
 
     /**
-     * 保存所有信号到文件
+     * 从打开的日志读取并校验一条记录
      */
-    bool saveToFile();
+    static bool readRecord(fs::File& file, uint32_t offset, LogRecord& record);
 
     /**
-     * 从文件加载信号
+     * 读取索引项的ADD记录 (需持有_mutex)，还没写入的从写入队列读取
      */
-    bool loadFromFile();
+    bool readEntry(fs::File& file, int index, LogRecord& record);
+
+    /**
+     * 放入写入队列 (需持有_mutex)
+     * @param raw 原始数据 (被复制，可为NULL)
+     * @return false=队列已满或内存不足
+     */
+    bool enqueueWrite(const LogRecord& record, const uint16_t* raw, size_t rawCount, bool removeRaw, unsigned long rawId);
+
+    /**
+     * 按记录编号查找写入队列中的ADD记录
+     * @return 队列项, NULL=不在队列中
+     */
+    PendingWrite* findPending(uint32_t id);
+
+    /**
+     * 把写入队列中当前的记录作为一批写入Flash (需持有_writeMutex，不持有_mutex)
+     */
+    bool writePending();
+
+    /**
+     * 写入原始数据文件
+     */
+    static bool writeRawFile(unsigned long id, const uint16_t* words, size_t wordCount);
+
+    /**
+     * 释放队首记录 (需持有_mutex)
+     */
+    void popPending();
+
+    /**
+     * 重放日志恢复信号列表
+     */
+    LogState replayLog();
+
+    /**
+     * 把已写入日志的有效信号重写为新日志 (需持有_writeMutex，不持有_mutex)
+     *
+     * 临时文件在锁外按快照写出，只有取快照和替换文件、换偏移时加锁；
+     * 写入队列不受影响，之后照常追加到新日志。新日志和写入队列都不再
+     * 引用的名称随后从名称池清除
+     */
+    bool compact();
+
+    /**
+     * 已同步的临时文件替换正式文件，原文件保留为上一代
+     */
+    static bool replaceFile(const char* tmpPath, const char* path, const char* prevPath);
+
+    /**
+     * 检查日志文件头和记录区 (用于判断中断的压缩留下的临时文件是否可用)
+     */
+    static bool checkLogFile(const char* path);
+
+    static void makeHeader(uint32_t magic, uint16_t recordSize, uint32_t generation,
+                           uint32_t recordCount, uint32_t dataCrc, FileHeader& header);
+    static bool checkHeader(const FileHeader& header, uint32_t magic, uint16_t recordSize);
+
+    /**
+     * 从旧版JSON文件逐条导入并写成新日志
+     */
+    bool loadFromJson();
+
+    /**
+     * 把旧格式日志 (每条带32字节名称) 逐条转换为新日志
+     */
+    bool migrateLegacyLog();
+
+    /**
+     * 名称池读写 (整个池写入临时文件后替换)
+     */
+    void loadNames();
+    bool loadNamesFrom(const char* path);
+    bool saveNames();
+
+    /**
+     * 登记自定义名称，没有名称或与默认名称相同时编号为0
+     * @param nameId 输出名称编号
+     * @return false=名称池已满 (nameId为0)
+     */
+    bool internName(const SignalRecord& signal, const char* name, uint16_t& nameId);
+
+    /**
+     * 新增信号到索引 (不写文件，不更新哈希表)
+     */
+    bool addToList(const SignalRecord& signal, uint32_t id, uint32_t offset);
+    void removeFromList(int index);
+
+    /**
+     * 按记录编号查找索引 (二分查找)
+     * @return 索引, -1=不存在
+     */
+    int indexOfId(uint32_t id);
+
+    /**
+     * 确保索引还能再放一个信号，必要时倍增扩容
+     */
+    bool ensureCapacity();
+
+    /**
+     * 哈希表: 插入一个索引 / 全部重建 (删除后索引移动时调用)
+     */
+    void insertSlot(int index);
+    void rebuildIndex();
+
+    /**
+     * 读取信号 (需持有_mutex)，先查缓存再读日志
+     */
+    bool readSignal(int index, SignalRecord& signal);
+
+    void cachePut(uint32_t id, const SignalRecord& signal);
+    void cacheRemove(uint32_t id);
+
+    static uint32_t keyHash(const RFCode& code, unsigned int bits, unsigned int protocol, unsigned int freq);
+
+    /**
+     * 失效记录是否超过阈值
+     */
+    bool needsCompaction();
+
+    static void encodeRecord(uint8_t op, uint32_t id, const SignalRecord* signal, LogRecord& record);
+    static void decodeRecord(const LogRecord& record, SignalRecord& signal);
+    static void defaultName(const SignalRecord& signal, char* outName, int maxLen);
+
+    static void storageTask(void* parameter);
+
+    IndexEntry* _entries;       // 信号索引 (容量_capacity)
+    int _capacity;
+    uint16_t* _slots;           // 哈希表, 存索引号 (2的幂，装载率不超过3/4)
+    uint32_t _slotMask;
+
+    NamePool _names;            // 自定义名称
+
+    CacheEntry _cache[CACHE_SIZE];
+    uint32_t _cacheClock;
+    unsigned long _cacheHits;
+    unsigned long _cacheMisses;
+
+    PendingWrite _pending[WRITE_QUEUE_SIZE];    // 写入队列 (环形)
+    int _pendingHead;
+    volatile int _pendingCount;
+    bool _namesDirty;           // 名称池有新名称还没写入
+    bool _logTorn;              // 日志末尾有写了一半的记录，下一批写入前先重写日志
+    unsigned long _batchCount;
+    unsigned long _batchedRecords;
+    unsigned long _maxBatchTime;
 
-    StoredSignal _signals[MAX_SIGNALS];
     int _signalCount;
+    uint32_t _generation;
     bool _initialized;
+    unsigned long _nextRawId;   // 下一个原始数据编号
+    uint32_t _nextId;           // 下一个记录编号
+    unsigned int _deadRecords;  // 日志中的失效记录数
+    unsigned long _compactionCount;
+    uint32_t _logGeneration;    // 当前日志的代数
+    uint32_t _namesGeneration;  // 当前名称池文件的代数
+    // 当前日志的ADD记录引用的名称 (含已删除的信号): 压缩后这份日志成为上一代，
+    // 它引用的名称保留到下一次压缩，退回上一代时名称不会错乱
+    uint8_t _logNameMarks[NamePool::MARK_BYTES];
+
+    SemaphoreHandle_t _mutex;           // 保护信号列表和写入队列
+    SemaphoreHandle_t _writeMutex;      // 日志追加和压缩互斥 (先取_writeMutex再取_mutex)
+    TaskHandle_t _storageTaskHandle;
 };
 
 #endif // SIGNAL_STORAGE_H
@@ -0,0 +1,452 @@
+/**
+ * @file SignalTransfer.cpp
+ * @brief 串口导出/导入信号库实现
+ */
+
+#include "SignalTransfer.h"
+#include "SignalJson.h"
+#include "RFReceiver.h"
+#include "EdgeTraceRecorder.h"
+#include "Crc32.h"
+#include <esp32-hal-log.h>
+
+static const char* TAG = "SignalTransfer";
+
+static const char* const PREFIX = "RFX ";
+
+SignalTransfer::SignalTransfer(SignalStorage* storage, Stream* stream)
+    : _storage(storage)
+    , _stream(stream)
+    , _receiver(NULL)
+    , _state(STATE_IDLE)
+    , _lineLength(0)
+    , _lineOverflow(false)
+    , _raw(NULL)
+    , _exportIndex(0)
+    , _exportTotal(0)
+    , _exportGeneration(0)
+    , _exportCrc(0)
+    , _lastActivity(0)
+    , _gapReported(false)
+    , _rawSignal()
+    , _rawExpected(0)
+    , _rawReceived(0)
+    , _added(0)
+    , _skipped(0)
+    , _failed(0)
+    , _traceDuration(0)
+    , _traceStartedScan(false)
+    , _traceOffset(0)
+    , _traceLength(0)
+    , _seq(0)
+    , _startTime(0)
+{
+    _line[0] = '\0';
+}
+
+void SignalTransfer::update() {
+    // 读入完整的行再处理，超长行整行丢弃
+    while (_stream->available() > 0) {
+        const int c = _stream->read();
+        if (c < 0) {
+            break;
+        }
+        if (c == '\n') {
+            if (_lineOverflow) {
+                ESP_LOGW(TAG, "丢弃超长行");
+            } else {
+                _line[_lineLength] = '\0';
+                handleLine(_line);
+            }
+            _lineLength = 0;
+            _lineOverflow = false;
+        } else if (c != '\r') {
+            if (_lineLength + 1 < sizeof(_line)) {
+                _line[_lineLength++] = (char)c;
+            } else {
+                _lineOverflow = true;
+            }
+        }
+    }
+
+    if (_state == STATE_EXPORT) {
+        exportStep();
+    } else if (_state == STATE_TRACE || _state == STATE_TRACE_EXPORT) {
+        traceStep();
+    } else if (_state == STATE_IMPORT && millis() - _lastActivity > IMPORT_TIMEOUT) {
+        ESP_LOGW(TAG, "导入超时，已新增 %u 个信号", _added);
+        _storage->flush();
+        _stream->printf("%sERROR timeout\n", PREFIX);
+        finish();
+    }
+}
+
+void SignalTransfer::handleLine(char* line) {
+    if (strncmp(line, PREFIX, strlen(PREFIX)) != 0) {
+        return;
+    }
+    char* command = line + strlen(PREFIX);
+
+    if (_state == STATE_IMPORT) {
+        _lastActivity = millis();
+        if ((command[0] == 'D' || command[0] == 'W') && command[1] == ' ') {
+            handleFrame(command[0], command + 2);
+            return;
+        }
+        if (strncmp(command, "END ", 4) == 0) {
+            finishImport(strtoul(command + 4, NULL, 10));
+            return;
+        }
+    }
+
+    if (strcmp(command, "EXPORT") == 0) {
+        if (start(STATE_EXPORT)) {
+            _exportIndex = 0;
+            _exportTotal = _storage->getSignalCount();
+            _exportGeneration = _storage->getGeneration();
+            _exportCrc = Crc32::INITIAL;
+            _seq = 1;
+            ESP_LOGI(TAG, "开始导出 %d 个信号", _exportTotal);
+            _stream->printf("%sBEGIN %d\n", PREFIX, _exportTotal);
+        }
+    } else if (strcmp(command, "IMPORT") == 0) {
+        if (start(STATE_IMPORT)) {
+            _seq = 1;
+            _gapReported = false;
+            _rawExpected = 0;
+            _added = 0;
+            _skipped = 0;
+            _failed = 0;
+            ESP_LOGI(TAG, "开始导入");
+            _stream->printf("%sREADY %d\n", PREFIX, SignalStorage::MAX_SIGNALS - _storage->getSignalCount());
+        }
+    } else if (strncmp(command, "TRACE ", 6) == 0) {
+        startTrace(strtoul(command + 6, NULL, 10));
+    } else if (strcmp(command, "ABORT") == 0) {
+        if (_state == STATE_IMPORT) {
+            _storage->flush();
+        }
+        finish();
+        _stream->printf("%sABORT\n", PREFIX);
+    }
+}
+
+bool SignalTransfer::start(State state) {
+    if (_state != STATE_IDLE) {
+        _stream->printf("%sERROR busy\n", PREFIX);
+        return false;
+    }
+    // 录制轨迹用自己的缓冲区
+    if (state == STATE_TRACE) {
+        _state = state;
+        _startTime = millis();
+        _lastActivity = _startTime;
+        return true;
+    }
+    _raw = (uint16_t*)malloc(SignalStorage::MAX_RAW_WORDS * sizeof(uint16_t));
+    if (!_raw) {
+        ESP_LOGE(TAG, "原始数据缓冲区分配失败");
+        _stream->printf("%sERROR nomem\n", PREFIX);
+        return false;
+    }
+    _state = state;
+    _startTime = millis();
+    _lastActivity = _startTime;
+    return true;
+}
+
+void SignalTransfer::finish() {
+    if (_state == STATE_TRACE) {
+        stopTrace();
+    }
+    EdgeTraceRecorder::release();
+    free(_raw);
+    _raw = NULL;
+    _state = STATE_IDLE;
+}
+
+// ==================== 导出 ====================
+
+void SignalTransfer::exportStep() {
+    // 导出期间信号列表变化时索引会错位，放弃本次导出
+    if (_storage->getGeneration() != _exportGeneration) {
+        ESP_LOGW(TAG, "导出期间信号列表改变，导出中止");
+        _stream->printf("%sERROR changed\n", PREFIX);
+        finish();
+        return;
+    }
+
+    SignalRecord signals[EXPORT_BATCH];
+    const int count = _storage->loadSignals(_exportIndex, signals, EXPORT_BATCH);
+    if (count == 0) {
+        if (_exportIndex < _exportTotal) {
+            ESP_LOGE(TAG, "读取信号失败: %d", _exportIndex);
+            _stream->printf("%sERROR read\n", PREFIX);
+        } else {
+            ESP_LOGI(TAG, "导出完成: %d 个信号, %lu 帧, %lu ms",
+                     _exportTotal, (unsigned long)(_seq - 1), millis() - _startTime);
+            _stream->printf("%sEND %lu %08lx\n", PREFIX, (unsigned long)(_seq - 1),
+                            (unsigned long)Crc32::finish(_exportCrc));
+        }
+        finish();
+        return;
+    }
+
+    char json[SignalJson::MAX_TEXT];
+    char hex[WORDS_PER_FRAME * 4 + 1];
+    for (int i = 0; i < count; i++) {
+        const SignalRecord& signal = signals[i];
+
+        char name[SignalJson::NAME_SIZE] = "";
+        if (signal.nameId) {
+            _storage->getSignalName(signal, name, sizeof(name));
+        }
+        size_t words = 0;
+        if (signal.isRaw()) {
+            words = _storage->loadRawData(signal, _raw, SignalStorage::MAX_RAW_WORDS);
+        }
+
+        const size_t length = SignalJson::write(signal, name, words, json, sizeof(json));
+        sendFrame('D', json, length);
+
+        for (size_t first = 0; first < words; first += WORDS_PER_FRAME) {
+            const size_t chunk = (words - first < WORDS_PER_FRAME) ? words - first : WORDS_PER_FRAME;
+            for (size_t w = 0; w < chunk; w++) {
+                snprintf(&hex[w * 4], 5, "%04X", _raw[first + w]);
+            }
+            sendFrame('W', hex, chunk * 4);
+        }
+    }
+    _exportIndex += count;
+}
+
+void SignalTransfer::sendFrame(char type, const char* payload, size_t length) {
+    _exportCrc = Crc32::update(_exportCrc, payload, length);
+    _stream->printf("%s%c %lu %08lx ", PREFIX, type, (unsigned long)_seq,
+                    (unsigned long)Crc32::compute(payload, length));
+    _stream->write((const uint8_t*)payload, length);
+    _stream->write('\n');
+    _seq++;
+}
+
+// ==================== 导入 ====================
+
+void SignalTransfer::handleFrame(char type, char* args) {
+    char* end = NULL;
+    const unsigned long seq = strtoul(args, &end, 10);
+    if (*end != ' ') {
+        _stream->printf("%sNAK %lu format\n", PREFIX, (unsigned long)_seq);
+        return;
+    }
+    const unsigned long crc = strtoul(end + 1, &end, 16);
+    if (*end != ' ') {
+        _stream->printf("%sNAK %lu format\n", PREFIX, (unsigned long)_seq);
+        return;
+    }
+    const char* payload = end + 1;
+
+    // 重发的帧已经处理过，只确认
+    if (seq < _seq) {
+        _stream->printf("%sACK %lu\n", PREFIX, seq);
+        return;
+    }
+    // 跳号: 中间的帧丢了，每个缺口只回复一次
+    if (seq > _seq) {
+        if (!_gapReported) {
+            _stream->printf("%sNAK %lu seq\n", PREFIX, (unsigned long)_seq);
+            _gapReported = true;
+        }
+        return;
+    }
+    _gapReported = false;
+
+    if (Crc32::compute(payload, strlen(payload)) != crc) {
+        _stream->printf("%sNAK %lu crc\n", PREFIX, (unsigned long)_seq);
+        return;
+    }
+
+    if (type == 'D') {
+        if (!importRecord(payload)) {
+            // 名称池满: 后面带名称的信号同样放不下，不确认这一帧，直接终止
+            ESP_LOGW(TAG, "名称池已满，导入终止，已新增 %u 个信号", _added);
+            _storage->flush();
+            _stream->printf("%sERROR names\n", PREFIX);
+            finish();
+            return;
+        }
+    } else {
+        importWords(payload);
+    }
+    _stream->printf("%sACK %lu\n", PREFIX, seq);
+    _seq++;
+}
+
+bool SignalTransfer::importRecord(const char* payload) {
+    if (_rawExpected > 0) {
+        ESP_LOGW(TAG, "原始信号数据不完整: %d/%d", (int)_rawReceived, (int)_rawExpected);
+        _rawExpected = 0;
+        _failed++;
+    }
+
+    SignalJson::Entry entry;
+    if (!SignalJson::parse(payload, entry)) {
+        ESP_LOGW(TAG, "无法解析的记录: %s", payload);
+        _failed++;
+        return true;
+    }
+
+    // 原始信号等数据收齐后再保存
+    if (entry.signal.isRaw()) {
+        if (entry.words == 0 || entry.words > SignalStorage::MAX_RAW_WORDS) {
+            _failed++;
+            return true;
+        }
+        _rawSignal = entry.signal;
+        _rawExpected = entry.words;
+        _rawReceived = 0;
+        return true;
+    }
+
+    const SignalRecord& signal = entry.signal;
+    SaveError error = SAVE_ERROR_NONE;
+    if (_storage->signalExists(signal.code, signal.bits, signal.protocol, signal.freq())) {
+        _skipped++;
+    } else if (_storage->saveSignal(signal, entry.name, &error)) {
+        _added++;
+    } else if (error == SAVE_ERROR_NAMES_FULL) {
+        return false;
+    } else {
+        _failed++;
+    }
+    return true;
+}
+
+void SignalTransfer::importWords(const char* payload) {
+    if (_rawExpected == 0) {
+        ESP_LOGW(TAG, "没有对应信号的原始数据帧");
+        return;
+    }
+
+    const size_t length = strlen(payload);
+    bool ok = (length % 4 == 0) && (_rawReceived + length / 4 <= _rawExpected);
+    for (size_t i = 0; ok && i < length; i += 4) {
+        char digits[5];
+        memcpy(digits, &payload[i], 4);
+        digits[4] = '\0';
+        char* end = NULL;
+        _raw[_rawReceived++] = (uint16_t)strtoul(digits, &end, 16);
+        ok = (*end == '\0');
+    }
+    if (!ok) {
+        ESP_LOGW(TAG, "原始数据帧格式错误");
+        _rawExpected = 0;
+        _failed++;
+        return;
+    }
+
+    if (_rawReceived == _rawExpected) {
+        if (_storage->saveRawSignal(_rawSignal.freq(), _raw, _rawReceived)) {
+            _added++;
+        } else {
+            _failed++;
+        }
+        _rawExpected = 0;
+    }
+}
+
+void SignalTransfer::finishImport(unsigned long frames) {
+    // 结尾之前还有帧没收到，让主机补发
+    if (frames != _seq - 1) {
+        _stream->printf("%sNAK %lu end\n", PREFIX, (unsigned long)_seq);
+        return;
+    }
+    if (_rawExpected > 0) {
+        _rawExpected = 0;
+        _failed++;
+    }
+
+    _storage->flush();
+    ESP_LOGI(TAG, "导入完成: 新增 %u, 已存在 %u, 失败 %u, %lu ms",
+             _added, _skipped, _failed, millis() - _startTime);
+    _stream->printf("%sDONE %u %u %u\n", PREFIX, _added, _skipped, _failed);
+    finish();
+}
+
+// ==================== 边沿轨迹 ====================
+
+void SignalTransfer::startTrace(unsigned long durationMs) {
+    if (_receiver == NULL) {
+        _stream->printf("%sERROR unsupported\n", PREFIX);
+        return;
+    }
+    if (durationMs == 0 || durationMs > MAX_TRACE_MS) {
+        _stream->printf("%sERROR range\n", PREFIX);
+        return;
+    }
+    if (!start(STATE_TRACE)) {
+        return;
+    }
+    if (!EdgeTraceRecorder::start(TRACE_BUFFER_SIZE)) {
+        _stream->printf("%sERROR nomem\n", PREFIX);
+        finish();
+        return;
+    }
+
+    _traceDuration = durationMs;
+    _traceStartedScan = !_receiver->isScanning();
+    if (_traceStartedScan) {
+        _receiver->startScanning();
+    }
+    _receiver->setEdgeTap(EdgeTraceRecorder::record);
+    ESP_LOGI(TAG, "开始录制边沿轨迹 %lu ms", durationMs);
+    _stream->printf("%sRECORDING %lu\n", PREFIX, durationMs);
+}
+
+void SignalTransfer::stopTrace() {
+    // 解码任务优先级高于主循环，运行到这里时它不会停在回调中间
+    _receiver->setEdgeTap(NULL);
+    EdgeTraceRecorder::stop();
+    if (_traceStartedScan) {
+        _receiver->stopScanning();
+        _traceStartedScan = false;
+    }
+}
+
+void SignalTransfer::traceStep() {
+    if (_state == STATE_TRACE) {
+        // 到时、缓冲区满或扫描被别处关掉都结束录制
+        if (millis() - _startTime < _traceDuration && !EdgeTraceRecorder::isFull() &&
+            _receiver->isScanning()) {
+            return;
+        }
+        stopTrace();
+        EdgeTraceRecorder::getData(_traceLength);
+        _traceOffset = 0;
+        _exportCrc = Crc32::INITIAL;
+        _seq = 1;
+        _state = STATE_TRACE_EXPORT;
+        _stream->printf("%sBEGIN %lu\n", PREFIX, (unsigned long)_traceLength);
+    }
+
+    size_t length = 0;
+    const uint8_t* data = EdgeTraceRecorder::getData(length);
+    char hex[TRACE_BYTES_PER_FRAME * 2 + 1];
+    for (int i = 0; i < EXPORT_BATCH && _traceOffset < _traceLength; i++) {
+        const size_t remaining = _traceLength - _traceOffset;
+        const size_t chunk = (remaining < TRACE_BYTES_PER_FRAME) ? remaining : TRACE_BYTES_PER_FRAME;
+        for (size_t b = 0; b < chunk; b++) {
+            snprintf(&hex[b * 2], 3, "%02X", data[_traceOffset + b]);
+        }
+        sendFrame('T', hex, chunk * 2);
+        _traceOffset += chunk;
+    }
+
+    if (_traceOffset >= _traceLength) {
+        ESP_LOGI(TAG, "轨迹发送完成: %lu 个边沿, %lu 字节, %lu 帧",
+                 EdgeTraceRecorder::getEdgeCount(), (unsigned long)_traceLength,
+                 (unsigned long)(_seq - 1));
+        _stream->printf("%sEND %lu %08lx\n", PREFIX, (unsigned long)(_seq - 1),
+                        (unsigned long)Crc32::finish(_exportCrc));
+        finish();
+    }
+}
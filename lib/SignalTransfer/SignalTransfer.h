@@ -0,0 +1,138 @@
+/**
+ * @file SignalTransfer.h
+ * @brief 通过串口导出/导入信号库 (备份和批量烧录)
+ *
+ * 逐条处理: 导出时每次从日志读几条、写成JSON发出；导入时每收到一帧
+ * 就解析并保存。只用固定大小的行缓冲区和一块原始数据缓冲区，
+ * 占用的内存与信号数量无关。
+ *
+ * 协议为文本行，以 "RFX " 开头，其他行 (例如日志输出) 忽略:
+ *
+ *   主机 -> 设备                设备 -> 主机
+ *   RFX EXPORT                  RFX BEGIN <信号数>
+ *                               RFX D <序号> <CRC> <JSON>   每个信号一帧
+ *                               RFX W <序号> <CRC> <HEX>    原始数据, 每帧最多64字
+ *                               RFX END <帧数> <CRC>        CRC为所有帧内容的CRC32
+ *   RFX IMPORT                  RFX READY <剩余容量>
+ *   RFX D/W <序号> <CRC> ...    RFX ACK <序号> / RFX NAK <期望序号> <原因>
+ *   RFX END <帧数>              RFX DONE <新增> <已存在> <失败>
+ *                               RFX ERROR names             名称池已满，导入终止
+ *   RFX ABORT                   RFX ABORT
+ *   RFX TRACE <毫秒>            RFX RECORDING <毫秒>        录制接收边沿 (见EdgeTrace.h)
+ *                               RFX BEGIN <字节数>          录制结束
+ *                               RFX T <序号> <CRC> <HEX>    轨迹数据, 每帧最多128字节
+ *                               RFX END <帧数> <CRC>
+ *
+ * 帧的CRC是内容部分的CRC32 (8位十六进制)。导入时序号从1开始连续递增，
+ * 主机可以连发几帧再等确认；收到CRC错误或跳号时设备回复NAK和期望的
+ * 序号，主机从该序号重发，已处理过的序号只确认不重复保存。
+ * 原始信号的JSON中 "words" 给出数据字数，数据紧跟在后面的W帧中，
+ * 每个字为4位十六进制 (RawPulse编码)。
+ * 录制期间接收机临时打开扫描 (原本关着的结束后关回)，轨迹数据是完整的
+ * EdgeTrace文件 (含文件头)，按帧顺序拼接即可。
+ */
+
+#ifndef SIGNAL_TRANSFER_H
+#define SIGNAL_TRANSFER_H
+
+#include <Arduino.h>
+#include "SignalStorage.h"
+
+class RFReceiver;
+
+class SignalTransfer {
+public:
+    static const size_t LINE_SIZE = 320;            // 一行的最大长度
+    static const int EXPORT_BATCH = 8;              // 每次update()导出的信号数
+    static const size_t WORDS_PER_FRAME = 64;       // 每个W帧的原始数据字数
+    static const unsigned long IMPORT_TIMEOUT = 10000;  // 导入时无数据超时 (毫秒)
+    static const size_t TRACE_BUFFER_SIZE = 16384;  // 轨迹录制缓冲区 (字节)
+    static const size_t TRACE_BYTES_PER_FRAME = 128;    // 每个T帧的轨迹字节数
+    static const unsigned long MAX_TRACE_MS = 60000;    // 最长录制时间 (毫秒)
+
+    SignalTransfer(SignalStorage* storage, Stream* stream);
+
+    /**
+     * 设置录制边沿轨迹用的接收模块 (不设置时不支持TRACE)
+     */
+    void setReceiver(RFReceiver* receiver) { _receiver = receiver; }
+
+    /**
+     * 处理串口输入，继续进行中的导出 (主循环调用)
+     */
+    void update();
+
+    /**
+     * 是否正在导出、导入或录制
+     */
+    bool isBusy() const { return _state != STATE_IDLE; }
+
+private:
+    enum State {
+        STATE_IDLE = 0,
+        STATE_EXPORT,
+        STATE_IMPORT,
+        STATE_TRACE,            // 录制中
+        STATE_TRACE_EXPORT      // 发送轨迹
+    };
+
+    SignalStorage* _storage;
+    Stream* _stream;
+    RFReceiver* _receiver;
+    State _state;
+
+    // 输入行
+    char _line[LINE_SIZE];
+    size_t _lineLength;
+    bool _lineOverflow;
+
+    // 原始数据缓冲区 (导出或导入期间分配)
+    uint16_t* _raw;
+
+    // 导出
+    int _exportIndex;
+    int _exportTotal;
+    uint32_t _exportGeneration;
+    uint32_t _exportCrc;        // 所有帧内容的CRC
+
+    // 导入
+    unsigned long _lastActivity;
+    bool _gapReported;          // 跳号已回复过NAK
+    SignalRecord _rawSignal;    // 正在接收数据的原始信号
+    size_t _rawExpected;
+    size_t _rawReceived;
+    unsigned int _added;
+    unsigned int _skipped;
+    unsigned int _failed;
+
+    // 轨迹
+    unsigned long _traceDuration;
+    bool _traceStartedScan;     // 扫描是录制时打开的
+    size_t _traceOffset;        // 已发送的字节数
+    size_t _traceLength;
+
+    uint32_t _seq;              // 导出: 下一个发出的序号; 导入: 期望的序号
+    unsigned long _startTime;
+
+    void handleLine(char* line);
+    bool start(State state);
+    void finish();
+
+    void exportStep();
+    void sendFrame(char type, const char* payload, size_t length);
+
+    void handleFrame(char type, char* args);
+    /**
+     * 保存一条记录
+     * @return false=名称池已满，导入应终止
+     */
+    bool importRecord(const char* payload);
+    void importWords(const char* payload);
+    void finishImport(unsigned long frames);
+
+    void startTrace(unsigned long durationMs);
+    void stopTrace();
+    void traceStep();
+};
+
+#endif // SIGNAL_TRANSFER_H
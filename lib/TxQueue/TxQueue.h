@@ -0,0 +1,200 @@
+/**
+ * @file TxQueue.h
+ * @brief 有界的发送任务队列 (按优先级出队，可按编号取消，可定时重复)
+ *
+ * 队列本身不加锁，时钟在构造时注入 (固件用micros())，并发访问由
+ * RFTransmitter用互斥锁保护，因此可以在主机上用假时钟单独验证排队语义。
+ * 重复发送的任务每播完一次由发送任务放回队列，间隔到了才能再次出队。
+ */
+
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "SignalRecord.h"
+
+/**
+ * 队列时钟 (微秒)
+ */
+typedef unsigned long (*TxClock)();
+
+// 发送优先级
+enum TxPriority {
+    TX_PRIORITY_NORMAL = 0,     // 普通发送，按先后顺序
+    TX_PRIORITY_URGENT = 1      // 紧急发送，插到所有普通任务之前
+};
+
+// 发送任务
+struct TxJob {
+    uint32_t id;                // 任务编号 (从1开始，0表示无效)
+    uint8_t priority;           // TxPriority
+    SignalRecord signal;        // 信号 (脉宽为0时使用协议默认值; 原始信号只用频段)
+    uint16_t* rawWords;         // 原始脉冲数据 (RawPulse编码，任务持有的副本)
+    size_t rawCount;            // 原始数据字数
+    uint16_t repeats;           // 播完后还要再发几次 (0=只发一次)
+    unsigned long intervalUs;   // 重复发送的间隔 (从上一次播完算起，微秒)
+    unsigned long queuedAt;     // 入队时间 (重复发送时为本次可以出队的时间，微秒)
+};
+
+// 发送结果
+enum TxResult {
+    TX_RESULT_DONE = 0,         // 发送完成
+    TX_RESULT_CANCELLED,        // 被取消
+    TX_RESULT_FAILED            // 发送失败 (程序过长、频率未知等)
+};
+
+// 单个任务的耗时统计
+struct TxJobStats {
+    uint32_t id;
+    unsigned int freq;
+    uint8_t result;             // TxResult
+    unsigned long queueWait;    // 排队等待时间 (重复发送时为最后一次，微秒)
+    unsigned long duration;     // 发送耗时 (重复发送时为最后一次，微秒)
+};
+
+template <unsigned int CAPACITY>
+class TxQueue {
+public:
+    // nextDelay()在队列为空时的返回值
+    static const unsigned long NEVER = ~0UL;
+
+    explicit TxQueue(TxClock clock) : _clock(clock), _jobs(), _count(0), _nextId(1) {}
+
+    /**
+     * 入队，立即可以出队
+     * @param job 任务 (id和queuedAt由队列填写)
+     * @return 任务编号, 0=队列已满
+     */
+    uint32_t push(const TxJob& job) {
+        if (_count >= CAPACITY) {
+            return 0;
+        }
+
+        const uint32_t id = _nextId;
+        _nextId++;
+        if (_nextId == 0) {
+            _nextId = 1;    // 0保留为无效编号
+        }
+        insert(job, id, _clock());
+        return id;
+    }
+
+    /**
+     * 重复发送: 播完一次的任务放回队列 (编号不变，repeats减一)，
+     * intervalUs之后才能再次出队
+     * @return false=没有剩余次数或队列已满 (任务到此结束)
+     */
+    bool reschedule(const TxJob& job) {
+        if (job.repeats == 0 || _count >= CAPACITY) {
+            return false;
+        }
+        TxJob next = job;
+        next.repeats--;
+        insert(next, job.id, _clock() + job.intervalUs);
+        return true;
+    }
+
+    /**
+     * 取出已经到时间的任务中优先级最高的一个 (同优先级先入队的先出)
+     * @return false=队列为空或都还没到时间
+     */
+    bool pop(TxJob& job) {
+        const unsigned long now = _clock();
+        for (unsigned int i = 0; i < _count; i++) {
+            if (isReady(_jobs[i], now)) {
+                job = _jobs[i];
+                removeAt(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * 取出第一个任务，不管是否到时间 (全部取消时用)
+     * @return false=队列为空
+     */
+    bool popAny(TxJob& job) {
+        if (_count == 0) {
+            return false;
+        }
+        job = _jobs[0];
+        removeAt(0);
+        return true;
+    }
+
+    /**
+     * 距离下一个任务可以出队还有多久 (微秒)
+     * @return 0=已有任务可以出队, NEVER=队列为空
+     */
+    unsigned long nextDelay() const {
+        const unsigned long now = _clock();
+        unsigned long delay = NEVER;
+        for (unsigned int i = 0; i < _count; i++) {
+            if (isReady(_jobs[i], now)) {
+                return 0;
+            }
+            const unsigned long wait = _jobs[i].queuedAt - now;
+            if (wait < delay) {
+                delay = wait;
+            }
+        }
+        return delay;
+    }
+
+    /**
+     * 按编号移除排队中的任务
+     * @param id 任务编号
+     * @param job 输出被移除的任务 (调用方负责释放原始数据)
+     * @return false=不在队列中
+     */
+    bool remove(uint32_t id, TxJob& job) {
+        for (unsigned int i = 0; i < _count; i++) {
+            if (_jobs[i].id == id) {
+                job = _jobs[i];
+                removeAt(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    unsigned int size() const { return _count; }
+    bool empty() const { return _count == 0; }
+    bool full() const { return _count >= CAPACITY; }
+
+private:
+    TxClock _clock;
+    TxJob _jobs[CAPACITY];
+    unsigned int _count;
+    uint32_t _nextId;
+
+    // queuedAt不晚于now (按差值比较，micros()回绕后仍然正确)
+    static bool isReady(const TxJob& job, unsigned long now) {
+        return (long)(now - job.queuedAt) >= 0;
+    }
+
+    void insert(const TxJob& job, uint32_t id, unsigned long readyAt) {
+        // 同优先级按先后顺序: 插到最后一个不低于自身优先级的任务之后
+        unsigned int pos = _count;
+        while (pos > 0 && _jobs[pos - 1].priority < job.priority) {
+            _jobs[pos] = _jobs[pos - 1];
+            pos--;
+        }
+
+        _jobs[pos] = job;
+        _jobs[pos].id = id;
+        _jobs[pos].queuedAt = readyAt;
+        _count++;
+    }
+
+    void removeAt(unsigned int index) {
+        for (unsigned int i = index; i + 1 < _count; i++) {
+            _jobs[i] = _jobs[i + 1];
+        }
+        _count--;
+    }
+};
+
+#endif // TX_QUEUE_H
@@ -0,0 +1,88 @@
+/**
+ * @file FS.h
+ * @brief native环境的Arduino文件系统接口 (fs::FS / fs::File)
+ *
+ * File包装主机的FILE*，拷贝共享同一个打开的文件，和arduino-esp32一样
+ * 最后一个副本析构时关闭。
+ */
+
+#ifndef HAL_FS_H
+#define HAL_FS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet = 0,
+    SeekCur = 1,
+    SeekEnd = 2
+};
+
+class File {
+public:
+    File() {}
+    File(FILE* handle, const char* path);
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size);
+    int read();
+    size_t read(uint8_t* buffer, size_t size);
+    int available();
+    void flush();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    const char* path() const;
+
+    operator bool() const { return _handle && _handle->file; }
+
+private:
+    struct Handle {
+        FILE* file;
+        std::string path;
+        ~Handle();
+    };
+
+    std::shared_ptr<Handle> _handle;
+};
+
+class FS {
+public:
+    virtual ~FS() {}
+
+    /**
+     * 打开文件
+     * @param mode "r" / "w" / "a" (可带 "+")
+     */
+    File open(const char* path, const char* mode = "r");
+    File open(const std::string& path, const char* mode = "r") { return open(path.c_str(), mode); }
+
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* pathFrom, const char* pathTo);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+
+protected:
+    /**
+     * 固件路径 ("/signals.log") 对应的主机路径
+     */
+    virtual std::string hostPath(const char* path) const = 0;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif // HAL_FS_H
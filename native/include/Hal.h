@@ -0,0 +1,152 @@
+/**
+ * @file Hal.h
+ * @brief 主机 (native) 环境的硬件模拟接口
+ *
+ * native环境下固件源码不变，Arduino/FreeRTOS/ESP-IDF/LittleFS/U8g2
+ * 的头文件由native/include提供，实现在native/src中:
+ *   GPIO和中断  - 引脚电平保存在内存里，setInput()按中断模式调用ISR
+ *   时间        - 默认取系统单调时钟；手动时钟下只在setMicros()时前进，
+ *                 delay()/delayMicroseconds()直接推进时钟，可以全速回放
+ *   任务        - FreeRTOS任务、通知、互斥量、队列、事件组用std::thread实现
+ *   LittleFS    - 映射到主机目录 (默认 ./littlefs，可用环境变量RF_REMOTE_FS改)
+ *   显示屏      - 模拟SSD1306显存，解析U8x8经I2C发出的命令和数据
+ *   RMT         - 记录每个通道最后一次播放的程序，在后台线程中按条目时长
+ *                 驱动输出引脚 (手动时钟下直接推进时钟)，播完后回调
+ *
+ * 本文件只给模拟程序和基准测试使用，固件源码不包含它。
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+namespace Hal {
+
+// ==================== 时间 ====================
+
+/**
+ * 切换到手动时钟 (micros()从startUs开始，只由setMicros()/advanceMicros()推进)
+ */
+void useManualClock(uint64_t startUs = 0);
+
+/**
+ * 切回系统单调时钟
+ */
+void useRealClock();
+
+bool isManualClock();
+void setMicros(uint64_t us);
+void advanceMicros(uint64_t us);
+
+// ==================== GPIO ====================
+
+/**
+ * 外部驱动输入引脚 (模拟接收模块、按键)
+ * 电平变化时按attachInterrupt()的模式调用ISR (在调用线程中执行)
+ */
+void setInput(uint8_t pin, int level);
+
+/**
+ * 读取引脚电平 (输出引脚为digitalWrite()写入的值)
+ */
+int getLevel(uint8_t pin);
+
+/**
+ * ISR被调用的次数 (所有引脚)
+ */
+uint32_t getInterruptCalls();
+
+/**
+ * 输出引脚电平变化的监听回调 (digitalWrite()和RMT播放都会调用，
+ * 在写入的线程中执行，可以在回调里setInput()把输出环回到输入)
+ * @param atUs 变化时的micros()
+ */
+typedef void (*OutputTap)(uint8_t pin, int level, unsigned long atUs);
+void setOutputTap(OutputTap tap);
+
+/**
+ * 设置analogRead()/analogReadMilliVolts()读到的电压
+ */
+void setAnalogMillivolts(uint8_t pin, uint32_t millivolts);
+
+// ==================== 浅睡眠 ====================
+
+/**
+ * 主循环是否正在esp_light_sleep_start()里 (真实硬件上此时所有任务都停着)
+ */
+bool isLightSleeping();
+
+/**
+ * 进入浅睡眠的次数
+ */
+uint32_t getLightSleepCount();
+
+// ==================== 串口 ====================
+
+/**
+ * Serial从标准输入读取 (后台线程)，输出始终写到标准输出
+ */
+void attachSerialStdin();
+
+// ==================== 文件系统 ====================
+
+/**
+ * LittleFS映射的主机目录 (begin()之前调用)
+ */
+void setFsRoot(const char* dir);
+const char* getFsRoot();
+
+/**
+ * 文件系统写操作的监听回调 (打开写入、写入、改名、删除之前调用，
+ * 在执行操作的线程中)。返回false时该操作失败且不改动文件，
+ * 用来模拟慢速Flash、写入失败和掉电
+ * @param op 操作: "open" "write" "rename" "remove"
+ * @param path 文件路径 (改名时为原路径)
+ */
+typedef bool (*FsTap)(const char* op, const char* path);
+void setFsTap(FsTap tap);
+
+// ==================== 显示屏 ====================
+
+static const int SCREEN_WIDTH = 128;
+static const int SCREEN_PAGES = 8;
+
+/**
+ * 模拟SSD1306显存 (8页 x 128列，每字节竖向8像素，低位在上)
+ */
+const uint8_t* screen();
+
+/**
+ * 显示屏收到的显存数据字节数和I2C写次数 (含命令)
+ */
+uint32_t getScreenDataBytes();
+uint32_t getScreenWrites();
+void resetScreenStats();
+
+/**
+ * 把显存画成字符画 (每行字符对应两行像素)
+ */
+void dumpScreen(FILE* out);
+
+// ==================== RMT ====================
+
+/**
+ * 通道最后一次播放的程序 (rmt_item32_t，与PulseStep位布局相同)
+ * @param count 输出条目数
+ */
+const uint32_t* getRmtItems(int channel, size_t& count);
+
+// ==================== 日志 ====================
+
+/**
+ * 运行时日志级别 (0=关闭 ... 5=Verbose)，不超过编译时的CORE_DEBUG_LEVEL
+ */
+void setLogLevel(int level);
+int getLogLevel();
+
+} // namespace Hal
+
+#endif // HAL_H
@@ -0,0 +1,38 @@
+/**
+ * @file LittleFS.h
+ * @brief native环境的LittleFS，映射到主机目录 (见Hal::setFsRoot())
+ */
+
+#ifndef HAL_LITTLEFS_H
+#define HAL_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+    LittleFSFS() : _mounted(false) {}
+
+    /**
+     * 挂载 (目录不存在时formatOnFail为true则创建)
+     */
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+               uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+    void end() { _mounted = false; }
+    bool format();
+    size_t totalBytes();
+    size_t usedBytes();
+
+protected:
+    std::string hostPath(const char* path) const override;
+
+private:
+    bool _mounted;
+};
+
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // HAL_LITTLEFS_H
@@ -0,0 +1,142 @@
+/**
+ * @file U8g2lib.h
+ * @brief native环境的U8g2 (SSD1306 128x64全缓冲)
+ *
+ * 缓冲区布局和U8g2相同 (8个tile行，每行128字节，每字节竖向8像素)，
+ * 所以TileDiff、Display的帧缓冲区都能原样使用。
+ *
+ * 字体只模拟度量: ASCII用内置的5x7点阵 (按字体放大和加宽)，
+ * 中文画成方框；文字只画前景像素 (相当于setFontMode(1))。
+ *
+ * 发送路径和U8g2的ssd13xx_fast_i2c相同: u8x8_DrawTile()先发一次
+ * 设置列和页的命令，再把数据按24字节一段发出，都经过u8x8->byte_cb。
+ * 默认的软件I2C回调直接写入模拟显示屏 (Hal::screen())。
+ */
+
+#ifndef HAL_U8G2LIB_H
+#define HAL_U8G2LIB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct u8x8_struct u8x8_t;
+typedef uint8_t (*u8x8_msg_cb)(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr);
+
+struct u8x8_struct {
+    u8x8_msg_cb byte_cb;
+    u8x8_msg_cb gpio_and_delay_cb;
+    uint8_t i2c_address;        // 8位地址 (与U8g2相同)
+    uint8_t pins[3];            // 时钟、数据、复位
+};
+
+#define U8X8_MSG_CAD_INIT               20
+#define U8X8_MSG_CAD_SEND_CMD           21
+#define U8X8_MSG_CAD_SEND_ARG           22
+#define U8X8_MSG_CAD_SEND_DATA          23
+#define U8X8_MSG_CAD_START_TRANSFER     24
+#define U8X8_MSG_CAD_END_TRANSFER       25
+
+#define U8X8_MSG_BYTE_INIT              U8X8_MSG_CAD_INIT
+#define U8X8_MSG_BYTE_SET_DC            32
+#define U8X8_MSG_BYTE_SEND              U8X8_MSG_CAD_SEND_DATA
+#define U8X8_MSG_BYTE_START_TRANSFER    U8X8_MSG_CAD_START_TRANSFER
+#define U8X8_MSG_BYTE_END_TRANSFER      U8X8_MSG_CAD_END_TRANSFER
+
+#define U8X8_MSG_GPIO_AND_DELAY_INIT    40
+
+#define U8X8_PIN_NONE                   255
+
+#define u8x8_GetI2CAddress(u8x8)        ((u8x8)->i2c_address)
+#define u8x8_gpio_Init(u8x8)            ((u8x8)->gpio_and_delay_cb((u8x8), U8X8_MSG_GPIO_AND_DELAY_INIT, 0, NULL))
+
+/**
+ * 把cnt个tile (每个8字节) 写到屏幕第y行第x个tile处
+ */
+uint8_t u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tilePtr);
+
+// 字体 (见HalDisplay.cpp)
+extern const uint8_t u8g2_font_5x7_tf[];
+extern const uint8_t u8g2_font_6x10_tf[];
+extern const uint8_t u8g2_font_logisoso16_tn[];
+extern const uint8_t u8g2_font_wqy12_t_gb2312[];
+
+typedef uint8_t u8g2_cb_t;
+#define U8G2_R0     0
+
+class U8G2 {
+public:
+    static const int WIDTH = 128;
+    static const int HEIGHT = 64;
+    static const int TILE_WIDTH = WIDTH / 8;
+    static const int TILE_HEIGHT = HEIGHT / 8;
+
+    U8G2(uint8_t clock, uint8_t data, uint8_t reset);
+
+    /**
+     * 初始化屏幕、清屏并点亮
+     */
+    bool begin();
+
+    void clearBuffer();
+    void sendBuffer();
+    void clearDisplay();
+    void setPowerSave(uint8_t isEnable);
+    void setContrast(uint8_t value);
+    void enableUTF8Print() {}
+
+    void setFont(const uint8_t* font) { _font = font; }
+
+    /**
+     * 0=清除 1=置位 2=异或
+     */
+    void setDrawColor(uint8_t color) { _drawColor = color; }
+    uint8_t getDrawColor() const { return _drawColor; }
+
+    void drawPixel(int x, int y);
+    void drawHLine(int x, int y, int width);
+    void drawVLine(int x, int y, int height);
+    void drawBox(int x, int y, int width, int height);
+    void drawFrame(int x, int y, int width, int height);
+
+    /**
+     * 以基线为y画字符串
+     * @return 字符串宽度
+     */
+    int drawStr(int x, int y, const char* str);
+    int drawUTF8(int x, int y, const char* str);
+    int getStrWidth(const char* str);
+    int getUTF8Width(const char* str);
+
+    uint8_t* getBufferPtr() { return _buffer; }
+    uint8_t getBufferTileWidth() const { return TILE_WIDTH; }
+    uint8_t getBufferTileHeight() const { return TILE_HEIGHT; }
+    int getDisplayWidth() const { return WIDTH; }
+    int getDisplayHeight() const { return HEIGHT; }
+    u8x8_t* getU8x8() { return &_u8x8; }
+
+private:
+    u8x8_t _u8x8;
+    uint8_t _buffer[WIDTH * TILE_HEIGHT];
+    const uint8_t* _font;
+    uint8_t _drawColor;
+
+    void sendCommands(const uint8_t* commands, uint8_t length);
+    int drawText(int x, int y, const char* str, bool utf8, bool draw);
+    int drawGlyph(int x, int y, uint32_t code, bool draw);
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_SW_I2C : public U8G2 {
+public:
+    U8G2_SSD1306_128X64_NONAME_F_SW_I2C(u8g2_cb_t rotation, uint8_t clock, uint8_t data,
+                                        uint8_t reset = U8X8_PIN_NONE)
+        : U8G2(clock, data, reset) { (void)rotation; }
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C(u8g2_cb_t rotation, uint8_t reset = U8X8_PIN_NONE,
+                                        uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+        : U8G2(clock, data, reset) { (void)rotation; }
+};
+
+#endif // HAL_U8G2LIB_H
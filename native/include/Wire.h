@@ -0,0 +1,41 @@
+/**
+ * @file Wire.h
+ * @brief native环境的Arduino I2C (只用于扫描总线)
+ *
+ * 模拟总线上只有显示屏 (0x3C) 一个从机。
+ */
+
+#ifndef HAL_WIRE_H
+#define HAL_WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire {
+public:
+    TwoWire() : _address(0), _length(0) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end();
+    bool setClock(uint32_t frequency);
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t data);
+    size_t write(const uint8_t* data, size_t length);
+
+    /**
+     * @return 0=成功 2=地址无应答
+     */
+    uint8_t endTransmission(bool sendStop = true);
+
+private:
+    static const size_t BUFFER_SIZE = 128;
+
+    uint8_t _address;
+    uint8_t _buffer[BUFFER_SIZE];
+    size_t _length;
+};
+
+extern TwoWire Wire;
+
+#endif // HAL_WIRE_H
@@ -0,0 +1,68 @@
+/**
+ * @file i2c.h
+ * @brief native环境的ESP-IDF I2C主机驱动
+ *
+ * 命令链接在i2c_master_cmd_begin()时逐段交给模拟的I2C总线
+ * (地址为显示屏时写入模拟SSD1306)。
+ */
+
+#ifndef HAL_DRIVER_I2C_H
+#define HAL_DRIVER_I2C_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int i2c_port_t;
+
+#define I2C_NUM_0   0
+#define I2C_NUM_MAX 1
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER
+} i2c_mode_t;
+
+typedef enum {
+    I2C_MASTER_WRITE = 0,
+    I2C_MASTER_READ
+} i2c_rw_t;
+
+typedef struct {
+    i2c_mode_t mode;
+    int sda_io_num;
+    int scl_io_num;
+    bool sda_pullup_en;
+    bool scl_pullup_en;
+    union {
+        struct {
+            uint32_t clk_speed;
+        } master;
+        struct {
+            uint8_t addr_10bit_en;
+            uint16_t slave_addr;
+        } slave;
+    };
+    uint32_t clk_flags;
+} i2c_config_t;
+
+typedef void* i2c_cmd_handle_t;
+
+#define I2C_LINK_RECOMMENDED_SIZE(TRANSACTIONS) (2 * 20 + 20 * 5 * (TRANSACTIONS))
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t* config);
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t rxBufferSize,
+                             size_t txBufferSize, int interruptFlags);
+esp_err_t i2c_driver_delete(i2c_port_t port);
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t* buffer, uint32_t size);
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ackEnable);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t length, bool ackEnable);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticksToWait);
+
+#endif // HAL_DRIVER_I2C_H
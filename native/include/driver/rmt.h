@@ -0,0 +1,78 @@
+/**
+ * @file rmt.h
+ * @brief native环境的ESP-IDF RMT发送驱动
+ *
+ * rmt_write_items()记录条目 (Hal::getRmtItems())，在后台线程中
+ * 按条目时长驱动输出引脚，播完后调用发送完成回调。
+ */
+
+#ifndef HAL_DRIVER_RMT_H
+#define HAL_DRIVER_RMT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+typedef enum {
+    RMT_CHANNEL_0 = 0,
+    RMT_CHANNEL_1,
+    RMT_CHANNEL_2,
+    RMT_CHANNEL_3,
+    RMT_CHANNEL_MAX
+} rmt_channel_t;
+
+typedef enum {
+    RMT_MODE_TX = 0,
+    RMT_MODE_RX
+} rmt_mode_t;
+
+typedef enum {
+    RMT_IDLE_LEVEL_LOW = 0,
+    RMT_IDLE_LEVEL_HIGH
+} rmt_idle_level_t;
+
+typedef struct {
+    union {
+        struct {
+            uint32_t duration0 : 15;
+            uint32_t level0 : 1;
+            uint32_t duration1 : 15;
+            uint32_t level1 : 1;
+        };
+        uint32_t val;
+    };
+} rmt_item32_t;
+
+typedef struct {
+    rmt_idle_level_t idle_level;
+    bool idle_output_en;
+    bool loop_en;
+} rmt_tx_config_t;
+
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id) \
+    { RMT_MODE_TX, (channel_id), (gpio), 80, 1, { RMT_IDLE_LEVEL_LOW, true, false } }
+
+typedef void (*rmt_tx_end_fn_t)(rmt_channel_t channel, void* arg);
+
+typedef struct {
+    rmt_tx_end_fn_t function;
+    void* arg;
+} rmt_tx_end_callback_t;
+
+esp_err_t rmt_config(const rmt_config_t* config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufferSize, int interruptFlags);
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t* items, int count, bool waitDone);
+esp_err_t rmt_tx_stop(rmt_channel_t channel);
+rmt_tx_end_callback_t rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void* arg);
+
+#endif // HAL_DRIVER_RMT_H
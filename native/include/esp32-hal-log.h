@@ -0,0 +1,59 @@
+/**
+ * @file esp32-hal-log.h
+ * @brief native环境的ESP_LOGx日志宏
+ *
+ * 输出到标准错误 (标准输出留给Serial)。编译时按CORE_DEBUG_LEVEL裁掉，
+ * 运行时再按Hal::setLogLevel()过滤。
+ */
+
+#ifndef HAL_ESP32_HAL_LOG_H
+#define HAL_ESP32_HAL_LOG_H
+
+#ifndef CORE_DEBUG_LEVEL
+#define CORE_DEBUG_LEVEL 3
+#endif
+
+#define ARDUHAL_LOG_LEVEL_NONE      0
+#define ARDUHAL_LOG_LEVEL_ERROR     1
+#define ARDUHAL_LOG_LEVEL_WARN      2
+#define ARDUHAL_LOG_LEVEL_INFO      3
+#define ARDUHAL_LOG_LEVEL_DEBUG     4
+#define ARDUHAL_LOG_LEVEL_VERBOSE   5
+
+void halLog(int level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+// 被裁掉的级别仍检查格式串和参数
+static inline void halLogNone(const char* tag, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static inline void halLogNone(const char*, const char*, ...) {}
+
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_ERROR
+#define ESP_LOGE(tag, format, ...) halLog(ARDUHAL_LOG_LEVEL_ERROR, tag, format, ##__VA_ARGS__)
+#else
+#define ESP_LOGE(tag, format, ...) halLogNone(tag, format, ##__VA_ARGS__)
+#endif
+
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_WARN
+#define ESP_LOGW(tag, format, ...) halLog(ARDUHAL_LOG_LEVEL_WARN, tag, format, ##__VA_ARGS__)
+#else
+#define ESP_LOGW(tag, format, ...) halLogNone(tag, format, ##__VA_ARGS__)
+#endif
+
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
+#define ESP_LOGI(tag, format, ...) halLog(ARDUHAL_LOG_LEVEL_INFO, tag, format, ##__VA_ARGS__)
+#else
+#define ESP_LOGI(tag, format, ...) halLogNone(tag, format, ##__VA_ARGS__)
+#endif
+
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
+#define ESP_LOGD(tag, format, ...) halLog(ARDUHAL_LOG_LEVEL_DEBUG, tag, format, ##__VA_ARGS__)
+#else
+#define ESP_LOGD(tag, format, ...) halLogNone(tag, format, ##__VA_ARGS__)
+#endif
+
+#if CORE_DEBUG_LEVEL >= ARDUHAL_LOG_LEVEL_VERBOSE
+#define ESP_LOGV(tag, format, ...) halLog(ARDUHAL_LOG_LEVEL_VERBOSE, tag, format, ##__VA_ARGS__)
+#else
+#define ESP_LOGV(tag, format, ...) halLogNone(tag, format, ##__VA_ARGS__)
+#endif
+
+#endif // HAL_ESP32_HAL_LOG_H
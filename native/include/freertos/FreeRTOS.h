@@ -0,0 +1,57 @@
+/**
+ * @file FreeRTOS.h
+ * @brief native环境的FreeRTOS类型和宏
+ *
+ * 1 tick = 1 ms (与固件配置相同)。临界区用一把全局递归锁实现，
+ * 模拟的ISR执行时也持有这把锁。
+ */
+
+#ifndef HAL_FREERTOS_H
+#define HAL_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+
+typedef struct HalTask* TaskHandle_t;
+typedef struct HalSemaphore* SemaphoreHandle_t;
+typedef struct HalQueue* QueueHandle_t;
+typedef struct HalEventGroup* EventGroupHandle_t;
+
+#define pdFALSE             ((BaseType_t)0)
+#define pdTRUE              ((BaseType_t)1)
+#define pdFAIL              pdFALSE
+#define pdPASS              pdTRUE
+#define errQUEUE_EMPTY      ((BaseType_t)0)
+#define errQUEUE_FULL       ((BaseType_t)0)
+
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    {0}
+
+void halEnterCritical();
+void halExitCritical();
+
+#define portENTER_CRITICAL(mux)         halEnterCritical()
+#define portEXIT_CRITICAL(mux)          halExitCritical()
+#define portENTER_CRITICAL_ISR(mux)     halEnterCritical()
+#define portEXIT_CRITICAL_ISR(mux)      halExitCritical()
+#define taskENTER_CRITICAL(mux)         halEnterCritical()
+#define taskEXIT_CRITICAL(mux)          halExitCritical()
+
+#define portYIELD_FROM_ISR(...)         ((void)0)
+
+#endif // HAL_FREERTOS_H
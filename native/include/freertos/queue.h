@@ -0,0 +1,20 @@
+/**
+ * @file queue.h
+ * @brief native环境的FreeRTOS队列 (按值复制的定长元素)
+ */
+
+#ifndef HAL_FREERTOS_QUEUE_H
+#define HAL_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#define xQueueSendToBack    xQueueSend
+
+#endif // HAL_FREERTOS_QUEUE_H
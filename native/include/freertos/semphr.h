@@ -0,0 +1,18 @@
+/**
+ * @file semphr.h
+ * @brief native环境的FreeRTOS信号量 (互斥量和二值信号量)
+ */
+
+#ifndef HAL_FREERTOS_SEMPHR_H
+#define HAL_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken);
+
+#endif // HAL_FREERTOS_SEMPHR_H
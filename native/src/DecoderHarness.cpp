@@ -0,0 +1,143 @@
+/**
+ * @file DecoderHarness.cpp
+ * @brief 主机全速接收解码实现
+ */
+
+#include "DecoderHarness.h"
+#include "Hal.h"
+#include "HostCommands.h"
+#include "RFReceiver.h"
+#include "pin_config.h"
+
+namespace {
+
+const uint64_t PROCESS_INTERVAL_US = RFReceiver::DECODE_INTERVAL_MS * 1000;
+
+// 最后一帧静默超时 (SEPARATION_LIMIT) 之后再多等一个周期
+const uint64_t SETTLE_US = 10000;
+
+const uint8_t PINS[2] = { RF_433_RX_PIN, RF_315_RX_PIN };
+
+} // namespace
+
+DecoderHarness::DecoderHarness()
+    : _rx433()
+    , _rx315()
+    , _time(0)
+    , _nextProcess(PROCESS_INTERVAL_US)
+    , _edges(0)
+    , _isrSeconds(0)
+    , _decodeSeconds(0)
+    , _overflowBase(0)
+    , _glitchBase(0)
+    , _gatedBase(0)
+    , _frames()
+{
+    Hal::useManualClock(START_US);
+    for (int band = 0; band < 2; band++) {
+        Hal::setInput(PINS[band], LOW);
+        _level[band] = LOW;
+    }
+    setGlitchFilter(RFReceiver::GLITCH_FILTER_US);
+    setEdgeRateLimit(RFReceiver::EDGE_RATE_LIMIT);
+    _rx433.enableReceive(RF_433_RX_PIN);
+    _rx315.enableReceive(RF_315_RX_PIN);
+    _overflowBase = RCSwitch433::getEdgeOverflowCount() + RCSwitch315::getEdgeOverflowCount();
+    _glitchBase = RCSwitch433::getGlitchCount() + RCSwitch315::getGlitchCount();
+    _gatedBase = RCSwitch433::getGatedTime() + RCSwitch315::getGatedTime();
+}
+
+DecoderHarness::~DecoderHarness() {
+    _rx433.disableReceive();
+    _rx315.disableReceive();
+    Hal::useRealClock();
+}
+
+void DecoderHarness::setTolerance(int percent) {
+    _rx433.setReceiveTolerance(percent);
+    _rx315.setReceiveTolerance(percent);
+}
+
+void DecoderHarness::edge(uint8_t band, uint8_t level, uint64_t atUs) {
+    advanceTo(atUs);
+    // 同电平的"边沿"在线路上不存在
+    if (level == _level[band]) {
+        return;
+    }
+    _level[band] = level;
+    const double t = hostSeconds();
+    Hal::setInput(PINS[band], level);
+    _isrSeconds += hostSeconds() - t;
+    _edges++;
+}
+
+void DecoderHarness::play(uint8_t band, const std::vector<SignalSynth::Pulse>& pulses) {
+    uint64_t at = _time;
+    for (size_t i = 0; i < pulses.size(); i++) {
+        edge(band, pulses[i].level, at);
+        at += pulses[i].duration;
+    }
+    advanceTo(at);
+}
+
+void DecoderHarness::advanceTo(uint64_t atUs) {
+    while (_nextProcess <= atUs) {
+        Hal::setMicros(START_US + _nextProcess);
+        process();
+        _nextProcess += PROCESS_INTERVAL_US;
+    }
+    if (atUs > _time) {
+        _time = atUs;
+        Hal::setMicros(START_US + _time);
+    }
+}
+
+void DecoderHarness::settle() {
+    edge(EdgeTrace::BAND_433, LOW, _time);
+    edge(EdgeTrace::BAND_315, LOW, _time);
+    advanceTo(_time + SETTLE_US);
+}
+
+void DecoderHarness::takeFrames(std::vector<Frame>& out) {
+    out.insert(out.end(), _frames.begin(), _frames.end());
+    _frames.clear();
+}
+
+void DecoderHarness::setGlitchFilter(unsigned int minPulseUs) {
+    RCSwitch433::setGlitchFilter(minPulseUs);
+    RCSwitch315::setGlitchFilter(minPulseUs);
+}
+
+void DecoderHarness::setEdgeRateLimit(unsigned long edgesPerSecond) {
+    RCSwitch433::setEdgeRateLimit(edgesPerSecond);
+    RCSwitch315::setEdgeRateLimit(edgesPerSecond);
+}
+
+unsigned long DecoderHarness::overflowCount() const {
+    return RCSwitch433::getEdgeOverflowCount() + RCSwitch315::getEdgeOverflowCount() - _overflowBase;
+}
+
+unsigned long DecoderHarness::glitchCount() const {
+    return RCSwitch433::getGlitchCount() + RCSwitch315::getGlitchCount() - _glitchBase;
+}
+
+unsigned long DecoderHarness::gatedTime() const {
+    return RCSwitch433::getGatedTime() + RCSwitch315::getGatedTime() - _gatedBase;
+}
+
+void DecoderHarness::process() {
+    const double t = hostSeconds();
+    RCSwitch433::processEdges();
+    RCSwitch315::processEdges();
+    _decodeSeconds += hostSeconds() - t;
+
+    Frame frame;
+    frame.freq = RCSwitch433::FREQUENCY;
+    while (_rx433.readFrame(frame.frame)) {
+        _frames.push_back(frame);
+    }
+    frame.freq = RCSwitch315::FREQUENCY;
+    while (_rx315.readFrame(frame.frame)) {
+        _frames.push_back(frame);
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file DecoderHarness.h
+ * @brief 在主机上以全速驱动两个频段的接收解码 (回放和测试用)
+ *
+ * 使用手动时钟: 边沿按绝对时间通过Hal::setInput()送到RF接收引脚，
+ * 触发真实的handleInterrupt()；时间每前进RFReceiver::DECODE_INTERVAL_MS
+ * 就调用一次两个频段的processEdges()，和设备上的解码任务节奏相同，
+ * 边沿缓冲区溢出和静默超时出帧的行为也就相同。
+ * 每次解码后把帧队列取空，帧数不受队列长度限制。
+ * 毛刺过滤和边沿风暴保护默认使用固件的设置 (RFReceiver)。
+ *
+ * 同一时间只能有一个实例 (接收状态是RCSwitch的静态成员)。
+ */
+
+#ifndef DECODER_HARNESS_H
+#define DECODER_HARNESS_H
+
+#include <stdint.h>
+#include <vector>
+#include "RCSwitch.h"
+#include "EdgeTrace.h"
+#include "SignalSynth.h"
+
+class DecoderHarness {
+public:
+    struct Frame {
+        unsigned int freq;      // 433/315
+        RCSwitchFrame frame;
+    };
+
+    static const uint64_t START_US = 1000000;
+
+    DecoderHarness();
+    ~DecoderHarness();
+
+    void setTolerance(int percent);
+
+    /**
+     * 毛刺过滤宽度上限和边沿速率上限 (0=关闭)
+     */
+    void setGlitchFilter(unsigned int minPulseUs);
+    void setEdgeRateLimit(unsigned long edgesPerSecond);
+
+    /**
+     * 在绝对时间 (微秒, 从0开始) 给频段送一个边沿
+     * @param band EdgeTrace频段编号 (0=433, 1=315)
+     */
+    void edge(uint8_t band, uint8_t level, uint64_t atUs);
+
+    /**
+     * 把一段电平序列从当前时间开始送到一个频段
+     */
+    void play(uint8_t band, const std::vector<SignalSynth::Pulse>& pulses);
+
+    /**
+     * 时间推进到atUs，期间按解码任务周期解码
+     */
+    void advanceTo(uint64_t atUs);
+
+    /**
+     * 线路拉低并静默足够久，让最后一帧输出
+     */
+    void settle();
+
+    /**
+     * 取走已解码的帧
+     */
+    void takeFrames(std::vector<Frame>& out);
+
+    uint64_t now() const { return _time; }
+    unsigned long edgeCount() const { return _edges; }
+    double isrSeconds() const { return _isrSeconds; }
+    double decodeSeconds() const { return _decodeSeconds; }
+    unsigned long overflowCount() const;
+    unsigned long glitchCount() const;      // 丢弃的毛刺 (两个频段)
+    unsigned long gatedTime() const;        // 中断关闭时间 (毫秒, 两个频段之和)
+
+private:
+    RCSwitch433 _rx433;
+    RCSwitch315 _rx315;
+    uint64_t _time;
+    uint64_t _nextProcess;
+    uint8_t _level[2];
+    unsigned long _edges;
+    double _isrSeconds;
+    double _decodeSeconds;
+    unsigned long _overflowBase;
+    unsigned long _glitchBase;
+    unsigned long _gatedBase;
+    std::vector<Frame> _frames;
+
+    void process();
+};
+
+#endif // DECODER_HARNESS_H
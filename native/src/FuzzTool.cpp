@@ -0,0 +1,316 @@
+/**
+ * @file FuzzTool.cpp
+ * @brief 收发往返模糊测试 (fuzz): 发送程序合成的边沿能否解回同样的编码
+ *
+ * 每次试验随机取协议、位数 (8-32) 和编码，用RCSwitch::compile()生成
+ * 发送程序，按 (1 + 漂移) 缩放并加高斯抖动后经DecoderHarness送入接收
+ * 路径。解出至少一帧编码、位数、协议都相同即为成功；协议号不同但按
+ * 解出的协议、编码和脉宽重发的波形与原信号相同 (时序比例相同的协议，
+ * 或者一帧错开几个时序的协议)，重放效果一样，也算成功，单独计数。
+ * 解出另一个协议且波形不同的帧是误判。
+ * 反相协议 (6、9-12) 的数据从第二个时序开始，和正相协议走不同的分支，
+ * 所以每个协议单独统计。
+ *
+ * 检查 (不通过时返回1):
+ *   - 默认参数下每个协议、每档抖动的成功率不低于FUZZ_FLOORS
+ *   - 抖动不超过协议最短时序的1/FUZZ_STRICT_JITTER_DIVISOR时没有任何误判。
+ *     抖动再大时部分短脉冲会短于毛刺过滤宽度，帧里出现错位，误判只统计
+ */
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "HostCommands.h"
+#include "DecoderHarness.h"
+#include "SignalSynth.h"
+#include "RCSwitch.h"
+#include "RFReceiver.h"
+
+#include <vector>
+
+namespace {
+
+const unsigned int FUZZ_PROTOCOLS = 12;         // RCSwitch的协议1-12
+const double FUZZ_JITTERS[] = { 0, 10, 25, 50, 100, 150 };  // 抖动标准差 (微秒)
+const int FUZZ_JITTER_COUNT = sizeof(FUZZ_JITTERS) / sizeof(FUZZ_JITTERS[0]);
+const unsigned int FUZZ_MIN_BITS = 8;
+const unsigned int FUZZ_MAX_BITS = 32;
+const int FUZZ_REPEATS = 3;                     // 第一帧前没有同步间隔，能解出后两帧
+const uint32_t FUZZ_QUIET_US = 20000;
+const int FUZZ_DEFAULT_TRIALS = 200;
+const double FUZZ_DEFAULT_DRIFT = 5;            // 脉宽误差上限 (±%)
+
+// 默认参数下各协议、各档抖动成功率的下限 (%)，比多个种子的最低值再留约10%
+const int FUZZ_FLOORS[FUZZ_PROTOCOLS][FUZZ_JITTER_COUNT] = {
+    { 100, 100, 90, 90, 35,  0 },   // 1
+    { 100, 100, 90, 90, 85, 70 },   // 2
+    { 100, 100, 75,  0,  0,  0 },   // 3: 脉宽100us
+    { 100, 100, 90, 85, 65,  0 },   // 4
+    { 100, 100, 90, 85, 10,  0 },   // 5
+    { 100, 100, 90, 90, 70, 15 },   // 6
+    { 100, 100, 85, 10,  0,  0 },   // 7: 脉宽150us
+    { 100, 100, 90, 70,  0,  0 },   // 8
+    { 100, 100, 90, 85,  0,  0 },   // 9
+    { 100, 100, 90, 90, 80, 10 },   // 10
+    { 100, 100, 90, 80, 10,  0 },   // 11
+    { 100, 100, 90, 85, 30,  0 },   // 12
+};
+
+// 抖动标准差不超过协议最短时序的1/6时不允许任何误判
+const unsigned int FUZZ_STRICT_JITTER_DIVISOR = 6;
+
+struct ProtocolResult {
+    int ok[FUZZ_JITTER_COUNT];                  // 含同波形的其他协议
+    int alias[FUZZ_JITTER_COUNT];               // 协议号不同但波形相同
+    int misattributed[FUZZ_JITTER_COUNT];       // 解出另一个协议，重放的波形也不同
+    int delivered[FUZZ_JITTER_COUNT];           // 其中能通过RFReceiver过滤的
+    unsigned long frames;
+    double seconds;                             // 中断+解码耗时
+
+    // 无抖动时的第一个失败用例
+    bool failed;
+    unsigned int failBits;
+    uint64_t failCode;
+    size_t failFrames;
+    RCSwitchFrame failFrame;
+};
+
+/**
+ * 按协议、脉宽发送一帧的电平序列 (首尾同电平时合并，作为循环序列)
+ */
+void frameCycle(unsigned int protocol, unsigned int delay, const RFCode& code, unsigned int bits,
+                std::vector<SignalSynth::Pulse>& cycle) {
+    static RCSwitch433 sender;
+    static PulseProgram program;
+    if (program.capacity() == 0) {
+        program.reserve(1024);
+    }
+    sender.setRepeatTransmit(1);
+    sender.setProtocol(protocol, delay);
+    sender.compile(code, bits, program);
+
+    SignalSynth synth(1);
+    synth.appendProgram(program, 0, 0);
+    cycle = synth.pulses();
+    if (cycle.size() > 1 && cycle.front().level == cycle.back().level) {
+        cycle.front().duration += cycle.back().duration;
+        cycle.pop_back();
+    }
+}
+
+} // namespace
+
+/**
+ * 按解出的协议、编码、位数和脉宽重发的波形与原信号是否相同。
+ * 重复发送时一帧接一帧，所以比较一帧电平序列的循环移位: 例如协议9
+ * (反相) 的帧从数据位开始，协议8把同一串电平看成从上一帧的同步之后
+ * 开始，解出的编码错开一位，但重放出来的波形完全一样
+ */
+bool sameWaveform(unsigned int protocol, uint64_t code, unsigned int bits, const RCSwitchFrame& frame) {
+    static std::vector<SignalSynth::Pulse> sent;
+    static std::vector<SignalSynth::Pulse> decoded;
+    frameCycle(protocol, frame.delay, RFCode(code), bits, sent);
+    frameCycle(frame.protocol, frame.delay, frame.code, frame.bitlength, decoded);
+    const size_t n = sent.size();
+    if (n == 0 || decoded.size() != n) {
+        return false;
+    }
+    for (size_t shift = 0; shift < n; shift++) {
+        size_t i = 0;
+        while (i < n && sent[(i + shift) % n].level == decoded[i].level &&
+               sent[(i + shift) % n].duration == decoded[i].duration) {
+            i++;
+        }
+        if (i == n) {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+/**
+ * 协议默认脉宽下最短的一段时序 (微秒)
+ */
+unsigned int shortestPulse(unsigned int protocol) {
+    RCSwitch433 sender;
+    sender.setProtocol(protocol);
+    sender.setRepeatTransmit(1);
+    PulseProgram program;
+    program.reserve(64);
+    sender.compile(RFCode(1), 2, program);  // 一个0位和一个1位
+
+    SignalSynth synth(1);
+    synth.appendProgram(program, 0, 0);
+    unsigned int shortest = UINT32_MAX;
+    for (size_t i = 0; i < synth.pulses().size(); i++) {
+        const unsigned int duration = synth.pulses()[i].duration;
+        shortest = duration < shortest ? duration : shortest;
+    }
+    return shortest;
+}
+
+void printFailure(unsigned int protocol, const ProtocolResult& result) {
+    printf("  p%u 无抖动失败: %u位 %llX", protocol, result.failBits,
+           (unsigned long long)result.failCode);
+    if (result.failFrames == 0) {
+        printf(" -> 没有帧\n");
+        return;
+    }
+    const RCSwitchFrame& frame = result.failFrame;
+    printf(" -> %u帧, 例如 p%u %u位 %llX\n", (unsigned)result.failFrames, frame.protocol,
+           frame.bitlength, (unsigned long long)frame.code.low64());
+}
+
+} // namespace
+
+int runFuzz(int argc, char** argv) {
+    const int trials = argc > 2 ? atoi(argv[2]) : FUZZ_DEFAULT_TRIALS;
+    const double drift = (argc > 3 ? atof(argv[3]) : FUZZ_DEFAULT_DRIFT) / 100.0;
+    const int tolerance = argc > 4 ? atoi(argv[4]) : RFReceiver::RECEIVE_TOLERANCE;
+    const uint32_t seed = argc > 5 ? strtoul(argv[5], NULL, 10) : 1;
+    if (trials <= 0 || tolerance <= 0) {
+        fprintf(stderr, "试验次数和容差必须大于0\n");
+        return 2;
+    }
+
+    Hal::setLogLevel(ARDUHAL_LOG_LEVEL_ERROR);
+    printf("== fuzz: %d trials/protocol/jitter, %u-%u bits, drift ±%.0f%%, tolerance %d%%, "
+           "%d repeats, seed %lu ==\n", trials, FUZZ_MIN_BITS, FUZZ_MAX_BITS, drift * 100,
+           tolerance, FUZZ_REPEATS, (unsigned long)seed);
+    printf("round-trip ok by jitter σ (us):\n");
+    printf("proto");
+    for (int j = 0; j < FUZZ_JITTER_COUNT; j++) {
+        printf(" %7.0f", FUZZ_JITTERS[j]);
+    }
+    printf("  frames/s\n");
+
+    SignalSynth random(seed);
+    DecoderHarness harness;
+    harness.setTolerance(tolerance);
+    RCSwitch433 sender;
+    sender.setRepeatTransmit(FUZZ_REPEATS);
+    PulseProgram program;
+    program.reserve(1024);
+    std::vector<DecoderHarness::Frame> frames;
+
+    int totalOk = 0;
+    int totalTrials = 0;
+    std::vector<ProtocolResult> results(FUZZ_PROTOCOLS + 1);
+    const double start = hostSeconds();
+
+    for (unsigned int p = 1; p <= FUZZ_PROTOCOLS; p++) {
+        ProtocolResult& result = results[p];
+        sender.setProtocol(p);
+
+        for (int j = 0; j < FUZZ_JITTER_COUNT; j++) {
+            for (int t = 0; t < trials; t++) {
+                const unsigned int bits = FUZZ_MIN_BITS + random.next() % (FUZZ_MAX_BITS - FUZZ_MIN_BITS + 1);
+                const uint64_t code = random.bits(bits);
+                sender.compile(RFCode(code), bits, program);
+
+                SignalSynth signal(random.next());
+                signal.appendLevel(LOW, FUZZ_QUIET_US);
+                signal.appendProgram(program, (random.uniform() * 2 - 1) * drift, FUZZ_JITTERS[j]);
+                signal.appendLevel(LOW, FUZZ_QUIET_US);
+
+                const double before = harness.isrSeconds() + harness.decodeSeconds();
+                harness.play(EdgeTrace::BAND_433, signal.pulses());
+                harness.settle();
+                result.seconds += harness.isrSeconds() + harness.decodeSeconds() - before;
+
+                frames.clear();
+                harness.takeFrames(frames);
+                result.frames += frames.size();
+
+                bool exact = false;
+                bool alias = false;
+                bool misattributed = false;
+                bool delivered = false;
+                for (size_t f = 0; f < frames.size(); f++) {
+                    const RCSwitchFrame& frame = frames[f].frame;
+                    if (frame.protocol == p) {
+                        exact = exact || (frame.bitlength == bits && frame.code == RFCode(code));
+                    } else if (sameWaveform(p, code, bits, frame)) {
+                        alias = true;
+                    } else {
+                        misattributed = true;
+                        delivered = delivered ||
+                            RFReceiver::isValidSignal(frame.code, frame.bitlength, RFReceiver::DEFAULT_FILTER);
+                    }
+                }
+                const bool ok = exact || alias;
+                result.ok[j] += ok ? 1 : 0;
+                result.alias[j] += (!exact && alias) ? 1 : 0;
+                result.misattributed[j] += misattributed ? 1 : 0;
+                result.delivered[j] += delivered ? 1 : 0;
+
+                if (!ok && j == 0 && !result.failed) {
+                    result.failed = true;
+                    result.failBits = bits;
+                    result.failCode = code;
+                    result.failFrames = frames.size();
+                    if (!frames.empty()) {
+                        result.failFrame = frames[0].frame;
+                    }
+                }
+            }
+            totalOk += result.ok[j];
+            totalTrials += trials;
+        }
+
+        printf("%5u", p);
+        for (int j = 0; j < FUZZ_JITTER_COUNT; j++) {
+            printf(" %6.1f%%", 100.0 * result.ok[j] / trials);
+        }
+        printf("  %8.0f\n", result.seconds > 0 ? result.frames / result.seconds : 0);
+    }
+
+    // 协议号不对: 另一个协议的时序窗口也接受了这段信号
+    printf("decoded as another protocol (same waveform / different waveform / passes RX filter):\n");
+    for (unsigned int p = 1; p <= FUZZ_PROTOCOLS; p++) {
+        int alias = 0;
+        int other = 0;
+        int delivered = 0;
+        for (int j = 0; j < FUZZ_JITTER_COUNT; j++) {
+            alias += results[p].alias[j];
+            other += results[p].misattributed[j];
+            delivered += results[p].delivered[j];
+        }
+        if (alias > 0 || other > 0) {
+            printf("  p%u: %d / %d / %d of %d\n", p, alias, other, delivered, trials * FUZZ_JITTER_COUNT);
+        }
+    }
+    for (unsigned int p = 1; p <= FUZZ_PROTOCOLS; p++) {
+        if (results[p].failed) {
+            printFailure(p, results[p]);
+        }
+    }
+
+    // 成功率下限只对默认参数成立
+    const bool defaults = trials >= FUZZ_DEFAULT_TRIALS && drift == FUZZ_DEFAULT_DRIFT / 100.0 &&
+                          tolerance == RFReceiver::RECEIVE_TOLERANCE;
+    int violations = 0;
+    for (unsigned int p = 1; p <= FUZZ_PROTOCOLS; p++) {
+        const ProtocolResult& result = results[p];
+        const double strictJitter = (double)shortestPulse(p) / FUZZ_STRICT_JITTER_DIVISOR;
+        for (int j = 0; j < FUZZ_JITTER_COUNT; j++) {
+            if (defaults && result.ok[j] * 100 < FUZZ_FLOORS[p - 1][j] * trials) {
+                printf("FAIL p%u σ=%.0fus: %.1f%% ok, floor %d%%\n", p, FUZZ_JITTERS[j],
+                       100.0 * result.ok[j] / trials, FUZZ_FLOORS[p - 1][j]);
+                violations++;
+            }
+            if (FUZZ_JITTERS[j] <= strictJitter && result.misattributed[j] > 0) {
+                printf("FAIL p%u σ=%.0fus: %d misattributed (%d pass the RX filter)\n", p, FUZZ_JITTERS[j],
+                       result.misattributed[j], result.delivered[j]);
+                violations++;
+            }
+        }
+    }
+
+    printf("total: %d/%d ok (%.1f%%), %.2f s, %s\n", totalOk, totalTrials,
+           100.0 * totalOk / totalTrials, hostSeconds() - start,
+           violations == 0 ? (defaults ? "all checks passed" : "misattribution checks passed")
+                           : "FAILED");
+    return violations == 0 ? 0 : 1;
+}
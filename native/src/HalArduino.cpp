@@ -0,0 +1,497 @@
+/**
+ * @file HalArduino.cpp
+ * @brief native环境: 时间、GPIO和中断、浅睡眠、ADC、串口、日志
+ */
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include "Hal.h"
+#include "HalInternal.h"
+
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// ==================== 时间 ====================
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+static std::atomic<bool> manualClock(false);
+static std::atomic<uint64_t> manualMicros(0);
+
+static uint64_t realMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint64_t halRealMillis() {
+    return realMicros() / 1000;
+}
+
+void Hal::useManualClock(uint64_t startUs) {
+    manualMicros = startUs;
+    manualClock = true;
+}
+
+void Hal::useRealClock() {
+    manualClock = false;
+}
+
+bool Hal::isManualClock() {
+    return manualClock;
+}
+
+void Hal::setMicros(uint64_t us) {
+    manualMicros = us;
+}
+
+void Hal::advanceMicros(uint64_t us) {
+    manualMicros += us;
+}
+
+unsigned long micros() {
+    return manualClock ? manualMicros.load() : realMicros();
+}
+
+unsigned long millis() {
+    return micros() / 1000;
+}
+
+void delay(uint32_t ms) {
+    if (manualClock) {
+        manualMicros += (uint64_t)ms * 1000;
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+void delayMicroseconds(uint32_t us) {
+    if (manualClock) {
+        manualMicros += us;
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+// ==================== 临界区 ====================
+
+// 临界区和模拟的ISR共用，ISR不会在临界区中途执行
+static std::recursive_mutex criticalMutex;
+
+void halEnterCritical() {
+    criticalMutex.lock();
+}
+
+void halExitCritical() {
+    criticalMutex.unlock();
+}
+
+// ==================== GPIO ====================
+
+static const int PIN_COUNT = 32;
+
+struct PinState {
+    int level;
+    uint8_t mode;
+    bool driven;                    // 由Hal::setInput()驱动，上下拉不再改变电平
+    void (*isr)(void);
+    int isrMode;
+    bool interruptEnabled;
+    gpio_int_type_t wakeType;
+};
+
+static PinState pins[PIN_COUNT];
+static std::atomic<uint32_t> interruptCalls(0);
+static std::atomic<Hal::OutputTap> outputTap(NULL);
+
+// 浅睡眠
+static std::mutex sleepMutex;
+static std::condition_variable sleepCondition;
+static uint64_t sleepTimerUs = 0;
+static bool gpioWakeup = false;
+static esp_sleep_wakeup_cause_t wakeupCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static std::atomic<bool> lightSleeping(false);
+static std::atomic<uint32_t> lightSleepCount(0);
+
+static bool validPin(int pin) {
+    return pin >= 0 && pin < PIN_COUNT;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (!validPin(pin)) return;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].mode = mode;
+    if (!pins[pin].driven) {
+        if ((mode & PULLUP) != 0) {
+            pins[pin].level = HIGH;
+        } else if ((mode & PULLDOWN) != 0) {
+            pins[pin].level = LOW;
+        }
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (!validPin(pin)) return;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    const int level = val ? HIGH : LOW;
+    if (pins[pin].level == level) {
+        return;
+    }
+    pins[pin].level = level;
+    const Hal::OutputTap tap = outputTap;
+    if (tap != NULL) {
+        tap(pin, level, micros());
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (!validPin(pin)) return LOW;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    return pins[pin].level;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+    if (!validPin(pin)) return;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].isr = isr;
+    pins[pin].isrMode = mode;
+    pins[pin].interruptEnabled = true;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (!validPin(pin)) return;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].isr = NULL;
+}
+
+void Hal::setInput(uint8_t pin, int level) {
+    if (!validPin(pin)) return;
+    level = level ? HIGH : LOW;
+    {
+        std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+        PinState& state = pins[pin];
+        const int previous = state.level;
+        state.level = level;
+        state.driven = true;
+
+        const bool rising = previous == LOW && level == HIGH;
+        const bool falling = previous == HIGH && level == LOW;
+        const bool fire = (rising && (state.isrMode & RISING) != 0) ||
+                          (falling && (state.isrMode & FALLING) != 0);
+        if (fire && state.isr != NULL && state.interruptEnabled) {
+            interruptCalls++;
+            state.isr();
+        }
+    }
+
+    // 睡眠中的主循环检查唤醒电平
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    sleepCondition.notify_all();
+}
+
+int Hal::getLevel(uint8_t pin) {
+    return digitalRead(pin);
+}
+
+uint32_t Hal::getInterruptCalls() {
+    return interruptCalls;
+}
+
+void Hal::setOutputTap(OutputTap tap) {
+    outputTap = tap;
+}
+
+// ==================== GPIO驱动 ====================
+
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+    if (!validPin(pin)) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    switch (type) {
+        case GPIO_INTR_POSEDGE: pins[pin].isrMode = RISING; break;
+        case GPIO_INTR_NEGEDGE: pins[pin].isrMode = FALLING; break;
+        case GPIO_INTR_ANYEDGE: pins[pin].isrMode = CHANGE; break;
+        default: pins[pin].isrMode = 0; break;      // 电平中断只用于唤醒，这里不模拟
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t pin) {
+    if (!validPin(pin)) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].interruptEnabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin) {
+    if (!validPin(pin)) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].interruptEnabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+    if (!validPin(pin) || (type != GPIO_INTR_LOW_LEVEL && type != GPIO_INTR_HIGH_LEVEL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].wakeType = type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+    if (!validPin(pin)) return ESP_ERR_INVALID_ARG;
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    pins[pin].wakeType = GPIO_INTR_DISABLE;
+    return ESP_OK;
+}
+
+// ==================== 浅睡眠 ====================
+
+static bool wakePinActive() {
+    std::lock_guard<std::recursive_mutex> lock(criticalMutex);
+    for (int i = 0; i < PIN_COUNT; i++) {
+        if ((pins[i].wakeType == GPIO_INTR_LOW_LEVEL && pins[i].level == LOW) ||
+            (pins[i].wakeType == GPIO_INTR_HIGH_LEVEL && pins[i].level == HIGH)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+    sleepTimerUs = timeUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+    gpioWakeup = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+    const uint64_t timeoutUs = sleepTimerUs;
+    sleepTimerUs = 0;
+    lightSleepCount++;
+
+    if (manualClock) {
+        // 手动时钟下直接睡满
+        manualMicros += timeoutUs;
+        wakeupCause = ESP_SLEEP_WAKEUP_TIMER;
+        return ESP_OK;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    lightSleeping = true;
+    const bool woken = sleepCondition.wait_for(lock, std::chrono::microseconds(timeoutUs), []() {
+        return gpioWakeup && wakePinActive();
+    });
+    lightSleeping = false;
+    wakeupCause = woken ? ESP_SLEEP_WAKEUP_GPIO : ESP_SLEEP_WAKEUP_TIMER;
+    return ESP_OK;
+}
+
+bool Hal::isLightSleeping() {
+    return lightSleeping;
+}
+
+uint32_t Hal::getLightSleepCount() {
+    return lightSleepCount;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return wakeupCause;
+}
+
+// ==================== ADC ====================
+
+static const uint32_t ADC_FULL_SCALE_MV = 3000;    // 与BAT_ADC_VREF一致
+static uint8_t adcBits = 12;
+static std::atomic<uint32_t> analogMillivolts[PIN_COUNT];
+
+void Hal::setAnalogMillivolts(uint8_t pin, uint32_t millivolts) {
+    if (validPin(pin)) {
+        analogMillivolts[pin] = millivolts;
+    }
+}
+
+void analogReadResolution(uint8_t bits) {
+    adcBits = bits;
+}
+
+void analogSetAttenuation(adc_attenuation_t attenuation) {
+    (void)attenuation;
+}
+
+uint16_t analogRead(uint8_t pin) {
+    const uint32_t maxValue = (1UL << adcBits) - 1;
+    const uint32_t mv = min(analogReadMilliVolts(pin), ADC_FULL_SCALE_MV);
+    return (uint16_t)((uint64_t)mv * maxValue / ADC_FULL_SCALE_MV);
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+    return validPin(pin) ? analogMillivolts[pin].load() : 0;
+}
+
+// ==================== 系统信息 ====================
+
+EspClass ESP;
+
+uint32_t getCpuFrequencyMhz() {
+    return 160;
+}
+
+// 主机上没有这些限制，返回ESP32-C3的典型值方便对照日志
+uint32_t EspClass::getFreeHeap() { return 280 * 1024; }
+uint32_t EspClass::getMinFreeHeap() { return 280 * 1024; }
+uint32_t EspClass::getFlashChipSize() { return 4 * 1024 * 1024; }
+const char* EspClass::getSdkVersion() { return "native"; }
+
+void EspClass::restart() {
+    fflush(stdout);
+    fflush(stderr);
+    _exit(0);
+}
+
+// ==================== 串口 ====================
+
+HardwareSerial Serial;
+
+static std::mutex serialMutex;
+static std::deque<uint8_t> serialInput;
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::print(int value) { return printf("%d", value); }
+size_t Print::print(unsigned int value) { return printf("%u", value); }
+size_t Print::print(long value) { return printf("%ld", value); }
+size_t Print::print(unsigned long value) { return printf("%lu", value); }
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    if ((size_t)length < sizeof(small)) {
+        return write((const uint8_t*)small, length);
+    }
+
+    char* large = (char*)malloc(length + 1);
+    if (large == NULL) {
+        return 0;
+    }
+    va_start(args, format);
+    vsnprintf(large, length + 1, format, args);
+    va_end(args);
+    const size_t written = write((const uint8_t*)large, length);
+    free(large);
+    return written;
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    const uint64_t start = halRealMillis();
+    while (count < length) {
+        const int c = read();
+        if (c >= 0) {
+            buffer[count++] = (uint8_t)c;
+        } else if (halRealMillis() - start >= _timeout) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return count;
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+    (void)baud;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size) {
+    return size;
+}
+
+int HardwareSerial::available() {
+    std::lock_guard<std::mutex> lock(serialMutex);
+    return (int)serialInput.size();
+}
+
+int HardwareSerial::read() {
+    std::lock_guard<std::mutex> lock(serialMutex);
+    if (serialInput.empty()) {
+        return -1;
+    }
+    const uint8_t c = serialInput.front();
+    serialInput.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    std::lock_guard<std::mutex> lock(serialMutex);
+    return serialInput.empty() ? -1 : serialInput.front();
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void Hal::attachSerialStdin() {
+    std::thread([]() {
+        uint8_t buffer[256];
+        ssize_t length;
+        while ((length = ::read(STDIN_FILENO, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(serialMutex);
+            serialInput.insert(serialInput.end(), buffer, buffer + length);
+        }
+    }).detach();
+}
+
+// ==================== 日志 ====================
+
+static std::atomic<int> logLevel(CORE_DEBUG_LEVEL);
+static std::mutex logMutex;
+
+void Hal::setLogLevel(int level) {
+    logLevel = max(0, min(level, CORE_DEBUG_LEVEL));
+}
+
+int Hal::getLogLevel() {
+    return logLevel;
+}
+
+void halLog(int level, const char* tag, const char* format, ...) {
+    if (level > logLevel) {
+        return;
+    }
+    static const char LEVEL_CHARS[] = "NEWIDV";
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    fprintf(stderr, "[%8lu][%c][%s] ", millis(), LEVEL_CHARS[level], tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
@@ -0,0 +1,475 @@
+/**
+ * @file HalDisplay.cpp
+ * @brief native环境: 模拟I2C总线上的SSD1306和U8g2全缓冲绘图
+ */
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include "Hal.h"
+#include "HalInternal.h"
+
+#include <mutex>
+#include <vector>
+
+// ==================== SSD1306 ====================
+
+static const uint8_t OLED_ADDRESS = 0x3C;
+
+struct Ssd1306 {
+    uint8_t ram[Hal::SCREEN_PAGES * Hal::SCREEN_WIDTH];
+    uint8_t page;
+    uint8_t column;
+    uint8_t columnStart;
+    uint8_t columnEnd;
+    uint8_t pageStart;
+    uint8_t pageEnd;
+    uint8_t addressMode;        // 0=水平 1=垂直 2=页 (上电默认)
+    uint8_t contrast;
+    bool on;
+    uint8_t command;            // 正在接收参数的命令
+    uint8_t args[6];
+    uint8_t argCount;
+    uint8_t argsNeeded;
+};
+
+static std::mutex screenMutex;
+static Ssd1306 oled = { {0}, 0, 0, 0, 127, 0, 7, 2, 0x7F, false, 0, {0}, 0, 0 };
+static uint32_t screenDataBytes = 0;
+static uint32_t screenWrites = 0;
+
+static uint8_t commandArgCount(uint8_t command) {
+    switch (command) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void executeCommand(uint8_t command, const uint8_t* args) {
+    if (command <= 0x0F) {
+        oled.column = (oled.column & 0xF0) | command;
+    } else if (command <= 0x1F) {
+        oled.column = (oled.column & 0x0F) | ((command & 0x0F) << 4);
+    } else if (command >= 0xB0 && command <= 0xB7) {
+        oled.page = command & 0x07;
+    } else {
+        switch (command) {
+            case 0x20: oled.addressMode = args[0] & 0x03; break;
+            case 0x21:
+                oled.columnStart = args[0] & 0x7F;
+                oled.columnEnd = args[1] & 0x7F;
+                oled.column = oled.columnStart;
+                break;
+            case 0x22:
+                oled.pageStart = args[0] & 0x07;
+                oled.pageEnd = args[1] & 0x07;
+                oled.page = oled.pageStart;
+                break;
+            case 0x81: oled.contrast = args[0]; break;
+            case 0xAE: oled.on = false; break;
+            case 0xAF: oled.on = true; break;
+            default: break;     // 时序、方向、滚动等不影响显存内容
+        }
+    }
+}
+
+static void receiveCommandByte(uint8_t value) {
+    if (oled.argsNeeded > 0) {
+        oled.args[oled.argCount++] = value;
+        if (oled.argCount == oled.argsNeeded) {
+            executeCommand(oled.command, oled.args);
+            oled.argsNeeded = 0;
+        }
+        return;
+    }
+    const uint8_t needed = commandArgCount(value);
+    if (needed == 0) {
+        executeCommand(value, NULL);
+    } else {
+        oled.command = value;
+        oled.argCount = 0;
+        oled.argsNeeded = needed;
+    }
+}
+
+static void receiveDataByte(uint8_t value) {
+    oled.ram[(oled.page & 0x07) * Hal::SCREEN_WIDTH + (oled.column & 0x7F)] = value;
+    screenDataBytes++;
+
+    if (oled.addressMode == 1) {
+        // 垂直: 先换页再换列
+        if (++oled.page > oled.pageEnd) {
+            oled.page = oled.pageStart;
+            oled.column = oled.column >= oled.columnEnd ? oled.columnStart : oled.column + 1;
+        }
+    } else if (oled.addressMode == 0) {
+        if (++oled.column > oled.columnEnd) {
+            oled.column = oled.columnStart;
+            oled.page = oled.page >= oled.pageEnd ? oled.pageStart : oled.page + 1;
+        }
+    } else {
+        oled.column = (oled.column + 1) & 0x7F;
+    }
+}
+
+bool halI2cWrite(uint8_t address, const uint8_t* data, size_t length) {
+    if (address != OLED_ADDRESS) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(screenMutex);
+    screenWrites++;
+
+    // 控制字节: bit7=Co (只跟一个字节)，bit6=D/C (1=显存数据)
+    size_t i = 0;
+    while (i < length) {
+        const uint8_t control = data[i++];
+        const bool isData = (control & 0x40) != 0;
+        const size_t end = (control & 0x80) != 0 ? min(i + 1, length) : length;
+        for (; i < end; i++) {
+            if (isData) {
+                receiveDataByte(data[i]);
+            } else {
+                receiveCommandByte(data[i]);
+            }
+        }
+    }
+    return true;
+}
+
+const uint8_t* Hal::screen() {
+    return oled.ram;
+}
+
+uint32_t Hal::getScreenDataBytes() {
+    std::lock_guard<std::mutex> lock(screenMutex);
+    return screenDataBytes;
+}
+
+uint32_t Hal::getScreenWrites() {
+    std::lock_guard<std::mutex> lock(screenMutex);
+    return screenWrites;
+}
+
+void Hal::resetScreenStats() {
+    std::lock_guard<std::mutex> lock(screenMutex);
+    screenDataBytes = 0;
+    screenWrites = 0;
+}
+
+void Hal::dumpScreen(FILE* out) {
+    std::lock_guard<std::mutex> lock(screenMutex);
+    // 半格字符: 上像素、下像素
+    static const char* const CELLS[4] = { " ", "\xe2\x96\x80", "\xe2\x96\x84", "\xe2\x96\x88" };
+
+    fprintf(out, "+");
+    for (int x = 0; x < SCREEN_WIDTH; x++) fputc('-', out);
+    fprintf(out, "+%s\n", oled.on ? "" : " (off)");
+    for (int y = 0; y < SCREEN_PAGES * 8; y += 2) {
+        fputc('|', out);
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            const uint8_t column = oled.ram[(y / 8) * SCREEN_WIDTH + x];
+            const int top = (column >> (y % 8)) & 1;
+            const int bottom = (column >> (y % 8 + 1)) & 1;
+            fputs(CELLS[top | (bottom << 1)], out);
+        }
+        fprintf(out, "|\n");
+    }
+    fprintf(out, "+");
+    for (int x = 0; x < SCREEN_WIDTH; x++) fputc('-', out);
+    fprintf(out, "+\n");
+}
+
+// ==================== U8x8 ====================
+
+// 软件I2C的字节回调: 攒一次写，END_TRANSFER时交给总线
+static std::vector<uint8_t> swTransfer;
+
+static uint8_t swByteCallback(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr) {
+    switch (msg) {
+        case U8X8_MSG_BYTE_INIT:
+        case U8X8_MSG_BYTE_SET_DC:
+            break;
+        case U8X8_MSG_BYTE_START_TRANSFER:
+            swTransfer.clear();
+            break;
+        case U8X8_MSG_BYTE_SEND:
+            swTransfer.insert(swTransfer.end(), (uint8_t*)argPtr, (uint8_t*)argPtr + argInt);
+            break;
+        case U8X8_MSG_BYTE_END_TRANSFER:
+            halI2cWrite(u8x8_GetI2CAddress(u8x8) >> 1, swTransfer.data(), swTransfer.size());
+            break;
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+static uint8_t gpioAndDelayCallback(u8x8_t* u8x8, uint8_t msg, uint8_t argInt, void* argPtr) {
+    (void)u8x8;
+    (void)msg;
+    (void)argInt;
+    (void)argPtr;
+    return 1;
+}
+
+static const uint8_t DATA_CHUNK = 24;      // ssd13xx_fast_i2c每次写的数据字节数
+
+uint8_t u8x8_DrawTile(u8x8_t* u8x8, uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tilePtr) {
+    const uint8_t column = x * 8;
+    uint8_t position[4] = {
+        0x00,                           // 控制字节: 命令
+        (uint8_t)(0x10 | (column >> 4)),
+        (uint8_t)(column & 0x0F),
+        (uint8_t)(0xB0 | y)
+    };
+    u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_START_TRANSFER, 0, NULL);
+    u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_SEND, sizeof(position), position);
+    u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_END_TRANSFER, 0, NULL);
+
+    uint8_t dataControl = 0x40;
+    size_t remaining = (size_t)cnt * 8;
+    while (remaining > 0) {
+        const uint8_t length = (uint8_t)min(remaining, (size_t)DATA_CHUNK);
+        u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_START_TRANSFER, 0, NULL);
+        u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_SEND, 1, &dataControl);
+        u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_SEND, length, tilePtr);
+        u8x8->byte_cb(u8x8, U8X8_MSG_BYTE_END_TRANSFER, 0, NULL);
+        tilePtr += length;
+        remaining -= length;
+    }
+    return 1;
+}
+
+// ==================== 字体 ====================
+
+// 字体只有度量: ASCII字宽、5x7点阵放大倍数、中文字宽 (0=无中文)
+const uint8_t u8g2_font_5x7_tf[] = { 5, 1, 0 };
+const uint8_t u8g2_font_6x10_tf[] = { 6, 1, 0 };
+const uint8_t u8g2_font_logisoso16_tn[] = { 11, 2, 0 };
+const uint8_t u8g2_font_wqy12_t_gb2312[] = { 6, 1, 12 };
+
+enum FontField {
+    FONT_ADVANCE = 0,
+    FONT_SCALE,
+    FONT_WIDE_ADVANCE
+};
+
+// 经典5x7点阵 (0x20-0x7E)，每字符5列，每列低位在上
+static const uint8_t GLYPHS[][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x56,0x20,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x14,0x08,0x3E,0x08,0x14}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08}
+};
+
+static const int GLYPH_ROWS = 7;
+
+/**
+ * 取下一个字符
+ * @param utf8 true=按UTF-8解码，false=每字节一个字符
+ */
+static uint32_t nextCode(const char*& str, bool utf8) {
+    const uint8_t first = (uint8_t)*str++;
+    if (!utf8 || first < 0x80) {
+        return first;
+    }
+    int extra = first >= 0xF0 ? 3 : (first >= 0xE0 ? 2 : (first >= 0xC0 ? 1 : 0));
+    uint32_t code = first & (0x3F >> extra);
+    for (; extra > 0 && (*str & 0xC0) == 0x80; extra--) {
+        code = (code << 6) | (*str++ & 0x3F);
+    }
+    return code;
+}
+
+// ==================== U8G2 ====================
+
+U8G2::U8G2(uint8_t clock, uint8_t data, uint8_t reset)
+    : _font(u8g2_font_6x10_tf)
+    , _drawColor(1)
+{
+    _u8x8.byte_cb = swByteCallback;
+    _u8x8.gpio_and_delay_cb = gpioAndDelayCallback;
+    _u8x8.i2c_address = OLED_ADDRESS << 1;
+    _u8x8.pins[0] = clock;
+    _u8x8.pins[1] = data;
+    _u8x8.pins[2] = reset;
+    memset(_buffer, 0, sizeof(_buffer));
+}
+
+bool U8G2::begin() {
+    // 与U8g2的ssd1306_128x64_noname初始化序列相同
+    static const uint8_t INIT_SEQUENCE[] = {
+        0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14, 0x20, 0x00,
+        0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1, 0xDB, 0x40, 0x2E, 0xA4, 0xA6
+    };
+
+    u8x8_gpio_Init(&_u8x8);
+    if (!_u8x8.byte_cb(&_u8x8, U8X8_MSG_BYTE_INIT, 0, NULL)) {
+        return false;
+    }
+    sendCommands(INIT_SEQUENCE, sizeof(INIT_SEQUENCE));
+    clearDisplay();
+    setPowerSave(0);
+    return true;
+}
+
+void U8G2::sendCommands(const uint8_t* commands, uint8_t length) {
+    uint8_t control = 0x00;
+    _u8x8.byte_cb(&_u8x8, U8X8_MSG_BYTE_START_TRANSFER, 0, NULL);
+    _u8x8.byte_cb(&_u8x8, U8X8_MSG_BYTE_SEND, 1, &control);
+    _u8x8.byte_cb(&_u8x8, U8X8_MSG_BYTE_SEND, length, (void*)commands);
+    _u8x8.byte_cb(&_u8x8, U8X8_MSG_BYTE_END_TRANSFER, 0, NULL);
+}
+
+void U8G2::clearBuffer() {
+    memset(_buffer, 0, sizeof(_buffer));
+}
+
+void U8G2::sendBuffer() {
+    for (int y = 0; y < TILE_HEIGHT; y++) {
+        u8x8_DrawTile(&_u8x8, 0, y, TILE_WIDTH, &_buffer[y * WIDTH]);
+    }
+}
+
+void U8G2::clearDisplay() {
+    clearBuffer();
+    sendBuffer();
+}
+
+void U8G2::setPowerSave(uint8_t isEnable) {
+    const uint8_t command = isEnable ? 0xAE : 0xAF;
+    sendCommands(&command, 1);
+}
+
+void U8G2::setContrast(uint8_t value) {
+    const uint8_t commands[] = { 0x81, value };
+    sendCommands(commands, sizeof(commands));
+}
+
+void U8G2::drawPixel(int x, int y) {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) {
+        return;
+    }
+    uint8_t& column = _buffer[(y >> 3) * WIDTH + x];
+    const uint8_t mask = 1 << (y & 7);
+    switch (_drawColor) {
+        case 0: column &= ~mask; break;
+        case 1: column |= mask; break;
+        default: column ^= mask; break;
+    }
+}
+
+void U8G2::drawHLine(int x, int y, int width) {
+    for (int i = 0; i < width; i++) {
+        drawPixel(x + i, y);
+    }
+}
+
+void U8G2::drawVLine(int x, int y, int height) {
+    for (int i = 0; i < height; i++) {
+        drawPixel(x, y + i);
+    }
+}
+
+void U8G2::drawBox(int x, int y, int width, int height) {
+    for (int i = 0; i < height; i++) {
+        drawHLine(x, y + i, width);
+    }
+}
+
+void U8G2::drawFrame(int x, int y, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    drawHLine(x, y, width);
+    if (height > 1) {
+        drawHLine(x, y + height - 1, width);
+    }
+    if (height > 2) {
+        drawVLine(x, y + 1, height - 2);
+        if (width > 1) {
+            drawVLine(x + width - 1, y + 1, height - 2);
+        }
+    }
+}
+
+int U8G2::drawGlyph(int x, int y, uint32_t code, bool draw) {
+    const int scale = _font[FONT_SCALE];
+    if (code >= 0x20 && code <= 0x7E) {
+        if (draw) {
+            const uint8_t* glyph = GLYPHS[code - 0x20];
+            const int top = y - GLYPH_ROWS * scale;
+            for (int col = 0; col < 5; col++) {
+                for (int row = 0; row < GLYPH_ROWS; row++) {
+                    if (glyph[col] & (1 << row)) {
+                        drawBox(x + col * scale, top + row * scale, scale, scale);
+                    }
+                }
+            }
+        }
+        return _font[FONT_ADVANCE];
+    }
+
+    // 中文等宽字符画成方框，字体没有的字符跳过 (与U8g2相同)
+    const int wide = _font[FONT_WIDE_ADVANCE];
+    if (code < 0x80 || wide == 0) {
+        return 0;
+    }
+    if (draw) {
+        drawFrame(x + 1, y - wide + 2, wide - 2, wide - 1);
+    }
+    return wide;
+}
+
+int U8G2::drawText(int x, int y, const char* str, bool utf8, bool draw) {
+    int width = 0;
+    while (*str != '\0') {
+        width += drawGlyph(x + width, y, nextCode(str, utf8), draw);
+    }
+    return width;
+}
+
+int U8G2::drawStr(int x, int y, const char* str) {
+    return drawText(x, y, str, false, true);
+}
+
+int U8G2::drawUTF8(int x, int y, const char* str) {
+    return drawText(x, y, str, true, true);
+}
+
+int U8G2::getStrWidth(const char* str) {
+    return drawText(0, 0, str, false, false);
+}
+
+int U8G2::getUTF8Width(const char* str) {
+    return drawText(0, 0, str, true, false);
+}
@@ -0,0 +1,382 @@
+/**
+ * @file HalDrivers.cpp
+ * @brief native环境: ESP-IDF RMT和I2C驱动、Arduino Wire、错误码
+ *
+ * I2C不模拟总线时间，每次写直接交给模拟总线 (见HalDisplay.cpp)。
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <driver/rmt.h>
+#include <driver/i2c.h>
+#include "Hal.h"
+#include "HalInternal.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ==================== 错误码 ====================
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                return "ESP_OK";
+        case ESP_FAIL:              return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+        default:                    return "UNKNOWN ERROR";
+    }
+}
+
+// ==================== RMT ====================
+
+static const uint32_t RMT_SOURCE_MHZ = 80;     // APB时钟
+
+struct RmtChannel {
+    bool configured;
+    bool installed;
+    int pin;
+    uint8_t clockDiv;
+    uint8_t idleLevel;
+    uint32_t generation;            // 每次发送或停止加1，过期的完成回调被丢弃
+    std::vector<uint32_t> items;
+};
+
+static std::mutex rmtMutex;
+static RmtChannel rmtChannels[RMT_CHANNEL_MAX];
+static rmt_tx_end_callback_t rmtCallback = { NULL, NULL };
+
+static bool validChannel(rmt_channel_t channel) {
+    return channel >= RMT_CHANNEL_0 && channel < RMT_CHANNEL_MAX;
+}
+
+esp_err_t rmt_config(const rmt_config_t* config) {
+    if (config == NULL || !validChannel(config->channel) || config->clk_div == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(rmtMutex);
+    RmtChannel& channel = rmtChannels[config->channel];
+    channel.configured = true;
+    channel.pin = config->gpio_num;
+    channel.clockDiv = config->clk_div;
+    channel.idleLevel = config->tx_config.idle_level == RMT_IDLE_LEVEL_HIGH ? HIGH : LOW;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufferSize, int interruptFlags) {
+    (void)rxBufferSize;
+    (void)interruptFlags;
+    if (!validChannel(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    std::lock_guard<std::mutex> lock(rmtMutex);
+    if (!rmtChannels[channel].configured) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    rmtChannels[channel].installed = true;
+    return ESP_OK;
+}
+
+/**
+ * 通道是否还在播放这一次发送 (rmt_tx_stop()或新的发送会让它过期)
+ */
+static bool rmtCurrent(rmt_channel_t channel, uint32_t generation) {
+    std::lock_guard<std::mutex> lock(rmtMutex);
+    return rmtChannels[channel].generation == generation;
+}
+
+/**
+ * 按条目驱动输出引脚: 实时时钟下按绝对时间表等待 (误差不累积)，
+ * 手动时钟下直接推进时钟，引脚上的边沿时间就是条目时长之和
+ */
+static void rmtPlay(rmt_channel_t channel, uint32_t generation, const std::vector<uint32_t>& items,
+                    int pin, uint8_t clockDiv, uint8_t idleLevel) {
+    const bool manual = Hal::isManualClock();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t offsetUs = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+        rmt_item32_t item;
+        item.val = items[i];
+        const uint32_t durations[2] = { item.duration0, item.duration1 };
+        const uint8_t levels[2] = { (uint8_t)item.level0, (uint8_t)item.level1 };
+        for (int half = 0; half < 2; half++) {
+            // 时长为0是结束标记
+            if (durations[half] == 0) {
+                i = items.size();
+                break;
+            }
+            if (!rmtCurrent(channel, generation)) {
+                return;
+            }
+            digitalWrite(pin, levels[half]);
+            const uint64_t us = (uint64_t)durations[half] * clockDiv / RMT_SOURCE_MHZ;
+            offsetUs += us;
+            if (manual) {
+                Hal::advanceMicros(us);
+            } else {
+                std::this_thread::sleep_until(start + std::chrono::microseconds(offsetUs));
+            }
+        }
+    }
+    digitalWrite(pin, idleLevel);
+}
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t* items, int count, bool waitDone) {
+    if (!validChannel(channel) || items == NULL || count <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t generation;
+    std::vector<uint32_t> program;
+    int pin;
+    uint8_t clockDiv;
+    uint8_t idleLevel;
+    {
+        std::lock_guard<std::mutex> lock(rmtMutex);
+        RmtChannel& state = rmtChannels[channel];
+        if (!state.installed) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        state.items.clear();
+        for (int i = 0; i < count; i++) {
+            state.items.push_back(items[i].val);
+            // 时长为0的条目是结束标记
+            if (items[i].duration0 == 0 || items[i].duration1 == 0) {
+                break;
+            }
+        }
+        generation = ++state.generation;
+        program = state.items;
+        pin = state.pin;
+        clockDiv = state.clockDiv;
+        idleLevel = state.idleLevel;
+    }
+
+    std::thread sender([channel, generation, program, pin, clockDiv, idleLevel]() {
+        rmtPlay(channel, generation, program, pin, clockDiv, idleLevel);
+        rmt_tx_end_callback_t callback;
+        {
+            std::lock_guard<std::mutex> lock(rmtMutex);
+            if (rmtChannels[channel].generation != generation) {
+                return;
+            }
+            callback = rmtCallback;
+        }
+        if (callback.function != NULL) {
+            callback.function(channel, callback.arg);
+        }
+    });
+    if (waitDone) {
+        sender.join();
+    } else {
+        sender.detach();
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_stop(rmt_channel_t channel) {
+    if (!validChannel(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int pin;
+    uint8_t idleLevel;
+    {
+        std::lock_guard<std::mutex> lock(rmtMutex);
+        rmtChannels[channel].generation++;
+        pin = rmtChannels[channel].pin;
+        idleLevel = rmtChannels[channel].idleLevel;
+    }
+    // 播放线程在下一步之前发现过期后退出，引脚回到空闲电平
+    digitalWrite(pin, idleLevel);
+    return ESP_OK;
+}
+
+rmt_tx_end_callback_t rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void* arg) {
+    std::lock_guard<std::mutex> lock(rmtMutex);
+    const rmt_tx_end_callback_t previous = rmtCallback;
+    rmtCallback.function = function;
+    rmtCallback.arg = arg;
+    return previous;
+}
+
+const uint32_t* Hal::getRmtItems(int channel, size_t& count) {
+    std::lock_guard<std::mutex> lock(rmtMutex);
+    if (!validChannel((rmt_channel_t)channel)) {
+        count = 0;
+        return NULL;
+    }
+    count = rmtChannels[channel].items.size();
+    return rmtChannels[channel].items.data();
+}
+
+// ==================== I2C ====================
+
+struct I2cCommand {
+    enum Type { START, WRITE, STOP } type;
+    std::vector<uint8_t> data;
+};
+
+struct I2cLink {
+    std::vector<I2cCommand> commands;
+};
+
+static bool i2cInstalled[I2C_NUM_MAX];
+
+static bool validPort(i2c_port_t port) {
+    return port >= 0 && port < I2C_NUM_MAX;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t* config) {
+    return (validPort(port) && config != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t rxBufferSize,
+                             size_t txBufferSize, int interruptFlags) {
+    (void)rxBufferSize;
+    (void)txBufferSize;
+    (void)interruptFlags;
+    if (!validPort(port) || mode != I2C_MODE_MASTER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (i2cInstalled[port]) {
+        return ESP_FAIL;
+    }
+    i2cInstalled[port] = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t port) {
+    if (!validPort(port) || !i2cInstalled[port]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    i2cInstalled[port] = false;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t* buffer, uint32_t size) {
+    (void)buffer;
+    (void)size;
+    return new I2cLink();
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd) {
+    delete (I2cLink*)cmd;
+}
+
+static esp_err_t addCommand(i2c_cmd_handle_t cmd, I2cCommand::Type type,
+                            const uint8_t* data = NULL, size_t length = 0) {
+    if (cmd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    I2cCommand command;
+    command.type = type;
+    command.data.assign(data, data + length);
+    ((I2cLink*)cmd)->commands.push_back(command);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+    return addCommand(cmd, I2cCommand::START);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+    return addCommand(cmd, I2cCommand::STOP);
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ackEnable) {
+    (void)ackEnable;
+    return addCommand(cmd, I2cCommand::WRITE, &data, 1);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t length, bool ackEnable) {
+    (void)ackEnable;
+    return addCommand(cmd, I2cCommand::WRITE, data, length);
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticksToWait) {
+    (void)ticksToWait;
+    if (!validPort(port) || cmd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!i2cInstalled[port]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 起始条件 (含重复起始) 和停止条件之间是一次写，第一个字节是地址
+    std::vector<uint8_t> transfer;
+    bool inTransfer = false;
+    const std::vector<I2cCommand>& commands = ((I2cLink*)cmd)->commands;
+    for (size_t i = 0; i <= commands.size(); i++) {
+        const bool boundary = i == commands.size() || commands[i].type != I2cCommand::WRITE;
+        if (boundary && inTransfer) {
+            if (transfer.empty() || !halI2cWrite(transfer[0] >> 1, transfer.data() + 1, transfer.size() - 1)) {
+                return ESP_FAIL;
+            }
+            inTransfer = false;
+        }
+        if (i == commands.size()) {
+            break;
+        }
+        if (commands[i].type == I2cCommand::START) {
+            transfer.clear();
+            inTransfer = true;
+        } else if (commands[i].type == I2cCommand::WRITE && inTransfer) {
+            transfer.insert(transfer.end(), commands[i].data.begin(), commands[i].data.end());
+        }
+    }
+    return ESP_OK;
+}
+
+// ==================== Wire ====================
+
+TwoWire Wire;
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    (void)frequency;
+    return true;
+}
+
+bool TwoWire::end() {
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    (void)frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    _address = address;
+    _length = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+    if (_length >= BUFFER_SIZE) {
+        return 0;
+    }
+    _buffer[_length++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+    size_t written = 0;
+    while (written < length && write(data[written]) == 1) {
+        written++;
+    }
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    const bool ack = halI2cWrite(_address, _buffer, _length);
+    _length = 0;
+    return ack ? 0 : 2;
+}
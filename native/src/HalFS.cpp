@@ -0,0 +1,252 @@
+/**
+ * @file HalFS.cpp
+ * @brief native环境: 把LittleFS映射到主机目录
+ */
+
+#include <FS.h>
+#include <LittleFS.h>
+#include <esp32-hal-log.h>
+#include "Hal.h"
+
+#include <atomic>
+#include <dirent.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char* TAG = "LittleFS";
+
+static std::string fsRoot;
+
+void Hal::setFsRoot(const char* dir) {
+    fsRoot = dir;
+    while (fsRoot.size() > 1 && fsRoot[fsRoot.size() - 1] == '/') {
+        fsRoot.erase(fsRoot.size() - 1);
+    }
+}
+
+static std::atomic<Hal::FsTap> fsTap(NULL);
+
+void Hal::setFsTap(FsTap tap) {
+    fsTap = tap;
+}
+
+/**
+ * 写操作前询问监听回调，false=操作失败
+ */
+static bool allowWrite(const char* op, const char* path) {
+    const Hal::FsTap tap = fsTap;
+    return tap == NULL || tap(op, path);
+}
+
+const char* Hal::getFsRoot() {
+    if (fsRoot.empty()) {
+        const char* env = getenv("RF_REMOTE_FS");
+        setFsRoot((env != NULL && env[0] != '\0') ? env : "./littlefs");
+    }
+    return fsRoot.c_str();
+}
+
+namespace fs {
+
+// ==================== File ====================
+
+File::Handle::~Handle() {
+    if (file != NULL) {
+        fclose(file);
+    }
+}
+
+File::File(FILE* file, const char* path) : _handle(new Handle()) {
+    _handle->file = file;
+    _handle->path = path;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!*this || !allowWrite("write", path())) return 0;
+    return fwrite(buffer, 1, size, _handle->file);
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+    if (!*this) return 0;
+    return fread(buffer, 1, size, _handle->file);
+}
+
+int File::available() {
+    if (!*this) return 0;
+    return (int)(size() - position());
+}
+
+void File::flush() {
+    if (*this) {
+        fflush(_handle->file);
+    }
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!*this) return false;
+    static const int WHENCE[] = { SEEK_SET, SEEK_CUR, SEEK_END };
+    return fseek(_handle->file, pos, WHENCE[mode]) == 0;
+}
+
+size_t File::position() const {
+    if (!*this) return 0;
+    const long pos = ftell(_handle->file);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+size_t File::size() const {
+    if (!*this) return 0;
+    fflush(_handle->file);
+    struct stat info;
+    return fstat(fileno(_handle->file), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+void File::close() {
+    if (*this) {
+        fclose(_handle->file);
+        _handle->file = NULL;
+    }
+}
+
+const char* File::path() const {
+    return _handle ? _handle->path.c_str() : NULL;
+}
+
+// ==================== FS ====================
+
+File FS::open(const char* path, const char* mode) {
+    // 和LittleFS一样按二进制打开
+    std::string hostMode(mode);
+    const size_t plus = hostMode.find('+');
+    hostMode = hostMode.substr(0, 1) + "b" + (plus != std::string::npos ? "+" : "");
+    if ((hostMode[0] != 'r' || plus != std::string::npos) && !allowWrite("open", path)) {
+        return File();
+    }
+
+    FILE* file = fopen(hostPath(path).c_str(), hostMode.c_str());
+    if (file == NULL) {
+        if (hostMode[0] != 'r' || errno != ENOENT) {
+            ESP_LOGE(TAG, "打开失败: %s (%s)", path, strerror(errno));
+        }
+        return File();
+    }
+    return File(file, path);
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return allowWrite("remove", path) && unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    return allowWrite("rename", pathFrom) && ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+// ==================== LittleFS ====================
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles,
+                       const char* partitionLabel) {
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+
+    const char* root = Hal::getFsRoot();
+    struct stat info;
+    if (stat(root, &info) != 0) {
+        if (!formatOnFail || ::mkdir(root, 0755) != 0) {
+            ESP_LOGE(TAG, "目录不存在: %s", root);
+            return false;
+        }
+        ESP_LOGI(TAG, "创建目录: %s", root);
+    } else if (!S_ISDIR(info.st_mode)) {
+        ESP_LOGE(TAG, "不是目录: %s", root);
+        return false;
+    }
+    _mounted = true;
+    return true;
+}
+
+static void removeTree(const std::string& path, bool removeSelf) {
+    DIR* dir = opendir(path.c_str());
+    if (dir != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                removeTree(path + "/" + entry->d_name, true);
+            }
+        }
+        closedir(dir);
+        if (removeSelf) {
+            ::rmdir(path.c_str());
+        }
+    } else if (removeSelf) {
+        unlink(path.c_str());
+    }
+}
+
+bool LittleFSFS::format() {
+    removeTree(Hal::getFsRoot(), false);
+    return true;
+}
+
+static size_t treeSize(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        return info.st_size;
+    }
+    size_t total = 0;
+    DIR* dir = opendir(path.c_str());
+    if (dir != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                total += treeSize(path + "/" + entry->d_name);
+            }
+        }
+        closedir(dir);
+    }
+    return total;
+}
+
+size_t LittleFSFS::totalBytes() {
+    return 0x160000;        // 默认分区表 (4MB) 的spiffs分区大小
+}
+
+size_t LittleFSFS::usedBytes() {
+    return treeSize(Hal::getFsRoot());
+}
+
+std::string LittleFSFS::hostPath(const char* path) const {
+    std::string result(Hal::getFsRoot());
+    if (path[0] != '/') {
+        result += '/';
+    }
+    return result + path;
+}
+
+} // namespace fs
+
+fs::LittleFSFS LittleFS;
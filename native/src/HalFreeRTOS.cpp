@@ -0,0 +1,290 @@
+/**
+ * @file HalFreeRTOS.cpp
+ * @brief native环境: 用std::thread实现FreeRTOS任务、通知、信号量、队列和事件组
+ *
+ * 超时按系统时钟计算 (1 tick = 1 ms)，不受Hal手动时钟影响。
+ * 句柄不回收 (固件里的任务和同步对象都常驻)。
+ */
+
+#include <Arduino.h>
+#include "HalInternal.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char* TAG = "FreeRTOS";
+
+/**
+ * 按ticksToWait等待条件成立
+ * @return 条件是否成立
+ */
+template <typename Predicate>
+static bool waitFor(std::condition_variable& condition, std::unique_lock<std::mutex>& lock,
+                    TickType_t ticksToWait, Predicate predicate) {
+    if (ticksToWait == portMAX_DELAY) {
+        condition.wait(lock, predicate);
+        return true;
+    }
+    return condition.wait_for(lock, std::chrono::milliseconds(ticksToWait), predicate);
+}
+
+// ==================== 任务 ====================
+
+struct HalTask {
+    std::string name;
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint32_t notifyValue;
+
+    explicit HalTask(const char* taskName) : name(taskName), notifyValue(0) {}
+};
+
+// vTaskDelete(NULL)用异常退出任务线程
+struct TaskDeleted {};
+
+static thread_local HalTask* currentTask = NULL;
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                       void* parameter, UBaseType_t priority, TaskHandle_t* handle) {
+    (void)stackDepth;
+    (void)priority;
+
+    HalTask* task = new HalTask(name);
+    if (handle != NULL) {
+        *handle = task;
+    }
+    std::thread([task, function, parameter]() {
+        currentTask = task;
+        try {
+            function(parameter);
+            ESP_LOGE(TAG, "任务 %s 返回 (FreeRTOS任务不能返回)", task->name.c_str());
+        } catch (const TaskDeleted&) {
+        }
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+    (void)coreId;
+    return xTaskCreate(function, name, stackDepth, parameter, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL || task == currentTask) {
+        throw TaskDeleted();
+    }
+    ESP_LOGW(TAG, "不支持删除其他任务 (%s)", task->name.c_str());
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+    }
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)halRealMillis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (currentTask == NULL) {
+        // setup()/loop()所在的主线程
+        currentTask = new HalTask("loopTask");
+    }
+    return currentTask;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    HalTask* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    waitFor(task->condition, lock, ticksToWait, [task]() { return task->notifyValue > 0; });
+    const uint32_t value = task->notifyValue;
+    if (value > 0) {
+        task->notifyValue = clearOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notifyValue++;
+    task->condition.notify_all();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(task);
+    if (higherPriorityTaskWoken != NULL) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+// ==================== 信号量 ====================
+
+struct HalSemaphore {
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint32_t count;
+
+    explicit HalSemaphore(uint32_t initial) : count(initial) {}
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new HalSemaphore(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new HalSemaphore(0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!waitFor(semaphore->condition, lock, ticksToWait, [semaphore]() { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count > 0) {
+        return pdFALSE;
+    }
+    semaphore->count = 1;
+    semaphore->condition.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != NULL) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+// ==================== 队列 ====================
+
+struct HalQueue {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::vector<uint8_t> > items;
+    size_t length;
+    size_t itemSize;
+
+    HalQueue(size_t queueLength, size_t size) : length(queueLength), itemSize(size) {}
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new HalQueue(length, itemSize);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue->condition, lock, ticksToWait, [queue]() { return queue->items.size() < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->itemSize));
+    queue->condition.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != NULL) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!waitFor(queue->condition, lock, ticksToWait, [queue]() { return !queue->items.empty(); })) {
+        return errQUEUE_EMPTY;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    queue->condition.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->items.size();
+}
+
+// ==================== 事件组 ====================
+
+struct HalEventGroup {
+    std::mutex mutex;
+    std::condition_variable condition;
+    EventBits_t bits;
+
+    HalEventGroup() : bits(0) {}
+};
+
+EventGroupHandle_t xEventGroupCreate() {
+    return new HalEventGroup();
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+    delete group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> lock(group->mutex);
+    group->bits |= bits;
+    group->condition.notify_all();
+    return group->bits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits,
+                                     BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != NULL) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    xEventGroupSetBits(group, bits);
+    return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> lock(group->mutex);
+    const EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    std::lock_guard<std::mutex> lock(group->mutex);
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clearOnExit,
+                                BaseType_t waitForAll, TickType_t ticksToWait) {
+    std::unique_lock<std::mutex> lock(group->mutex);
+    const bool satisfied = waitFor(group->condition, lock, ticksToWait, [group, bits, waitForAll]() {
+        return waitForAll ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+    });
+    const EventBits_t value = group->bits;
+    if (satisfied && clearOnExit) {
+        group->bits &= ~bits;
+    }
+    return value;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file HalInternal.h
+ * @brief native/src各模块之间共享的内部接口 (固件和模拟程序都不用)
+ */
+
+#ifndef HAL_INTERNAL_H
+#define HAL_INTERNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * 系统单调时钟 (ms)，不受手动时钟影响，用于超时和任务延时
+ */
+uint64_t halRealMillis();
+
+/**
+ * 一次I2C写 (起始条件 + 地址 + 数据 + 停止条件)
+ * @param address 7位地址
+ * @return false=地址无应答
+ */
+bool halI2cWrite(uint8_t address, const uint8_t* data, size_t length);
+
+#endif // HAL_INTERNAL_H
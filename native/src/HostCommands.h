@@ -0,0 +1,38 @@
+/**
+ * @file HostCommands.h
+ * @brief native程序各子命令的入口 (HostMain.cpp分发)
+ */
+
+#ifndef HOST_COMMANDS_H
+#define HOST_COMMANDS_H
+
+#include <stdint.h>
+
+struct RCSwitchFrame;
+
+/**
+ * 单调时钟 (秒)，用于测量主机上的耗时
+ */
+double hostSeconds();
+
+/**
+ * 处理器周期计数 (x86上是TSC，其他平台退化为纳秒)，用于比较解码开销
+ */
+uint64_t hostCycles();
+
+// TraceTool.cpp
+int runReplay(int argc, char** argv);
+int runCorpus(int argc, char** argv);
+
+// FuzzTool.cpp
+int runFuzz(int argc, char** argv);
+
+/**
+ * 按解出的协议、编码、位数和脉宽重发的波形与按protocol发送code的波形是否相同
+ */
+bool sameWaveform(unsigned int protocol, uint64_t code, unsigned int bits, const RCSwitchFrame& frame);
+
+// RocTool.cpp
+int runRoc(int argc, char** argv);
+
+#endif // HOST_COMMANDS_H
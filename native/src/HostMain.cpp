@@ -0,0 +1,805 @@
+/**
+ * @file HostMain.cpp
+ * @brief native环境的程序入口
+ *
+ *   rf-remote sim [秒数] [按键@毫秒 ...]   运行固件的setup()/loop()，结束时打印屏幕
+ *                                          按键: up / ok / down，例如 ok@500 down@1200
+ *   rf-remote bench [decoder|storage|render] 基准测试 (默认全部)，解码成功率低于下限时返回1
+ *   rf-remote replay [清单|轨迹.rft ...]     回放边沿轨迹，统计解码结果和耗时
+ *                                          (默认 native/corpus/corpus.txt)
+ *   rf-remote corpus [目录]                 重新生成合成的轨迹语料
+ *   rf-remote fuzz [次数] [漂移%] [容差%] [种子]
+ *                                          收发往返模糊测试 (12个协议 x 抖动)
+ *   rf-remote roc [次数] [噪声秒数] [位数] [毛刺/秒] [残帧/秒] [种子]
+ *                                          噪声信道下扫描接收容差和过滤设置
+ *
+ * 串口输出写到标准输出，日志写到标准错误；sim模式下标准输入接到Serial。
+ * 单元测试 (pio test -e native) 由test/下的测试提供main()，这里的入口不编译。
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "Hal.h"
+#include "HostCommands.h"
+#include "pin_config.h"
+#include "RCSwitch.h"
+#include "PulseProgram.h"
+#include "DecoderHarness.h"
+#include "SignalStorage.h"
+#include "Display.h"
+#include "TileDiff.h"
+#include "Menu.h"
+#include "StatusBar.h"
+
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 固件入口 (src/main.cpp)
+void setup();
+void loop();
+
+double hostSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t hostCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// 单元测试只用上面的计时函数
+#ifndef PIO_UNIT_TESTING
+
+namespace {
+
+// 空载电池电压 (ADC引脚，分压后)，约3.9V
+const uint32_t BATTERY_MILLIVOLTS = 350;
+
+const int PRESS_MS = 80;
+
+/**
+ * 可复现的伪随机数 (xorshift32)
+ */
+uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void usage() {
+    fprintf(stderr,
+            "用法:\n"
+            "  rf-remote sim [秒数] [up|ok|down@毫秒 ...]\n"
+            "  rf-remote bench [decoder|storage|render]\n"
+            "  rf-remote replay [清单|轨迹.rft ...]\n"
+            "  rf-remote corpus [目录]\n"
+            "  rf-remote fuzz [次数] [漂移%%] [容差%%] [种子]\n"
+            "  rf-remote roc [次数] [噪声秒数] [位数] [毛刺/秒] [残帧/秒] [种子]\n"
+            "环境变量 RF_REMOTE_FS 指定LittleFS目录 (默认 ./littlefs)\n");
+}
+
+// ==================== sim ====================
+
+struct Press {
+    uint8_t pin;
+    unsigned long atMs;
+};
+
+bool parsePress(const char* text, Press& press) {
+    const char* at = strchr(text, '@');
+    if (at == NULL) {
+        return false;
+    }
+    const std::string name(text, at - text);
+    if (name == "up") {
+        press.pin = BTN_UP_PIN;
+    } else if (name == "ok") {
+        press.pin = BTN_OK_PIN;
+    } else if (name == "down") {
+        press.pin = BTN_DOWN_PIN;
+    } else {
+        return false;
+    }
+    press.atMs = strtoul(at + 1, NULL, 10);
+    return true;
+}
+
+int runSim(int argc, char** argv) {
+    const double seconds = argc > 2 ? atof(argv[2]) : 3.0;
+    std::vector<Press> presses;
+    for (int i = 3; i < argc; i++) {
+        Press press;
+        if (!parsePress(argv[i], press)) {
+            usage();
+            return 2;
+        }
+        presses.push_back(press);
+    }
+
+    Hal::setAnalogMillivolts(BAT_ADC_PIN, BATTERY_MILLIVOLTS);
+    Hal::attachSerialStdin();
+    setup();
+
+    // 按键由单独的线程按时间表驱动，主线程照常运行loop()
+    const unsigned long start = millis();
+    std::thread([presses, start]() {
+        for (size_t i = 0; i < presses.size(); i++) {
+            const unsigned long elapsed = millis() - start;
+            if (presses[i].atMs > elapsed) {
+                delay(presses[i].atMs - elapsed);
+            }
+            Hal::setInput(presses[i].pin, LOW);
+            delay(PRESS_MS);
+            Hal::setInput(presses[i].pin, HIGH);
+        }
+    }).detach();
+
+    while (millis() - start < seconds * 1000) {
+        loop();
+    }
+
+    fflush(stdout);
+    Hal::dumpScreen(stdout);
+    return 0;
+}
+
+// ==================== bench: decoder ====================
+
+const unsigned int DECODER_PROTOCOLS = 12;       // RCSwitch的协议1-12
+const int DECODER_CODES_PER_PROTOCOL = 200;
+const int DECODER_BITS = 24;
+const int DECODER_REPEATS = 4;
+const unsigned int DECODER_PROCESS_EVERY = 32;    // 每隔多少个边沿调用一次processEdges (缓冲区256)
+const uint32_t DECODER_IDLE_US = 20000;
+
+// 各协议编码和协议都解对的下限 (%)。协议9和协议8是同一串电平错开半位，
+// 以1结尾的编码两种读法误差相同，解成编号小的协议8，只能靠重放波形相同
+const int DECODER_PROTOCOL_FLOORS[DECODER_PROTOCOLS] = { 99, 99, 99, 99, 99, 99, 99, 99, 40, 99, 99, 99 };
+// 解出的帧按它的协议重放与原信号相同的下限 (%)，所有协议
+const int DECODER_REPLAY_FLOOR = 99;
+
+/**
+ * @return 各协议都达到下限
+ */
+bool benchDecoder() {
+    printf("== decoder: RCSwitch433, %d bits, %d repeats, %d codes/protocol ==\n",
+           DECODER_BITS, DECODER_REPEATS, DECODER_CODES_PER_PROTOCOL);
+    printf("proto  frames/tx  code ok  proto ok  replay ok  isr ns/edge  decode ns/edge\n");
+
+    Hal::useManualClock(1000000);
+    RCSwitch433 receiver;
+    receiver.enableReceive(RF_433_RX_PIN);
+    RCSwitch433 sender;
+    sender.setRepeatTransmit(DECODER_REPEATS);
+    PulseProgram program;
+    program.reserve(1024);
+
+    uint32_t seed = 1;
+    unsigned long totalEdges = 0;
+    double totalIsr = 0;
+    double totalDecode = 0;
+    int totalCodes = 0;
+    int totalOk = 0;
+    int violations = 0;
+
+    for (unsigned int p = 1; p <= DECODER_PROTOCOLS; p++) {
+        sender.setProtocol(p);
+        unsigned long edges = 0;
+        unsigned long frames = 0;
+        int codeOk = 0;
+        int protocolOk = 0;
+        int replayOk = 0;
+        double isrTime = 0;
+        double decodeTime = 0;
+
+        for (int i = 0; i < DECODER_CODES_PER_PROTOCOL; i++) {
+            const uint64_t code = nextRandom(seed) & ((1UL << DECODER_BITS) - 1);
+            sender.compile(RFCode(code), DECODER_BITS, program);
+
+            // 上一轮的残留: 静默后把队列清空
+            Hal::setInput(RF_433_RX_PIN, LOW);
+            Hal::advanceMicros(DECODER_IDLE_US);
+            RCSwitch433::processEdges();
+            RCSwitch433::ReceivedFrame frame;
+            while (receiver.readFrame(frame)) {}
+
+            const PulseStep* steps = program.steps();
+            for (size_t s = 0; s < program.size(); s++) {
+                const uint32_t levels[2] = { steps[s].level0, steps[s].level1 };
+                const uint32_t durations[2] = { steps[s].duration0, steps[s].duration1 };
+                for (int half = 0; half < 2 && durations[half] > 0; half++) {
+                    double t = hostSeconds();
+                    Hal::setInput(RF_433_RX_PIN, levels[half]);
+                    isrTime += hostSeconds() - t;
+                    Hal::advanceMicros(durations[half]);
+                    if (++edges % DECODER_PROCESS_EVERY == 0) {
+                        t = hostSeconds();
+                        RCSwitch433::processEdges();
+                        decodeTime += hostSeconds() - t;
+                    }
+                }
+            }
+            Hal::setInput(RF_433_RX_PIN, LOW);
+            Hal::advanceMicros(DECODER_IDLE_US);
+            const double t = hostSeconds();
+            RCSwitch433::processEdges();
+            decodeTime += hostSeconds() - t;
+
+            bool matched = false;
+            bool protocolMatched = false;
+            bool replayMatched = false;
+            while (receiver.readFrame(frame)) {
+                frames++;
+                if (frame.code == RFCode(code) && frame.bitlength == (unsigned int)DECODER_BITS) {
+                    matched = true;
+                    protocolMatched = protocolMatched || frame.protocol == p;
+                }
+                replayMatched = replayMatched || protocolMatched || sameWaveform(p, code, DECODER_BITS, frame);
+            }
+            codeOk += matched ? 1 : 0;
+            protocolOk += protocolMatched ? 1 : 0;
+            replayOk += replayMatched ? 1 : 0;
+        }
+
+        printf("%5u  %9.2f  %6.1f%%  %7.1f%%  %8.1f%%  %11.0f  %14.0f\n", p,
+               (double)frames / DECODER_CODES_PER_PROTOCOL,
+               100.0 * codeOk / DECODER_CODES_PER_PROTOCOL,
+               100.0 * protocolOk / DECODER_CODES_PER_PROTOCOL,
+               100.0 * replayOk / DECODER_CODES_PER_PROTOCOL,
+               isrTime * 1e9 / edges, decodeTime * 1e9 / edges);
+        if (protocolOk * 100 < DECODER_PROTOCOL_FLOORS[p - 1] * DECODER_CODES_PER_PROTOCOL) {
+            printf("FAIL p%u: %.1f%% proto ok, floor %d%%\n", p,
+                   100.0 * protocolOk / DECODER_CODES_PER_PROTOCOL, DECODER_PROTOCOL_FLOORS[p - 1]);
+            violations++;
+        }
+        if (replayOk * 100 < DECODER_REPLAY_FLOOR * DECODER_CODES_PER_PROTOCOL) {
+            printf("FAIL p%u: %.1f%% replay ok, floor %d%%\n", p,
+                   100.0 * replayOk / DECODER_CODES_PER_PROTOCOL, DECODER_REPLAY_FLOOR);
+            violations++;
+        }
+        totalEdges += edges;
+        totalIsr += isrTime;
+        totalDecode += decodeTime;
+        totalCodes += DECODER_CODES_PER_PROTOCOL;
+        totalOk += codeOk;
+    }
+
+    receiver.disableReceive();
+    Hal::useRealClock();
+    printf("total  %lu edges, code ok %.1f%%, isr %.0f ns/edge, decode %.0f ns/edge, %s\n\n",
+           totalEdges, 100.0 * totalOk / totalCodes,
+           totalIsr * 1e9 / totalEdges, totalDecode * 1e9 / totalEdges,
+           violations == 0 ? "floors passed" : "FAILED");
+    return violations == 0;
+}
+
+// ==================== bench: decoder cycles ====================
+
+/**
+ * 改版前的解码 (rc-switch原版): 在中断里收集时序，同步间隔到达时
+ * 按编号逐个协议整帧重新匹配，第一个匹配的协议胜出。只用于对比耗时。
+ * 编码类型是模板参数: uint32_t是原来的unsigned long，RFCode用来量出
+ * 加宽编码在中断里多花的时间。
+ */
+namespace baseline {
+
+struct HighLow {
+    uint8_t high;
+    uint8_t low;
+};
+
+struct Protocol {
+    uint16_t pulseLength;
+    HighLow syncFactor;
+    HighLow zero;
+    HighLow one;
+    bool invertedSignal;
+};
+
+const Protocol PROTOCOLS[] = {
+    { 350, {  1, 31 }, {  1,  3 }, {  3,  1 }, false },
+    { 650, {  1, 10 }, {  1,  2 }, {  2,  1 }, false },
+    { 100, { 30, 71 }, {  4, 11 }, {  9,  6 }, false },
+    { 380, {  1,  6 }, {  1,  3 }, {  3,  1 }, false },
+    { 500, {  6, 14 }, {  1,  2 }, {  2,  1 }, false },
+    { 450, { 23,  1 }, {  1,  2 }, {  2,  1 }, true  },
+    { 150, {  2, 62 }, {  1,  6 }, {  6,  1 }, false },
+    { 200, {  3, 130}, {  7, 16 }, {  3, 16 }, false },
+    { 200, { 130, 7 }, { 16,  7 }, { 16,  3 }, true  },
+    { 365, { 18,  1 }, {  3,  1 }, {  1,  3 }, true  },
+    { 270, { 36,  1 }, {  1,  2 }, {  2,  1 }, true  },
+    { 320, { 36,  1 }, {  1,  2 }, {  2,  1 }, true  },
+};
+
+const unsigned int NUM_PROTOCOLS = sizeof(PROTOCOLS) / sizeof(PROTOCOLS[0]);
+const unsigned int SEPARATION_LIMIT = 4300;
+const unsigned int MAX_CHANGES = 67;
+const int TOLERANCE = 60;
+
+volatile unsigned int timings[MAX_CHANGES];
+unsigned int timingsIndex = 0;
+unsigned long lastTime = 0;
+RFCode receivedValue;
+volatile unsigned int receivedBitlength = 0;
+volatile unsigned int receivedProtocol = 0;
+RFCode expectedCode;
+unsigned int expectedProtocol = 0;
+unsigned long frames = 0;
+
+inline void shiftIn(uint32_t& code, bool bit) {
+    code = (code << 1) | (bit ? 1 : 0);
+}
+
+inline void shiftIn(RFCode& code, bool bit) {
+    code.shiftIn(bit);
+}
+
+template <typename Code>
+bool receiveProtocol(unsigned int p, unsigned int changeCount) {
+    const Protocol& pro = PROTOCOLS[p - 1];
+    Code code = Code();
+    const unsigned int syncLength = pro.syncFactor.low > pro.syncFactor.high
+                                    ? pro.syncFactor.low : pro.syncFactor.high;
+    const unsigned int delay = timings[0] / syncLength;
+    const unsigned int delayTolerance = delay * TOLERANCE / 100;
+    const unsigned int firstDataTiming = pro.invertedSignal ? 2 : 1;
+
+    for (unsigned int i = firstDataTiming; i < changeCount - 1; i += 2) {
+        if ((unsigned int)abs((int)timings[i] - (int)(delay * pro.zero.high)) < delayTolerance &&
+            (unsigned int)abs((int)timings[i + 1] - (int)(delay * pro.zero.low)) < delayTolerance) {
+            shiftIn(code, false);
+        } else if ((unsigned int)abs((int)timings[i] - (int)(delay * pro.one.high)) < delayTolerance &&
+                   (unsigned int)abs((int)timings[i + 1] - (int)(delay * pro.one.low)) < delayTolerance) {
+            shiftIn(code, true);
+        } else {
+            return false;
+        }
+    }
+    if (changeCount > 7) {
+        receivedValue = RFCode(code);
+        receivedBitlength = (changeCount - 1) / 2;
+        receivedProtocol = p;
+        return true;
+    }
+    return false;
+}
+
+template <typename Code>
+void handleInterrupt() {
+    const unsigned long time = micros();
+    const unsigned int duration = time - lastTime;
+    if (duration > SEPARATION_LIMIT) {
+        if ((unsigned int)abs((int)duration - (int)timings[0]) < 200 ||
+            (timingsIndex >= 7 && timingsIndex <= MAX_CHANGES)) {
+            for (unsigned int i = 1; i <= NUM_PROTOCOLS; i++) {
+                if (receiveProtocol<Code>(i, timingsIndex)) {
+                    frames += receivedValue == expectedCode && receivedProtocol == expectedProtocol ? 1 : 0;
+                    break;
+                }
+            }
+        }
+        timingsIndex = 0;
+    }
+    if (timingsIndex < MAX_CHANGES) {
+        timings[timingsIndex++] = duration;
+    }
+    lastTime = time;
+}
+
+} // namespace baseline
+
+/**
+ * 同一组波形分别送给改版前的中断内解码 (32位编码和RFCode各一次) 和现在的
+ * 流式解码，比较每解对一帧 (编码和协议都对) 花的周期数
+ * (中断+解码任务合计，含模拟引脚的开销)
+ */
+enum CyclePass { PASS_BEFORE_32, PASS_BEFORE_WIDE, PASS_AFTER, PASS_COUNT };
+
+void benchDecoderCycles() {
+    printf("== decoder cycles per ok frame: before (rc-switch, decode in ISR) vs after (streaming) ==\n");
+    printf("proto  before 32-bit  before RFCode   after streaming\n");
+
+    Hal::useManualClock(1000000);
+    RCSwitch433 receiver;
+    RCSwitch433 sender;
+    sender.setRepeatTransmit(DECODER_REPEATS);
+    PulseProgram program;
+    program.reserve(1024);
+
+    uint64_t totalCycles[PASS_COUNT] = { 0, 0, 0 };
+    unsigned long totalFrames[PASS_COUNT] = { 0, 0, 0 };
+
+    for (unsigned int p = 1; p <= DECODER_PROTOCOLS; p++) {
+        sender.setProtocol(p);
+        uint64_t cycles[PASS_COUNT] = { 0, 0, 0 };
+        unsigned long frames[PASS_COUNT] = { 0, 0, 0 };
+
+        for (int pass = 0; pass < PASS_COUNT; pass++) {
+            uint32_t seed = 1;
+            baseline::frames = 0;
+            if (pass == PASS_BEFORE_32) {
+                attachInterrupt(RF_433_RX_PIN, baseline::handleInterrupt<uint32_t>, CHANGE);
+            } else if (pass == PASS_BEFORE_WIDE) {
+                attachInterrupt(RF_433_RX_PIN, baseline::handleInterrupt<RFCode>, CHANGE);
+            } else {
+                receiver.enableReceive(RF_433_RX_PIN);
+            }
+
+            for (int i = 0; i < DECODER_CODES_PER_PROTOCOL; i++) {
+                const uint64_t code = nextRandom(seed) & ((1UL << DECODER_BITS) - 1);
+                sender.compile(RFCode(code), DECODER_BITS, program);
+                baseline::expectedCode = RFCode(code);
+                baseline::expectedProtocol = p;
+
+                const uint64_t start = hostCycles();
+                const PulseStep* steps = program.steps();
+                unsigned long edges = 0;
+                for (size_t s = 0; s < program.size(); s++) {
+                    const uint32_t levels[2] = { steps[s].level0, steps[s].level1 };
+                    const uint32_t durations[2] = { steps[s].duration0, steps[s].duration1 };
+                    for (int half = 0; half < 2 && durations[half] > 0; half++) {
+                        Hal::setInput(RF_433_RX_PIN, levels[half]);
+                        Hal::advanceMicros(durations[half]);
+                        if (pass == PASS_AFTER && ++edges % DECODER_PROCESS_EVERY == 0) {
+                            RCSwitch433::processEdges();
+                        }
+                    }
+                }
+                Hal::setInput(RF_433_RX_PIN, LOW);
+                Hal::advanceMicros(DECODER_IDLE_US);
+                // 静默之后的下一个边沿才让原版解出最后一帧
+                Hal::setInput(RF_433_RX_PIN, HIGH);
+                Hal::advanceMicros(DECODER_IDLE_US);
+                Hal::setInput(RF_433_RX_PIN, LOW);
+                if (pass == PASS_AFTER) {
+                    RCSwitch433::processEdges();
+                }
+                cycles[pass] += hostCycles() - start;
+
+                if (pass == PASS_AFTER) {
+                    RCSwitch433::ReceivedFrame frame;
+                    while (receiver.readFrame(frame)) {
+                        frames[pass] += frame.code == RFCode(code) && frame.protocol == p ? 1 : 0;
+                    }
+                }
+            }
+
+            if (pass == PASS_AFTER) {
+                receiver.disableReceive();
+            } else {
+                detachInterrupt(RF_433_RX_PIN);
+                frames[pass] = baseline::frames;
+            }
+        }
+
+        printf("%5u", p);
+        for (int pass = 0; pass < PASS_COUNT; pass++) {
+            if (frames[pass] > 0) {
+                printf("  %9.0f/%-4lu", (double)cycles[pass] / frames[pass], frames[pass]);
+            } else {
+                printf("  %9s/%-4lu", "-", frames[pass]);
+            }
+            totalCycles[pass] += cycles[pass];
+            totalFrames[pass] += frames[pass];
+        }
+        printf("\n");
+    }
+
+    Hal::useRealClock();
+    printf("total");
+    for (int pass = 0; pass < PASS_COUNT; pass++) {
+        printf("  %9.0f/%-4lu", totalFrames[pass] > 0 ? (double)totalCycles[pass] / totalFrames[pass] : 0.0,
+               totalFrames[pass]);
+    }
+    printf("  (cycles/ok frame / ok frames)\n\n");
+}
+
+// ==================== bench: decoder latency ====================
+
+const int LATENCY_CODES_PER_PROTOCOL = 50;
+const int LATENCY_SHORT_BITS = 12;              // 低于RFReceiver::MIN_VALID_BITS，帧本身不能印证同步间隔
+const uint32_t LATENCY_QUIET_US = 50000;
+
+/**
+ * 发送一次按键 (DECODER_REPEATS帧)，量第一帧和第二帧 (重复帧) 的解码延迟 (微秒)
+ * @return 解出了两帧
+ */
+bool measurePress(DecoderHarness& harness, const PulseProgram& program, uint32_t seed,
+                  unsigned long& first, unsigned long& repeat) {
+    SignalSynth signal(seed);
+    signal.appendLevel(LOW, LATENCY_QUIET_US);
+    signal.appendProgram(program, 0, 0);
+    signal.appendLevel(LOW, LATENCY_QUIET_US);
+
+    // 逐段送入，每出一帧读一次它的延迟
+    const std::vector<SignalSynth::Pulse>& pulses = signal.pulses();
+    std::vector<SignalSynth::Pulse> one(1);
+    std::vector<DecoderHarness::Frame> frames;
+    unsigned long latencies[2] = { 0, 0 };
+    for (size_t i = 0; i < pulses.size(); i++) {
+        one[0] = pulses[i];
+        const size_t before = frames.size();
+        harness.play(EdgeTrace::BAND_433, one);
+        harness.takeFrames(frames);
+        if (frames.size() > before && before < 2) {
+            latencies[before] = RCSwitch433::getLastDecodeLatency(frames.back().frame.protocol);
+        }
+    }
+    harness.settle();
+    harness.takeFrames(frames);
+    first = latencies[0];
+    repeat = latencies[1];
+    return frames.size() >= 2;
+}
+
+/**
+ * 按解码任务的节奏 (DecoderHarness) 量帧首个边沿到输出的延迟: 按键的第一帧
+ * 和之后的重复帧。帧本身印证不了同步间隔时 (反相协议、短帧)，第一帧要等
+ * 下一个同步间隔才输出，比重复帧晚一帧左右
+ */
+void benchDecoderLatency() {
+    printf("== decoder latency: first edge of frame to output (ms), %d repeats, %d codes/protocol ==\n",
+           DECODER_REPEATS, LATENCY_CODES_PER_PROTOCOL);
+    printf("proto  frame   first %2db  repeat %2db   first %2db  repeat %2db\n",
+           DECODER_BITS, DECODER_BITS, LATENCY_SHORT_BITS, LATENCY_SHORT_BITS);
+
+    DecoderHarness harness;
+    RCSwitch433 sender;
+    sender.setRepeatTransmit(DECODER_REPEATS);
+    PulseProgram program;
+    program.reserve(1024);
+    const int bitCounts[2] = { DECODER_BITS, LATENCY_SHORT_BITS };
+
+    uint32_t seed = 1;
+    for (unsigned int p = 1; p <= DECODER_PROTOCOLS; p++) {
+        sender.setProtocol(p);
+        double frameMs = 0;
+        double first[2] = { 0, 0 };
+        double repeat[2] = { 0, 0 };
+        int frames[2] = { 0, 0 };
+
+        for (int b = 0; b < 2; b++) {
+            for (int i = 0; i < LATENCY_CODES_PER_PROTOCOL; i++) {
+                const uint64_t code = nextRandom(seed) & ((1UL << bitCounts[b]) - 1);
+                sender.compile(RFCode(code), bitCounts[b], program);
+                if (b == 0) {
+                    frameMs = program.totalDuration() / 1000.0 / DECODER_REPEATS;
+                }
+                unsigned long firstUs;
+                unsigned long repeatUs;
+                if (measurePress(harness, program, nextRandom(seed), firstUs, repeatUs)) {
+                    first[b] += firstUs / 1000.0;
+                    repeat[b] += repeatUs / 1000.0;
+                    frames[b]++;
+                }
+            }
+        }
+
+        printf("%5u  %5.1f", p, frameMs);
+        for (int b = 0; b < 2; b++) {
+            if (frames[b] > 0) {
+                printf("  %9.1f  %10.1f", first[b] / frames[b], repeat[b] / frames[b]);
+            } else {
+                printf("  %9s  %10s", "-", "-");
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+// ==================== bench: storage ====================
+
+const int STORAGE_SIZES[] = { 50, 500, 5000 };
+const int STORAGE_LOOKUPS = 5000;
+
+SignalRecord makeSignal(int i) {
+    SignalRecord signal;
+    signal.code = RFCode(0x100000 + i * 7919ULL);
+    signal.set(1 + i % 3, 24, 350);
+    signal.setFreq(i % 4 == 0 ? SignalRecord::FREQ_315 : SignalRecord::FREQ_433);
+    return signal;
+}
+
+/**
+ * 在空目录里保存count个信号，重新挂载后测查找、读取和删除
+ */
+void benchStorageSize(int count) {
+    char dir[] = "/tmp/rf-remote-bench-XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("mkdtemp");
+        return;
+    }
+    Hal::setFsRoot(dir);
+
+    SignalStorage* storage = new SignalStorage();
+    storage->begin();
+
+    double t = hostSeconds();
+    int saved = 0;
+    for (int i = 0; i < count; i++) {
+        saved += storage->saveSignal(makeSignal(i)) ? 1 : 0;
+    }
+    storage->flush();
+    const double saveTime = hostSeconds() - t;
+
+    // 重新挂载: 重放日志重建索引
+    t = hostSeconds();
+    SignalStorage* reopened = new SignalStorage();
+    reopened->begin();
+    const double replayTime = hostSeconds() - t;
+
+    // 一半查已保存的信号，一半查不存在的编码
+    uint32_t seed = 7;
+    int found = 0;
+    t = hostSeconds();
+    for (int i = 0; i < STORAGE_LOOKUPS; i++) {
+        const SignalRecord key = makeSignal(nextRandom(seed) % (count * 2));
+        found += reopened->findSignal(key.code, key.bits, key.protocol, key.freq()) >= 0 ? 1 : 0;
+    }
+    const double findTime = hostSeconds() - t;
+
+    int read = 0;
+    t = hostSeconds();
+    for (int i = 0; i < STORAGE_LOOKUPS; i++) {
+        SignalRecord signal;
+        read += reopened->getSignal(nextRandom(seed) % reopened->getSignalCount(), signal) ? 1 : 0;
+    }
+    const double readTime = hostSeconds() - t;
+    const size_t memory = reopened->getIndexMemory();
+
+    const int deletes = count / 10;
+    t = hostSeconds();
+    for (int i = 0; i < deletes; i++) {
+        reopened->deleteSignal(0);
+    }
+    reopened->flush();
+    const double deleteTime = hostSeconds() - t;
+
+    printf("%7d %7d %10.1f %9.2f %10.2f %9.2f %10.1f %9u  %d/%d\n",
+           count, saved, saveTime * 1e6 / count, replayTime * 1e3,
+           findTime * 1e6 / STORAGE_LOOKUPS, readTime * 1e6 / STORAGE_LOOKUPS,
+           deleteTime * 1e6 / deletes, (unsigned int)memory, found, read);
+
+    // 两个实例的存储任务常驻，文件留给它们，只清空内容
+    LittleFS.format();
+    rmdir(dir);
+}
+
+void benchStorage() {
+    printf("== storage: save, replay, lookup (half misses), read, delete; index RAM ==\n");
+    printf("signals   saved   save+flush    replay     lookup      read     delete  index RAM  found/read\n");
+    printf("                   us/signal        ms  us/lookup   us/read  us/signal      bytes\n");
+    for (size_t i = 0; i < sizeof(STORAGE_SIZES) / sizeof(STORAGE_SIZES[0]); i++) {
+        benchStorageSize(STORAGE_SIZES[i]);
+    }
+    printf("\n");
+}
+
+// ==================== bench: render ====================
+
+const int RENDER_FRAMES = 2000;
+
+const char* RENDER_MENU_ITEMS[] = { "信号接收", "发送模式", "关于" };
+
+/**
+ * 比较并把变化的tile发给模拟屏幕
+ * @return 发送的数据字节数
+ */
+size_t presentDiff(U8G2* u8g2, TileDiff& diff) {
+    TileDiff::Run runs[TileDiff::MAX_RUNS];
+    const int count = diff.diff(u8g2->getBufferPtr(), 0, TileDiff::HEIGHT_TILES, runs);
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) {
+        u8x8_DrawTile(u8g2->getU8x8(), runs[i].x, runs[i].y, runs[i].width,
+                      u8g2->getBufferPtr() + runs[i].y * TileDiff::ROW_BYTES + runs[i].x * TileDiff::TILE_BYTES);
+        bytes += runs[i].width * TileDiff::TILE_BYTES;
+    }
+    return bytes;
+}
+
+void benchRender() {
+    printf("== render: %d frames (menu navigation) ==\n", RENDER_FRAMES);
+
+    Display display;        // 不调用begin()，只借用它的U8g2缓冲区
+    U8G2* u8g2 = display.getU8g2();
+    u8g2->begin();
+    StatusBar statusBar(u8g2);
+    Menu menu(u8g2, RENDER_MENU_ITEMS, sizeof(RENDER_MENU_ITEMS) / sizeof(RENDER_MENU_ITEMS[0]));
+    TileDiff diff;
+
+    double drawTime = 0;
+    double diffTime = 0;
+    size_t diffBytes = 0;
+    Hal::resetScreenStats();
+    for (int i = 0; i < RENDER_FRAMES; i++) {
+        double t = hostSeconds();
+        u8g2->clearBuffer();
+        statusBar.draw("RF Remote", 80, false, false);
+        menu.draw();
+        drawTime += hostSeconds() - t;
+
+        t = hostSeconds();
+        diffBytes += presentDiff(u8g2, diff);
+        diffTime += hostSeconds() - t;
+
+        menu.next();
+    }
+    const uint32_t screenBytes = Hal::getScreenDataBytes();
+
+    double fullTime = 0;
+    for (int i = 0; i < RENDER_FRAMES; i++) {
+        const double t = hostSeconds();
+        u8g2->sendBuffer();
+        fullTime += hostSeconds() - t;
+    }
+
+    printf("draw         %8.2f us/frame\n", drawTime * 1e6 / RENDER_FRAMES);
+    printf("diff+send    %8.2f us/frame  (%.0f bytes/frame, screen got %u)\n",
+           diffTime * 1e6 / RENDER_FRAMES, (double)diffBytes / RENDER_FRAMES, (unsigned)screenBytes);
+    printf("full send    %8.2f us/frame  (%d bytes/frame)\n\n",
+           fullTime * 1e6 / RENDER_FRAMES, (int)TileDiff::BUFFER_SIZE);
+}
+
+int runBench(int argc, char** argv) {
+    const char* which = argc > 2 ? argv[2] : "all";
+    const bool all = strcmp(which, "all") == 0;
+    if (!all && strcmp(which, "decoder") != 0 && strcmp(which, "storage") != 0 &&
+        strcmp(which, "render") != 0) {
+        usage();
+        return 2;
+    }
+
+    // 基准测试只看结果，日志只留错误
+    Hal::setLogLevel(ARDUHAL_LOG_LEVEL_ERROR);
+    const double start = hostSeconds();
+    bool passed = true;
+    if (all || strcmp(which, "decoder") == 0) {
+        passed = benchDecoder();
+        benchDecoderCycles();
+        benchDecoderLatency();
+    }
+    if (all || strcmp(which, "storage") == 0) benchStorage();
+    if (all || strcmp(which, "render") == 0) benchRender();
+    printf("done in %.2f s\n", hostSeconds() - start);
+    return passed ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int result;
+    if (argc > 1 && strcmp(argv[1], "sim") == 0) {
+        result = runSim(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        result = runBench(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], "replay") == 0) {
+        result = runReplay(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], "corpus") == 0) {
+        result = runCorpus(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], "fuzz") == 0) {
+        result = runFuzz(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], "roc") == 0) {
+        result = runRoc(argc, argv);
+    } else {
+        usage();
+        result = 2;
+    }
+
+    // 固件任务都是无限循环，不等它们结束
+    fflush(stdout);
+    fflush(stderr);
+    _exit(result);
+}
+#endif // PIO_UNIT_TESTING
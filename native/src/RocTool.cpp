@@ -0,0 +1,396 @@
+/**
+ * @file RocTool.cpp
+ * @brief 噪声信道模拟和接收设置的ROC扫描 (roc)
+ *
+ * 信道模型 (毛刺和残帧的频度可由命令行指定，其余参数见下方常量):
+ *   AGC底噪  - 无载波时接收机输出的随机脉冲，成串出现，串之间有长短不一
+ *              的静默 (超过分隔时间的静默会被当作同步间隔)
+ *   毛刺     - 随机插入的短反相脉冲，信号和底噪上都有
+ *   残帧     - 纯噪声段中随机截取的一小段遥控器帧 (远处的遥控器、AGC未稳定)
+ *   按键     - 从第一帧中间开始 (AGC稳定前的部分丢失)，之后完整重复几帧
+ *
+ * 每个接收容差各解码一遍同样的信号 (随机种子相同)，再对解出的帧套用
+ * 不同的过滤设置 (RFReceiver::isValidSignal())，统计:
+ *   检出率 - 按键中至少一帧编码和位数正确且通过过滤 (协议号错误由fuzz统计)
+ *   误报   - 纯噪声段中通过过滤的帧 (每分钟)，按解出的协议分类
+ *   错码   - 按键期间通过过滤但编码或位数错误的帧 (每次按键)
+ * 接收路径使用固件的毛刺过滤，最后给出关闭毛刺过滤时固件设置的结果。
+ */
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "HostCommands.h"
+#include "DecoderHarness.h"
+#include "SignalSynth.h"
+#include "RCSwitch.h"
+#include "RFReceiver.h"
+
+#include <vector>
+
+namespace {
+
+const unsigned int ROC_PROTOCOLS = 12;          // RCSwitch的协议1-12
+const int ROC_TOLERANCES[] = { 30, 40, 50, 60, 70, 80, 90 };
+const int ROC_TOLERANCE_COUNT = sizeof(ROC_TOLERANCES) / sizeof(ROC_TOLERANCES[0]);
+const unsigned int ROC_MIN_BITS[] = { 0, 12, 16, 20, 24 };
+const int ROC_MIN_BITS_COUNT = sizeof(ROC_MIN_BITS) / sizeof(ROC_MIN_BITS[0]);
+
+// 信号
+const int ROC_REPEATS = 4;
+const double ROC_JITTER_US = 30;
+const double ROC_DRIFT = 0.05;                  // 每次按键的脉宽误差上限 (±)
+
+// 噪声
+const double ROC_NOISE_MEAN_US = 400;
+const uint32_t ROC_NOISE_MIN_US = 30;
+const double ROC_BURST_MEAN_US = 20000;         // 底噪串平均时长
+const uint32_t ROC_QUIET_MIN_US = 1000;         // 串之间的静默 (均匀分布)
+const uint32_t ROC_QUIET_MAX_US = 12000;
+const double ROC_DEFAULT_GLITCHES = 5;          // 每秒毛刺数
+const uint32_t ROC_GLITCH_MIN_US = 5;
+const uint32_t ROC_GLITCH_MAX_US = 60;
+const double ROC_DEFAULT_PARTIALS = 0.5;        // 每秒残帧数 (不超过1)
+const int ROC_PARTIAL_REPEATS = 2;              // 从两帧中截取，常带着前一帧的同步间隔
+const double ROC_PARTIAL_FRACTION = 0.5;        // 残帧不超过一帧
+const uint32_t ROC_PRESS_NOISE_US = 100000;     // 按键前后的底噪
+const uint64_t ROC_NOISE_SEGMENT_US = 1000000;
+
+// 误报预算 (每分钟)，用于给出推荐设置
+const double ROC_FALSE_ALARM_BUDGET = 1.0;
+
+const int ROC_DEFAULT_PRESSES = 100;
+const double ROC_DEFAULT_NOISE_SECONDS = 60;
+const unsigned int ROC_DEFAULT_BITS = 24;
+
+// 命令行给出的信道参数
+struct Channel {
+    int presses;                                // 每个协议的按键次数
+    double noiseSeconds;                        // 纯噪声段总时长
+    unsigned int bits;
+    double glitchesPerMs;
+    double partialsPerSecond;
+    uint32_t seed;
+};
+
+struct DecodedFrame {
+    unsigned int protocol;
+    unsigned int bits;
+    RFCode code;
+};
+
+// 一次按键解出的帧
+struct Press {
+    unsigned int protocol;
+    unsigned int bits;
+    RFCode code;
+    std::vector<DecodedFrame> frames;
+};
+
+// 一个容差下的解码结果
+struct Decoded {
+    std::vector<Press> presses;
+    std::vector<DecodedFrame> noise;
+};
+
+// 一组过滤设置在一个容差下的统计
+struct Score {
+    int detected[ROC_PROTOCOLS + 1];
+    int presses[ROC_PROTOCOLS + 1];
+    int wrong;
+    int falseAlarms[ROC_PROTOCOLS + 1];        // 按解出的协议
+    int totalFalseAlarms;
+};
+
+std::vector<RFReceiver::SignalFilter> makeFilters() {
+    std::vector<RFReceiver::SignalFilter> filters;
+    for (int b = 0; b < ROC_MIN_BITS_COUNT; b++) {
+        for (int flags = 0; flags < 4; flags++) {
+            RFReceiver::SignalFilter filter;
+            filter.minBits = ROC_MIN_BITS[b];
+            filter.rejectMaskBits = (flags & 1) != 0;
+            filter.rejectAllOnes = (flags & 2) != 0;
+            filters.push_back(filter);
+        }
+    }
+    return filters;
+}
+
+bool isDefaultFilter(const RFReceiver::SignalFilter& filter) {
+    const RFReceiver::SignalFilter& d = RFReceiver::DEFAULT_FILTER;
+    return filter.minBits == d.minBits && filter.rejectMaskBits == d.rejectMaskBits &&
+           filter.rejectAllOnes == d.rejectAllOnes;
+}
+
+void describeFilter(const RFReceiver::SignalFilter& filter, char* text, size_t size) {
+    snprintf(text, size, "bits>=%-2u %s %s", filter.minBits,
+             filter.rejectMaskBits ? "2^n-1" : "     ", filter.rejectAllOnes ? "ones" : "    ");
+}
+
+/**
+ * 与RFReceiver::handleFrame()相同: 全0编码总是丢弃，其余交给过滤设置
+ */
+bool accepted(const DecodedFrame& frame, const RFReceiver::SignalFilter& filter) {
+    return !frame.code.isZero() && RFReceiver::isValidSignal(frame.code, frame.bits, filter);
+}
+
+void collect(DecoderHarness& harness, std::vector<DecodedFrame>& out) {
+    std::vector<DecoderHarness::Frame> frames;
+    harness.takeFrames(frames);
+    for (size_t i = 0; i < frames.size(); i++) {
+        const DecodedFrame frame = { frames[i].frame.protocol, frames[i].frame.bitlength, frames[i].frame.code };
+        out.push_back(frame);
+    }
+}
+
+/**
+ * 追加durationUs长的底噪: 随机长度的脉冲串和静默交替
+ */
+void appendChatter(SignalSynth& signal, uint64_t durationUs) {
+    const uint64_t stop = signal.totalDuration() + durationUs;
+    while (signal.totalDuration() < stop) {
+        const uint64_t left = stop - signal.totalDuration();
+        uint64_t burst = (uint64_t)signal.exponential(ROC_BURST_MEAN_US);
+        signal.appendNoise(burst < left ? burst : left, ROC_NOISE_MEAN_US, ROC_NOISE_MIN_US);
+        if (signal.totalDuration() >= stop) {
+            break;
+        }
+        const uint64_t quiet = ROC_QUIET_MIN_US + signal.next() % (ROC_QUIET_MAX_US - ROC_QUIET_MIN_US + 1);
+        const uint64_t rest = stop - signal.totalDuration();
+        signal.appendLevel(LOW, quiet < rest ? quiet : rest);
+    }
+}
+
+/**
+ * 用一个容差解码全部按键和纯噪声段 (同一种子生成的信号完全相同)
+ */
+void decodeChannel(int tolerance, unsigned int glitchUs, const Channel& channel, Decoded& decoded) {
+    const unsigned int bits = channel.bits;
+    SignalSynth random(channel.seed);
+    DecoderHarness harness;
+    harness.setTolerance(tolerance);
+    harness.setGlitchFilter(glitchUs);
+    RCSwitch433 sender;
+    PulseProgram program;
+    program.reserve(2048);
+
+    for (unsigned int p = 1; p <= ROC_PROTOCOLS; p++) {
+        sender.setProtocol(p);
+        for (int i = 0; i < channel.presses; i++) {
+            Press press;
+            press.protocol = p;
+            press.bits = bits;
+            press.code = RFCode(random.bits(bits));
+
+            sender.setRepeatTransmit(ROC_REPEATS);
+            sender.compile(press.code, bits, program);
+            const double frameUs = (double)program.totalDuration() / ROC_REPEATS;
+
+            SignalSynth signal(random.next());
+            appendChatter(signal, ROC_PRESS_NOISE_US);
+            const double drift = (signal.uniform() * 2 - 1) * ROC_DRIFT;
+            const double skip = signal.uniform() * frameUs;
+            signal.appendSlice(program, drift, ROC_JITTER_US, skip, program.totalDuration() - skip);
+            appendChatter(signal, ROC_PRESS_NOISE_US);
+            signal.injectGlitches(0, channel.glitchesPerMs, ROC_GLITCH_MIN_US, ROC_GLITCH_MAX_US);
+
+            harness.play(EdgeTrace::BAND_433, signal.pulses());
+            harness.settle();
+            collect(harness, press.frames);
+            decoded.presses.push_back(press);
+        }
+    }
+
+    // 纯噪声段: 底噪、毛刺和随机协议的残帧
+    const int segments = (int)(channel.noiseSeconds * 1e6 / ROC_NOISE_SEGMENT_US + 0.5);
+    for (int i = 0; i < segments; i++) {
+        SignalSynth signal(random.next());
+        const uint64_t partialAt = (uint64_t)(signal.uniform() * ROC_NOISE_SEGMENT_US);
+        appendChatter(signal, partialAt);
+        if (signal.uniform() < channel.partialsPerSecond * ROC_NOISE_SEGMENT_US / 1e6) {
+            sender.setProtocol(1 + random.next() % ROC_PROTOCOLS);
+            sender.setRepeatTransmit(ROC_PARTIAL_REPEATS);
+            sender.compile(RFCode(random.bits(bits)), bits, program);
+            signal.appendPartial(program, 0, ROC_JITTER_US, ROC_PARTIAL_FRACTION);
+            // 发射停止后AGC恢复增益之前的静默
+            signal.appendLevel(LOW, ROC_QUIET_MAX_US);
+        }
+        const uint64_t used = signal.totalDuration();
+        if (used < ROC_NOISE_SEGMENT_US) {
+            appendChatter(signal, ROC_NOISE_SEGMENT_US - used);
+        }
+        signal.injectGlitches(0, channel.glitchesPerMs, ROC_GLITCH_MIN_US, ROC_GLITCH_MAX_US);
+        harness.play(EdgeTrace::BAND_433, signal.pulses());
+    }
+    harness.settle();
+    collect(harness, decoded.noise);
+}
+
+void score(const Decoded& decoded, const RFReceiver::SignalFilter& filter, Score& result) {
+    memset(&result, 0, sizeof(result));
+    for (size_t i = 0; i < decoded.presses.size(); i++) {
+        const Press& press = decoded.presses[i];
+        bool detected = false;
+        for (size_t f = 0; f < press.frames.size(); f++) {
+            const DecodedFrame& frame = press.frames[f];
+            if (!accepted(frame, filter)) {
+                continue;
+            }
+            if (frame.bits == press.bits && frame.code == press.code) {
+                detected = true;
+            } else {
+                result.wrong++;
+            }
+        }
+        result.presses[press.protocol]++;
+        result.detected[press.protocol] += detected ? 1 : 0;
+    }
+    for (size_t i = 0; i < decoded.noise.size(); i++) {
+        const DecodedFrame& frame = decoded.noise[i];
+        if (accepted(frame, filter)) {
+            result.falseAlarms[frame.protocol <= ROC_PROTOCOLS ? frame.protocol : 0]++;
+            result.totalFalseAlarms++;
+        }
+    }
+}
+
+double detectionRate(const Score& score) {
+    int detected = 0;
+    int presses = 0;
+    for (unsigned int p = 1; p <= ROC_PROTOCOLS; p++) {
+        detected += score.detected[p];
+        presses += score.presses[p];
+    }
+    return presses ? 100.0 * detected / presses : 0;
+}
+
+} // namespace
+
+int runRoc(int argc, char** argv) {
+    Channel channel;
+    channel.presses = argc > 2 ? atoi(argv[2]) : ROC_DEFAULT_PRESSES;
+    channel.noiseSeconds = argc > 3 ? atof(argv[3]) : ROC_DEFAULT_NOISE_SECONDS;
+    channel.bits = argc > 4 ? strtoul(argv[4], NULL, 10) : ROC_DEFAULT_BITS;
+    channel.glitchesPerMs = (argc > 5 ? atof(argv[5]) : ROC_DEFAULT_GLITCHES) / 1000;
+    channel.partialsPerSecond = argc > 6 ? atof(argv[6]) : ROC_DEFAULT_PARTIALS;
+    channel.seed = argc > 7 ? strtoul(argv[7], NULL, 10) : 1;
+    if (channel.presses <= 0 || channel.noiseSeconds <= 0 || channel.bits == 0 || channel.bits > 64 ||
+        channel.glitchesPerMs < 0 || channel.partialsPerSecond < 0 || channel.partialsPerSecond > 1) {
+        fprintf(stderr, "按键次数、噪声时长必须大于0，位数1-64，毛刺数不小于0，残帧数0-1\n");
+        return 2;
+    }
+    const int presses = channel.presses;
+    const double noiseSeconds = channel.noiseSeconds;
+
+    Hal::setLogLevel(ARDUHAL_LOG_LEVEL_ERROR);
+    printf("== roc: %d presses/protocol (%u bits, %d repeats, jitter %.0f us, drift ±%.0f%%), "
+           "%.0f s noise, glitches %.0f/s, partial frames %.1f/s, seed %lu ==\n",
+           presses, channel.bits, ROC_REPEATS, ROC_JITTER_US, ROC_DRIFT * 100, noiseSeconds,
+           channel.glitchesPerMs * 1000, channel.partialsPerSecond, (unsigned long)channel.seed);
+    const double start = hostSeconds();
+
+    const std::vector<RFReceiver::SignalFilter> filters = makeFilters();
+    // scores[容差][过滤设置]
+    std::vector<std::vector<Score> > scores(ROC_TOLERANCE_COUNT, std::vector<Score>(filters.size()));
+    int defaultFilter = 0;
+    for (size_t f = 0; f < filters.size(); f++) {
+        if (isDefaultFilter(filters[f])) {
+            defaultFilter = f;
+        }
+    }
+
+    for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+        Decoded decoded;
+        decodeChannel(ROC_TOLERANCES[t], RFReceiver::GLITCH_FILTER_US, channel, decoded);
+        for (size_t f = 0; f < filters.size(); f++) {
+            score(decoded, filters[f], scores[t][f]);
+        }
+    }
+    const double minutes = noiseSeconds / 60;
+
+    // 全部协议: 每格为 检出率% / 每分钟误报
+    printf("\ndetection %% / false alarms per minute, by tolerance (* = firmware default)\n");
+    printf("%-22s", "filter");
+    for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+        printf(" %9d%%%c", ROC_TOLERANCES[t], ROC_TOLERANCES[t] == RFReceiver::RECEIVE_TOLERANCE ? '*' : ' ');
+    }
+    printf("\n");
+    for (size_t f = 0; f < filters.size(); f++) {
+        char name[32];
+        describeFilter(filters[f], name, sizeof(name));
+        printf("%-21s%c", name, (int)f == defaultFilter ? '*' : ' ');
+        for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+            const Score& s = scores[t][f];
+            printf(" %5.1f/%-5.1f", detectionRate(s), s.totalFalseAlarms / minutes);
+        }
+        printf("\n");
+    }
+
+    // 每个协议 (固件的过滤设置)
+    printf("\nper protocol with the firmware filter: detection %% / false alarms per minute decoded as it\n");
+    printf("%-5s", "proto");
+    for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+        printf(" %10d%%", ROC_TOLERANCES[t]);
+    }
+    printf("\n");
+    for (unsigned int p = 1; p <= ROC_PROTOCOLS; p++) {
+        printf("%5u", p);
+        for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+            const Score& s = scores[t][defaultFilter];
+            printf(" %5.1f/%-5.1f", s.presses[p] ? 100.0 * s.detected[p] / s.presses[p] : 0,
+                   s.falseAlarms[p] / minutes);
+        }
+        printf("\n");
+    }
+    printf("%-5s", "wrong");
+    for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+        const Score& s = scores[t][defaultFilter];
+        printf(" %10.2f ", (double)s.wrong / (presses * ROC_PROTOCOLS));
+    }
+    printf(" (wrong-code frames per press)\n");
+
+    // 误报预算内检出率最高的设置 (相同时取误报少的)
+    int bestT = -1;
+    size_t bestF = 0;
+    for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+        for (size_t f = 0; f < filters.size(); f++) {
+            const Score& s = scores[t][f];
+            if (s.totalFalseAlarms / minutes > ROC_FALSE_ALARM_BUDGET) {
+                continue;
+            }
+            if (bestT < 0 || detectionRate(s) > detectionRate(scores[bestT][bestF]) ||
+                (detectionRate(s) == detectionRate(scores[bestT][bestF]) &&
+                 s.totalFalseAlarms < scores[bestT][bestF].totalFalseAlarms)) {
+                bestT = t;
+                bestF = f;
+            }
+        }
+    }
+    int defaultT = 0;
+    for (int t = 0; t < ROC_TOLERANCE_COUNT; t++) {
+        if (ROC_TOLERANCES[t] == RFReceiver::RECEIVE_TOLERANCE) {
+            defaultT = t;
+        }
+    }
+    const Score& current = scores[defaultT][defaultFilter];
+    printf("\nfirmware default: tolerance %d%%, glitch filter up to %u us, detection %.1f%%, %.1f false alarms/min\n",
+           RFReceiver::RECEIVE_TOLERANCE, RFReceiver::GLITCH_FILTER_US, detectionRate(current),
+           current.totalFalseAlarms / minutes);
+
+    // 同样的设置关闭毛刺过滤
+    Decoded unfiltered;
+    decodeChannel(RFReceiver::RECEIVE_TOLERANCE, 0, channel, unfiltered);
+    Score raw;
+    score(unfiltered, filters[defaultFilter], raw);
+    printf("without glitch filter: detection %.1f%%, %.1f false alarms/min\n",
+           detectionRate(raw), raw.totalFalseAlarms / minutes);
+    if (bestT >= 0) {
+        char name[32];
+        describeFilter(filters[bestF], name, sizeof(name));
+        const Score& best = scores[bestT][bestF];
+        printf("best within %.1f false alarms/min: tolerance %d%%, %s, detection %.1f%%, %.1f false alarms/min\n",
+               ROC_FALSE_ALARM_BUDGET, ROC_TOLERANCES[bestT], name, detectionRate(best),
+               best.totalFalseAlarms / minutes);
+    }
+    printf("done in %.2f s\n", hostSeconds() - start);
+    return 0;
+}
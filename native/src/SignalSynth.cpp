@@ -0,0 +1,139 @@
+/**
+ * @file SignalSynth.cpp
+ * @brief 合成接收机输出的电平序列
+ */
+
+#include "SignalSynth.h"
+#include <math.h>
+
+SignalSynth::SignalSynth(uint32_t seed)
+    : _state(seed ? seed : 1)
+    , _pulses()
+    , _total(0)
+{
+}
+
+uint32_t SignalSynth::next() {
+    // xorshift32
+    _state ^= _state << 13;
+    _state ^= _state >> 17;
+    _state ^= _state << 5;
+    return _state;
+}
+
+double SignalSynth::uniform() {
+    return (next() >> 8) / 16777216.0;
+}
+
+double SignalSynth::gaussian() {
+    // Box-Muller
+    const double u = 1.0 - uniform();
+    const double v = uniform();
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+double SignalSynth::exponential(double mean) {
+    return -mean * log(1.0 - uniform());
+}
+
+uint64_t SignalSynth::bits(unsigned int count) {
+    const uint64_t high = next();
+    const uint64_t value = (high << 32) | next();
+    return count >= 64 ? value : value & ((1ULL << count) - 1);
+}
+
+void SignalSynth::appendLevel(uint8_t level, uint32_t duration) {
+    if (duration == 0) {
+        return;
+    }
+    _total += duration;
+    if (!_pulses.empty() && _pulses.back().level == level) {
+        _pulses.back().duration += duration;
+        return;
+    }
+    const Pulse pulse = { level, duration };
+    _pulses.push_back(pulse);
+}
+
+void SignalSynth::appendProgram(const PulseProgram& program, double drift, double jitterUs) {
+    appendSlice(program, drift, jitterUs, 0, program.totalDuration());
+}
+
+void SignalSynth::appendNoise(uint64_t durationUs, double meanUs, uint32_t minUs) {
+    uint8_t level = _pulses.empty() ? 1 : !_pulses.back().level;
+    uint64_t elapsed = 0;
+    while (elapsed < durationUs) {
+        uint32_t duration = minUs + (uint32_t)exponential(meanUs - minUs);
+        if (elapsed + duration > durationUs) {
+            duration = durationUs - elapsed;
+        }
+        appendLevel(level, duration);
+        elapsed += duration;
+        level = !level;
+    }
+}
+
+void SignalSynth::appendSlice(const PulseProgram& program, double drift, double jitterUs,
+                              double startUs, double lengthUs) {
+    const PulseStep* steps = program.steps();
+    const double stop = startUs + lengthUs;
+    double at = 0;
+    for (size_t i = 0; i < program.size() && at < stop; i++) {
+        const uint32_t levels[2] = { steps[i].level0, steps[i].level1 };
+        const uint32_t durations[2] = { steps[i].duration0, steps[i].duration1 };
+        for (int half = 0; half < 2 && durations[half] > 0; half++) {
+            // 只保留落在截取范围内的部分
+            const double begin = at > startUs ? at : startUs;
+            at += durations[half];
+            const double end = at < stop ? at : stop;
+            if (end <= begin) {
+                continue;
+            }
+            const double duration = (end - begin) * (1.0 + drift) + gaussian() * jitterUs;
+            appendLevel(levels[half], duration < MIN_PULSE ? MIN_PULSE : (uint32_t)(duration + 0.5));
+        }
+    }
+}
+
+void SignalSynth::appendPartial(const PulseProgram& program, double drift, double jitterUs,
+                                double maxFraction) {
+    const double length = program.totalDuration() * maxFraction * uniform();
+    const double start = (program.totalDuration() - length) * uniform();
+    appendSlice(program, drift, jitterUs, start, length);
+}
+
+void SignalSynth::injectGlitches(size_t from, double perMs, uint32_t minUs, uint32_t maxUs) {
+    if (from >= _pulses.size() || perMs <= 0) {
+        return;
+    }
+    const std::vector<Pulse> source(_pulses.begin() + from, _pulses.end());
+    _pulses.resize(from);
+    for (size_t i = 0; i < source.size(); i++) {
+        _total -= source[i].duration;
+    }
+
+    // 毛刺间隔服从指数分布，毛刺占用所在电平段的时间，总时长不变
+    double untilNext = exponential(1000.0 / perMs);
+    for (size_t i = 0; i < source.size(); i++) {
+        const Pulse& pulse = source[i];
+        uint32_t remaining = pulse.duration;
+        while (untilNext < remaining) {
+            const uint32_t before = (uint32_t)untilNext;
+            uint32_t width = minUs + next() % (maxUs - minUs + 1);
+            if (before + width > remaining) {
+                width = remaining - before;
+            }
+            appendLevel(pulse.level, before);
+            appendLevel(!pulse.level, width);
+            remaining -= before + width;
+            untilNext = exponential(1000.0 / perMs);
+        }
+        untilNext -= remaining;
+        appendLevel(pulse.level, remaining);
+    }
+}
+
+void SignalSynth::clear() {
+    _pulses.clear();
+    _total = 0;
+}
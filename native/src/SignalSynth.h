@@ -0,0 +1,88 @@
+/**
+ * @file SignalSynth.h
+ * @brief 合成接收机输出的电平序列 (主机测试用)
+ *
+ * 遥控器帧由RCSwitch::compile()生成的发送程序展开，每个脉冲按
+ * (1 + 漂移) 缩放后再加高斯抖动，模拟遥控器振荡器误差和接收机边沿抖动；
+ * 帧之间可以插入静默或AGC底噪 (无载波时接收机输出的随机脉冲)。
+ * 相邻的同电平片段自动合并，因此序列里每个片段开头都是一个真实边沿。
+ */
+
+#ifndef SIGNAL_SYNTH_H
+#define SIGNAL_SYNTH_H
+
+#include <stdint.h>
+#include <vector>
+#include "PulseProgram.h"
+
+class SignalSynth {
+public:
+    // 一段电平: 以level保持duration微秒
+    struct Pulse {
+        uint8_t level;
+        uint32_t duration;
+    };
+
+    static const uint32_t MIN_PULSE = 2;    // 抖动后脉冲的最短时长 (微秒)
+
+    explicit SignalSynth(uint32_t seed);
+
+    // ========== 随机数 (可复现) ==========
+    uint32_t next();
+    double uniform();               // [0, 1)
+    double gaussian();              // 标准正态分布
+    double exponential(double mean);
+    uint64_t bits(unsigned int count);  // 低count位随机的编码
+
+    // ========== 生成 ==========
+    /**
+     * 追加一段电平 (与上一段同电平时合并)
+     */
+    void appendLevel(uint8_t level, uint32_t duration);
+
+    /**
+     * 追加发送程序展开后的脉冲
+     * @param drift 脉宽相对误差 (例如0.05为长5%)
+     * @param jitterUs 每个脉冲的抖动标准差 (微秒)
+     */
+    void appendProgram(const PulseProgram& program, double drift, double jitterUs);
+
+    /**
+     * 追加AGC底噪: 高低电平交替，时长服从指数分布
+     * @param durationUs 总时长
+     * @param meanUs 平均脉冲时长
+     * @param minUs 最短脉冲时长
+     */
+    void appendNoise(uint64_t durationUs, double meanUs, uint32_t minUs);
+
+    /**
+     * 追加发送程序从startUs开始、长lengthUs的一段 (切开的电平段按比例截短)
+     */
+    void appendSlice(const PulseProgram& program, double drift, double jitterUs,
+                     double startUs, double lengthUs);
+
+    /**
+     * 追加发送程序中随机截取的一段 (接收机AGC还没稳定、远处遥控器的残帧)
+     * @param maxFraction 截取长度上限 (占程序总时长的比例)
+     */
+    void appendPartial(const PulseProgram& program, double drift, double jitterUs, double maxFraction);
+
+    /**
+     * 在第from段之后的电平中随机插入反相毛刺
+     * @param perMs 平均每毫秒的毛刺数
+     * @param minUs 毛刺最短时长
+     * @param maxUs 毛刺最长时长
+     */
+    void injectGlitches(size_t from, double perMs, uint32_t minUs, uint32_t maxUs);
+
+    const std::vector<Pulse>& pulses() const { return _pulses; }
+    uint64_t totalDuration() const { return _total; }
+    void clear();
+
+private:
+    uint32_t _state;
+    std::vector<Pulse> _pulses;
+    uint64_t _total;
+};
+
+#endif // SIGNAL_SYNTH_H
@@ -0,0 +1,437 @@
+/**
+ * @file TraceTool.cpp
+ * @brief 边沿轨迹的回放基准 (replay) 和合成语料生成 (corpus)
+ *
+ * 语料清单每行一个轨迹文件 (路径相对清单所在目录):
+ *
+ *   # 文件        频率  协议  位数  编码(十六进制)
+ *   pt2262.rft    433   1     24    5551F5
+ *   noise.rft     433   -     -     -          没有预期信号，解出的帧都算误报
+ *
+ * 回放时按两个频段的绝对时间合并边沿，经DecoderHarness送入真实的
+ * 中断和解码代码，统计解出的帧中与预期相同的帧数、误报帧数、
+ * 丢弃的毛刺、中断关闭时间和每个边沿的中断/解码耗时。
+ */
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "HostCommands.h"
+#include "DecoderHarness.h"
+#include "SignalSynth.h"
+#include "EdgeTrace.h"
+#include "RCSwitch.h"
+#include "RFReceiver.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const DEFAULT_MANIFEST = "native/corpus/corpus.txt";
+const char* const DEFAULT_CORPUS_DIR = "native/corpus";
+
+// 轨迹里的一个边沿 (绝对时间)
+struct TimedEdge {
+    uint64_t at;
+    uint8_t band;
+    uint8_t level;
+};
+
+bool edgeBefore(const TimedEdge& a, const TimedEdge& b) {
+    return a.at < b.at;
+}
+
+// 清单中的一项
+struct TraceEntry {
+    std::string path;
+    std::string name;
+    unsigned int freq;
+    unsigned int protocol;      // 0=没有预期信号
+    unsigned int bits;
+    uint64_t code;
+};
+
+bool readFile(const std::string& path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == NULL) {
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    fclose(f);
+    return true;
+}
+
+/**
+ * 读取轨迹，换算成绝对时间并按时间合并两个频段
+ */
+bool loadTrace(const std::string& path, std::vector<TimedEdge>& edges) {
+    std::vector<uint8_t> data;
+    if (!readFile(path, data) || !EdgeTrace::checkHeader(data.data(), data.size())) {
+        return false;
+    }
+
+    uint64_t time[2] = { 0, 0 };
+    size_t pos = EdgeTrace::HEADER_SIZE;
+    EdgeTrace::Edge edge;
+    while (EdgeTrace::decode(data.data(), data.size(), pos, edge)) {
+        time[edge.band] += edge.delta;
+        const TimedEdge timed = { time[edge.band], edge.band, edge.level };
+        edges.push_back(timed);
+    }
+    std::stable_sort(edges.begin(), edges.end(), edgeBefore);
+    return pos == data.size();
+}
+
+/**
+ * 把每个频段从0时刻开始的电平序列写成轨迹 (只记录电平变化)
+ */
+bool saveTrace(const std::string& path, const std::vector<SignalSynth::Pulse>* bands[2]) {
+    std::vector<TimedEdge> edges;
+    for (uint8_t band = 0; band < 2; band++) {
+        if (bands[band] == NULL) {
+            continue;
+        }
+        uint64_t at = 0;
+        uint8_t level = LOW;
+        for (size_t i = 0; i < bands[band]->size(); i++) {
+            const SignalSynth::Pulse& pulse = (*bands[band])[i];
+            if (pulse.level != level) {
+                const TimedEdge edge = { at, band, pulse.level };
+                edges.push_back(edge);
+                level = pulse.level;
+            }
+            at += pulse.duration;
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end(), edgeBefore);
+
+    std::vector<uint8_t> data(EdgeTrace::HEADER_SIZE);
+    EdgeTrace::writeHeader(data.data(), data.size());
+    uint64_t last[2] = { 0, 0 };
+    for (size_t i = 0; i < edges.size(); i++) {
+        EdgeTrace::Edge edge;
+        edge.band = edges[i].band;
+        edge.level = edges[i].level;
+        edge.delta = (uint32_t)(edges[i].at - last[edge.band]);
+        last[edge.band] = edges[i].at;
+
+        uint8_t bytes[EdgeTrace::MAX_EDGE_SIZE];
+        const size_t n = EdgeTrace::encode(edge, bytes, sizeof(bytes));
+        data.insert(data.end(), bytes, bytes + n);
+    }
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == NULL) {
+        return false;
+    }
+    const bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+std::string directoryOf(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+std::string baseName(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool endsWith(const std::string& text, const char* suffix) {
+    const size_t n = strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+bool loadManifest(const std::string& path, std::vector<TraceEntry>& entries) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (f == NULL) {
+        return false;
+    }
+    const std::string dir = directoryOf(path);
+    char line[256];
+    int number = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        number++;
+        char* hash = strchr(line, '#');
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+        char file[128], freq[16], protocol[16], bits[16], code[32];
+        const int fields = sscanf(line, "%127s %15s %15s %15s %31s", file, freq, protocol, bits, code);
+        if (fields <= 0) {
+            continue;
+        }
+        if (fields != 5) {
+            fprintf(stderr, "%s:%d: 需要5列\n", path.c_str(), number);
+            ok = false;
+            continue;
+        }
+        TraceEntry entry;
+        entry.path = dir + "/" + file;
+        entry.name = file;
+        entry.freq = strtoul(freq, NULL, 10);
+        entry.protocol = strcmp(protocol, "-") == 0 ? 0 : strtoul(protocol, NULL, 10);
+        entry.bits = entry.protocol ? strtoul(bits, NULL, 10) : 0;
+        entry.code = entry.protocol ? strtoull(code, NULL, 16) : 0;
+        entries.push_back(entry);
+    }
+    fclose(f);
+    return ok;
+}
+
+// ==================== replay ====================
+
+struct ReplayResult {
+    unsigned long edges;
+    unsigned long frames;
+    unsigned long matched;
+    unsigned long falseFrames;
+    unsigned long otherProtocol;    // 误报中编码和位数正确、只是协议号不同的帧
+    unsigned long overflows;
+    unsigned long glitches;
+    unsigned long gatedMs;
+    double isrSeconds;
+    double decodeSeconds;
+    std::map<unsigned int, unsigned long> falseByProtocol;
+};
+
+bool replayTrace(const TraceEntry& entry, ReplayResult& result) {
+    std::vector<TimedEdge> edges;
+    if (!loadTrace(entry.path, edges)) {
+        fprintf(stderr, "无法读取轨迹: %s\n", entry.path.c_str());
+        return false;
+    }
+
+    DecoderHarness harness;
+    harness.setTolerance(RFReceiver::RECEIVE_TOLERANCE);
+    for (size_t i = 0; i < edges.size(); i++) {
+        harness.edge(edges[i].band, edges[i].level, edges[i].at);
+    }
+    harness.settle();
+
+    std::vector<DecoderHarness::Frame> frames;
+    harness.takeFrames(frames);
+
+    result.edges = harness.edgeCount();
+    result.frames = frames.size();
+    result.matched = 0;
+    result.falseFrames = 0;
+    result.otherProtocol = 0;
+    result.overflows = harness.overflowCount();
+    result.glitches = harness.glitchCount();
+    result.gatedMs = harness.gatedTime();
+    result.isrSeconds = harness.isrSeconds();
+    result.decodeSeconds = harness.decodeSeconds();
+    for (size_t i = 0; i < frames.size(); i++) {
+        const RCSwitchFrame& frame = frames[i].frame;
+        const bool codeMatch = entry.protocol != 0 && frames[i].freq == entry.freq &&
+                               frame.bitlength == entry.bits && frame.code == RFCode(entry.code);
+        if (codeMatch && frame.protocol == entry.protocol) {
+            result.matched++;
+        } else {
+            result.falseFrames++;
+            result.otherProtocol += codeMatch ? 1 : 0;
+            result.falseByProtocol[frame.protocol]++;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int runReplay(int argc, char** argv) {
+    std::vector<TraceEntry> entries;
+    if (argc <= 2) {
+        if (!loadManifest(DEFAULT_MANIFEST, entries)) {
+            fprintf(stderr, "无法读取清单: %s\n", DEFAULT_MANIFEST);
+            return 1;
+        }
+    }
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (endsWith(arg, ".rft")) {
+            // 单独的轨迹没有预期信号，所有帧都列为"误报"，按协议分类看
+            TraceEntry entry;
+            entry.path = arg;
+            entry.name = baseName(arg);
+            entry.freq = 0;
+            entry.protocol = 0;
+            entry.bits = 0;
+            entry.code = 0;
+            entries.push_back(entry);
+        } else if (!loadManifest(arg, entries)) {
+            fprintf(stderr, "无法读取清单: %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    Hal::setLogLevel(ARDUHAL_LOG_LEVEL_ERROR);
+    printf("== replay: %d traces ==\n", (int)entries.size());
+    printf("%-16s %4s %5s %4s %7s %6s %6s %6s %11s %7s %8s %12s %15s\n", "trace", "freq", "proto", "bits",
+           "edges", "frames", "match", "false", "other proto", "glitch", "gated ms", "isr ns/edge",
+           "decode ns/edge");
+
+    ReplayResult total = ReplayResult();
+    int failed = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const TraceEntry& entry = entries[i];
+        ReplayResult result = ReplayResult();
+        if (!replayTrace(entry, result)) {
+            failed++;
+            continue;
+        }
+
+        char proto[16] = "-";
+        char bits[16] = "-";
+        if (entry.protocol) {
+            snprintf(proto, sizeof(proto), "%u", entry.protocol);
+            snprintf(bits, sizeof(bits), "%u", entry.bits);
+        }
+        const double edges = result.edges ? result.edges : 1;
+        printf("%-16s %4u %5s %4s %7lu %6lu %6lu %6lu %11lu %7lu %8lu %12.0f %15.0f\n", entry.name.c_str(),
+               entry.freq, proto, bits, result.edges, result.frames, result.matched,
+               result.falseFrames, result.otherProtocol, result.glitches, result.gatedMs,
+               result.isrSeconds * 1e9 / edges, result.decodeSeconds * 1e9 / edges);
+        if (!result.falseByProtocol.empty()) {
+            printf("%16s false by protocol:", "");
+            std::map<unsigned int, unsigned long>::const_iterator it;
+            for (it = result.falseByProtocol.begin(); it != result.falseByProtocol.end(); ++it) {
+                printf(" %u:%lu", it->first, it->second);
+            }
+            printf("\n");
+        }
+        if (result.overflows) {
+            printf("%16s edge buffer overflows: %lu\n", "", result.overflows);
+        }
+
+        total.edges += result.edges;
+        total.frames += result.frames;
+        total.matched += result.matched;
+        total.falseFrames += result.falseFrames;
+        total.otherProtocol += result.otherProtocol;
+        total.glitches += result.glitches;
+        total.gatedMs += result.gatedMs;
+        total.isrSeconds += result.isrSeconds;
+        total.decodeSeconds += result.decodeSeconds;
+    }
+
+    const double edges = total.edges ? total.edges : 1;
+    printf("total: %lu edges, %lu frames, %lu match, %lu false (%lu other proto), "
+           "%lu glitches, gated %lu ms, isr %.0f ns/edge, decode %.0f ns/edge\n",
+           total.edges, total.frames, total.matched, total.falseFrames, total.otherProtocol,
+           total.glitches, total.gatedMs, total.isrSeconds * 1e9 / edges, total.decodeSeconds * 1e9 / edges);
+    return failed ? 1 : 0;
+}
+
+// ==================== corpus ====================
+
+namespace {
+
+// 一个合成轨迹: 同一遥控器按几次键，按键之间是AGC底噪
+struct CorpusSpec {
+    const char* file;
+    unsigned int freq;
+    unsigned int protocol;      // 0=只有底噪
+    unsigned int bits;
+    uint64_t code;
+    int presses;
+    int repeats;                // 每次按键的帧数
+    double jitterUs;            // 边沿抖动标准差
+    double drift;               // 每次按键的脉宽误差上限 (±)
+    double noiseMeanUs;         // 按键之间底噪的平均脉宽
+    uint32_t seed;
+    const char* comment;
+};
+
+const CorpusSpec CORPUS[] = {
+    { "pt2262.rft",  433, 1, 24, 0x5551F5,  5, 8, 40, 0.08, 400, 2262, "PT2262, 24位" },
+    { "ev1527.rft",  315, 3, 24, 0xA3C5E1,  5, 8, 15, 0.05, 400, 1527, "EV1527, 24位" },
+    { "ht6p20b.rft", 433, 6, 28, 0x8F0C3A5, 5, 8, 40, 0.08, 400, 6020, "HT6P20B, 28位, 反相" },
+    { "noise.rft",   433, 0, 0,  0,         0, 0, 0,  0,    400, 4242, "两个频段都只有AGC底噪" },
+    { "storm.rft",   433, 1, 24, 0x3A5C0F,  5, 8, 40, 0.08, 40,  3333, "PT2262, 按键之间是每秒2万多个边沿的噪声" },
+};
+
+const uint32_t QUIET_US = 20000;            // 帧前后AGC稳定的静默
+const uint32_t PRESS_GAP_US = 250000;       // 按键之间的底噪时长
+const uint64_t NOISE_ONLY_US = 3000000;     // 纯底噪轨迹的时长
+const double NOISE_MEAN_US = 400;
+const uint32_t NOISE_MIN_US = 30;
+
+void synthesize(const CorpusSpec& spec, SignalSynth& signal, SignalSynth& other) {
+    if (spec.protocol == 0) {
+        signal.appendNoise(NOISE_ONLY_US, NOISE_MEAN_US, NOISE_MIN_US);
+        other.appendNoise(NOISE_ONLY_US, NOISE_MEAN_US, NOISE_MIN_US);
+        return;
+    }
+
+    RCSwitch433 sender;
+    sender.setProtocol(spec.protocol);
+    sender.setRepeatTransmit(spec.repeats);
+    PulseProgram program;
+    program.reserve(4096);
+    sender.compile(RFCode(spec.code), spec.bits, program);
+
+    signal.appendNoise(PRESS_GAP_US, spec.noiseMeanUs, NOISE_MIN_US);
+    for (int press = 0; press < spec.presses; press++) {
+        signal.appendLevel(LOW, QUIET_US);
+        const double drift = (signal.uniform() * 2 - 1) * spec.drift;
+        signal.appendProgram(program, drift, spec.jitterUs);
+        signal.appendLevel(LOW, QUIET_US);
+        signal.appendNoise(PRESS_GAP_US, spec.noiseMeanUs, NOISE_MIN_US);
+    }
+    // 另一个频段同时只有底噪
+    other.appendNoise(signal.totalDuration(), NOISE_MEAN_US, NOISE_MIN_US);
+}
+
+} // namespace
+
+int runCorpus(int argc, char** argv) {
+    const std::string dir = argc > 2 ? argv[2] : DEFAULT_CORPUS_DIR;
+    const std::string manifestPath = dir + "/corpus.txt";
+    FILE* manifest = fopen(manifestPath.c_str(), "w");
+    if (manifest == NULL) {
+        perror(manifestPath.c_str());
+        return 1;
+    }
+    fprintf(manifest,
+            "# 边沿轨迹语料 (由 rf-remote corpus 合成，回放: rf-remote replay %s)\n"
+            "# 文件        频率  协议  位数  编码(十六进制)\n", manifestPath.c_str());
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); i++) {
+        const CorpusSpec& spec = CORPUS[i];
+        SignalSynth signal(spec.seed);
+        SignalSynth other(spec.seed ^ 0x9E3779B9);
+        synthesize(spec, signal, other);
+
+        const uint8_t band = EdgeTrace::bandOf(spec.freq);
+        const std::vector<SignalSynth::Pulse>* bands[2];
+        bands[band] = &signal.pulses();
+        bands[band ^ 1] = &other.pulses();
+        const std::string path = dir + "/" + spec.file;
+        if (!saveTrace(path, bands)) {
+            perror(path.c_str());
+            failed++;
+            continue;
+        }
+
+        if (spec.protocol) {
+            fprintf(manifest, "%-13s %-5u %-5u %-5u %-15llX # %s\n", spec.file, spec.freq,
+                    spec.protocol, spec.bits, (unsigned long long)spec.code, spec.comment);
+        } else {
+            fprintf(manifest, "%-13s %-5u %-5s %-5s %-15s # %s\n", spec.file, spec.freq,
+                    "-", "-", "-", spec.comment);
+        }
+        printf("%s: %.1f s\n", path.c_str(), signal.totalDuration() / 1e6);
+    }
+    fclose(manifest);
+    return failed ? 1 : 0;
+}
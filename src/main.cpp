@@ -1,16 +1,20 @@
 #include <Arduino.h>
 #include <esp32-hal-log.h>
+#include <algorithm>
 #include "Display.h"
 #include "StatusBar.h"
 #include "Menu.h"
 #include "BatteryMonitor.h"
 #include "ButtonManager.h"
+#include "AppEvents.h"
+#include "PowerManager.h"
 #include "pin_config.h"
 
 // RF模块
 #include "RFReceiver.h"
 #include "RFTransmitter.h"
 #include "SignalStorage.h"
+#include "SignalTransfer.h"
 
 // 页面模块
 #include "Page.h"
@@ -25,9 +29,11 @@ static const char* TAG = "Main";
 Display display;
 BatteryMonitor battery;
 ButtonManager buttons;
+PowerManager power;
 RFReceiver rfReceiver;
 RFTransmitter rfTransmitter;
 SignalStorage signalStorage;
+SignalTransfer* signalTransfer;
 StatusBar* statusBar;
 Menu* menu;
 U8G2* u8g2;
@@ -67,6 +73,7 @@ const uint8_t CONTENT_TILES = 6;         // 内容区高度: 48像素 = 6 tiles
 bool statusBarDirty = true;   // 状态栏需要刷新
 bool contentDirty = true;     // 内容区需要刷新
 bool fullRefresh = true;      // 需要全屏刷新
+bool framePending = false;    // 缓冲区已重绘，还没提交给显示任务
 
 // 电池状态缓存
 uint8_t lastBatteryPercent = 0;
@@ -75,9 +82,22 @@ bool lastIsUSBPowered = false;
 unsigned long lastBatteryUpdate = 0;
 const unsigned long BATTERY_UPDATE_INTERVAL = 1000;
 
+// 页面定时刷新
+unsigned long lastPageRefresh = 0;
+
 // 页面标题缓存 (用于检测标题变化)
 const char* lastTitle = nullptr;
 
+// USB供电时串口可能有导入导出命令，至少每隔这么久看一次 (ms)
+const unsigned long SERIAL_POLL_INTERVAL = 20;
+
+// 主循环耗时统计 (最长一次迭代、累计处理时间，定期输出后清零)
+unsigned long loopMaxTime = 0;
+unsigned long loopBusyTime = 0;     // 微秒
+unsigned long loopWakeCount = 0;
+unsigned long lastLoopReport = 0;
+const unsigned long LOOP_REPORT_INTERVAL = 10000;
+
 // ============ 局部刷新函数 ============
 
 // 清除指定区域 (像素坐标)
@@ -87,7 +107,7 @@ inline void clearArea(int16_t x, int16_t y, int16_t w, int16_t h) {
     u8g2->setDrawColor(1);
 }
 
-// 只刷新状态栏区域
+// 只重绘状态栏区域
 void refreshStatusBar(const char* title) {
     // 清除状态栏区域
     clearArea(0, 0, 128, 16);
@@ -95,11 +115,10 @@ void refreshStatusBar(const char* title) {
     // 绘制状态栏
     statusBar->draw(title, lastBatteryPercent, lastIsCharging, lastIsUSBPowered);
 
-    // 只发送状态栏区域
-    u8g2->updateDisplayArea(0, 0, SCREEN_WIDTH_TILES, STATUSBAR_TILES);
+    framePending = true;
 }
 
-// 只刷新内容区域
+// 只重绘内容区域
 void refreshContent() {
     // 清除内容区域
     clearArea(0, 16, 128, 48);
@@ -114,11 +133,10 @@ void refreshContent() {
         currentPageObj->draw();
     }
 
-    // 只发送内容区域
-    u8g2->updateDisplayArea(0, CONTENT_START_TILE, SCREEN_WIDTH_TILES, CONTENT_TILES);
+    framePending = true;
 }
 
-// 全屏刷新
+// 全屏重绘
 void refreshAll(const char* title) {
     u8g2->clearBuffer();
 
@@ -132,7 +150,7 @@ void refreshAll(const char* title) {
         currentPageObj->draw();
     }
 
-    u8g2->sendBuffer();
+    framePending = true;
 }
 
 // ============ 辅助函数 ============
@@ -155,9 +173,73 @@ PageState getPageStateByIndex(int index) {
     }
 }
 
+// ============ 事件等待 ============
+
+// 距离下一件定时要做的事还有多久 (ms)，0=马上还有事
+unsigned long nextTimeout(unsigned long now) {
+    // 还有要画的或没交给显示任务的帧
+    if (fullRefresh || statusBarDirty || contentDirty || framePending || currentPage != lastPage) {
+        return 0;
+    }
+    // 串口导入导出进行中
+    if (signalTransfer->isBusy() || Serial.available() > 0) {
+        return 0;
+    }
+
+    // 电池检测
+    unsigned long elapsed = std::min(now - lastBatteryUpdate, BATTERY_UPDATE_INTERVAL);
+    unsigned long timeout = BATTERY_UPDATE_INTERVAL - elapsed;
+
+    // 页面定时刷新
+    if (currentPageObj) {
+        const unsigned long interval = currentPageObj->getRefreshInterval();
+        if (interval > 0) {
+            elapsed = std::min(now - lastPageRefresh, interval);
+            timeout = std::min(timeout, interval - elapsed);
+        }
+    }
+
+    if (lastIsUSBPowered) {
+        timeout = std::min(timeout, SERIAL_POLL_INTERVAL);
+    }
+    return timeout;
+}
+
+// 没有进行中的工作，可以停下CPU
+bool canSleep() {
+    // USB供电时不睡: 浅睡眠会断开USB串口，而且不省电池
+    return !lastIsUSBPowered &&
+           !rfReceiver.isScanning() &&
+           !rfTransmitter.isSending() &&
+           !signalTransfer->isBusy() &&
+           signalStorage.getPendingWrites() == 0 &&
+           !display.isBusy() &&
+           !ButtonManager::isPressed() &&
+           !AppEvents::pending();
+}
+
+// 阻塞到有事件 (按键、RF帧、发送结束) 或下一个定时任务到期
+void waitForEvents() {
+    const unsigned long timeout = nextTimeout(millis());
+    if (timeout == 0) {
+        AppEvents::wait(0);  // 清掉这次迭代会处理到的事件位
+        return;
+    }
+
+    if (timeout >= PowerManager::MIN_SLEEP_MS && canSleep()) {
+        power.lightSleep(timeout);
+        buttons.resyncAfterWake();
+        return;
+    }
+
+    AppEvents::wait(timeout);
+}
+
 // ============ 主程序 ============
 
 void setup() {
+    // 导入时主机会连发几帧，接收缓冲区要放得下
+    Serial.setRxBufferSize(SignalTransfer::LINE_SIZE * 4);
     Serial.begin(115200);
     delay(1000);
 
@@ -165,6 +247,9 @@ void setup() {
     ESP_LOGI(TAG, "RF遥控器启动中...");
     ESP_LOGI(TAG, "==============================");
 
+    // 其他模块产生事件前创建
+    AppEvents::begin();
+
     display.scanI2C();
     display.begin();
     u8g2 = display.getU8g2();
@@ -176,11 +261,13 @@ void setup() {
     rfReceiver.begin();
     rfTransmitter.begin();
     signalStorage.begin();
+    signalTransfer = new SignalTransfer(&signalStorage, &Serial);
+    signalTransfer->setReceiver(&rfReceiver);
 
     statusBar = new StatusBar(u8g2);
     menu = new Menu(u8g2, menuItems, MENU_ITEMS_COUNT);
 
-    aboutPage = new AboutPage(u8g2, &battery);
+    aboutPage = new AboutPage(u8g2, &battery, &display);
     signalRxPage = new SignalRxPage(u8g2, &rfReceiver, &signalStorage);
     signalTxPage = new SignalTxPage(u8g2, &signalStorage, &rfTransmitter);
 
@@ -190,6 +277,7 @@ void setup() {
 
     // 初始全屏刷新
     refreshAll("RF遥控器");
+    framePending = !display.present();
     lastTitle = "RF遥控器";
     fullRefresh = false;
     statusBarDirty = false;
@@ -250,6 +338,9 @@ void handleButtonEvent(ButtonEvent event) {
 }
 
 void loop() {
+    waitForEvents();
+    unsigned long loopStart = micros();
+
     // 处理按键事件
     if (buttons.hasEvent()) {
         while (buttons.hasEvent()) {
@@ -258,6 +349,9 @@ void loop() {
         }
     }
 
+    // 串口导出/导入信号库
+    signalTransfer->update();
+
     // 检查页面是否改变
     if (currentPage != lastPage) {
         lastPage = currentPage;
@@ -265,17 +359,19 @@ void loop() {
     }
 
     // 页面更新
+    unsigned long now = millis();
     if (currentPageObj) {
         if (currentPageObj->update()) {
             contentDirty = true;  // 页面更新只刷新内容区
         }
-        if (currentPageObj->needsConstantRefresh()) {
+        const unsigned long interval = currentPageObj->getRefreshInterval();
+        if (interval > 0 && now - lastPageRefresh >= interval) {
+            lastPageRefresh = now;
             contentDirty = true;
         }
     }
 
     // 定时更新电池状态
-    unsigned long now = millis();
     if (now - lastBatteryUpdate >= BATTERY_UPDATE_INTERVAL) {
         uint8_t batteryPercent = battery.getBatteryPercent();
         bool isCharging = battery.isCharging();
@@ -296,6 +392,9 @@ void loop() {
     // 获取当前标题
     const char* currentTitle = (currentPage == PAGE_MENU) ? "RF遥控器" :
                                (currentPageObj ? currentPageObj->getTitle() : "RF遥控器");
+    if (currentTitle != lastTitle) {
+        statusBarDirty = true;  // 页面标题变化 (如切换模式)
+    }
 
     // ============ 智能刷新 ============
     if (fullRefresh) {
@@ -318,4 +417,39 @@ void loop() {
             contentDirty = false;
         }
     }
+
+    // 提交给显示任务发送 (只发送变化的tile)，主循环不等I2C
+    if (framePending && display.present()) {
+        framePending = false;
+    }
+
+    unsigned long loopTime = micros() - loopStart;
+    if (loopTime > loopMaxTime) {
+        loopMaxTime = loopTime;
+    }
+    loopBusyTime += loopTime;
+    loopWakeCount++;
+    if (now - lastLoopReport >= LOOP_REPORT_INTERVAL) {
+        const unsigned long period = now - lastLoopReport;
+        ESP_LOGI(TAG, "主循环最长耗时: %lu us (待写入: %d)", loopMaxTime, signalStorage.getPendingWrites());
+        // 占用率按千分比算，避免浮点
+        ESP_LOGI(TAG, "主循环: 唤醒 %lu 次, 占用 %lu.%lu%%, 浅睡眠 %lu 次 共 %lu ms (%lu%%)",
+                 loopWakeCount, loopBusyTime / period / 10, loopBusyTime / period % 10,
+                 (unsigned long)power.getSleepCount(), (unsigned long)power.getSleepTime(),
+                 (unsigned long)power.getSleepTime() * 100 / period);
+        const uint32_t frames = display.getFrameCount();
+        if (frames > 0) {
+            ESP_LOGI(TAG, "显示刷新: %lu 帧 (合并 %lu, 丢弃 %lu), 平均 %lu 字节/帧, 最长 %lu us",
+                     (unsigned long)frames, (unsigned long)display.getCoalescedCount(),
+                     (unsigned long)display.getDroppedCount(),
+                     (unsigned long)(display.getTotalBytes() / frames),
+                     (unsigned long)display.getMaxFrameTime());
+        }
+        display.resetStats();
+        power.resetStats();
+        loopMaxTime = 0;
+        loopBusyTime = 0;
+        loopWakeCount = 0;
+        lastLoopReport = now;
+    }
 }
@@ -0,0 +1,125 @@
+/**
+ * @file test_main.cpp
+ * @brief 433MHz和315MHz两个RCSwitch实例化对同样的边沿流解码结果相同
+ *
+ * 两个频段各有一份静态接收状态和中断入口。同一段合成波形同时送到
+ * 两个接收引脚 (边沿交错进入两个ISR)，两边解出的帧必须逐一相同，
+ * 任何一边的状态泄漏到另一边都会让结果不一致。
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "DecoderHarness.h"
+#include "EdgeTrace.h"
+#include "RCSwitch.h"
+#include "SignalSynth.h"
+
+#include <vector>
+
+namespace {
+
+const unsigned int PROTOCOLS = 12;
+const int CODES_PER_PROTOCOL = 20;
+const int REPEATS = 4;
+const uint32_t QUIET_US = 20000;
+
+/**
+ * 把同一段电平序列同时送到两个频段
+ */
+void playBoth(DecoderHarness& harness, const std::vector<SignalSynth::Pulse>& pulses) {
+    uint64_t at = harness.now();
+    for (size_t i = 0; i < pulses.size(); i++) {
+        harness.edge(EdgeTrace::BAND_433, pulses[i].level, at);
+        harness.edge(EdgeTrace::BAND_315, pulses[i].level, at);
+        at += pulses[i].duration;
+    }
+    harness.advanceTo(at);
+}
+
+/**
+ * 按频段拆分帧，并检查两边逐帧相同
+ * @return 每个频段的帧数
+ */
+size_t compareBands(const std::vector<DecoderHarness::Frame>& frames) {
+    std::vector<RCSwitchFrame> band433;
+    std::vector<RCSwitchFrame> band315;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (frames[i].freq == RCSwitch433::FREQUENCY) {
+            band433.push_back(frames[i].frame);
+        } else {
+            band315.push_back(frames[i].frame);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(band433.size(), band315.size());
+    for (size_t i = 0; i < band433.size(); i++) {
+        TEST_ASSERT_TRUE(band433[i].code == band315[i].code);
+        TEST_ASSERT_EQUAL_UINT32(band433[i].bitlength, band315[i].bitlength);
+        TEST_ASSERT_EQUAL_UINT32(band433[i].protocol, band315[i].protocol);
+        TEST_ASSERT_EQUAL_UINT32(band433[i].delay, band315[i].delay);
+        TEST_ASSERT_EQUAL_UINT32(band433[i].timestamp, band315[i].timestamp);
+    }
+    return band433.size();
+}
+
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * 每个协议的随机编码，加抖动
+ */
+void test_bands_decode_protocols_identically(void) {
+    DecoderHarness harness;
+    RCSwitch433 sender;
+    sender.setRepeatTransmit(REPEATS);
+    PulseProgram program;
+    program.reserve(1024);
+    SignalSynth synth(2);
+
+    for (unsigned int p = 1; p <= PROTOCOLS; p++) {
+        sender.setProtocol(p);
+        for (int i = 0; i < CODES_PER_PROTOCOL; i++) {
+            const unsigned int bits = 8 + synth.next() % 25;
+            TEST_ASSERT_TRUE(sender.compile(RFCode(synth.bits(bits)), bits, program));
+            synth.clear();
+            synth.appendProgram(program, 0.02, 25);
+            synth.appendLevel(LOW, QUIET_US);
+            playBoth(harness, synth.pulses());
+        }
+    }
+    harness.settle();
+
+    std::vector<DecoderHarness::Frame> decoded;
+    harness.takeFrames(decoded);
+    TEST_ASSERT_GREATER_THAN(PROTOCOLS * CODES_PER_PROTOCOL, compareBands(decoded));
+}
+
+/**
+ * AGC底噪和毛刺: 误报帧、丢弃的毛刺在两个频段上也必须一样
+ */
+void test_bands_decode_noise_identically(void) {
+    DecoderHarness harness;
+    const unsigned long glitchesBefore = RCSwitch433::getGlitchCount();
+    const unsigned long glitches315Before = RCSwitch315::getGlitchCount();
+    SignalSynth synth(3);
+    synth.appendNoise(2000000, 300, 20);
+    synth.injectGlitches(0, 0.05, 5, 40);
+    playBoth(harness, synth.pulses());
+    harness.settle();
+
+    std::vector<DecoderHarness::Frame> decoded;
+    harness.takeFrames(decoded);
+    compareBands(decoded);
+    TEST_ASSERT_EQUAL_UINT32(RCSwitch433::getGlitchCount() - glitchesBefore,
+                             RCSwitch315::getGlitchCount() - glitches315Before);
+    TEST_ASSERT_EQUAL_UINT32(RCSwitch433::getGatedTime(), RCSwitch315::getGatedTime());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bands_decode_protocols_identically);
+    RUN_TEST(test_bands_decode_noise_identically);
+    return UNITY_END();
+}
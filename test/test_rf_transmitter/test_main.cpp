@@ -0,0 +1,273 @@
+/**
+ * @file test_main.cpp
+ * @brief RMT播放的时序精度和发送期间暂停接收
+ *
+ * 手动时钟下模拟的RMT按条目时长驱动发送引脚，引脚上每个边沿的时间
+ * 都被记录下来，和阻塞发送 (digitalWrite + delayMicroseconds) 写出的
+ * 波形以及协议的标称时序逐个脉冲比较。发送引脚环回到同频段的接收
+ * 引脚，发送期间接收端不能收到自己的信号，发送结束后照常接收。
+ * 重复发送的任务在一次播放刚结束时取消，不能被放回队列继续发送。
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Hal.h"
+#include "RCSwitch.h"
+#include "RFTransmitter.h"
+#include "pin_config.h"
+
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int REPEATS = 10;
+const int BITS = 24;
+const uint64_t CODE = 0xA5C3F0;
+const uint32_t IDLE_US = 20000;
+const int CANCEL_ROUNDS = 20;
+const uint16_t CANCEL_REPEATS = 1000;      // 取消失败时还要发很久
+
+struct Edge {
+    int level;
+    unsigned long atUs;
+};
+
+std::vector<Edge> edges433;
+volatile bool loopback = false;
+
+// 取消测试只数边沿 (停止播放时测试线程也会写引脚，不能同时往edges433里加)
+volatile bool countOnly = false;
+std::atomic<size_t> writes433(0);
+size_t wakeAtWrite = 0;
+std::mutex wakeMutex;
+std::condition_variable wakeCond;
+
+void recordOutput(uint8_t pin, int level, unsigned long atUs) {
+    if (pin != RF_433_TX_PIN) {
+        return;
+    }
+    const size_t writes = ++writes433;
+    if (countOnly) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        if (writes == wakeAtWrite) {
+            wakeCond.notify_all();
+        }
+        return;
+    }
+    Edge edge = { level, atUs };
+    edges433.push_back(edge);
+    if (loopback) {
+        Hal::setInput(RF_433_RX_PIN, level);
+    }
+}
+
+/**
+ * 相邻边沿之间的脉冲宽度 (最后一个边沿回到空闲低电平，不算脉冲)
+ */
+std::vector<unsigned long> pulseWidths(const std::vector<Edge>& edges) {
+    std::vector<unsigned long> widths;
+    for (size_t i = 1; i < edges.size(); i++) {
+        widths.push_back(edges[i].atUs - edges[i - 1].atUs);
+    }
+    return widths;
+}
+
+bool waitIdle(RFTransmitter& tx) {
+    for (int i = 0; i < 2000; i++) {
+        if (!tx.isSending()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+/**
+ * 短暂忙等本频段恢复接收 (发送任务播完一次后立即恢复，然后才决定是否放回队列)。
+ * 单核上不一定等得到，超时后照样取消，只是落点换成下一次播放中或排队中
+ */
+void spinUntilReceiveResumed() {
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+    while (RCSwitch433::isReceiveSuspended() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * 等到发送引脚写到第target次 (播放最后一次写空闲电平时叫醒测试线程)
+ */
+bool waitWrites(size_t target) {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeAtWrite = target;
+    const bool reached = wakeCond.wait_for(lock, std::chrono::seconds(2),
+                                           [target]() { return writes433 >= target; });
+    wakeAtWrite = 0;
+    return reached;
+}
+
+SignalRecord makeSignal(unsigned int protocol) {
+    SignalRecord signal;
+    signal.code = RFCode(CODE);
+    signal.set(protocol, BITS, 0);
+    signal.setFreq(SignalRecord::FREQ_433);
+    return signal;
+}
+
+RFTransmitter* transmitter = NULL;
+
+} // namespace
+
+void setUp(void) {
+    edges433.clear();
+    loopback = false;
+}
+
+void tearDown(void) {}
+
+/**
+ * RMT播放和阻塞发送在引脚上写出完全相同的脉冲序列
+ */
+void test_rmt_waveform_matches_bitbang(void) {
+    RCSwitch433 bitbang;
+    bitbang.enableTransmit(RF_433_TX_PIN);
+    bitbang.setRepeatTransmit(REPEATS);
+
+    for (unsigned int p = 1; p <= 12; p++) {
+        edges433.clear();
+        TEST_ASSERT_NOT_EQUAL(0, transmitter->send(makeSignal(p)));
+        TEST_ASSERT_TRUE(waitIdle(*transmitter));
+        const std::vector<unsigned long> played = pulseWidths(edges433);
+
+        edges433.clear();
+        bitbang.setProtocol(p);
+        bitbang.send(RFCode(CODE), BITS);
+        const std::vector<unsigned long> written = pulseWidths(edges433);
+
+        TEST_ASSERT_GREATER_THAN(BITS * 2 * REPEATS - 1, played.size());
+        TEST_ASSERT_EQUAL_UINT32(written.size(), played.size());
+        for (size_t i = 0; i < played.size(); i++) {
+            TEST_ASSERT_EQUAL_UINT32(written[i], played[i]);
+        }
+    }
+    bitbang.disableTransmit();
+}
+
+/**
+ * 协议1 (350us): 每位是 1:3 或 3:1，同步是 1:31，误差不超过RMT的1us分辨率
+ */
+void test_rmt_timing_matches_protocol(void) {
+    TEST_ASSERT_NOT_EQUAL(0, transmitter->send(makeSignal(1)));
+    TEST_ASSERT_TRUE(waitIdle(*transmitter));
+    const std::vector<unsigned long> widths = pulseWidths(edges433);
+    TEST_ASSERT_EQUAL_UINT32((BITS + 1) * 2 * REPEATS - 1, widths.size());
+
+    for (int r = 0; r < REPEATS; r++) {
+        for (int b = 0; b < BITS; b++) {
+            const bool one = (CODE >> (BITS - 1 - b)) & 1;
+            const size_t i = (r * (BITS + 1) + b) * 2;
+            TEST_ASSERT_UINT32_WITHIN(1, one ? 1050 : 350, widths[i]);
+            TEST_ASSERT_UINT32_WITHIN(1, one ? 350 : 1050, widths[i + 1]);
+        }
+        const size_t sync = (r * (BITS + 1) + BITS) * 2;
+        TEST_ASSERT_UINT32_WITHIN(1, 350, widths[sync]);
+        if (sync + 1 < widths.size()) {
+            TEST_ASSERT_UINT32_WITHIN(1, 350 * 31, widths[sync + 1]);
+        }
+    }
+}
+
+/**
+ * 发送引脚环回到接收引脚: 发送期间接收中断丢弃边沿，结束后恢复接收
+ */
+void test_receive_suspended_while_sending(void) {
+    RCSwitch433 receiver;
+    receiver.enableReceive(RF_433_RX_PIN);
+    loopback = true;
+
+    const unsigned long before = RCSwitch433::getInterruptCount();
+    TEST_ASSERT_NOT_EQUAL(0, transmitter->send(makeSignal(1)));
+    TEST_ASSERT_TRUE(waitIdle(*transmitter));
+    TEST_ASSERT_FALSE(RCSwitch433::isReceiveSuspended());
+    TEST_ASSERT_EQUAL_UINT32(before, RCSwitch433::getInterruptCount());
+
+    Hal::advanceMicros(IDLE_US);
+    RCSwitch433::processEdges();
+    RCSwitch433::ReceivedFrame frame;
+    TEST_ASSERT_FALSE(receiver.readFrame(frame));
+
+    // 别的发射机 (这里用阻塞发送模拟) 的信号照常解码
+    RCSwitch433 other;
+    other.enableTransmit(RF_433_TX_PIN);
+    other.setRepeatTransmit(3);
+    other.setProtocol(1);
+    other.send(RFCode(CODE), BITS);
+    Hal::advanceMicros(IDLE_US);
+    RCSwitch433::processEdges();
+    TEST_ASSERT_TRUE(receiver.readFrame(frame));
+    TEST_ASSERT_TRUE(frame.code == RFCode(CODE));
+    TEST_ASSERT_EQUAL_UINT32(1, frame.protocol);
+
+    loopback = false;
+    other.disableTransmit();
+    receiver.disableReceive();
+}
+
+/**
+ * 重复发送的任务在一次播放刚结束时取消: cancel()返回true就不能再放回队列，
+ * 任务以"已取消"结束 (取消落在播放结束和放回队列之间时最容易出错)
+ */
+void test_cancel_repeating_job_at_end_of_playback(void) {
+    // 一次播放写几次发送引脚
+    edges433.clear();
+    TEST_ASSERT_NOT_EQUAL(0, transmitter->send(makeSignal(1)));
+    TEST_ASSERT_TRUE(waitIdle(*transmitter));
+    const size_t perPlayback = edges433.size();
+    TEST_ASSERT_TRUE(perPlayback > 0);
+
+    countOnly = true;
+    for (int round = 0; round < CANCEL_ROUNDS; round++) {
+        const size_t base = writes433;
+        const uint32_t id = transmitter->send(makeSignal(1), TX_PRIORITY_NORMAL, CANCEL_REPEATS, 0);
+        TEST_ASSERT_NOT_EQUAL(0, id);
+
+        // 第1~3次播放写完最后一个电平、发送任务恢复接收时取消 (还没决定是否放回队列)
+        TEST_ASSERT_TRUE(waitWrites(base + perPlayback * (round % 3 + 1)));
+        spinUntilReceiveResumed();
+        TEST_ASSERT_TRUE(transmitter->cancel(id));
+        const size_t cancelledAt = writes433;
+
+        TEST_ASSERT_TRUE(waitIdle(*transmitter));
+        const TxJobStats stats = transmitter->getLastJobStats();
+        TEST_ASSERT_EQUAL_UINT32(id, stats.id);
+        TEST_ASSERT_EQUAL_UINT8(TX_RESULT_CANCELLED, stats.result);
+        // 最多还有取消时正在进行的那一次播放
+        TEST_ASSERT_TRUE(writes433 <= cancelledAt + perPlayback);
+    }
+    countOnly = false;
+}
+
+int main() {
+    Hal::setLogLevel(ARDUHAL_LOG_LEVEL_ERROR);
+    Hal::useManualClock(1000000);
+    Hal::setOutputTap(recordOutput);
+    transmitter = new RFTransmitter();
+    transmitter->begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rmt_waveform_matches_bitbang);
+    RUN_TEST(test_rmt_timing_matches_protocol);
+    RUN_TEST(test_receive_suspended_while_sending);
+    RUN_TEST(test_cancel_repeating_job_at_end_of_playback);
+    const int failures = UNITY_END();
+
+    // 发送任务常驻，不等它结束
+    fflush(stdout);
+    _exit(failures);
+}
@@ -0,0 +1,244 @@
+/**
+ * @file test_main.cpp
+ * @brief 信号日志的墓碑、后台压缩和重新加载
+ *
+ * 每个测试使用新的临时LittleFS目录。删除产生的墓碑超过阈值后由存储任务
+ * 压缩，压缩前后以及压缩刚被唤醒时继续保存和删除的信号，重新加载后
+ * 都必须和内存中的列表一致 (顺序、编码、名称)。
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Hal.h"
+#include "SignalStorage.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace {
+
+const unsigned int FREQ = 433;
+const unsigned int PROTOCOL = 1;
+const unsigned int BITS = 24;
+
+volatile int tmpWrites = 0;
+
+/**
+ * 慢速Flash: 压缩写临时文件时每次写入等待1ms
+ */
+bool slowTmpWrites(const char* op, const char* path) {
+    if (strcmp(op, "write") == 0 && strstr(path, ".tmp") != NULL) {
+        tmpWrites++;
+        delay(1);
+    }
+    return true;
+}
+
+SignalRecord makeSignal(uint32_t code) {
+    SignalRecord signal;
+    signal.code = code;
+    signal.setFreq(FREQ);
+    signal.set(PROTOCOL, BITS, 0);
+    return signal;
+}
+
+/**
+ * 存储任务一直引用存储对象，测试里的对象不释放
+ */
+SignalStorage& newStorage() {
+    SignalStorage* storage = new SignalStorage();
+    TEST_ASSERT_TRUE(storage->begin());
+    return *storage;
+}
+
+void useFreshRoot() {
+    char dir[] = "/tmp/rf-storage-XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    Hal::setFsRoot(dir);
+}
+
+/**
+ * 等存储任务完成第target次压缩
+ */
+bool waitForCompaction(SignalStorage& storage, unsigned long target) {
+    for (int i = 0; i < 500 && storage.getCompactionCount() < target; i++) {
+        delay(10);
+    }
+    return storage.getCompactionCount() >= target;
+}
+
+/**
+ * 两个存储的信号列表 (编码和名称) 逐项相同
+ */
+void assertSameList(SignalStorage& expected, SignalStorage& actual) {
+    TEST_ASSERT_EQUAL_INT(expected.getSignalCount(), actual.getSignalCount());
+    for (int i = 0; i < expected.getSignalCount(); i++) {
+        SignalRecord a;
+        SignalRecord b;
+        TEST_ASSERT_TRUE(expected.getSignal(i, a));
+        TEST_ASSERT_TRUE(actual.getSignal(i, b));
+        TEST_ASSERT_TRUE(a.code == b.code);
+        char nameA[32];
+        char nameB[32];
+        expected.getSignalName(a, nameA, sizeof(nameA));
+        actual.getSignalName(b, nameB, sizeof(nameB));
+        TEST_ASSERT_EQUAL_STRING(nameA, nameB);
+    }
+}
+
+} // namespace
+
+void setUp(void) {
+    useFreshRoot();
+}
+
+void tearDown(void) {
+    Hal::setFsTap(NULL);
+}
+
+/**
+ * 删掉大部分信号后自动压缩，重新加载后列表不变且没有失效记录
+ */
+void test_tombstones_compact_and_reload(void) {
+    SignalStorage& storage = newStorage();
+    for (uint32_t code = 1; code <= 40; code++) {
+        char name[16];
+        snprintf(name, sizeof(name), "key%u", (unsigned int)code);
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(code), (code % 4 == 0) ? name : NULL));
+    }
+    TEST_ASSERT_TRUE(storage.flush());
+    const unsigned long compactions = storage.getCompactionCount();
+
+    // 删除30个: 60条失效记录，超过阈值也超过有效记录数
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_TRUE(storage.deleteSignal(i % 2 == 0 ? 0 : storage.getSignalCount() - 1));
+    }
+    TEST_ASSERT_EQUAL_INT(10, storage.getSignalCount());
+    TEST_ASSERT_TRUE(waitForCompaction(storage, compactions + 1));
+    TEST_ASSERT_EQUAL_UINT32(0, storage.getDeadRecordCount());
+
+    SignalStorage& reloaded = newStorage();
+    assertSameList(storage, reloaded);
+    TEST_ASSERT_EQUAL_UINT32(0, reloaded.getDeadRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(storage.getLogGeneration(), reloaded.getLogGeneration());
+}
+
+/**
+ * 压缩期间一直保存和删除: 这些改动进入写入队列 (队列满时等压缩结束)，
+ * 压缩后追加到新日志，重新加载后一条不少
+ */
+void test_changes_during_compaction_survive(void) {
+    SignalStorage& storage = newStorage();
+    for (uint32_t code = 1; code <= 600; code++) {
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(code)));
+    }
+    TEST_ASSERT_TRUE(storage.flush());
+    const unsigned long compactions = storage.getCompactionCount();
+
+    Hal::setFsTap(slowTmpWrites);
+    tmpWrites = 0;
+    for (int i = 0; i < 500; i++) {
+        TEST_ASSERT_TRUE(storage.deleteSignal(0));
+    }
+
+    // 不等压缩，边保存边删除，直到压缩完成
+    uint32_t code = 10000;
+    int expected = storage.getSignalCount();
+    int duringCompaction = 0;
+    while (storage.getCompactionCount() == compactions && code < 20000) {
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(code++), "late"));
+        expected++;
+        // 保存返回时压缩还在写临时文件: 没有被压缩挡住
+        if (tmpWrites > 0 && storage.getCompactionCount() == compactions) {
+            duringCompaction++;
+        }
+        if (code % 8 == 0) {
+            TEST_ASSERT_TRUE(storage.deleteSignal(expected / 2));
+            expected--;
+        }
+        delay(1);
+    }
+    TEST_ASSERT_TRUE(waitForCompaction(storage, compactions + 1));
+    TEST_ASSERT_GREATER_THAN(0, duringCompaction);
+    TEST_ASSERT_TRUE(storage.flush());
+    TEST_ASSERT_EQUAL_INT(expected, storage.getSignalCount());
+    TEST_ASSERT_TRUE(storage.findSignal(RFCode((uint64_t)(code - 1)), BITS, PROTOCOL, FREQ) >= 0);
+
+    SignalStorage& reloaded = newStorage();
+    assertSameList(storage, reloaded);
+}
+
+/**
+ * 名称池写满时保存失败并报告原因；删除带名称的信号、再压缩两次后
+ * (第一次压缩后上一代日志还引用这些名称) 空出的位置可以放新名称，
+ * 保留的名称编号不变，重新加载后名称正确
+ */
+void test_name_pool_full_and_reclaimed(void) {
+    SignalStorage& storage = newStorage();
+    char name[32];
+    uint32_t code = 1;
+    SaveError error = SAVE_ERROR_NONE;
+    while (true) {
+        snprintf(name, sizeof(name), "living-room-lamp-%05u", (unsigned int)code);
+        if (!storage.saveSignal(makeSignal(code), name, &error)) {
+            break;
+        }
+        code++;
+    }
+    TEST_ASSERT_EQUAL_INT(SAVE_ERROR_NAMES_FULL, error);
+    TEST_ASSERT_TRUE(storage.findSignal(RFCode((uint64_t)code), BITS, PROTOCOL, FREQ) < 0);
+    TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(code)));     // 默认名称不占名称池
+    TEST_ASSERT_FALSE(storage.saveSignal(makeSignal(code), NULL, &error));
+    TEST_ASSERT_EQUAL_INT(SAVE_ERROR_EXISTS, error);
+    TEST_ASSERT_TRUE(storage.flush());
+
+    // 保留第一个和最后一个带名称的信号，删除中间的
+    const int named = (int)code - 1;
+    const unsigned long compactions = storage.getCompactionCount();
+    for (int i = 1; i < named - 1; i++) {
+        TEST_ASSERT_TRUE(storage.deleteSignal(1));
+    }
+    TEST_ASSERT_TRUE(waitForCompaction(storage, compactions + 1));
+
+    // 再攒一批失效记录触发第二次压缩，上一代日志换掉后名称才释放
+    for (uint32_t i = 0; i < 8; i++) {
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(6000 + i)));
+    }
+    for (uint32_t i = 0; i < 8; i++) {
+        TEST_ASSERT_TRUE(storage.deleteSignal(storage.findSignal(RFCode((uint64_t)(6000 + i)), BITS, PROTOCOL, FREQ)));
+    }
+    TEST_ASSERT_TRUE(waitForCompaction(storage, compactions + 2));
+
+    SignalRecord last;
+    TEST_ASSERT_TRUE(storage.getSignal(1, last));
+    for (int i = 0; i < 10; i++) {
+        snprintf(name, sizeof(name), "garage-door-%02d", i);
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(5000 + i), name, &error));
+        TEST_ASSERT_EQUAL_INT(SAVE_ERROR_NONE, error);
+    }
+    TEST_ASSERT_TRUE(storage.flush());
+
+    SignalStorage& reloaded = newStorage();
+    assertSameList(storage, reloaded);
+    SignalRecord signal;
+    TEST_ASSERT_TRUE(reloaded.getSignal(0, signal));
+    reloaded.getSignalName(signal, name, sizeof(name));
+    TEST_ASSERT_EQUAL_STRING("living-room-lamp-00001", name);
+    TEST_ASSERT_TRUE(reloaded.getSignal(1, signal));
+    TEST_ASSERT_EQUAL_UINT16(last.nameId, signal.nameId);
+    TEST_ASSERT_TRUE(reloaded.getSignal(reloaded.getSignalCount() - 1, signal));
+    reloaded.getSignalName(signal, name, sizeof(name));
+    TEST_ASSERT_EQUAL_STRING("garage-door-09", name);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_tombstones_compact_and_reload);
+    RUN_TEST(test_changes_during_compaction_survive);
+    RUN_TEST(test_name_pool_full_and_reclaimed);
+    const int failures = UNITY_END();
+    // 存储任务还在运行，直接退出
+    fflush(stdout);
+    _exit(failures);
+}
@@ -0,0 +1,387 @@
+/**
+ * @file test_main.cpp
+ * @brief 串口导出/导入的往返测试 (伪终端代替串口)
+ *
+ * 设备一侧的SignalTransfer读写伪终端的主端，主机一侧直接运行
+ * tools/rfx.py 打开从端，和接真实设备时完全一样。5000个信号
+ * (带自定义名称和原始信号) 导出后导入到空白的存储，逐个比较；
+ * 导出期间记录堆内存的峰值增长，不能随信号数量增长。
+ * 名称池放不下的导入以错误结束，rfx.py返回非零。
+ *
+ * 需要 python3 和 pyserial (tools/requirements.txt)。native环境 (platformio.ini)
+ * 定义RF_REMOTE_ROOT (项目目录) 和RF_REMOTE_PYTHON (PlatformIO自带的
+ * Python，已装有pyserial)，此时缺少工具算失败；手动编译时缺少则跳过。
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Hal.h"
+#include "SignalStorage.h"
+#include "SignalTransfer.h"
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int LIBRARY_SIGNALS = 5000;
+const int RAW_SIGNALS = 5;
+const size_t RAW_WORDS = 300;
+const double MAX_TRANSFER_SECONDS = 30.0;
+const size_t MAX_HEAP_GROWTH = 16 * 1024;   // 导出期间堆内存最多增长 (字节)
+
+const char* const NAMES[] = { "tv", "fan", "garage", "porch light", "gate", "blinds up", "blinds down" };
+
+/**
+ * 伪终端主端作为设备的串口
+ */
+class PtyStream : public Stream {
+public:
+    explicit PtyStream(int fd) : _fd(fd) {}
+
+    int available() override {
+        fill();
+        return (int)_input.size();
+    }
+
+    int read() override {
+        fill();
+        if (_input.empty()) {
+            return -1;
+        }
+        const uint8_t c = _input.front();
+        _input.pop_front();
+        return c;
+    }
+
+    int peek() override {
+        fill();
+        return _input.empty() ? -1 : _input.front();
+    }
+
+    size_t write(uint8_t c) override {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+        size_t written = 0;
+        while (written < size) {
+            const ssize_t n = ::write(_fd, buffer + written, size - written);
+            if (n <= 0) {
+                break;
+            }
+            written += n;
+        }
+        return written;
+    }
+
+    using Print::write;
+
+private:
+    int _fd;
+    std::deque<uint8_t> _input;
+
+    void fill() {
+        struct pollfd pfd = { _fd, POLLIN, 0 };
+        uint8_t buffer[512];
+        while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+            const ssize_t n = ::read(_fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                break;
+            }
+            _input.insert(_input.end(), buffer, buffer + n);
+        }
+    }
+};
+
+int ptyMaster = -1;
+int ptySlave = -1;              // 测试一直打开从端，rfx.py关闭后主端不会读到EIO
+std::string ptyPath;
+std::string rfxPath;
+
+#ifdef RF_REMOTE_PYTHON
+const char* const PYTHON = RF_REMOTE_PYTHON;
+#else
+const char* const PYTHON = "python3";
+#endif
+
+// 信号库内容: 编码、协议参数、名称和原始数据
+struct Item {
+    SignalRecord signal;
+    std::string name;
+    std::vector<uint16_t> raw;
+};
+
+typedef std::vector<Item> Library;
+
+std::vector<Item> readLibrary(SignalStorage& storage) {
+    Library library;
+    for (int i = 0; i < storage.getSignalCount(); i++) {
+        Item item;
+        TEST_ASSERT_TRUE(storage.getSignal(i, item.signal));
+        char name[32];
+        storage.getSignalName(item.signal, name, sizeof(name));
+        item.name = name;
+        if (item.signal.isRaw()) {
+            item.raw.resize(SignalStorage::MAX_RAW_WORDS);
+            item.raw.resize(storage.loadRawData(item.signal, item.raw.data(), item.raw.size()));
+        }
+        library.push_back(item);
+    }
+    return library;
+}
+
+size_t heapInUse() {
+    return mallinfo2().uordblks;
+}
+
+/**
+ * 存储任务一直引用存储对象，测试里的对象不释放
+ */
+SignalStorage& newStorage() {
+    char dir[] = "/tmp/rf-transfer-XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    Hal::setFsRoot(dir);
+    SignalStorage* storage = new SignalStorage();
+    TEST_ASSERT_TRUE(storage->begin());
+    return *storage;
+}
+
+/**
+ * 设备主循环: 在后台线程里反复调用update()，直到rfx.py退出
+ */
+class Device {
+public:
+    explicit Device(SignalStorage& storage)
+        : _stream(ptyMaster), _transfer(&storage, &_stream), _running(true), _baseHeap(heapInUse()), _peakHeap(0) {
+        _thread = std::thread([this]() {
+            while (_running) {
+                _transfer.update();
+                const size_t heap = heapInUse();
+                if (heap > _peakHeap) {
+                    _peakHeap = heap;
+                }
+                delayMicroseconds(100);
+            }
+        });
+    }
+
+    ~Device() {
+        _running = false;
+        _thread.join();
+    }
+
+    size_t heapGrowth() const { return _peakHeap > _baseHeap ? _peakHeap - _baseHeap : 0; }
+
+private:
+    PtyStream _stream;
+    SignalTransfer _transfer;
+    std::atomic<bool> _running;
+    size_t _baseHeap;
+    std::atomic<size_t> _peakHeap;
+    std::thread _thread;
+};
+
+/**
+ * 运行rfx.py，返回退出码，输出 (stderr) 存到output
+ */
+int runRfx(const char* command, const std::string& file, std::string& output, double& seconds) {
+    const std::string line = std::string(PYTHON) + " " + rfxPath + " " + command + " " + ptyPath + " " + file + " 2>&1";
+    const unsigned long start = millis();
+    FILE* pipe = popen(line.c_str(), "r");
+    TEST_ASSERT_NOT_NULL(pipe);
+    char buffer[256];
+    output.clear();
+    while (fgets(buffer, sizeof(buffer), pipe) != NULL) {
+        output += buffer;
+    }
+    const int status = pclose(pipe);
+    seconds = (millis() - start) / 1000.0;
+    printf("rfx.py %s: %.2f s\n%s", command, seconds, output.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+bool findRfx() {
+    // PlatformIO在项目目录运行测试; __FILE__可能是绝对路径
+    std::string fromSource(__FILE__);
+    const size_t cut = fromSource.rfind("/test/");
+    const std::string candidates[] = {
+        getenv("RF_REMOTE_ROOT") ? std::string(getenv("RF_REMOTE_ROOT")) + "/tools/rfx.py" : std::string(),
+#ifdef RF_REMOTE_ROOT
+        std::string(RF_REMOTE_ROOT) + "/tools/rfx.py",
+#endif
+        cut != std::string::npos ? fromSource.substr(0, cut) + "/tools/rfx.py" : std::string(),
+        "tools/rfx.py",
+    };
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        if (!candidates[i].empty() && access(candidates[i].c_str(), R_OK) == 0) {
+            rfxPath = candidates[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+bool openPty() {
+    ptyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    if (ptyMaster < 0 || grantpt(ptyMaster) != 0 || unlockpt(ptyMaster) != 0) {
+        return false;
+    }
+    ptyPath = ptsname(ptyMaster);
+    ptySlave = open(ptyPath.c_str(), O_RDWR | O_NOCTTY);
+    if (ptySlave < 0) {
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(ptySlave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(ptySlave, TCSANOW, &tio);
+    return true;
+}
+
+void requireTools() {
+    const std::string check = std::string(PYTHON) + " -c 'import serial' >/dev/null 2>&1";
+    if (!rfxPath.empty() && system(check.c_str()) == 0) {
+        return;
+    }
+#ifdef RF_REMOTE_ROOT
+    TEST_FAIL_MESSAGE("native环境下找不到 tools/rfx.py 或 pyserial (pip install -r tools/requirements.txt)");
+#else
+    TEST_IGNORE_MESSAGE("需要 tools/rfx.py、python3 和 pyserial");
+#endif
+}
+
+} // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * 5000个信号导出再导入到空白存储，内容逐个相同
+ */
+void test_export_import_round_trip(void) {
+    requireTools();
+
+    SignalStorage& source = newStorage();
+    for (int i = 0; i < LIBRARY_SIGNALS - RAW_SIGNALS; i++) {
+        SignalRecord signal;
+        signal.code = RFCode(0x1000000ULL + i * 7919ULL, (i % 50 == 0) ? 0xABCDULL : 0);
+        signal.setFreq(i % 3 == 0 ? SignalRecord::FREQ_315 : SignalRecord::FREQ_433);
+        signal.set(1 + i % 12, (i % 50 == 0) ? 80 : 24 + i % 8, (i % 5 == 0) ? 300 + i % 100 : 0);
+        const char* name = (i % 7 == 0) ? NAMES[i % (sizeof(NAMES) / sizeof(NAMES[0]))] : NULL;
+        TEST_ASSERT_TRUE(source.saveSignal(signal, name));
+    }
+    for (int i = 0; i < RAW_SIGNALS; i++) {
+        uint16_t words[RAW_WORDS];
+        for (size_t w = 0; w < RAW_WORDS; w++) {
+            words[w] = (uint16_t)(200 + (w * 37 + i * 11) % 900);
+        }
+        TEST_ASSERT_TRUE(source.saveRawSignal(SignalRecord::FREQ_433, words, RAW_WORDS));
+    }
+    TEST_ASSERT_TRUE(source.flush());
+    const Library expected = readLibrary(source);
+    TEST_ASSERT_EQUAL_INT(LIBRARY_SIGNALS, (int)expected.size());
+
+    char backup[] = "/tmp/rf-transfer-backup-XXXXXX";
+    const int backupFd = mkstemp(backup);
+    TEST_ASSERT_TRUE(backupFd >= 0);
+    close(backupFd);
+
+    std::string output;
+    double seconds = 0;
+    size_t heapGrowth = 0;
+    {
+        Device device(source);
+        TEST_ASSERT_EQUAL_INT(0, runRfx("export", backup, output, seconds));
+        heapGrowth = device.heapGrowth();
+    }
+    printf("导出期间堆内存增长 %u 字节\n", (unsigned int)heapGrowth);
+    TEST_ASSERT_TRUE(seconds < MAX_TRANSFER_SECONDS);
+    TEST_ASSERT_TRUE(heapGrowth < MAX_HEAP_GROWTH);
+
+    SignalStorage& target = newStorage();
+    {
+        Device device(target);
+        TEST_ASSERT_EQUAL_INT(0, runRfx("import", backup, output, seconds));
+    }
+    TEST_ASSERT_TRUE(seconds < MAX_TRANSFER_SECONDS);
+    TEST_ASSERT_TRUE(output.find("新增 5000, 已存在 0, 失败 0") != std::string::npos);
+
+    const Library actual = readLibrary(target);
+    TEST_ASSERT_EQUAL_INT(LIBRARY_SIGNALS, (int)actual.size());
+    for (int i = 0; i < LIBRARY_SIGNALS; i++) {
+        const SignalRecord& a = expected[i].signal;
+        const SignalRecord& b = actual[i].signal;
+        TEST_ASSERT_TRUE(a.code == b.code);
+        TEST_ASSERT_EQUAL_INT(a.type, b.type);
+        TEST_ASSERT_EQUAL_INT(a.freq(), b.freq());
+        if (!a.isRaw()) {
+            TEST_ASSERT_EQUAL_INT(a.protocol, b.protocol);
+            TEST_ASSERT_EQUAL_INT(a.bits, b.bits);
+            TEST_ASSERT_EQUAL_INT(a.pulseLength, b.pulseLength);
+            TEST_ASSERT_EQUAL_STRING(expected[i].name.c_str(), actual[i].name.c_str());
+        }
+        TEST_ASSERT_TRUE(expected[i].raw == actual[i].raw);
+    }
+    unlink(backup);
+}
+
+/**
+ * 每个信号一个长名称: 名称池写满后设备回复ERROR names，rfx.py报错退出，
+ * 之前导入的信号保留
+ */
+void test_import_stops_when_name_pool_is_full(void) {
+    requireTools();
+
+    char backup[] = "/tmp/rf-transfer-names-XXXXXX";
+    const int backupFd = mkstemp(backup);
+    TEST_ASSERT_TRUE(backupFd >= 0);
+    FILE* file = fdopen(backupFd, "w");
+    for (int i = 0; i < 200; i++) {
+        fprintf(file, "{\"name\":\"kitchen-remote-button-%05d\",\"freq\":433,\"code\":%d,"
+                      "\"protocol\":1,\"bits\":24}\n", i, 100000 + i);
+    }
+    fclose(file);
+
+    SignalStorage& target = newStorage();
+    std::string output;
+    double seconds = 0;
+    int status;
+    {
+        Device device(target);
+        status = runRfx("import", backup, output, seconds);
+    }
+    TEST_ASSERT_NOT_EQUAL(0, status);
+    TEST_ASSERT_TRUE(output.find("名称池已满") != std::string::npos);
+    TEST_ASSERT_TRUE(target.getSignalCount() > 0);
+    TEST_ASSERT_TRUE(target.getSignalCount() < 200);
+    unlink(backup);
+}
+
+int main() {
+    findRfx();
+    if (!openPty()) {
+        perror("pty");
+        return 1;
+    }
+    UNITY_BEGIN();
+    RUN_TEST(test_export_import_round_trip);
+    RUN_TEST(test_import_stops_when_name_pool_is_full);
+    const int failures = UNITY_END();
+    // 存储任务还在运行，直接退出
+    fflush(stdout);
+    _exit(failures);
+}
@@ -0,0 +1,288 @@
+/**
+ * @file test_main.cpp
+ * @brief 浅睡眠前后不丢按键、接收和存储事件
+ *
+ * 在模拟层上运行完整固件 (setup()/loop())，电池供电，空闲时主循环
+ * 会进入浅睡眠。真实硬件睡眠时CPU和所有任务都停着，按键下降沿
+ * 不进中断，接收引脚的边沿直接丢掉，所以:
+ *   - 睡眠中按下的每个按键 (长短不一) 都要唤醒主循环并产生恰好一个事件
+ *   - 接收页面扫描期间不能睡，发出的每一帧都要解码并保存
+ *   - 存储写入 (故意放慢) 不能发生在睡眠期间，重新加载后一条不少:
+ *     删除信号后写入还在排队，主循环要等写完才睡
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Hal.h"
+#include "Menu.h"
+#include "Page.h"
+#include "RCSwitch.h"
+#include "RFReceiver.h"
+#include "SignalStorage.h"
+#include "SignalSynth.h"
+#include "pin_config.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+// 固件入口和全局对象 (src/main.cpp)
+void setup();
+void loop();
+extern Menu* menu;
+extern Page* currentPageObj;
+extern RFReceiver rfReceiver;
+extern SignalStorage signalStorage;
+
+namespace {
+
+// 电池电压 (ADC引脚，分压后)，校准后约3.7V，低于USB供电的判断门限
+const uint32_t BATTERY_MILLIVOLTS = 300;
+
+const int MENU_ITEMS = 3;
+const int RX_MENU_INDEX = 0;
+const int TX_MENU_INDEX = 1;
+const unsigned long LONG_PRESS_MS = 550;
+const int CURSOR_TO_DELETE_TAPS = 12;      // 编辑模式下光标移过所有数字位到删除按钮
+
+// 按住时长 (ms): 从比防抖还短到接近长按
+const unsigned long TAP_MS[] = { 5, 15, 40, 120, 300 };
+const int TAP_ROUNDS = 2;
+
+const int RX_FRAMES = 5;
+const unsigned int RX_PROTOCOL = 1;
+const unsigned int RX_BITS = 24;
+const unsigned int RX_REPEATS = 8;
+const unsigned long RX_GAP_MS = RFReceiver::RECEIVE_COOLDOWN_MS + 100;
+
+const unsigned long SLOW_WRITE_MS = 40;     // 每次写Flash的耗时
+// 删除时每次写Flash的耗时: 比主循环一次定时等待还长，写入跨过主循环想睡的时刻
+const unsigned long VERY_SLOW_WRITE_MS = 600;
+const unsigned long WAIT_MS = 3000;
+
+std::atomic<bool> firmwareReady(false);
+std::atomic<unsigned long> writeMs(SLOW_WRITE_MS);
+std::atomic<uint32_t> fsOps(0);
+std::atomic<uint32_t> fsOpsWhileSleeping(0);
+
+/**
+ * 慢速Flash，并记下睡眠期间的写操作 (真实硬件上此时存储任务停着)
+ */
+bool slowFlash(const char* op, const char* path) {
+    (void)op;
+    (void)path;
+    fsOps++;
+    // 操作在等待之后才执行，前后都不能在睡眠中
+    const bool sleepingBefore = Hal::isLightSleeping();
+    delay(writeMs);
+    if (sleepingBefore || Hal::isLightSleeping()) {
+        fsOpsWhileSleeping++;
+    }
+    return true;
+}
+
+/**
+ * 等到条件成立，超时返回false
+ */
+template <typename Condition>
+bool waitFor(Condition condition, unsigned long timeoutMs = WAIT_MS) {
+    const unsigned long start = millis();
+    while (!condition()) {
+        if (millis() - start > timeoutMs) {
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+bool waitUntilSleeping() {
+    return waitFor([]() { return Hal::isLightSleeping(); });
+}
+
+void tap(uint8_t pin, unsigned long holdMs) {
+    Hal::setInput(pin, LOW);
+    delay(holdMs);
+    Hal::setInput(pin, HIGH);
+}
+
+/**
+ * 在菜单里移到第index项 (每次下移都等主循环处理完)
+ */
+void selectMenuItem(int index) {
+    while (menu->getCurrentSelection() != index) {
+        const int expected = (menu->getCurrentSelection() + 1) % MENU_ITEMS;
+        tap(BTN_DOWN_PIN, 40);
+        TEST_ASSERT_TRUE(waitFor([expected]() { return menu->getCurrentSelection() == expected; }));
+    }
+}
+
+/**
+ * 短按并等按键处理完 (主循环会接着睡)
+ */
+void tapAndSettle(uint8_t pin, unsigned long holdMs) {
+    tap(pin, holdMs);
+    delay(100);
+}
+
+/**
+ * 实时播放一帧到433MHz接收引脚 (忙等，边沿时间戳由ISR里的micros()决定)
+ */
+void playFrame(const RFCode& code) {
+    RCSwitch433 sender;
+    sender.setProtocol(RX_PROTOCOL);
+    sender.setRepeatTransmit(RX_REPEATS);
+    PulseProgram program;
+    program.reserve(1024);
+    TEST_ASSERT_TRUE(sender.compile(code, RX_BITS, program));
+    SignalSynth synth(1);
+    synth.appendProgram(program, 0, 0);
+
+    const std::vector<SignalSynth::Pulse>& pulses = synth.pulses();
+    unsigned long at = micros();
+    for (size_t i = 0; i < pulses.size(); i++) {
+        Hal::setInput(RF_433_RX_PIN, pulses[i].level);
+        at += pulses[i].duration;
+        while ((long)(micros() - at) < 0) {
+        }
+    }
+    Hal::setInput(RF_433_RX_PIN, LOW);
+}
+
+RFCode frameCode(int index) {
+    return RFCode(0x5A0000ULL + index * 0x111ULL);
+}
+
+} // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * 睡眠中按下的按键: 长短不一，每次恰好让菜单下移一项
+ */
+void test_taps_during_sleep_are_not_lost(void) {
+    for (int round = 0; round < TAP_ROUNDS; round++) {
+        for (size_t i = 0; i < sizeof(TAP_MS) / sizeof(TAP_MS[0]); i++) {
+            TEST_ASSERT_TRUE_MESSAGE(waitUntilSleeping(), "空闲时没有进入浅睡眠");
+            const int expected = (menu->getCurrentSelection() + 1) % MENU_ITEMS;
+            tap(BTN_DOWN_PIN, TAP_MS[i]);
+            TEST_ASSERT_TRUE_MESSAGE(waitFor([expected]() { return menu->getCurrentSelection() == expected; }),
+                                     "睡眠中的按键丢失");
+            // 不能多出事件
+            delay(100);
+            TEST_ASSERT_EQUAL_INT(expected, menu->getCurrentSelection());
+        }
+    }
+}
+
+/**
+ * 接收页面扫描期间不睡，每一帧都保存；离开后重新进入浅睡眠
+ */
+void test_frames_while_scanning_are_received_and_stored(void) {
+    selectMenuItem(RX_MENU_INDEX);
+    TEST_ASSERT_TRUE(waitUntilSleeping());
+    tap(BTN_OK_PIN, 40);
+    TEST_ASSERT_TRUE(waitFor([]() { return rfReceiver.isScanning(); }));
+
+    const uint32_t sleepsBefore = Hal::getLightSleepCount();
+    const int countBefore = signalStorage.getSignalCount();
+    for (int i = 0; i < RX_FRAMES; i++) {
+        delay(RX_GAP_MS);
+        playFrame(frameCode(i));
+        TEST_ASSERT_TRUE_MESSAGE(waitFor([countBefore, i]() { return signalStorage.getSignalCount() == countBefore + i + 1; }),
+                                 "扫描期间发出的帧没有保存");
+    }
+    TEST_ASSERT_EQUAL_UINT32(sleepsBefore, Hal::getLightSleepCount());
+
+    // 长按上键回到菜单，写入完成后才睡
+    Hal::setInput(BTN_UP_PIN, LOW);
+    TEST_ASSERT_TRUE(waitFor([]() { return !rfReceiver.isScanning(); }));
+    Hal::setInput(BTN_UP_PIN, HIGH);
+    TEST_ASSERT_TRUE(waitFor([]() { return currentPageObj == NULL; }));
+    TEST_ASSERT_TRUE(waitUntilSleeping());
+    TEST_ASSERT_EQUAL_INT(0, signalStorage.getPendingWrites());
+
+    TEST_ASSERT_GREATER_THAN(0, fsOps.load());
+    TEST_ASSERT_EQUAL_UINT32(0, fsOpsWhileSleeping.load());
+
+    // 重新加载 (另一个实例读同一个目录)，和内存里的一条不差。
+    // 忙等播放在单核主机上偶尔被抢占，解出的编码可能和发出的不同，只比较保存下来的
+    SignalStorage* reloaded = new SignalStorage();
+    TEST_ASSERT_TRUE(reloaded->begin());
+    TEST_ASSERT_EQUAL_INT(countBefore + RX_FRAMES, reloaded->getSignalCount());
+    for (int i = 0; i < reloaded->getSignalCount(); i++) {
+        SignalRecord expected;
+        SignalRecord actual;
+        TEST_ASSERT_TRUE(signalStorage.getSignal(i, expected));
+        TEST_ASSERT_TRUE(reloaded->getSignal(i, actual));
+        TEST_ASSERT_TRUE(expected.sameKey(actual));
+    }
+}
+
+/**
+ * 发送页面删除第一个信号: 删除记录排队写入期间不睡，写完后重新睡眠
+ */
+void test_delete_is_written_before_sleep(void) {
+    SignalRecord first;
+    TEST_ASSERT_TRUE(signalStorage.getSignal(0, first));
+    const int countBefore = signalStorage.getSignalCount();
+
+    TEST_ASSERT_TRUE(waitUntilSleeping());
+    selectMenuItem(TX_MENU_INDEX);
+    tapAndSettle(BTN_OK_PIN, 40);
+    TEST_ASSERT_NOT_NULL(currentPageObj);
+
+    // 长按确认进入编辑模式，光标移到删除按钮，再长按确认
+    tapAndSettle(BTN_OK_PIN, LONG_PRESS_MS);
+    for (int i = 0; i < CURSOR_TO_DELETE_TAPS; i++) {
+        tapAndSettle(BTN_DOWN_PIN, 40);
+    }
+    const uint32_t sleepingWritesBefore = fsOpsWhileSleeping;
+    writeMs = VERY_SLOW_WRITE_MS;
+    tapAndSettle(BTN_OK_PIN, LONG_PRESS_MS);
+    TEST_ASSERT_TRUE(waitFor([countBefore]() { return signalStorage.getSignalCount() == countBefore - 1; }));
+
+    TEST_ASSERT_TRUE(waitFor([]() { return signalStorage.getPendingWrites() == 0; }, 10000));
+    writeMs = SLOW_WRITE_MS;
+    TEST_ASSERT_TRUE(waitUntilSleeping());
+    TEST_ASSERT_EQUAL_UINT32(sleepingWritesBefore, fsOpsWhileSleeping.load());
+
+    SignalStorage* reloaded = new SignalStorage();
+    TEST_ASSERT_TRUE(reloaded->begin());
+    TEST_ASSERT_EQUAL_INT(countBefore - 1, reloaded->getSignalCount());
+    TEST_ASSERT_FALSE(reloaded->signalExists(first.code, first.bits, first.protocol, first.freq()));
+}
+
+int main() {
+    char dir[] = "/tmp/rf-sleep-XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        return 1;
+    }
+    Hal::setFsRoot(dir);
+    Hal::setFsTap(slowFlash);
+    Hal::setAnalogMillivolts(BAT_ADC_PIN, BATTERY_MILLIVOLTS);
+
+    // 固件在自己的线程里运行，断言留在主线程
+    std::thread([]() {
+        setup();
+        firmwareReady = true;
+        while (true) {
+            loop();
+        }
+    }).detach();
+    while (!firmwareReady) {
+        delay(10);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_taps_during_sleep_are_not_lost);
+    RUN_TEST(test_frames_while_scanning_are_received_and_stored);
+    RUN_TEST(test_delete_is_written_before_sleep);
+    const int failures = UNITY_END();
+    // 固件和它的任务还在运行，直接退出
+    fflush(stdout);
+    _exit(failures);
+}
@@ -0,0 +1,135 @@
+/**
+ * @file test_main.cpp
+ * @brief SPSCQueue在真实并发下不丢、不重、不乱序
+ *
+ * 生产者在另一个线程里推送带序号的帧，队列满时重试 (模拟中断下一次再推)；
+ * 消费者逐个检查序号和内容。小容量的队列保证反复绕回和反复写满。
+ */
+
+#include <unity.h>
+#include "SPSCQueue.h"
+
+#include <thread>
+
+namespace {
+
+const unsigned int QUEUE_SIZE = 16;
+const uint32_t FRAMES = 100000;
+
+/**
+ * 模拟解码出的帧: 内容由序号推出，撕裂的读写会让校验对不上
+ */
+struct Frame {
+    uint32_t seq;
+    uint32_t code;
+    uint32_t check;
+};
+
+Frame makeFrame(uint32_t seq) {
+    Frame frame;
+    frame.seq = seq;
+    frame.code = seq * 2654435761u;
+    frame.check = ~frame.code ^ seq;
+    return frame;
+}
+
+void assertFrame(const Frame& frame, uint32_t seq) {
+    TEST_ASSERT_EQUAL_UINT32(seq, frame.seq);
+    TEST_ASSERT_EQUAL_UINT32(seq * 2654435761u, frame.code);
+    TEST_ASSERT_EQUAL_UINT32(~frame.code ^ seq, frame.check);
+}
+
+} // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/**
+ * 写满后再推被拒绝并计数，已有元素不受影响
+ */
+void test_queue_full_drops_new_item(void) {
+    SPSCQueue<Frame, QUEUE_SIZE> queue;
+    for (uint32_t i = 0; i < QUEUE_SIZE - 1; i++) {
+        TEST_ASSERT_TRUE(queue.push(makeFrame(i)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(QUEUE_SIZE - 1, queue.size());
+    TEST_ASSERT_FALSE(queue.push(makeFrame(99)));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getDropCount());
+
+    Frame frame;
+    for (uint32_t i = 0; i < QUEUE_SIZE - 1; i++) {
+        TEST_ASSERT_TRUE(queue.pop(frame));
+        assertFrame(frame, i);
+    }
+    TEST_ASSERT_FALSE(queue.pop(frame));
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+/**
+ * 单线程交替推入弹出，head/tail多次绕回
+ */
+void test_queue_wraps_around(void) {
+    SPSCQueue<Frame, QUEUE_SIZE> queue;
+    uint32_t pushed = 0;
+    uint32_t popped = 0;
+    Frame frame;
+    for (int round = 0; round < 100; round++) {
+        const unsigned int batch = 1 + round % (QUEUE_SIZE - 1);
+        for (unsigned int i = 0; i < batch; i++) {
+            TEST_ASSERT_TRUE(queue.push(makeFrame(pushed++)));
+        }
+        TEST_ASSERT_EQUAL_UINT32(pushed - popped, queue.size());
+        while (queue.pop(frame)) {
+            assertFrame(frame, popped++);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(pushed, popped);
+    TEST_ASSERT_EQUAL_UINT32(0, queue.getDropCount());
+}
+
+/**
+ * 生产者线程推N帧，满了就重试；消费者收到的序列必须是0..N-1，
+ * 丢弃计数等于被拒绝的推送次数。两边空等时让出CPU，单核上也能交替运行
+ */
+void test_queue_threaded_no_loss_no_reorder(void) {
+    static SPSCQueue<Frame, QUEUE_SIZE> queue;
+    unsigned long rejected = 0;
+
+    std::thread producer([&rejected]() {
+        for (uint32_t seq = 0; seq < FRAMES; seq++) {
+            const Frame frame = makeFrame(seq);
+            while (!queue.push(frame)) {
+                rejected++;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    unsigned long maxSize = 0;
+    Frame frame;
+    while (expected < FRAMES) {
+        const unsigned int size = queue.size();
+        maxSize = size > maxSize ? size : maxSize;
+        if (queue.pop(frame)) {
+            assertFrame(frame, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_FALSE(queue.pop(frame));
+    TEST_ASSERT_EQUAL_UINT32(rejected, queue.getDropCount());
+    // 消费者和生产者速度相近，但至少会有一次看到队列里积了多个元素
+    TEST_ASSERT_GREATER_THAN(1, maxSize);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_full_drops_new_item);
+    RUN_TEST(test_queue_wraps_around);
+    RUN_TEST(test_queue_threaded_no_loss_no_reorder);
+    return UNITY_END();
+}
@@ -0,0 +1,360 @@
+/**
+ * @file test_main.cpp
+ * @brief 信号存储的掉电恢复 (故障注入)
+ *
+ * 文件系统监听回调数出每一步写操作 (打开写入、写入、改名、删除)，
+ * 从第N步起全部失败，模拟在该步之后掉电。每个场景先空跑一遍数出总步数，
+ * 再对每个N: 把基准信号库复制到新目录，执行操作并等存储任务停下，
+ * 然后"重启" (新的存储对象begin())，检查信号库完整: 只能是操作前、
+ * 操作后或者 (批量删除时) 按顺序删掉了前几个，名称和原始数据都对得上。
+ *
+ * 覆盖的写路径: 日志追加 (新增和删除墓碑)、名称池整文件替换、
+ * 日志压缩的临时文件和两次改名。压缩清理名称池之后正式日志损坏、
+ * 退回上一代日志时，上一代引用的名称仍然正确。
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "Hal.h"
+#include "SignalStorage.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace {
+
+const unsigned int FREQ = 433;
+const unsigned int PROTOCOL = 1;
+const unsigned int BITS = 24;
+const unsigned long SETTLE_MS = 300;    // 等存储任务写完一批并完成压缩
+
+std::atomic<int> fsOps(0);
+std::atomic<int> cutAfter(-1);          // -1=不掉电
+
+std::atomic<bool> tearNextAppend(false);
+
+/**
+ * 下一次追加日志失败一次 (写了一半的批次，写入前先压缩)
+ */
+bool tearAppend(const char* op, const char* path) {
+    return !(strcmp(op, "write") == 0 && strcmp(path, "/signals.dat") == 0 && tearNextAppend.exchange(false));
+}
+
+/**
+ * 第cutAfter步起所有写操作失败
+ */
+bool powerCut(const char* op, const char* path) {
+    (void)op;
+    (void)path;
+    const int step = fsOps++;
+    return cutAfter < 0 || step < cutAfter;
+}
+
+// 信号库内容: 编码和显示名称，原始信号附带数据字数
+struct Item {
+    uint64_t code;
+    std::string name;
+    size_t rawWords;
+
+    bool operator==(const Item& other) const {
+        return code == other.code && name == other.name && rawWords == other.rawWords;
+    }
+};
+
+typedef std::vector<Item> Library;
+
+SignalRecord makeSignal(uint32_t code) {
+    SignalRecord signal;
+    signal.code = code;
+    signal.setFreq(FREQ);
+    signal.set(PROTOCOL, BITS, 0);
+    return signal;
+}
+
+/**
+ * 存储任务一直引用存储对象，测试里的对象不释放
+ */
+SignalStorage& newStorage() {
+    SignalStorage* storage = new SignalStorage();
+    TEST_ASSERT_TRUE(storage->begin());
+    return *storage;
+}
+
+Library readLibrary(SignalStorage& storage) {
+    Library library;
+    for (int i = 0; i < storage.getSignalCount(); i++) {
+        SignalRecord signal;
+        TEST_ASSERT_TRUE(storage.getSignal(i, signal));
+        char name[32];
+        storage.getSignalName(signal, name, sizeof(name));
+        Item item = { signal.code.low64(), name, 0 };
+        if (signal.isRaw()) {
+            uint16_t words[SignalStorage::MAX_RAW_WORDS];
+            item.rawWords = storage.loadRawData(signal, words, SignalStorage::MAX_RAW_WORDS);
+            TEST_ASSERT_TRUE(item.rawWords > 0);
+        }
+        library.push_back(item);
+    }
+    return library;
+}
+
+void copyTree(const std::string& from, const std::string& to) {
+    mkdir(to.c_str(), 0755);
+    DIR* dir = opendir(from.c_str());
+    TEST_ASSERT_NOT_NULL(dir);
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        const std::string source = from + "/" + entry->d_name;
+        const std::string target = to + "/" + entry->d_name;
+        struct stat info;
+        TEST_ASSERT_TRUE(stat(source.c_str(), &info) == 0);
+        if (S_ISDIR(info.st_mode)) {
+            copyTree(source, target);
+            continue;
+        }
+        FILE* in = fopen(source.c_str(), "rb");
+        FILE* out = fopen(target.c_str(), "wb");
+        TEST_ASSERT_TRUE(in != NULL && out != NULL);
+        char buffer[4096];
+        size_t bytes;
+        while ((bytes = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            fwrite(buffer, 1, bytes, out);
+        }
+        fclose(in);
+        fclose(out);
+    }
+    closedir(dir);
+}
+
+std::string makeTempDir() {
+    char dir[] = "/tmp/rf-power-cut-XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    return dir;
+}
+
+typedef void (*Setup)(SignalStorage& storage);
+typedef void (*Operation)(SignalStorage& storage);
+
+/**
+ * 建好基准信号库，返回所在目录和内容
+ */
+std::string buildBaseline(Setup setup, Library& baseline) {
+    const std::string dir = makeTempDir();
+    Hal::setFsRoot(dir.c_str());
+    SignalStorage& storage = newStorage();
+    setup(storage);
+    TEST_ASSERT_TRUE(storage.flush());
+    delay(SETTLE_MS);
+    baseline = readLibrary(storage);
+    return dir;
+}
+
+/**
+ * 在基准副本上执行操作，第cut步起掉电 (-1=不掉电)，返回执行的写操作步数
+ */
+int runOperation(const std::string& baselineDir, Operation operation, int cut, std::string& dir) {
+    dir = makeTempDir();
+    copyTree(baselineDir, dir);
+    Hal::setFsRoot(dir.c_str());
+    SignalStorage& storage = newStorage();
+
+    fsOps = 0;
+    cutAfter = cut;
+    Hal::setFsTap(powerCut);
+    operation(storage);
+    delay(SETTLE_MS);
+    Hal::setFsTap(NULL);
+    return fsOps;
+}
+
+/**
+ * 对每一步掉电后重启，检查信号库是accept()接受的状态之一，之后还能照常保存
+ */
+void runScenario(Setup setup, Operation operation, bool (*accept)(const Library&, const Library&, const Library&)) {
+    Library baseline;
+    const std::string baselineDir = buildBaseline(setup, baseline);
+
+    // 空跑: 总步数和操作后的信号库
+    std::string dir;
+    const int steps = runOperation(baselineDir, operation, -1, dir);
+    TEST_ASSERT_GREATER_THAN(0, steps);
+    Library after = readLibrary(newStorage());
+    TEST_ASSERT_FALSE(after == baseline);
+
+    for (int cut = 0; cut < steps; cut++) {
+        runOperation(baselineDir, operation, cut, dir);
+
+        // 重启
+        SignalStorage& storage = newStorage();
+        const Library library = readLibrary(storage);
+        if (!accept(library, baseline, after)) {
+            char message[96];
+            snprintf(message, sizeof(message), "第 %d/%d 步掉电后信号库不一致 (%d 个信号)",
+                     cut, steps, (int)library.size());
+            TEST_FAIL_MESSAGE(message);
+        }
+
+        // 恢复后的日志可以继续追加
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(900000), "after-reboot"));
+        TEST_ASSERT_TRUE(storage.flush());
+    }
+}
+
+bool beforeOrAfter(const Library& library, const Library& baseline, const Library& after) {
+    return library == baseline || library == after;
+}
+
+/**
+ * 从头按顺序删掉若干个 (每个墓碑单独生效)
+ */
+bool prefixDeleted(const Library& library, const Library& baseline, const Library& after) {
+    (void)after;
+    if (library.size() > baseline.size()) {
+        return false;
+    }
+    const size_t deleted = baseline.size() - library.size();
+    return Library(baseline.begin() + deleted, baseline.end()) == library;
+}
+
+// ---------- 场景 ----------
+
+void setupNamed(SignalStorage& storage) {
+    for (uint32_t code = 1; code <= 40; code++) {
+        char name[24];
+        snprintf(name, sizeof(name), "remote-%u", (unsigned int)code);
+        TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(code), (code % 4 == 0) ? name : NULL));
+    }
+    uint16_t words[64];
+    for (size_t i = 0; i < 64; i++) {
+        words[i] = (uint16_t)(300 + i);
+    }
+    TEST_ASSERT_TRUE(storage.saveRawSignal(FREQ, words, 64));
+}
+
+void saveWithNewName(SignalStorage& storage) {
+    TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(500), "porch-light"));
+    storage.flush();
+}
+
+void deleteRaw(SignalStorage& storage) {
+    TEST_ASSERT_TRUE(storage.deleteSignal(storage.getSignalCount() - 1));
+    storage.flush();
+}
+
+void deleteMostAndCompact(SignalStorage& storage) {
+    const unsigned long compactions = storage.getCompactionCount();
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_TRUE(storage.deleteSignal(0));
+    }
+    // 存储任务写墓碑并压缩 (掉电时两者都可能失败，等足够久)
+    for (int i = 0; i < 100 && storage.getCompactionCount() == compactions && cutAfter < 0; i++) {
+        delay(10);
+    }
+}
+
+/**
+ * 改写日志文件头的版本号，begin()认为这一代不可用
+ */
+void corruptLogHeader(const std::string& dir) {
+    FILE* file = fopen((dir + "/signals.dat").c_str(), "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    const uint16_t version = 0xFFFF;
+    fseek(file, sizeof(uint32_t), SEEK_SET);
+    TEST_ASSERT_EQUAL(1, (int)fwrite(&version, sizeof(version), 1, file));
+    fclose(file);
+}
+
+const char* findName(const Library& library, uint64_t code) {
+    for (size_t i = 0; i < library.size(); i++) {
+        if (library[i].code == code) {
+            return library[i].name.c_str();
+        }
+    }
+    return NULL;
+}
+
+} // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {
+    Hal::setFsTap(NULL);
+}
+
+/**
+ * 追加新信号: 先替换名称池，再追加ADD记录
+ */
+void test_power_cut_while_appending(void) {
+    runScenario(setupNamed, saveWithNewName, beforeOrAfter);
+}
+
+/**
+ * 删除原始信号: 追加墓碑后删除数据文件
+ */
+void test_power_cut_while_deleting(void) {
+    runScenario(setupNamed, deleteRaw, beforeOrAfter);
+}
+
+/**
+ * 一批墓碑写入后压缩: 临时文件、两次改名、名称池清理
+ */
+void test_power_cut_while_compacting(void) {
+    runScenario(setupNamed, deleteMostAndCompact, prefixDeleted);
+}
+
+/**
+ * 删除带名称的信号时日志写坏: 压缩在墓碑写入前完成并清理名称池，
+ * 同样长度的新名称接着保存。正式日志随后损坏，退回上一代日志 (被删除的
+ * 信号还在)，它的名称不能被清掉或变成新名称
+ */
+void test_names_survive_fallback_to_previous_log(void) {
+    const std::string dir = makeTempDir();
+    Hal::setFsRoot(dir.c_str());
+    SignalStorage& storage = newStorage();
+    setupNamed(storage);
+    TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(700), "alpha-remote"));
+    TEST_ASSERT_TRUE(storage.flush());
+    delay(SETTLE_MS);
+
+    const unsigned long compactions = storage.getCompactionCount();
+    Hal::setFsTap(tearAppend);
+    tearNextAppend = true;
+    TEST_ASSERT_TRUE(storage.deleteSignal(storage.findSignal(RFCode(700), BITS, PROTOCOL, FREQ)));
+    TEST_ASSERT_TRUE(storage.flush());
+    Hal::setFsTap(NULL);
+    TEST_ASSERT_FALSE(tearNextAppend);
+    TEST_ASSERT_EQUAL_UINT32(compactions + 1, storage.getCompactionCount());
+
+    TEST_ASSERT_TRUE(storage.saveSignal(makeSignal(701), "porch-light!"));
+    TEST_ASSERT_TRUE(storage.flush());
+    delay(SETTLE_MS);
+
+    corruptLogHeader(dir);
+    const Library library = readLibrary(newStorage());
+    TEST_ASSERT_NOT_NULL(findName(library, 700));
+    TEST_ASSERT_EQUAL_STRING("alpha-remote", findName(library, 700));
+    TEST_ASSERT_NULL(findName(library, 701));
+    TEST_ASSERT_EQUAL_STRING("remote-40", findName(library, 40));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_power_cut_while_appending);
+    RUN_TEST(test_power_cut_while_deleting);
+    RUN_TEST(test_power_cut_while_compacting);
+    RUN_TEST(test_names_survive_fallback_to_previous_log);
+    const int failures = UNITY_END();
+    // 存储任务还在运行，直接退出
+    fflush(stdout);
+    _exit(failures);
+}
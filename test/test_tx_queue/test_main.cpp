@@ -0,0 +1,207 @@
+/**
+ * @file test_main.cpp
+ * @brief TxQueue的排队语义 (注入假时钟)
+ *
+ * 优先级和同优先级的先后顺序、重复发送的间隔、按编号取消，
+ * 时间完全由测试控制，包括micros()回绕。
+ */
+
+#include <unity.h>
+#include "TxQueue.h"
+
+namespace {
+
+const unsigned int CAPACITY = 8;
+
+unsigned long fakeNow = 0;
+
+unsigned long fakeClock() {
+    return fakeNow;
+}
+
+TxJob makeJob(TxPriority priority, uint16_t repeats = 0, unsigned long intervalUs = 0) {
+    TxJob job = TxJob();
+    job.priority = priority;
+    job.repeats = repeats;
+    job.intervalUs = intervalUs;
+    return job;
+}
+
+} // namespace
+
+void setUp(void) {
+    fakeNow = 1000;
+}
+
+void tearDown(void) {}
+
+/**
+ * 紧急任务排在所有普通任务之前，编号从1开始递增
+ */
+void test_urgent_jumps_normal(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    const uint32_t a = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t b = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t u = queue.push(makeJob(TX_PRIORITY_URGENT));
+    const uint32_t c = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t v = queue.push(makeJob(TX_PRIORITY_URGENT));
+    TEST_ASSERT_EQUAL_UINT32(1, a);
+    TEST_ASSERT_EQUAL_UINT32(5, v);
+
+    const uint32_t expected[] = { u, v, a, b, c };
+    TxJob job;
+    for (unsigned int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(queue.pop(job));
+        TEST_ASSERT_EQUAL_UINT32(expected[i], job.id);
+    }
+    TEST_ASSERT_FALSE(queue.pop(job));
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+/**
+ * 同优先级先入先出，入队时间取注入的时钟；满了拒绝
+ */
+void test_fifo_within_priority(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    uint32_t ids[CAPACITY];
+    for (unsigned int i = 0; i < CAPACITY; i++) {
+        fakeNow = 1000 + i * 10;
+        ids[i] = queue.push(makeJob(TX_PRIORITY_NORMAL));
+        TEST_ASSERT_NOT_EQUAL(0, ids[i]);
+    }
+    TEST_ASSERT_TRUE(queue.full());
+    TEST_ASSERT_EQUAL_UINT32(0, queue.push(makeJob(TX_PRIORITY_URGENT)));
+
+    TxJob job;
+    for (unsigned int i = 0; i < CAPACITY; i++) {
+        TEST_ASSERT_TRUE(queue.pop(job));
+        TEST_ASSERT_EQUAL_UINT32(ids[i], job.id);
+        TEST_ASSERT_EQUAL_UINT32(1000 + i * 10, job.queuedAt);
+    }
+}
+
+/**
+ * 重复发送: 同一编号按间隔再出队，间隔未到时不出队，次数用完后结束
+ */
+void test_repeat_waits_for_interval(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    const uint32_t id = queue.push(makeJob(TX_PRIORITY_NORMAL, 2, 5000));
+    TEST_ASSERT_EQUAL_UINT32(0, queue.nextDelay());
+
+    TxJob job;
+    for (int remaining = 2; remaining >= 0; remaining--) {
+        TEST_ASSERT_TRUE(queue.pop(job));
+        TEST_ASSERT_EQUAL_UINT32(id, job.id);
+        TEST_ASSERT_EQUAL_UINT32(remaining, job.repeats);
+
+        fakeNow += 300;     // 播放耗时
+        if (remaining == 0) {
+            TEST_ASSERT_FALSE(queue.reschedule(job));
+            break;
+        }
+        TEST_ASSERT_TRUE(queue.reschedule(job));
+
+        fakeNow += 4999;
+        TEST_ASSERT_FALSE(queue.pop(job));
+        TEST_ASSERT_EQUAL_UINT32(1, queue.nextDelay());
+        fakeNow += 1;
+    }
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_EQUAL_UINT32(TxQueue<CAPACITY>::NEVER, queue.nextDelay());
+}
+
+/**
+ * 等待间隔的紧急任务不挡住已经可以发送的普通任务，到时间后再插队
+ */
+void test_waiting_repeat_does_not_block(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    const uint32_t urgent = queue.push(makeJob(TX_PRIORITY_URGENT, 1, 2000));
+    TxJob job;
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_TRUE(queue.reschedule(job));
+
+    const uint32_t a = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t b = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(a, job.id);
+
+    fakeNow += 2000;
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(urgent, job.id);
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(b, job.id);
+}
+
+/**
+ * 按编号取消: 排队中和等待重复的任务都能移除，其他任务顺序不变
+ */
+void test_cancel_by_id(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    const uint32_t a = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t b = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t c = queue.push(makeJob(TX_PRIORITY_NORMAL));
+    const uint32_t r = queue.push(makeJob(TX_PRIORITY_URGENT, 3, 10000));
+
+    TxJob job;
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(r, job.id);
+    TEST_ASSERT_TRUE(queue.reschedule(job));
+
+    TEST_ASSERT_TRUE(queue.remove(b, job));
+    TEST_ASSERT_EQUAL_UINT32(b, job.id);
+    TEST_ASSERT_FALSE(queue.remove(b, job));
+    TEST_ASSERT_TRUE(queue.remove(r, job));
+    TEST_ASSERT_EQUAL_UINT32(2, job.repeats);
+    TEST_ASSERT_FALSE(queue.remove(999, job));
+
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(a, job.id);
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(c, job.id);
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+/**
+ * 全部取消时popAny()也取出还没到时间的任务
+ */
+void test_pop_any_ignores_schedule(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    queue.push(makeJob(TX_PRIORITY_NORMAL, 1, 100000));
+    TxJob job;
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_TRUE(queue.reschedule(job));
+    TEST_ASSERT_FALSE(queue.pop(job));
+    TEST_ASSERT_TRUE(queue.popAny(job));
+    TEST_ASSERT_TRUE(queue.empty());
+}
+
+/**
+ * 时钟回绕: 间隔跨过unsigned long的最大值仍按差值计算
+ */
+void test_interval_across_clock_wrap(void) {
+    TxQueue<CAPACITY> queue(fakeClock);
+    fakeNow = ~0UL - 1000;
+    queue.push(makeJob(TX_PRIORITY_NORMAL, 1, 3000));
+    TxJob job;
+    TEST_ASSERT_TRUE(queue.pop(job));
+    TEST_ASSERT_TRUE(queue.reschedule(job));
+
+    TEST_ASSERT_EQUAL_UINT32(3000, queue.nextDelay());
+    fakeNow += 2999;    // 已经回绕
+    TEST_ASSERT_FALSE(queue.pop(job));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.nextDelay());
+    fakeNow += 1;
+    TEST_ASSERT_TRUE(queue.pop(job));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_urgent_jumps_normal);
+    RUN_TEST(test_fifo_within_priority);
+    RUN_TEST(test_repeat_waits_for_interval);
+    RUN_TEST(test_waiting_repeat_does_not_block);
+    RUN_TEST(test_cancel_by_id);
+    RUN_TEST(test_pop_any_ignores_schedule);
+    RUN_TEST(test_interval_across_clock_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+通过串口备份/导入RF遥控器的信号库 (协议见 lib/SignalTransfer/SignalTransfer.h)
+
+用法:
+    python3 tools/rfx.py export /dev/ttyACM0 backup.jsonl
+    python3 tools/rfx.py import /dev/ttyACM0 backup.jsonl
+    python3 tools/rfx.py trace /dev/ttyACM0 capture.rft --ms 5000
+
+备份文件每行一个信号 (JSON)，原始信号的脉冲数据以十六进制放在 "data" 字段。
+trace录制接收机输出的边沿轨迹 (格式见 lib/EdgeTrace/EdgeTrace.h)，
+可以放进 native/corpus 用 rf-remote replay 回放。
+需要 pyserial (pip install -r tools/requirements.txt)。
+"""
+
+import argparse
+import json
+import sys
+import time
+import zlib
+
+import serial
+
+PREFIX = "RFX "
+WORDS_PER_FRAME = 64
+WINDOW_BYTES = 1024         # 未确认数据上限 (设备接收缓冲区为1280字节)
+RETRANSMIT_TIMEOUT = 1.0    # 无确认时重发 (秒)
+REPLY_TIMEOUT = 10.0        # 等待设备应答 (秒)
+
+
+class TransferError(Exception):
+    pass
+
+
+def crc32(text):
+    return zlib.crc32(text.encode("utf-8")) & 0xFFFFFFFF
+
+
+class LineReader:
+    """按行读取串口 (超时返回的半行留到下次拼接)"""
+
+    def __init__(self, port):
+        self.port = port
+        self.buffer = bytearray()
+
+    def read_line(self, deadline):
+        """读取一行协议输出，忽略日志等其他行"""
+        while True:
+            end = self.buffer.find(b"\n")
+            if end >= 0:
+                line = bytes(self.buffer[:end])
+                del self.buffer[:end + 1]
+                text = line.decode("utf-8", "replace").rstrip("\r")
+                # 日志可能插在协议行前面
+                index = text.find(PREFIX)
+                if index >= 0:
+                    return text[index + len(PREFIX):]
+                continue
+            if time.monotonic() >= deadline:
+                return None
+            self.buffer += self.port.read(max(1, self.port.in_waiting))
+
+    def reset(self):
+        self.port.reset_input_buffer()
+        self.buffer.clear()
+
+
+def export_library(port, path):
+    reader = LineReader(port)
+    reader.reset()
+    port.write(b"RFX EXPORT\n")
+
+    deadline = time.monotonic() + REPLY_TIMEOUT
+    records = []
+    expected_seq = 1
+    total_crc = 0
+    while True:
+        line = reader.read_line(deadline)
+        if line is None:
+            raise TransferError("等待设备超时")
+        deadline = time.monotonic() + REPLY_TIMEOUT
+
+        kind, _, rest = line.partition(" ")
+        if kind == "BEGIN":
+            print("设备共有 %s 个信号" % rest, file=sys.stderr)
+        elif kind in ("D", "W"):
+            seq, crc, payload = rest.split(" ", 2)
+            if int(seq) != expected_seq or int(crc, 16) != crc32(payload):
+                raise TransferError("第 %d 帧损坏" % expected_seq)
+            expected_seq += 1
+            total_crc = zlib.crc32(payload.encode("utf-8"), total_crc)
+            if kind == "D":
+                records.append(json.loads(payload))
+            elif records and records[-1].get("type") == "raw":
+                records[-1]["data"] = records[-1].get("data", "") + payload
+            else:
+                raise TransferError("第 %s 帧: 原始数据前没有信号" % seq)
+        elif kind == "END":
+            frames, crc = rest.split(" ")
+            if int(frames) != expected_seq - 1 or int(crc, 16) != total_crc & 0xFFFFFFFF:
+                raise TransferError("帧数或总CRC不符")
+            break
+        elif kind == "ERROR":
+            raise TransferError("设备报错: " + rest)
+
+    with open(path, "w", encoding="utf-8") as f:
+        for record in records:
+            f.write(json.dumps(record, ensure_ascii=False, separators=(",", ":")) + "\n")
+    return len(records)
+
+
+def record_trace(port, path, ms):
+    reader = LineReader(port)
+    reader.reset()
+    port.write(b"RFX TRACE %d\n" % ms)
+
+    # 录制期间设备不发协议行
+    deadline = time.monotonic() + REPLY_TIMEOUT + ms / 1000.0
+    data = bytearray()
+    expected_seq = 1
+    total_crc = 0
+    while True:
+        line = reader.read_line(deadline)
+        if line is None:
+            raise TransferError("等待设备超时")
+        deadline = time.monotonic() + REPLY_TIMEOUT + ms / 1000.0
+
+        kind, _, rest = line.partition(" ")
+        if kind == "RECORDING":
+            print("录制 %s ms ..." % rest, file=sys.stderr)
+        elif kind == "BEGIN":
+            print("轨迹 %s 字节" % rest, file=sys.stderr)
+        elif kind == "T":
+            seq, crc, payload = rest.split(" ", 2)
+            if int(seq) != expected_seq or int(crc, 16) != crc32(payload):
+                raise TransferError("第 %d 帧损坏" % expected_seq)
+            expected_seq += 1
+            total_crc = zlib.crc32(payload.encode("utf-8"), total_crc)
+            data += bytes.fromhex(payload)
+        elif kind == "END":
+            frames, crc = rest.split(" ")
+            if int(frames) != expected_seq - 1 or int(crc, 16) != total_crc & 0xFFFFFFFF:
+                raise TransferError("帧数或总CRC不符")
+            break
+        elif kind == "ERROR":
+            raise TransferError("设备报错: " + rest)
+
+    with open(path, "wb") as f:
+        f.write(data)
+    return len(data)
+
+
+def build_frames(path):
+    """备份文件拆成D/W帧"""
+    frames = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            record = json.loads(line)
+            data = record.pop("data", "")
+            if record.get("type") == "raw":
+                record["words"] = len(data) // 4
+            frames.append(("D", json.dumps(record, ensure_ascii=False, separators=(",", ":"))))
+            for i in range(0, len(data), WORDS_PER_FRAME * 4):
+                frames.append(("W", data[i:i + WORDS_PER_FRAME * 4]))
+
+    lines = []
+    for seq, (kind, payload) in enumerate(frames, 1):
+        lines.append(("RFX %s %d %08x %s\n" % (kind, seq, crc32(payload), payload)).encode("utf-8"))
+    return lines
+
+
+def import_library(port, path):
+    lines = build_frames(path)
+    count = len(lines)
+
+    reader = LineReader(port)
+    reader.reset()
+    for _ in range(3):
+        port.write(b"RFX IMPORT\n")
+        line = reader.read_line(time.monotonic() + RETRANSMIT_TIMEOUT * 2)
+        if line is not None:
+            break
+    if line is None or not line.startswith("READY"):
+        raise TransferError("设备未就绪: %s" % line)
+    print("设备剩余容量 %s" % line.split(" ")[1], file=sys.stderr)
+
+    base = 1            # 最早未确认的序号
+    next_seq = 1        # 下一个要发送的序号
+    last_progress = time.monotonic()
+    end_sent = False
+    while True:
+        # 窗口内连续发送
+        in_flight = sum(len(lines[i - 1]) for i in range(base, next_seq))
+        while next_seq <= count and in_flight + len(lines[next_seq - 1]) <= WINDOW_BYTES:
+            port.write(lines[next_seq - 1])
+            in_flight += len(lines[next_seq - 1])
+            next_seq += 1
+        if base > count and not end_sent:
+            port.write(b"RFX END %d\n" % count)
+            end_sent = True
+
+        line = reader.read_line(time.monotonic() + RETRANSMIT_TIMEOUT)
+        if line is None:
+            if time.monotonic() - last_progress > REPLY_TIMEOUT:
+                raise TransferError("设备无应答")
+            next_seq = base     # 超时，从最早未确认的帧重发
+            end_sent = False
+            continue
+
+        kind, _, rest = line.partition(" ")
+        if kind == "ACK":
+            seq = int(rest)
+            if seq >= base:
+                base = seq + 1
+                last_progress = time.monotonic()
+        elif kind == "NAK":
+            seq = int(rest.split(" ")[0])
+            base = max(base, seq)
+            next_seq = seq
+            end_sent = False
+        elif kind == "DONE":
+            added, skipped, failed = (int(x) for x in rest.split(" "))
+            return added, skipped, failed
+        elif kind == "ERROR" and rest == "names":
+            raise TransferError("设备名称池已满，导入终止 (第 %d 帧之前的信号已保存)" % base)
+        elif kind == "ERROR":
+            raise TransferError("设备报错: " + rest)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RF遥控器信号库串口备份/导入")
+    parser.add_argument("command", choices=["export", "import", "trace"])
+    parser.add_argument("port", help="串口, 例如 /dev/ttyACM0 或 COM3")
+    parser.add_argument("file", help="备份文件 (每行一个JSON) 或轨迹文件 (trace)")
+    parser.add_argument("--retries", type=int, default=3, help="导出失败时重试次数")
+    parser.add_argument("--ms", type=int, default=5000, help="轨迹录制时长 (毫秒, 最长60000)")
+    args = parser.parse_args()
+
+    port = serial.Serial(args.port, 115200, timeout=0.1)
+    start = time.monotonic()
+    try:
+        if args.command == "export":
+            for attempt in range(args.retries + 1):
+                try:
+                    count = export_library(port, args.file)
+                    break
+                except TransferError as e:
+                    if attempt == args.retries:
+                        raise
+                    print("导出失败 (%s)，重试" % e, file=sys.stderr)
+                    port.write(b"RFX ABORT\n")
+                    time.sleep(0.5)
+            print("导出 %d 个信号, %.1f 秒" % (count, time.monotonic() - start), file=sys.stderr)
+        elif args.command == "trace":
+            size = record_trace(port, args.file, args.ms)
+            print("轨迹已保存: %d 字节" % size, file=sys.stderr)
+        else:
+            added, skipped, failed = import_library(port, args.file)
+            print("导入完成: 新增 %d, 已存在 %d, 失败 %d, %.1f 秒"
+                  % (added, skipped, failed, time.monotonic() - start), file=sys.stderr)
+    except TransferError as e:
+        print("错误: %s" % e, file=sys.stderr)
+        return 1
+    finally:
+        port.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())